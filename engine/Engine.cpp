@@ -159,6 +159,9 @@ using namespace TelEngine;
 #define WORKER_SLEEP 500000
 #endif
 
+// Default lock profiler sampling interval when enabled from command
+#define DEF_LOCK_PROFILE 100
+
 // Supervisor control constants
 
 // Minimum configurable size of child's sanity pool
@@ -247,6 +250,7 @@ static void sighandler(int signal)
 static void abrthandler(int sig)
 {
     ::signal(SIGABRT,s_abrt_handler);
+    Debugger::flushOutput(true);
     Engine* eng = Engine::self();
     if (eng) {
 	// TODO: retrieve all the information without getting any mutex locks
@@ -554,6 +558,22 @@ bool EngineStatusHandler::received(Message &msg)
 		objects(msg.retValue(),details);
 	    return true;
 	}
+	if (sel.startSkip("dns")) {
+	    msg.retValue() << "name=dns,type=system;";
+	    Resolver::cacheStatus(msg.retValue());
+	    msg.retValue() << "\r\n";
+	    if ((sel == YSTRING("flush")) || msg.getBoolValue(YSTRING("flush")))
+		Resolver::cacheFlush();
+	    return true;
+	}
+	if (sel.startSkip("locks")) {
+	    msg.retValue() << "name=locks,type=system";
+	    Lockable::dumpProfiling(msg.retValue(),details);
+	    msg.retValue() << "\r\n";
+	    if ((sel == YSTRING("reset")) || msg.getBoolValue(YSTRING("reset")))
+		Lockable::resetProfiling();
+	    return true;
+	}
 	if (sel.startSkip("dispatcher")) {
 	    bool byMsg = sel.startSkip("handlers");
 	    if ((byMsg || sel.startSkip("handlers-trackname")) && sel) {
@@ -620,6 +640,7 @@ bool EngineStatusHandler::received(Message &msg)
 	msg.retValue() << ",waiting=" << locks;
     msg.retValue() << ",acceptcalls=" << lookup(Engine::accept(),Engine::getCallAcceptStates());
     msg.retValue() << ",congestion=" << Engine::getCongestion();
+    msg.retValue() << ",outdropped=" << Debugger::outputDropped();
     if (msg.getBoolValue("reset",false))
 	Engine::self()->resetMax();
     if (details) {
@@ -690,6 +711,8 @@ static const char s_logvOpt[] = "  logview\r\n";
 static const char s_logvMsg[] = "Show log of engine startup and initialization process\r\n";
 static const char s_runpOpt[] = "  runparam name=value\r\n";
 static const char s_runpMsg[] = "Add a new parameter to the Engine's runtime list\r\n";
+static const char s_locksOpt[] = "  locks [on [sample]|off|reset]\r\n";
+static const char s_locksMsg[] = "Control the lock contention profiler, see results with 'status locks [reset]'\r\n";
 static const char s_dispatcherHelpShort[] =
     "  dispatcher {handlers|trace_msg_time|trace_msg_handler_time}\r\n"
     "  status dispatcher ...\r\n";
@@ -811,6 +834,7 @@ void EngineCommand::doCompletion(Message &msg, const String& partLine, const Str
 	completeOne(msg.retValue(),YSTRING("logview"),partWord);
 	completeOne(msg.retValue(),YSTRING("runparam"),partWord);
 	completeOne(msg.retValue(),YSTRING("dispatcher"),partWord);
+	completeOne(msg.retValue(),YSTRING("locks"),partWord);
 	if (!partLine)
 	    completeOne(msg.retValue(),YSTRING("version"),partWord);
     }
@@ -818,6 +842,17 @@ void EngineCommand::doCompletion(Message &msg, const String& partLine, const Str
 	completeOne(msg.retValue(),YSTRING("engine"),partWord);
 	completeOne(msg.retValue(),YSTRING("objects"),partWord);
 	completeOne(msg.retValue(),YSTRING("dispatcher"),partWord);
+	completeOne(msg.retValue(),YSTRING("locks"),partWord);
+	completeOne(msg.retValue(),YSTRING("dns"),partWord);
+    }
+    else if (partLine == YSTRING("status locks"))
+	completeOne(msg.retValue(),YSTRING("reset"),partWord);
+    else if (partLine == YSTRING("status dns"))
+	completeOne(msg.retValue(),YSTRING("flush"),partWord);
+    else if (partLine == YSTRING("locks")) {
+	completeOne(msg.retValue(),YSTRING("on"),partWord);
+	completeOne(msg.retValue(),YSTRING("off"),partWord);
+	completeOne(msg.retValue(),YSTRING("reset"),partWord);
     }
     else if (partLine == YSTRING("status objects")) {
 	for (ObjList* l = getObjCounters().skipNull();l;l = l->skipNext())
@@ -945,6 +980,21 @@ bool EngineCommand::received(Message &msg)
 	    }
 	    return false;
 	}
+	if (line.startSkip("locks")) {
+	    if (line.startSkip("reset"))
+		Lockable::resetProfiling();
+	    else if (line.startSkip("off"))
+		Lockable::enableProfiling(0);
+	    else if (line.startSkip("on"))
+		Lockable::enableProfiling(line.toInteger(DEF_LOCK_PROFILE,0,1));
+	    else if (line)
+		return false;
+	    if (Lockable::profiling())
+		(msg.retValue() = "Lock profiling is on, sampling every ") << Lockable::profiling() << " acquisitions\r\n";
+	    else
+		msg.retValue() = "Lock profiling is off\r\n";
+	    return true;
+	}
 	if (line.startSkip("dispatcher")) {
 	    ObjList tmp;
 	    line.split(tmp,' ',false);
@@ -1088,7 +1138,7 @@ bool EngineHelp::received(Message &msg)
     const char* opts = (s_nounload ? s_cmdsOptNoUnload : s_cmdsOpt);
     String line = msg.getValue("line");
     if (line.null()) {
-	msg.retValue() << opts << s_evtsOpt << s_logvOpt << s_runpOpt << s_dispatcherHelpShort;
+	msg.retValue() << opts << s_evtsOpt << s_logvOpt << s_runpOpt << s_locksOpt << s_dispatcherHelpShort;
 	msg.retValue() << "  version\r\n";
 	return false;
     }
@@ -1100,6 +1150,8 @@ bool EngineHelp::received(Message &msg)
 	msg.retValue() << s_logvOpt << s_logvMsg;
     else if (line == YSTRING("runparam"))
 	msg.retValue() << s_runpOpt << s_runpMsg;
+    else if (line == YSTRING("locks"))
+	msg.retValue() << s_locksOpt << s_locksMsg;
     else if (line == YSTRING("dispatcher"))
 	msg.retValue() << s_dispatcherHelp;
     else
@@ -1774,9 +1826,13 @@ int Engine::engineInit()
     if (s_timejump && (s_timejump < MIN_TIME_JUMP))
 	s_timejump = MIN_TIME_JUMP;
     s_timejump *= 1000;
+    Debugger::asyncOutput(1024 * s_cfg.getIntValue("general","asyncoutput",0,0,65536));
+    Lockable::enableProfiling(s_cfg.getIntValue("general","lockprofile",0,0,1000000));
     m_dispatcher.warnTime(1000*(u_int64_t)s_cfg.getIntValue("general","warntime"));
     m_dispatcher.traceTime(s_cfg.getBoolValue("general","trace_msg_time"));
     m_dispatcher.traceHandlerTime(s_cfg.getBoolValue("general","trace_msg_handler_time"));
+    NamedList* dns = s_cfg.getSection("dns");
+    Resolver::setup(dns ? *dns : NamedList::empty());
     extraPath(clientMode() ? "client" : "server");
     extraPath(s_cfg.getValue("general","extrapath"));
 
@@ -2011,6 +2067,10 @@ int Engine::run()
 	    if (s_timejump && (s_timejump < MIN_TIME_JUMP))
 		s_timejump = MIN_TIME_JUMP;
 	    s_timejump *= 1000;
+	    Debugger::asyncOutput(1024 * s_cfg.getIntValue("general","asyncoutput",0,0,65536));
+	    Lockable::enableProfiling(s_cfg.getIntValue("general","lockprofile",Lockable::profiling(),0,1000000));
+	    NamedList* dns = s_cfg.getSection("dns");
+	    Resolver::setup(dns ? *dns : NamedList::empty());
 	    initPlugins();
 	    last = 0;
 	}
@@ -2168,6 +2228,8 @@ int Engine::engineCleanup()
     checkPoint();
     // We are occasionally doing things that can cause crashes so don't abort
     abortOnBug(s_sigabrt && s_lateabrt);
+    // stop the output thread so it's not killed holding buffered lines
+    Debugger::asyncOutput(0);
     Thread::killall();
     checkPoint();
     m_dispatcher.dequeue();
@@ -2765,6 +2827,8 @@ int Engine::cleanupLibrary()
 {
     // We are occasionally doing things that can cause crashes so don't abort
     abortOnBug(s_sigabrt && s_lateabrt);
+    // stop the output thread so it's not killed holding buffered lines
+    Debugger::asyncOutput(0);
     Thread::killall();
     int mux = Mutex::locks();
     if (mux < 0)
@@ -19,6 +19,9 @@
 
 #include "yateclass.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 #ifdef _WINDOWS
 
 typedef HANDLE HMUTEX;
@@ -56,12 +59,51 @@ typedef pthread_rwlock_t rwlock_t;
 
 namespace TelEngine {
 
+// Number of wait and hold time histogram buckets, each 4 times larger
+#define LOCK_PROFILE_BUCKETS 10
+// Size of the lock name hash table
+#define LOCK_PROFILE_HASH 127
+
+// Contention statistics of all locks sharing a name and type
+struct LockProfile
+{
+    LockProfile* next;
+    char* name;
+    const char* type;
+    u_int64_t acquired;
+    u_int64_t contended;
+    u_int64_t waitTotal;
+    u_int64_t waitMax;
+    u_int64_t holds;
+    u_int64_t holdTotal;
+    u_int64_t holdMax;
+    u_int64_t wait[LOCK_PROFILE_BUCKETS];
+    u_int64_t hold[LOCK_PROFILE_BUCKETS];
+};
+
+// Statistics of a single lock, merged in the named ones periodically
+struct LockProfileData
+{
+    LockProfile* stats;
+    unsigned int acquired;
+    unsigned int contended;
+    unsigned int holds;
+    u_int64_t holdStart;
+    u_int64_t waitTotal;
+    u_int64_t waitMax;
+    u_int64_t holdTotal;
+    u_int64_t holdMax;
+    unsigned int wait[LOCK_PROFILE_BUCKETS];
+    unsigned int hold[LOCK_PROFILE_BUCKETS];
+};
+
 class LockablePrivateBase
 {
 public:
     inline LockablePrivateBase(const char* name)
-	: m_name(name ? name : ""), m_owner(0), m_ownerName(0)
+	: m_profile(0), m_name(name ? name : ""), m_owner(0), m_ownerName(0)
 	{}
+    ~LockablePrivateBase();
     inline const char* name() const
 	{ return m_name; }
     inline Thread* owner() const
@@ -74,6 +116,7 @@ protected:
 	    m_owner = th;
 	    m_ownerName = th ? th->name() : "";
 	}
+    LockProfileData* m_profile;
 private:
     const char* m_name;
     Thread* m_owner;
@@ -98,6 +141,7 @@ public:
     static volatile int s_count;
     static volatile int s_locks;
 private:
+    bool tryLock();
     HMUTEX m_mutex;
     int m_refcount;
     volatile unsigned int m_locked;
@@ -127,6 +171,7 @@ private:
     volatile unsigned int m_waiting;
     unsigned int m_maxcount;
     const char* m_name;
+    LockProfileData* m_profile;
 };
 
 class RWLockPrivate : public LockablePrivateBase
@@ -183,6 +228,8 @@ static GlobalMutex s_global;
 static unsigned long s_maxwait = 0;
 static bool s_unsafe = MUTEX_STATIC_UNSAFE;
 static bool s_safety = false;
+static unsigned int s_profile = 0;
+static LockProfile* s_profiles[LOCK_PROFILE_HASH];
 #ifdef _WINDOWS
 static bool s_rwLockDisabled = true;
 #else
@@ -245,6 +292,185 @@ void GlobalMutex::unlock()
 #endif
 }
 
+// Profile counters are updated concurrently by holders of shared locks
+#ifdef ATOMIC_OPS
+#ifdef _WINDOWS
+static inline unsigned int profileAdd(unsigned int& val, unsigned int n = 1)
+    { return (unsigned int)InterlockedExchangeAdd((LONG*)&val,(LONG)n) + n; }
+static inline void profileAdd(u_int64_t& val, u_int64_t n)
+    { InterlockedExchangeAdd64((LONGLONG*)&val,(LONGLONG)n); }
+static inline unsigned int profileTake(unsigned int& val)
+    { return (unsigned int)InterlockedExchange((LONG*)&val,0); }
+static inline u_int64_t profileTake(u_int64_t& val)
+    { return (u_int64_t)InterlockedExchange64((LONGLONG*)&val,0); }
+static inline bool profileSwap(u_int64_t& val, u_int64_t old, u_int64_t n)
+    { return (u_int64_t)InterlockedCompareExchange64((LONGLONG*)&val,(LONGLONG)n,(LONGLONG)old) == old; }
+#else
+static inline unsigned int profileAdd(unsigned int& val, unsigned int n = 1)
+    { return __sync_add_and_fetch(&val,n); }
+static inline void profileAdd(u_int64_t& val, u_int64_t n)
+    { __sync_add_and_fetch(&val,n); }
+static inline unsigned int profileTake(unsigned int& val)
+    { return __sync_fetch_and_and(&val,0); }
+static inline u_int64_t profileTake(u_int64_t& val)
+    { return __sync_fetch_and_and(&val,0); }
+static inline bool profileSwap(u_int64_t& val, u_int64_t old, u_int64_t n)
+    { return __sync_bool_compare_and_swap(&val,old,n); }
+#endif
+#else
+// shared locks are accounted with GlobalMutex locked
+static inline unsigned int profileAdd(unsigned int& val, unsigned int n = 1)
+    { return val += n; }
+static inline void profileAdd(u_int64_t& val, u_int64_t n)
+    { val += n; }
+static inline unsigned int profileTake(unsigned int& val)
+    { unsigned int tmp = val; val = 0; return tmp; }
+static inline u_int64_t profileTake(u_int64_t& val)
+    { u_int64_t tmp = val; val = 0; return tmp; }
+static inline bool profileSwap(u_int64_t& val, u_int64_t old, u_int64_t n)
+    { val = n; return true; }
+#endif
+
+// Raise a profile maximum
+static inline void profileMax(u_int64_t& val, u_int64_t n)
+{
+    for (u_int64_t old = val; old < n; old = val) {
+	if (profileSwap(val,old,n))
+	    break;
+    }
+}
+
+// Histogram bucket of a time interval in usec
+static inline unsigned int profileBucket(u_int64_t usec)
+{
+    unsigned int b = 0;
+    while (usec && (b < LOCK_PROFILE_BUCKETS - 1)) {
+	usec >>= 2;
+	b++;
+    }
+    return b;
+}
+
+// Find or create the statistics of a lock name, GlobalMutex must be locked
+static LockProfile* profileFind(const char* name, const char* type)
+{
+    if (!(name && *name))
+	name = "?";
+    LockProfile** bucket = &s_profiles[String::hash(name) % LOCK_PROFILE_HASH];
+    for (LockProfile* p = *bucket; p; p = p->next) {
+	if ((p->type == type) && !::strcmp(p->name,name))
+	    return p;
+    }
+    LockProfile* p = new LockProfile;
+    ::memset(p,0,sizeof(LockProfile));
+    unsigned int len = ::strlen(name);
+    p->name = new char[len + 1];
+    ::memcpy(p->name,name,len + 1);
+    p->type = type;
+    p->next = *bucket;
+    *bucket = p;
+    return p;
+}
+
+// Merge the statistics of a lock in the named ones, GlobalMutex must be locked
+static void profileMerge(LockProfileData* data)
+{
+    // counters are taken one by one, shared holders may still update them
+    LockProfile* p = data->stats;
+    p->acquired += profileTake(data->acquired);
+    p->contended += profileTake(data->contended);
+    p->waitTotal += profileTake(data->waitTotal);
+    u_int64_t max = profileTake(data->waitMax);
+    if (p->waitMax < max)
+	p->waitMax = max;
+    p->holds += profileTake(data->holds);
+    p->holdTotal += profileTake(data->holdTotal);
+    max = profileTake(data->holdMax);
+    if (p->holdMax < max)
+	p->holdMax = max;
+    for (unsigned int i = 0; i < LOCK_PROFILE_BUCKETS; i++) {
+	p->wait[i] += profileTake(data->wait[i]);
+	p->hold[i] += profileTake(data->hold[i]);
+    }
+}
+
+// Account a successful lock acquisition
+// Wait start is non zero if the lock was contended, hold is set if hold time can be sampled
+// Shared is set if other threads may hold the lock at the same time
+static void profileAcquired(LockProfileData*& data, const char* name, const char* type,
+    u_int64_t waitStart, bool hold, bool shared)
+{
+    unsigned int sample = s_profile;
+    if (!sample)
+	return;
+    if (!data) {
+	GlobalMutex::lock();
+	if (!data) {
+	    LockProfileData* tmp = new LockProfileData;
+	    ::memset(tmp,0,sizeof(LockProfileData));
+	    tmp->stats = profileFind(name,type);
+	    data = tmp;
+	}
+	GlobalMutex::unlock();
+    }
+#ifndef ATOMIC_OPS
+    if (shared)
+	GlobalMutex::lock();
+#endif
+    unsigned int acquired = profileAdd(data->acquired);
+    if (waitStart) {
+	u_int64_t wait = Time::now() - waitStart;
+	profileAdd(data->contended);
+	profileAdd(data->waitTotal,wait);
+	profileMax(data->waitMax,wait);
+	profileAdd(data->wait[profileBucket(wait)]);
+    }
+#ifndef ATOMIC_OPS
+    if (shared)
+	GlobalMutex::unlock();
+#endif
+    if (acquired < sample)
+	return;
+    // sample hold time of the acquisition that triggers the merge
+    if (hold && !data->holdStart)
+	data->holdStart = Time::now();
+    GlobalMutex::lock();
+    profileMerge(data);
+    GlobalMutex::unlock();
+}
+
+// Account the release of a lock whose hold time is sampled
+static inline void profileReleased(LockProfileData* data)
+{
+    if (!(data && data->holdStart))
+	return;
+    u_int64_t hold = Time::now() - data->holdStart;
+    data->holdStart = 0;
+    profileAdd(data->holds);
+    profileAdd(data->holdTotal,hold);
+    profileMax(data->holdMax,hold);
+    profileAdd(data->hold[profileBucket(hold)]);
+}
+
+// Merge and release the statistics of a destroyed lock
+static void profileDestroyed(LockProfileData*& data)
+{
+    if (!data)
+	return;
+    GlobalMutex::lock();
+    data->holdStart = 0;
+    profileMerge(data);
+    GlobalMutex::unlock();
+    delete data;
+    data = 0;
+}
+
+
+LockablePrivateBase::~LockablePrivateBase()
+{
+    profileDestroyed(m_profile);
+}
+
 
 MutexPrivate::MutexPrivate(bool recursive, const char* name)
     : LockablePrivateBase(name),
@@ -318,15 +544,19 @@ bool MutexPrivate::lock(long maxwait)
 	m_waiting++;
 	GlobalMutex::unlock();
     }
+    // when profiling try first to find out if the lock is contended
+    u_int64_t waitStart = 0;
+    if (s_profile && maxwait && !s_unsafe && !(rval = tryLock()))
+	waitStart = Time::now();
 #ifdef _WINDOWS
     DWORD ms = 0;
     if (maxwait < 0)
 	ms = INFINITE;
     else if (maxwait > 0)
 	ms = (DWORD)(maxwait / 1000);
-    rval = s_unsafe || (::WaitForSingleObject(m_mutex,ms) == WAIT_OBJECT_0);
+    rval = rval || s_unsafe || (::WaitForSingleObject(m_mutex,ms) == WAIT_OBJECT_0);
 #else
-    if (s_unsafe)
+    if (rval || s_unsafe)
 	rval = true;
     else if (maxwait < 0)
 	rval = !::pthread_mutex_lock(&m_mutex);
@@ -374,6 +604,8 @@ bool MutexPrivate::lock(long maxwait)
     }
     if (safety)
 	GlobalMutex::unlock();
+    if (rval && s_profile)
+	profileAcquired(m_profile,name(),"mutex",waitStart,(1 == m_locked),false);
     if (warn && !rval)
 	Debug(DebugFail,
 	    "Thread '%s' could not lock mutex '%s' owned by '%s' (%p) waited by %u others for %lu usec!",
@@ -381,6 +613,15 @@ bool MutexPrivate::lock(long maxwait)
     return rval;
 }
 
+bool MutexPrivate::tryLock()
+{
+#ifdef _WINDOWS
+    return (::WaitForSingleObject(m_mutex,0) == WAIT_OBJECT_0);
+#else
+    return !::pthread_mutex_trylock(&m_mutex);
+#endif
+}
+
 bool MutexPrivate::unlock()
 {
     bool ok = false;
@@ -397,6 +638,7 @@ bool MutexPrivate::unlock()
 		Debug(DebugFail,"MutexPrivate '%s' unlocked by '%s' (%p) but owned by '%s' (%p) [%p]",
 		    name(),thr ? thr->name() : "",thr,ownerName(),owner(),this);
 	    setOwner();
+	    profileReleased(m_profile);
 	}
 	if (safety) {
 	    int locks = --s_locks;
@@ -426,7 +668,7 @@ bool MutexPrivate::unlock()
 SemaphorePrivate::SemaphorePrivate(unsigned int maxcount, const char* name,
     unsigned int initialCount)
     : m_refcount(1), m_waiting(0), m_maxcount(maxcount),
-      m_name(name)
+      m_name(name), m_profile(0)
 {
     if (initialCount > m_maxcount)
 	initialCount = m_maxcount;
@@ -442,6 +684,7 @@ SemaphorePrivate::SemaphorePrivate(unsigned int maxcount, const char* name,
 
 SemaphorePrivate::~SemaphorePrivate()
 {
+    profileDestroyed(m_profile);
     GlobalMutex::lock();
     s_count--;
 #ifdef _WINDOWS
@@ -475,15 +718,26 @@ bool SemaphorePrivate::lock(long maxwait)
 	m_waiting++;
 	GlobalMutex::unlock();
     }
+    // when profiling try first to find out if the semaphore is contended
+    u_int64_t waitStart = 0;
+    if (s_profile && maxwait && !s_unsafe) {
+#ifdef _WINDOWS
+	rval = (::WaitForSingleObject(m_semaphore,0) == WAIT_OBJECT_0);
+#else
+	rval = !::sem_trywait(&m_semaphore);
+#endif
+	if (!rval)
+	    waitStart = Time::now();
+    }
 #ifdef _WINDOWS
     DWORD ms = 0;
     if (maxwait < 0)
 	ms = INFINITE;
     else if (maxwait > 0)
 	ms = (DWORD)(maxwait / 1000);
-    rval = s_unsafe || (::WaitForSingleObject(m_semaphore,ms) == WAIT_OBJECT_0);
+    rval = rval || s_unsafe || (::WaitForSingleObject(m_semaphore,ms) == WAIT_OBJECT_0);
 #else
-    if (s_unsafe)
+    if (rval || s_unsafe)
 	rval = true;
     else if (maxwait < 0)
 	rval = !::sem_wait(&m_semaphore);
@@ -530,6 +784,8 @@ bool SemaphorePrivate::lock(long maxwait)
 	thr->m_locking = false;
     if (safety)
 	GlobalMutex::unlock();
+    if (rval && s_profile)
+	profileAcquired(m_profile,m_name,"semaphore",waitStart,false,true);
     if (warn && !rval)
 	Debug(DebugFail,"Thread '%s' could not lock semaphore '%s' waited by %u others for %lu usec!",
 	    Thread::currentName(),m_name,m_waiting,maxwait);
@@ -603,6 +859,93 @@ unsigned long Lockable::wait()
     return s_maxwait;
 }
 
+void Lockable::enableProfiling(unsigned int sample)
+{
+    s_profile = sample;
+}
+
+unsigned int Lockable::profiling()
+{
+    return s_profile;
+}
+
+void Lockable::resetProfiling()
+{
+    GlobalMutex::lock();
+    for (unsigned int i = 0; i < LOCK_PROFILE_HASH; i++) {
+	for (LockProfile* p = s_profiles[i]; p; p = p->next) {
+	    LockProfile* next = p->next;
+	    char* name = p->name;
+	    const char* type = p->type;
+	    ::memset(p,0,sizeof(LockProfile));
+	    p->next = next;
+	    p->name = name;
+	    p->type = type;
+	}
+    }
+    GlobalMutex::unlock();
+}
+
+// Sort lock statistics by total wait time, then by acquisitions
+static int profileCompare(const void* a, const void* b)
+{
+    const LockProfile* p1 = static_cast<const LockProfile*>(a);
+    const LockProfile* p2 = static_cast<const LockProfile*>(b);
+    if (p1->waitTotal != p2->waitTotal)
+	return (p1->waitTotal > p2->waitTotal) ? -1 : 1;
+    if (p1->acquired != p2->acquired)
+	return (p1->acquired > p2->acquired) ? -1 : 1;
+    return ::strcmp(p1->name,p2->name);
+}
+
+void Lockable::dumpProfiling(String& str, bool details)
+{
+    // copy the statistics, don't build strings with the global mutex locked
+    GlobalMutex::lock();
+    unsigned int n = 0;
+    for (unsigned int i = 0; i < LOCK_PROFILE_HASH; i++) {
+	for (LockProfile* p = s_profiles[i]; p; p = p->next)
+	    if (p->acquired)
+		n++;
+    }
+    LockProfile* stats = n ? new LockProfile[n] : 0;
+    n = 0;
+    for (unsigned int i = 0; stats && (i < LOCK_PROFILE_HASH); i++) {
+	for (LockProfile* p = s_profiles[i]; p; p = p->next)
+	    if (p->acquired)
+		stats[n++] = *p;
+    }
+    GlobalMutex::unlock();
+    if (details)
+	str << ",format=Type|Acquired|Contended|WaitAvg|WaitMax|HoldAvg|HoldMax|Wait|Hold";
+    str << ";profiling=" << s_profile << ",count=" << n << ",buckets=0";
+    for (unsigned int b = 1, usec = 1; b < LOCK_PROFILE_BUCKETS; b++, usec *= 4)
+	str << "/" << usec;
+    if (details && n) {
+	::qsort(stats,n,sizeof(LockProfile),profileCompare);
+	str << ";";
+	for (unsigned int i = 0; i < n; i++) {
+	    const LockProfile& p = stats[i];
+	    String name(p.name);
+	    for (char* c = const_cast<char*>(name.c_str()); *c; c++) {
+		if (*c == ',' || *c == ';' || *c == '=' || *c == '|')
+		    *c = '_';
+	    }
+	    if (i)
+		str << ",";
+	    str << name << "=" << p.type << "|" << p.acquired << "|" << p.contended;
+	    str << "|" << (p.contended ? (p.waitTotal / p.contended) : 0) << "|" << p.waitMax;
+	    str << "|" << (p.holds ? (p.holdTotal / p.holds) : 0) << "|" << p.holdMax << "|";
+	    for (unsigned int b = 0; b < LOCK_PROFILE_BUCKETS; b++)
+		str << (b ? "/" : "") << p.wait[b];
+	    str << "|";
+	    for (unsigned int b = 0; b < LOCK_PROFILE_BUCKETS; b++)
+		str << (b ? "/" : "") << p.hold[b];
+	}
+    }
+    delete[] stats;
+}
+
 
 Mutex::Mutex(bool recursive, const char* name)
     : m_private(0)
@@ -908,9 +1251,19 @@ bool RWLockPrivate::readLock(long maxwait)
 #ifdef _WINDOWS
     // not implemented, uses m_nonRWLck
 #else
-    if (s_unsafe)
+    // when profiling try first to find out if the lock is contended
+    u_int64_t waitStart = 0;
+    bool locked = false;
+    if (s_profile && maxwait && !s_unsafe) {
+	ret = ::pthread_rwlock_tryrdlock(&m_lock);
+	if (ret)
+	    waitStart = Time::now();
+	else
+	    locked = true;
+    }
+    if (s_unsafe || locked)
 	ret = 0;
-    if (maxwait < 0)
+    else if (maxwait < 0)
 	ret = ::pthread_rwlock_rdlock(&m_lock);
     else if (!maxwait)
 	ret = ::pthread_rwlock_tryrdlock(&m_lock);
@@ -963,6 +1316,10 @@ bool RWLockPrivate::readLock(long maxwait)
     }
     if (safety)
 	GlobalMutex::unlock();
+#ifndef _WINDOWS
+    if (!ret && s_profile)
+	profileAcquired(m_profile,name(),"rwlock",waitStart,false,true);
+#endif
     if (warn && ret)
 	Debug(DebugFail,"Thread '%s' could not lock for read RW lock '%s'"
 	    " writing-owned by '%s' (%p) after waiting for %ld usec! [%p]",
@@ -992,9 +1349,19 @@ bool RWLockPrivate::writeLock(long maxwait)
 #ifdef _WINDOWS
     // not implemented, uses m_nonRWLck
 #else
-    if (s_unsafe)
+    // when profiling try first to find out if the lock is contended
+    u_int64_t waitStart = 0;
+    bool locked = false;
+    if (s_profile && maxwait && !s_unsafe) {
+	ret = ::pthread_rwlock_trywrlock(&m_lock);
+	if (ret)
+	    waitStart = Time::now();
+	else
+	    locked = true;
+    }
+    if (s_unsafe || locked)
 	ret = 0;
-    if (maxwait < 0)
+    else if (maxwait < 0)
 	ret = ::pthread_rwlock_wrlock(&m_lock);
     else if (!maxwait)
 	ret = ::pthread_rwlock_trywrlock(&m_lock);
@@ -1048,6 +1415,10 @@ bool RWLockPrivate::writeLock(long maxwait)
     }
     if (safety)
 	GlobalMutex::unlock();
+#ifndef _WINDOWS
+    if (!ret && s_profile)
+	profileAcquired(m_profile,name(),"rwlock",waitStart,true,false);
+#endif
     if (warn && ret)
 	Debug(DebugFail,"Thread '%s' could not lock for write RW lock '%s'"
 	    " writing-owned by '%s' (%p) after waiting for %ld usec! [%p]",
@@ -1086,6 +1457,7 @@ bool RWLockPrivate::unlock()
 		Debug(DebugFail,"RWLockPrivate '%s' unlocked by '%s' (%p) but owned by '%s' (%p) [%p]",
 		    name(),thr ? thr->name() : "",thr,ownerName(),owner(),this);
 	    setOwner();
+	    profileReleased(m_profile);
 	}
 	if (safety) {
 	    int locks = --s_locks;
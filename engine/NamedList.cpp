@@ -124,12 +124,19 @@ NamedList& NamedList::addParam(const char* name, const char* value, bool emptyOK
     return *this;
 }
 
+// Identical interned names are the same object, don't compare their text
+static inline bool nlSameName(const NamedString* ns, const String& name, bool interned)
+{
+    return interned ? (&ns->name() == &name) : (ns->name() == name);
+}
+
 static inline void nlClearParam(const String& name, ObjList* lst)
 {
+    bool interned = NamedString::isName(name);
     lst = lst ? lst->skipNull() : 0;
     while (lst) {
         NamedString* ns = static_cast<NamedString*>(lst->get());
-        if (ns->name() == name) {
+        if (nlSameName(ns,name,interned)) {
 	    lst->remove();
 	    lst = lst->skipNull();
 	}
@@ -143,10 +150,11 @@ NamedList& NamedList::setParam(NamedString* param, bool clearOther)
     XDebug(DebugAll,"NamedList::setParam(%p) [%p]",param,this);
     if (!param)
 	return *this;
+    bool interned = NamedString::isName(param->name());
     ObjList* o = m_params.skipNull();
     while (o) {
         NamedString* s = static_cast<NamedString*>(o->get());
-        if (s->name() == param->name()) {
+        if (nlSameName(s,param->name(),interned)) {
 	    o->set(param);
 	    if (clearOther)
 		nlClearParam(param->name(),o->skipNext());
@@ -170,9 +178,10 @@ static inline NamedString* nlSetParamCreate(NamedList& list, const String& name,
     ObjList* append = list.paramList()->skipNull();
     if (!append)
 	return static_cast<NamedString*>(list.paramList()->append(new NamedString(name))->get());
+    bool interned = NamedString::isName(name);
     while (true) {
         NamedString* ns = static_cast<NamedString*>(append->get());
-        if (ns->name() == name) {
+        if (nlSameName(ns,name,interned)) {
 	    if (clearOther)
 		nlClearParam(name,append->skipNext());
 	    return ns;
@@ -553,10 +562,11 @@ int NamedList::getIndex(const NamedString* param) const
 
 int NamedList::getIndex(const String& name) const
 {
+    bool interned = NamedString::isName(name);
     const ObjList *p = &m_params;
     for (int i=0; p; p=p->next(),i++) {
         NamedString *s = static_cast<NamedString *>(p->get());
-        if (s && (s->name() == name))
+        if (s && nlSameName(s,name,interned))
             return i;
     }
     return -1;
@@ -565,10 +575,11 @@ int NamedList::getIndex(const String& name) const
 NamedString* NamedList::getParam(const String& name) const
 {
     XDebug(DebugInfo,"NamedList::getParam(\"%s\")",name.c_str());
+    bool interned = NamedString::isName(name);
     const ObjList *p = m_params.skipNull();
     for (; p; p=p->skipNext()) {
         NamedString *s = static_cast<NamedString *>(p->get());
-        if (s->name() == name)
+        if (nlSameName(s,name,interned))
             return s;
     }
     return 0;
@@ -35,8 +35,11 @@
 #elif !defined(NO_RESOLV)
 #include <resolv.h>
 #include <arpa/nameser.h>
+#include <netinet/in.h>
 #endif // _WINDOWS
 
+#include <string.h>
+
 using namespace TelEngine;
 
 // Resolver type names
@@ -128,6 +131,215 @@ static bool insertRecord(ObjList& result, DnsRecord* rec, bool ascPref, const ch
 }
 
 
+/*
+ * Query cache
+ */
+namespace { // anonymous
+
+#define DNS_CACHE_HASH 256               // Buckets in the query cache
+#define DNS_MAX_SERVERS 3                // Maximum configured name servers
+
+// A cached or in progress query
+class DnsCacheEntry : public RefObject
+{
+public:
+    inline DnsCacheEntry(const String& key, Resolver::Type type, const String& dname)
+	: m_key(key), m_type(type), m_dname(dname), m_code(0), m_expire(0),
+	  m_pending(true), m_waiters(0), m_done(0x7fffffff,"DnsCacheEntry",0)
+	{ }
+    virtual const String& toString() const
+	{ return m_key; }
+    String m_key;
+    Resolver::Type m_type;
+    String m_dname;
+    int m_code;
+    String m_error;
+    ObjList m_records;
+    u_int64_t m_expire;                  // Expiration time in msec, 0 to not keep
+    bool m_pending;                      // Query in progress
+    unsigned int m_waiters;              // Threads waiting for query completion
+    Semaphore m_done;                    // Signaled once for each waiter
+};
+
+// Cache and statistics, all protected by the cache mutex
+class DnsCache
+{
+public:
+    inline DnsCache()
+	: m_mutex(false,"DnsCache"), m_entries(DNS_CACHE_HASH), m_count(0),
+	  m_enabled(true), m_maxEntries(10000), m_minTtl(0), m_maxTtl(3600),
+	  m_negTtl(60), m_waitTimeout(10000000), m_servers(0),
+	  m_hits(0), m_negHits(0), m_misses(0), m_coalesced(0), m_expired(0),
+	  m_evicted(0), m_failures(0), m_waitTimeouts(0)
+	{ }
+    // Find an entry, drop it if expired. Mutex must be locked
+    DnsCacheEntry* find(const String& key, u_int64_t now);
+    // Add a pending entry, evict old ones if full. Mutex must be locked
+    DnsCacheEntry* add(const String& key, Resolver::Type type, const String& dname);
+    // Run a query and complete the entry
+    void resolve(DnsCacheEntry* e);
+    // Set entry result, notify waiters
+    void complete(DnsCacheEntry* e, int code, ObjList& records, const String& error);
+    // Build the cache key of a query
+    static void buildKey(String& key, Resolver::Type type, const char* dname);
+
+    Mutex m_mutex;
+    HashList m_entries;
+    unsigned int m_count;
+    // Configuration
+    bool m_enabled;
+    unsigned int m_maxEntries;
+    unsigned int m_minTtl;
+    unsigned int m_maxTtl;
+    unsigned int m_negTtl;
+    u_int64_t m_waitTimeout;             // Wait for a query in progress, in usec
+#ifdef __RES
+    struct sockaddr_in m_serverAddr[DNS_MAX_SERVERS];
+#endif
+    unsigned int m_servers;
+    // Statistics
+    u_int64_t m_hits;
+    u_int64_t m_negHits;
+    u_int64_t m_misses;
+    u_int64_t m_coalesced;
+    u_int64_t m_expired;
+    u_int64_t m_evicted;
+    u_int64_t m_failures;
+    u_int64_t m_waitTimeouts;
+};
+
+static DnsCache s_cache;
+
+// Build the cache key of a query
+void DnsCache::buildKey(String& key, Resolver::Type type, const char* dname)
+{
+    key << lookup(type,Resolver::s_types,"?") << ":" << dname;
+    key.toLower();
+}
+
+// Find an entry, drop it if expired
+DnsCacheEntry* DnsCache::find(const String& key, u_int64_t now)
+{
+    DnsCacheEntry* e = static_cast<DnsCacheEntry*>(m_entries[key]);
+    if (e && !e->m_pending && (e->m_expire <= now)) {
+	m_expired++;
+	m_entries.remove(e,key.hash());
+	m_count--;
+	e = 0;
+    }
+    return e;
+}
+
+// Add a pending entry, evict old ones if full
+DnsCacheEntry* DnsCache::add(const String& key, Resolver::Type type, const String& dname)
+{
+    if (m_count >= m_maxEntries) {
+	// drop expired entries first, then anything completed
+	u_int64_t now = Time::msecNow();
+	for (int pass = 0; pass < 2 && (m_count >= m_maxEntries); pass++) {
+	    for (unsigned int i = 0; i < m_entries.length(); i++) {
+		ObjList* l = m_entries.getList(i);
+		while (l) {
+		    DnsCacheEntry* e = static_cast<DnsCacheEntry*>(l->get());
+		    if (e && !e->m_pending && (pass || (e->m_expire <= now))) {
+			l->remove();
+			m_count--;
+			if (pass)
+			    m_evicted++;
+			else
+			    m_expired++;
+			continue;
+		    }
+		    l = l->next();
+		}
+		if (pass && (m_count < m_maxEntries))
+		    break;
+	    }
+	}
+    }
+    DnsCacheEntry* e = new DnsCacheEntry(key,type,dname);
+    m_entries.append(e);
+    m_count++;
+    return e;
+}
+
+// Run a query and complete the entry
+void DnsCache::resolve(DnsCacheEntry* e)
+{
+    ObjList records;
+    String error;
+    int code = -1;
+    if (Resolver::init())
+	code = Resolver::query(e->m_type,e->m_dname,records,&error);
+    else
+	error = "Resolver not available";
+    complete(e,code,records,error);
+}
+
+// Set entry result, notify waiters
+void DnsCache::complete(DnsCacheEntry* e, int code, ObjList& records, const String& error)
+{
+    // Negative answers are cached, transient errors are not
+    bool negative = !records.skipNull();
+#ifdef _WINDOWS
+    bool cacheable = !code || (code == DNS_ERROR_RCODE_NAME_ERROR) || (code == DNS_INFO_NO_RECORDS);
+#elif defined(__RES)
+    bool cacheable = !code || (code == HOST_NOT_FOUND) || (code == NO_DATA);
+#else
+    bool cacheable = false;
+#endif
+    unsigned int ttl = 0;
+    if (!negative) {
+	ttl = m_maxTtl;
+	for (ObjList* o = records.skipNull(); o; o = o->skipNext()) {
+	    int t = static_cast<DnsRecord*>(o->get())->ttl();
+	    if (t < 0)
+		t = 0;
+	    if ((unsigned int)t < ttl)
+		ttl = t;
+	}
+	if (ttl < m_minTtl)
+	    ttl = m_minTtl;
+    }
+    else
+	ttl = m_negTtl;
+    Lock lck(m_mutex);
+    e->m_code = code;
+    e->m_error = error;
+    e->m_records.clear();
+    Resolver::copyRecords(e->m_type,e->m_records,records);
+    e->m_pending = false;
+    if (code)
+	m_failures++;
+    if (m_enabled && cacheable && ttl)
+	e->m_expire = Time::msecNow() + 1000 * (u_int64_t)ttl;
+    else {
+	e->m_expire = 0;
+	if (m_entries.remove(e,e->m_key.hash(),false)) {
+	    m_count--;
+	    e->deref();
+	}
+    }
+    for (; e->m_waiters; e->m_waiters--)
+	e->m_done.unlock();
+}
+
+// Apply the configured name servers to the resolver of the current thread
+static void setServers()
+{
+#ifdef __RES
+    Lock lck(s_cache.m_mutex);
+    if (!s_cache.m_servers)
+	return;
+    for (unsigned int i = 0; i < s_cache.m_servers; i++)
+	_res.nsaddr_list[i] = s_cache.m_serverAddr[i];
+    _res.nscount = s_cache.m_servers;
+#endif
+}
+
+}; // anonymous namespace
+
+
 /*
  * __dn_skipname() not available at link time
 */
@@ -359,6 +571,27 @@ void NaptrRecord::dump(String& buf, const char* sep)
     buf << sep << "next=" << "'" << m_next << "'";
 }
 
+// Copy a NaptrRecord list into another one
+void NaptrRecord::copy(ObjList& dest, const ObjList& src)
+{
+    dest.clear();
+    ObjList* last = &dest;
+    for (ObjList* o = src.skipNull(); o; o = o->skipNext()) {
+	NaptrRecord* rec = static_cast<NaptrRecord*>(o->get());
+	NaptrRecord* n = new NaptrRecord;
+	n->m_ttl = rec->m_ttl;
+	n->m_order = rec->m_order;
+	n->m_pref = rec->m_pref;
+	n->m_flags = rec->m_flags;
+	n->m_service = rec->m_service;
+	n->m_regmatch.setFlags(true,false);
+	n->m_regmatch = rec->m_regmatch;
+	n->m_template = rec->m_template;
+	n->m_next = rec->m_next;
+	last = last->append(n);
+    }
+}
+
 
 // Runtime check for resolver availability
 bool Resolver::available(Type t)
@@ -400,6 +633,7 @@ bool Resolver::init(int timeout, int retries)
 	_res.retrans = timeout;
     if (retries >= 0)
 	_res.retry = retries;
+    setServers();
     return true;
 #endif
     return false;
@@ -848,4 +1082,163 @@ int Resolver::txtQuery(const char* dname, ObjList& result, String* error)
     return printResult(Txt,code,dname,result,error);
 }
 
+// Configure the query cache
+void Resolver::setup(const NamedList& params)
+{
+    Lock lck(s_cache.m_mutex);
+    s_cache.m_enabled = params.getBoolValue(YSTRING("cache"),true);
+    s_cache.m_maxEntries = params.getIntValue(YSTRING("cache_size"),10000,10,1000000);
+    s_cache.m_minTtl = params.getIntValue(YSTRING("min_ttl"),0,0,86400);
+    s_cache.m_maxTtl = params.getIntValue(YSTRING("max_ttl"),3600,s_cache.m_minTtl,86400);
+    s_cache.m_negTtl = params.getIntValue(YSTRING("negative_ttl"),60,0,86400);
+    s_cache.m_waitTimeout = 1000 * (u_int64_t)params.getIntValue(YSTRING("wait_timeout"),10000,100,120000);
+    s_cache.m_servers = 0;
+#ifdef __RES
+    ObjList* list = params[YSTRING("nameservers")].split(',',false);
+    for (ObjList* o = list->skipNull(); o && s_cache.m_servers < DNS_MAX_SERVERS; o = o->skipNext()) {
+	String* str = static_cast<String*>(o->get());
+	str->trimBlanks();
+	String host = *str;
+	int port = 53;
+	int pos = str->rfind(':');
+	if (pos > 0) {
+	    host = str->substr(0,pos);
+	    port = str->substr(pos + 1).toInteger(0);
+	}
+	SocketAddr addr(SocketAddr::IPv4);
+	if (!(port > 0 && port < 65536 && addr.host(host) && addr.port(port))) {
+	    Debug(DebugConf,"Resolver: invalid name server '%s'",str->c_str());
+	    continue;
+	}
+	::memcpy(&s_cache.m_serverAddr[s_cache.m_servers++],addr.address(),sizeof(struct sockaddr_in));
+    }
+    TelEngine::destruct(list);
+#endif
+    if (!s_cache.m_enabled) {
+	lck.drop();
+	cacheFlush();
+    }
+}
+
+// Make a query using the cache, wait for an identical query in progress
+int Resolver::cachedQuery(Type type, const char* dname, ObjList& result, String* error)
+{
+    if (TelEngine::null(dname))
+	return query(type,dname,result,error);
+    String key;
+    DnsCache::buildKey(key,type,dname);
+    Lock lck(s_cache.m_mutex);
+    DnsCacheEntry* e = s_cache.find(key,Time::msecNow());
+    if (e && !e->m_pending) {
+	if (e->m_records.skipNull())
+	    s_cache.m_hits++;
+	else
+	    s_cache.m_negHits++;
+	copyRecords(type,result,e->m_records);
+	if (error)
+	    *error = e->m_error;
+	return e->m_code;
+    }
+    if (e) {
+	// Identical query in progress, wait for it
+	s_cache.m_coalesced++;
+	e->ref();
+	e->m_waiters++;
+	long tout = (long)s_cache.m_waitTimeout;
+	lck.drop();
+	bool done = e->m_done.lock(tout);
+	lck.acquire(s_cache.m_mutex);
+	int code = -1;
+	if (!(done || e->m_pending)) {
+	    // completed after the wait expired, take the signal meant for us
+	    e->m_done.lock(0);
+	    done = true;
+	}
+	if (done) {
+	    code = e->m_code;
+	    copyRecords(type,result,e->m_records);
+	    if (error)
+		*error = e->m_error;
+	}
+	else {
+	    e->m_waiters--;
+	    s_cache.m_waitTimeouts++;
+	    if (error)
+		*error = "Timeout waiting for query in progress";
+	}
+	lck.drop();
+	if (!done)
+	    Debug(DebugMild,"Resolver timed out waiting for %s query in progress",e->m_key.c_str());
+	TelEngine::destruct(e);
+	return code;
+    }
+    s_cache.m_misses++;
+    e = s_cache.add(key,type,dname);
+    e->ref();
+    lck.drop();
+    s_cache.resolve(e);
+    lck.acquire(s_cache.m_mutex);
+    int code = e->m_code;
+    copyRecords(type,result,e->m_records);
+    if (error)
+	*error = e->m_error;
+    lck.drop();
+    TelEngine::destruct(e);
+    return code;
+}
+
+// Copy a list of records of a given type
+void Resolver::copyRecords(Type type, ObjList& dest, const ObjList& src)
+{
+    switch (type) {
+	case Srv:
+	    SrvRecord::copy(dest,src);
+	    break;
+	case Naptr:
+	    NaptrRecord::copy(dest,src);
+	    break;
+	case A4:
+	case A6:
+	case Txt:
+	    TxtRecord::copy(dest,src);
+	    break;
+	default:
+	    dest.clear();
+    }
+}
+
+// Append cache statistics to a status string
+void Resolver::cacheStatus(String& buf)
+{
+    Lock lck(s_cache.m_mutex);
+    buf << "enabled=" << String::boolText(s_cache.m_enabled);
+    buf << ",entries=" << s_cache.m_count;
+    buf << ",hits=" << s_cache.m_hits;
+    buf << ",neghits=" << s_cache.m_negHits;
+    buf << ",misses=" << s_cache.m_misses;
+    buf << ",coalesced=" << s_cache.m_coalesced;
+    buf << ",expired=" << s_cache.m_expired;
+    buf << ",evicted=" << s_cache.m_evicted;
+    buf << ",failures=" << s_cache.m_failures;
+    buf << ",waittimeouts=" << s_cache.m_waitTimeouts;
+}
+
+// Remove all completed entries from the query cache
+void Resolver::cacheFlush()
+{
+    Lock lck(s_cache.m_mutex);
+    for (unsigned int i = 0; i < s_cache.m_entries.length(); i++) {
+	ObjList* l = s_cache.m_entries.getList(i);
+	while (l) {
+	    DnsCacheEntry* e = static_cast<DnsCacheEntry*>(l->get());
+	    if (e && !e->m_pending) {
+		l->remove();
+		s_cache.m_count--;
+		continue;
+	    }
+	    l = l->next();
+	}
+    }
+}
+
 /* vi: set ts=8 sw=4 sts=4 noet: */
@@ -56,6 +56,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <utime.h>
+#include <sys/uio.h>
 #endif
 
 #ifndef SHUT_RD
@@ -72,6 +73,8 @@
 
 #define MAX_SOCKLEN 1024
 #define MAX_RESWAIT 5000000
+// Maximum number of buffers passed to a single writev() call
+#define MAX_IOV 64
 
 using namespace TelEngine;
 
@@ -1624,6 +1627,176 @@ bool File::listDirectory(const char* path, ObjList* dirs, ObjList* files, int* e
 }
 
 
+const TokenDict BatchFileWriter::s_fsyncPolicy[] = {
+    { "none",   FsyncNone },
+    { "flush",  FsyncFlush },
+    { "rotate", FsyncRotate },
+    { 0, 0 }
+};
+
+BatchFileWriter::BatchFileWriter()
+    : m_flushInterval(0), m_flushSize(0), m_maxBacklog(0),
+      m_fsync(FsyncNone), m_rotateSize(0), m_rotateInterval(0),
+      m_queued(0), m_bytes(0), m_maxQueued(0), m_written(0), m_flushes(0),
+      m_flushTime(0), m_flushMax(0), m_errors(0), m_rotations(0)
+{
+}
+
+void BatchFileWriter::setup(const NamedList& params)
+{
+    m_flushInterval = params.getIntValue(YSTRING("flush_interval"),0,0,60000);
+    m_flushSize = params.getIntValue(YSTRING("flush_size"),65536,0,16777216);
+    m_maxBacklog = params.getIntValue(YSTRING("max_backlog"),4194304,65536);
+    m_fsync = params.getIntValue(YSTRING("fsync"),s_fsyncPolicy,FsyncNone);
+    m_rotateSize = params.getInt64Value(YSTRING("rotate_size"),0,0);
+    m_rotateInterval = params.getIntValue(YSTRING("rotate_interval"),0,0);
+}
+
+bool BatchFileWriter::needRotate(int64_t size, u_int32_t since) const
+{
+    if (m_rotateSize && (size >= m_rotateSize))
+	return true;
+    return m_rotateInterval && since && (Time::secNow() >= since + m_rotateInterval);
+}
+
+// Rename a file to name.YYYYMMDDhhmmss, add a counter if it already exists
+bool BatchFileWriter::rotate(const String& name, int* error)
+{
+    int year;
+    unsigned int month, day, hour, minute, sec;
+    Time::toDateTime(Time::secNow(),year,month,day,hour,minute,sec);
+    char buf[20];
+    ::snprintf(buf,sizeof(buf),".%04d%02u%02u%02u%02u%02u",year,month,day,hour,minute,sec);
+    String dest = name + buf;
+    for (unsigned int i = 1; File::exists(dest); i++)
+	dest = name + buf + "-" + String(i);
+    if (!File::rename(name,dest,error))
+	return false;
+    m_rotations++;
+    return true;
+}
+
+void BatchFileWriter::queued(unsigned int bytes)
+{
+    m_bytes += bytes;
+    if (++m_queued > m_maxQueued)
+	m_maxQueued = m_queued;
+}
+
+unsigned int BatchFileWriter::dequeued()
+{
+    unsigned int n = m_queued;
+    m_queued = 0;
+    m_bytes = 0;
+    return n;
+}
+
+void BatchFileWriter::flushed(unsigned int written, unsigned int errors, u_int64_t usec)
+{
+    m_written += written;
+    m_errors += errors;
+    m_flushes++;
+    m_flushTime += usec;
+    if (m_flushMax < usec)
+	m_flushMax = usec;
+}
+
+void BatchFileWriter::status(String& str) const
+{
+    str << "queued=" << m_queued << ",bytes=" << m_bytes << ",maxqueued=" << m_maxQueued;
+    str << ",written=" << m_written << ",errors=" << m_errors;
+    str << ",flushes=" << m_flushes;
+    str << ",flushavg=" << (unsigned int)(m_flushes ? (m_flushTime / m_flushes) : 0);
+    str << ",flushmax=" << (unsigned int)m_flushMax;
+    str << ",rotations=" << m_rotations;
+}
+
+bool BatchFileWriter::writeLines(File& file, const ObjList& lines, bool eoln, int64_t* bytes)
+{
+    if (!file.valid())
+	return false;
+    bool ok = true;
+    const ObjList* l = lines.skipNull();
+#ifdef _WINDOWS
+    String buf;
+    for (; l; l = l->skipNext()) {
+	buf += *static_cast<const String*>(l->get());
+	if (eoln)
+	    buf += BatchFileWriter::eoln();
+    }
+    ok = (file.writeData(buf.c_str(),buf.length()) == (int)buf.length());
+    if (ok && bytes)
+	*bytes += buf.length();
+#else
+    static const char s_eoln[] = { '\n' };
+    // Each line may need a second buffer for the terminator
+    int per = eoln ? 2 : 1;
+    struct iovec iov[MAX_IOV];
+    while (ok && l) {
+	int n = 0;
+	ssize_t total = 0;
+	for (; l && (n + per <= MAX_IOV); l = l->skipNext()) {
+	    const String* s = static_cast<const String*>(l->get());
+	    iov[n].iov_base = (void*)s->c_str();
+	    iov[n].iov_len = s->length();
+	    total += iov[n++].iov_len;
+	    if (eoln) {
+		iov[n].iov_base = (void*)s_eoln;
+		iov[n].iov_len = sizeof(s_eoln);
+		total += iov[n++].iov_len;
+	    }
+	}
+	struct iovec* v = iov;
+	while (total > 0) {
+	    ssize_t w = ::writev(file.handle(),v,n);
+	    if (w < 0) {
+		if (errno == EINTR)
+		    continue;
+		ok = false;
+		break;
+	    }
+	    if (bytes)
+		*bytes += w;
+	    total -= w;
+	    // Skip fully written buffers, adjust a partially written one
+	    while (n && (w >= (ssize_t)v->iov_len)) {
+		w -= v->iov_len;
+		v++;
+		n--;
+	    }
+	    if (n && w) {
+		v->iov_base = (char*)v->iov_base + w;
+		v->iov_len -= w;
+	    }
+	}
+    }
+#endif
+    if (ok && (m_fsync == FsyncFlush))
+	sync(file);
+    return ok;
+}
+
+bool BatchFileWriter::sync(File& file)
+{
+    if (!file.valid())
+	return false;
+#ifdef _WINDOWS
+    return 0 != ::FlushFileBuffers(file.handle());
+#else
+    return 0 == ::fsync(file.handle());
+#endif
+}
+
+const char* BatchFileWriter::eoln()
+{
+#ifdef _WINDOWS
+    return "\r\n";
+#else
+    return "\n";
+#endif
+}
+
+
 unsigned int Socket::s_features = 0
 #ifdef IPPROTO_IPV6
     | FProtoIpv6
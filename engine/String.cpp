@@ -2551,20 +2551,204 @@ bool Regexp::isCaseInsensitive() const
 }
 
 
+// Number of buckets in the interned parameter names table
+#define NAME_ATOM_BUCKETS 4093
+// Number of mutexes protecting the buckets
+#define NAME_ATOM_MUTEXES 31
+
+namespace { // anonymous
+
+// Interned, immutable and reference counted name shared by NamedString objects
+class NameAtom : public String
+{
+public:
+    inline NameAtom(const char* prefix, int prefixLen, const char* name, int nameLen, NameAtom* next)
+	: String(prefixLen ? prefix : name,prefixLen ? prefixLen : nameLen,
+	    prefixLen ? name : 0,prefixLen ? nameLen : 0),
+	  m_refs(1), m_next(next)
+	{ hash(); }
+    virtual void* getObject(const String& name) const
+	{
+	    if (name == YATOM("NameAtom"))
+		return (void*)this;
+	    return String::getObject(name);
+	}
+    inline bool equals(const char* prefix, unsigned int prefixLen, const char* name, unsigned int nameLen) const
+	{
+	    return (length() == prefixLen + nameLen) &&
+		!(prefixLen && ::memcmp(c_str(),prefix,prefixLen)) &&
+		!(nameLen && ::memcmp(c_str() + prefixLen,name,nameLen));
+	}
+    int m_refs;
+    NameAtom* m_next;
+};
+
+}; // anonymous namespace
+
+static NameAtom* s_nameAtoms[NAME_ATOM_BUCKETS];
+
+// The pool is never destroyed, static NamedString may outlive this module
+static MutexPool& nameAtomMutex()
+{
+    static MutexPool* s_pool = new MutexPool(NAME_ATOM_MUTEXES,false,"NameAtom");
+    return *s_pool;
+}
+
+// sdbm hash of a string of known length, same as String::hash()
+static inline unsigned int nameAtomHash(const char* str, unsigned int len, unsigned int h)
+{
+    while (len--)
+	h = (h << 6) + (h << 16) - h + (unsigned char)*str++;
+    return h;
+}
+
+// Take a new reference to an atom known to be alive
+static inline void nameAtomRef(NameAtom* atom)
+{
+#ifdef ATOMIC_OPS
+#ifdef _WINDOWS
+    InterlockedIncrement((LONG*)&atom->m_refs);
+#else
+    __sync_add_and_fetch(&atom->m_refs,1);
+#endif
+#else
+    Lock lck(nameAtomMutex().mutex(atom->hash() % NAME_ATOM_BUCKETS));
+    atom->m_refs++;
+#endif
+}
+
+// Drop a reference to an atom, remove it from table when last one is gone
+static void nameAtomDeref(const String* name)
+{
+    NameAtom* atom = static_cast<NameAtom*>(const_cast<String*>(name));
+    unsigned int idx = atom->hash() % NAME_ATOM_BUCKETS;
+#ifdef ATOMIC_OPS
+#ifdef _WINDOWS
+    if (InterlockedDecrement((LONG*)&atom->m_refs) > 0)
+	return;
+#else
+    if (__sync_sub_and_fetch(&atom->m_refs,1) > 0)
+	return;
+#endif
+    // Lookups never resurrect a dead atom so it's safe to drop it
+    Lock lck(nameAtomMutex().mutex(idx));
+#else
+    Lock lck(nameAtomMutex().mutex(idx));
+    if (--atom->m_refs > 0)
+	return;
+#endif
+    for (NameAtom** p = &s_nameAtoms[idx]; *p; p = &(*p)->m_next) {
+	if (*p == atom) {
+	    *p = atom->m_next;
+	    break;
+	}
+    }
+    lck.drop();
+    delete atom;
+}
+
+// Find or create the interned version of a prefixed name
+static const String* nameAtom(const char* prefix, int prefixLen, const char* name, int nameLen,
+    const String* hashed = 0)
+{
+    prefixLen = prefix ? getAllocLength(prefix,prefixLen) : 0;
+    nameLen = name ? getAllocLength(name,nameLen) : 0;
+    if (!(prefixLen || nameLen))
+	return &String::empty();
+    unsigned int h = hashed ? hashed->hash() :
+	nameAtomHash(name,nameLen,nameAtomHash(prefix,prefixLen,0));
+    unsigned int idx = h % NAME_ATOM_BUCKETS;
+    Lock lck(nameAtomMutex().mutex(idx));
+    for (NameAtom* a = s_nameAtoms[idx]; a; a = a->m_next) {
+	if (a->hash() != h || !a->equals(prefix,prefixLen,name,nameLen))
+	    continue;
+#ifdef ATOMIC_OPS
+	// Skip atoms whose last reference is being dropped
+#ifdef _WINDOWS
+	if (InterlockedIncrement((LONG*)&a->m_refs) > 1)
+	    return a;
+	InterlockedDecrement((LONG*)&a->m_refs);
+#else
+	if (__sync_add_and_fetch(&a->m_refs,1) > 1)
+	    return a;
+	__sync_sub_and_fetch(&a->m_refs,1);
+#endif
+#else
+	a->m_refs++;
+	return a;
+#endif
+    }
+    s_nameAtoms[idx] = new NameAtom(prefix,prefixLen,name,nameLen,s_nameAtoms[idx]);
+    return s_nameAtoms[idx];
+}
+
+// Retrieve the interned version of a name, share it if already interned
+static inline const String* nameAtom(const String& name)
+{
+    NameAtom* atom = static_cast<NameAtom*>(name.getObject(YATOM("NameAtom")));
+    if (atom) {
+	nameAtomRef(atom);
+	return atom;
+    }
+    return nameAtom(0,0,name.c_str(),name.length(),&name);
+}
+
+
 NamedString::NamedString(const char* name, const char* value, int len,
     const char* namePrefix, int nameLen)
-    : String(value,len)
+    : String(value,len),
+      m_name(nameAtom(namePrefix,-1,name,nameLen))
 {
-    if (namePrefix)
-	m_name.assign(namePrefix,-1,name,nameLen);
-    else
-	m_name.assign(name,nameLen);
     XDebug(DebugAll,"NamedString::NamedString(\"%s\",\"%s\") [%p]",name,value,this);
 }
 
+NamedString::NamedString(const String& name, const char* value, int len,
+    const char* namePrefix)
+    : String(value,len),
+      m_name(namePrefix ? nameAtom(namePrefix,-1,name.c_str(),name.length()) : nameAtom(name))
+{
+    XDebug(DebugAll,"NamedString::NamedString(\"%s\",\"%s\") [%p]",name.c_str(),value,this);
+}
+
+NamedString::~NamedString()
+{
+    if (m_name->length())
+	nameAtomDeref(m_name);
+}
+
+void NamedString::rename(const String& name)
+{
+    if (&name == m_name)
+	return;
+    const String* old = m_name;
+    m_name = nameAtom(name);
+    if (old->length())
+	nameAtomDeref(old);
+}
+
+bool NamedString::isName(const String& name)
+{
+    return 0 != name.getObject(YATOM("NameAtom"));
+}
+
+const String* NamedString::atom(const String*& str, const char* name)
+{
+    if (!str) {
+	const String* a = nameAtom(0,0,name,-1);
+	s_mutex.lock();
+	bool set = !str;
+	if (set)
+	    str = a;
+	s_mutex.unlock();
+	if (!set && a->length())
+	    nameAtomDeref(a);
+    }
+    return str;
+}
+
 const String& NamedString::toString() const
 {
-    return m_name;
+    return *m_name;
 }
 
 void* NamedString::getObject(const String& name) const
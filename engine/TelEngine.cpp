@@ -202,6 +202,53 @@ static Thread* s_thr = 0;
 bool CapturedEvent::s_capturing = false;
 ObjList CapturedEvent::s_events;
 
+#ifndef OUT_ASYNC_SHARDS
+#define OUT_ASYNC_SHARDS 17
+#endif
+
+// Header of a line kept in the asynchronous output buffers
+struct AsyncOutLine
+{
+    u_int64_t seq;
+    int level;
+    unsigned int len;
+};
+
+// Space taken by a line, leaves room for newline and NUL, keeps alignment
+#define ASYNC_LINE_SIZE(len) ((sizeof(AsyncOutLine) + (len) + 2 + 7) & ~7)
+
+// Buffer of a group of producer threads
+struct AsyncOutShard
+{
+    char* data;
+    unsigned int used;
+    unsigned int dropped;
+};
+
+// Background thread writing the asynchronous output
+class AsyncOutThread : public Thread
+{
+public:
+    inline AsyncOutThread()
+	: Thread("DebugOutput",Thread::Low)
+	{ }
+    virtual void run();
+};
+
+static bool s_asyncOut = false;
+static bool s_asyncRunning = false;
+static unsigned int s_asyncSize = 0;
+static u_int64_t s_asyncSeq = 0;
+static u_int64_t s_asyncDropped = 0;
+static AsyncOutShard s_asyncShards[OUT_ASYNC_SHARDS];
+static char* s_asyncSpare[OUT_ASYNC_SHARDS];
+static MutexPool s_asyncMutex(OUT_ASYNC_SHARDS,false,"DebugAsync");
+static Mutex s_asyncDrain(false,"DebugAsyncDrain");
+static Semaphore s_asyncWake(1,"DebugAsyncWake",0);
+#ifndef ATOMIC_OPS
+static Mutex s_asyncCountMux(false,"DebugAsyncCount");
+#endif
+
 static bool reentered()
 {
     if (!s_thr)
@@ -209,19 +256,9 @@ static bool reentered()
     return (Thread::current() == s_thr);
 }
 
-static void common_output(int level,char* buf)
+// Write one line to the output callbacks, out_mux must be locked
+static void locked_output(int level, char* buf, int n)
 {
-    if (level < -1)
-	level = -1;
-    if (level > DebugMax)
-	level = DebugMax;
-    int n = ::strlen(buf);
-    if (n && (buf[n-1] == '\n'))
-	n--;
-    // serialize the output strings
-    out_mux.lock();
-    // TODO: detect reentrant calls from foreign threads and main thread
-    s_thr = Thread::current();
     if (CapturedEvent::capturing()) {
 	buf[n] = '\0';
 	bool save = s_debugging;
@@ -236,10 +273,169 @@ static void common_output(int level,char* buf)
     if (s_intout)
 	s_intout(buf,level);
     buf[n] = '\0';
+}
+
+// Store a line in the buffer of the current thread's group
+// Return false if the line must be written synchronously
+static bool async_put(int level, const char* buf, unsigned int n)
+{
+    unsigned int len = ASYNC_LINE_SIZE(n);
+    unsigned int idx = s_asyncMutex.index(Thread::current());
+    Lock lck(s_asyncMutex.mutex(idx));
+    if (!s_asyncOut || (len > s_asyncSize))
+	return false;
+    AsyncOutShard& shard = s_asyncShards[idx];
+    if (shard.used + len > s_asyncSize) {
+	shard.dropped++;
+	return true;
+    }
+    AsyncOutLine* line = reinterpret_cast<AsyncOutLine*>(shard.data + shard.used);
+#ifdef ATOMIC_OPS
+#ifdef _WINDOWS
+    line->seq = InterlockedIncrement64((LONGLONG*)&s_asyncSeq);
+#else
+    line->seq = __sync_add_and_fetch(&s_asyncSeq,1);
+#endif
+#else
+    s_asyncCountMux.lock();
+    line->seq = ++s_asyncSeq;
+    s_asyncCountMux.unlock();
+#endif
+    line->level = level;
+    line->len = n;
+    ::memcpy(line + 1,buf,n);
+    shard.used += len;
+    bool wake = (shard.used > s_asyncSize / 2);
+    lck.drop();
+    if (wake)
+	s_asyncWake.unlock();
+    return true;
+}
+
+// Write buffered lines in the order they were produced
+// Unless in emergency s_asyncDrain must be locked
+static void async_drain(bool emergency = false)
+{
+    char* data[OUT_ASYNC_SHARDS];
+    unsigned int used[OUT_ASYNC_SHARDS];
+    unsigned int pos[OUT_ASYNC_SHARDS];
+    unsigned int dropped = 0;
+    for (unsigned int i = 0; i < OUT_ASYNC_SHARDS; i++) {
+	AsyncOutShard& shard = s_asyncShards[i];
+	if (!emergency)
+	    s_asyncMutex.mutex(i)->lock();
+	if (emergency)
+	    data[i] = shard.data;
+	else {
+	    data[i] = shard.data;
+	    shard.data = s_asyncSpare[i];
+	    s_asyncSpare[i] = data[i];
+	}
+	used[i] = shard.used;
+	pos[i] = 0;
+	dropped += shard.dropped;
+	shard.used = 0;
+	shard.dropped = 0;
+	if (!emergency)
+	    s_asyncMutex.mutex(i)->unlock();
+    }
+    if (!emergency)
+	out_mux.lock();
+    s_thr = Thread::current();
+    for (;;) {
+	AsyncOutLine* line = 0;
+	unsigned int idx = 0;
+	for (unsigned int i = 0; i < OUT_ASYNC_SHARDS; i++) {
+	    if (pos[i] >= used[i])
+		continue;
+	    AsyncOutLine* l = reinterpret_cast<AsyncOutLine*>(data[i] + pos[i]);
+	    if (!line || (l->seq < line->seq)) {
+		line = l;
+		idx = i;
+	    }
+	}
+	if (!line)
+	    break;
+	pos[idx] += ASYNC_LINE_SIZE(line->len);
+	if (emergency) {
+	    char* buf = reinterpret_cast<char*>(line + 1);
+	    buf[line->len] = '\n';
+	    buf[line->len + 1] = '\0';
+	    if (s_output)
+		s_output(buf,line->level);
+	}
+	else
+	    locked_output(line->level,reinterpret_cast<char*>(line + 1),line->len);
+    }
+    if (dropped) {
+	// an emergency drain may run concurrently with a normal one
+#ifdef ATOMIC_OPS
+#ifdef _WINDOWS
+	InterlockedExchangeAdd64((LONGLONG*)&s_asyncDropped,dropped);
+#else
+	__sync_add_and_fetch(&s_asyncDropped,(u_int64_t)dropped);
+#endif
+#else
+	s_asyncCountMux.lock();
+	s_asyncDropped += dropped;
+	s_asyncCountMux.unlock();
+#endif
+	char buf[64];
+	int n = ::snprintf(buf,sizeof(buf) - 2,"<WARN> Output buffers full, dropped %u lines",dropped);
+	if (emergency) {
+	    buf[n] = '\n';
+	    buf[n + 1] = '\0';
+	    if (s_output)
+		s_output(buf,DebugWarn);
+	}
+	else
+	    locked_output(DebugWarn,buf,n);
+    }
+    s_thr = 0;
+    if (!emergency)
+	out_mux.unlock();
+}
+
+void AsyncOutThread::run()
+{
+    for (;;) {
+	s_asyncWake.lock(Thread::idleUsec());
+	Lock lck(s_asyncDrain);
+	if (!s_asyncOut) {
+	    s_asyncRunning = false;
+	    break;
+	}
+	async_drain();
+    }
+}
+
+static void common_output(int level,char* buf)
+{
+    if (level < -1)
+	level = -1;
+    if (level > DebugMax)
+	level = DebugMax;
+    int n = ::strlen(buf);
+    if (n && (buf[n-1] == '\n'))
+	n--;
+    if (s_asyncOut && async_put(level,buf,n))
+	return;
+    // serialize the output strings
+    out_mux.lock();
+    // TODO: detect reentrant calls from foreign threads and main thread
+    s_thr = Thread::current();
+    locked_output(level,buf,n);
     s_thr = 0;
     out_mux.unlock();
 }
 
+// Abort after writing any buffered output
+static void dbg_abort()
+{
+    Debugger::flushOutput();
+    abort();
+}
+
 static void dbg_output(int level,const char* prefix, const char* format, va_list ap,
     const char* alarmComp = 0, const char* alarmInfo = 0)
 {
@@ -322,7 +518,7 @@ void Debug(int level, const char* format, ...)
     ind_mux.unlock();
     va_end(va);
     if (s_abort && (level == DebugFail))
-	abort();
+	dbg_abort();
 }
 
 void Debug(const char* facility, int level, const char* format, ...)
@@ -344,7 +540,7 @@ void Debug(const char* facility, int level, const char* format, ...)
     ind_mux.unlock();
     va_end(va);
     if (s_abort && (level == DebugFail))
-	abort();
+	dbg_abort();
 }
 
 void Debug(const DebugEnabler* local, int level, const char* format, ...)
@@ -377,7 +573,7 @@ void Debug(const DebugEnabler* local, int level, const char* format, ...)
     ind_mux.unlock();
     va_end(va);
     if (s_abort && (level == DebugFail))
-	abort();
+	dbg_abort();
 }
 
 void Alarm(const char* component, int level, const char* format, ...)
@@ -395,7 +591,7 @@ void Alarm(const char* component, int level, const char* format, ...)
     ind_mux.unlock();
     va_end(va);
     if (s_abort && (level == DebugFail))
-	abort();
+	dbg_abort();
 }
 
 void Alarm(const DebugEnabler* component, int level, const char* format, ...)
@@ -413,7 +609,7 @@ void Alarm(const DebugEnabler* component, int level, const char* format, ...)
     ind_mux.unlock();
     va_end(va);
     if (s_abort && (level == DebugFail))
-	abort();
+	dbg_abort();
 }
 
 void Alarm(const char* component, const char* info, int level, const char* format, ...)
@@ -431,7 +627,7 @@ void Alarm(const char* component, const char* info, int level, const char* forma
     ind_mux.unlock();
     va_end(va);
     if (s_abort && (level == DebugFail))
-	abort();
+	dbg_abort();
 }
 
 void Alarm(const DebugEnabler* component, const char* info, int level, const char* format, ...)
@@ -449,7 +645,7 @@ void Alarm(const DebugEnabler* component, const char* info, int level, const cha
     ind_mux.unlock();
     va_end(va);
     if (s_abort && (level == DebugFail))
-	abort();
+	dbg_abort();
 }
 
 void TraceDebug(const char* traceId, int level, const char* format, ...)
@@ -474,7 +670,7 @@ void TraceDebug(const char* traceId, int level, const char* format, ...)
     ind_mux.unlock();
     va_end(va);
     if (s_abort && (level == DebugFail))
-	abort();
+	dbg_abort();
 }
 
 void TraceDebug(const char* traceId, const char* facility, int level, const char* format, ...)
@@ -499,7 +695,7 @@ void TraceDebug(const char* traceId, const char* facility, int level, const char
     ind_mux.unlock();
     va_end(va);
     if (s_abort && (level == DebugFail))
-	abort();
+	dbg_abort();
 }
 
 void TraceDebug(const char* traceId, const DebugEnabler* local, int level, const char* format, ...)
@@ -541,7 +737,7 @@ void TraceDebug(const char* traceId, const DebugEnabler* local, int level, const
     ind_mux.unlock();
     va_end(va);
     if (s_abort && (level == DebugFail))
-	abort();
+	dbg_abort();
 }
 
 void TraceAlarm(const char* traceId, const char* component, int level, const char* format, ...)
@@ -562,7 +758,7 @@ void TraceAlarm(const char* traceId, const char* component, int level, const cha
     ind_mux.unlock();
     va_end(va);
     if (s_abort && (level == DebugFail))
-	abort();
+	dbg_abort();
 }
 
 void TraceAlarm(const char* traceId, const DebugEnabler* component, int level, const char* format, ...)
@@ -583,7 +779,7 @@ void TraceAlarm(const char* traceId, const DebugEnabler* component, int level, c
     ind_mux.unlock();
     va_end(va);
     if (s_abort && (level == DebugFail))
-	abort();
+	dbg_abort();
 }
 
 void TraceAlarm(const char* traceId, const char* component, const char* info, int level, const char* format, ...)
@@ -604,7 +800,7 @@ void TraceAlarm(const char* traceId, const char* component, const char* info, in
     ind_mux.unlock();
     va_end(va);
     if (s_abort && (level == DebugFail))
-	abort();
+	dbg_abort();
 }
 
 void TraceAlarm(const char* traceId, const DebugEnabler* component, const char* info, int level, const char* format, ...)
@@ -625,13 +821,13 @@ void TraceAlarm(const char* traceId, const DebugEnabler* component, const char*
     ind_mux.unlock();
     va_end(va);
     if (s_abort && (level == DebugFail))
-	abort();
+	dbg_abort();
 }
 
 void abortOnBug()
 {
     if (s_abort)
-	abort();
+	dbg_abort();
 }
 
 bool abortOnBug(bool doAbort)
@@ -819,6 +1015,90 @@ void Debugger::setIntOut(void (*outFunc)(const char*,int))
     out_mux.unlock();
 }
 
+bool Debugger::asyncOutput(unsigned int maxBytes)
+{
+    // each group must hold at least one full line
+    unsigned int size = (maxBytes / OUT_ASYNC_SHARDS) & ~7;
+    if (size && (size < 2 * OUT_BUFFER_SIZE))
+	size = 2 * OUT_BUFFER_SIZE;
+    Lock lck(s_asyncDrain);
+    if (size == s_asyncSize)
+	return s_asyncOut;
+    if (s_asyncOut) {
+	s_asyncOut = false;
+	// wait for producers to leave the buffers
+	for (unsigned int i = 0; i < OUT_ASYNC_SHARDS; i++)
+	    Lock l(s_asyncMutex.mutex(i));
+	async_drain();
+	lck.drop();
+	while (s_asyncRunning) {
+	    s_asyncWake.unlock();
+	    Thread::idle();
+	}
+	lck.acquire(s_asyncDrain);
+	for (unsigned int i = 0; i < OUT_ASYNC_SHARDS; i++) {
+	    delete[] s_asyncShards[i].data;
+	    delete[] s_asyncSpare[i];
+	    s_asyncShards[i].data = 0;
+	    s_asyncSpare[i] = 0;
+	}
+    }
+    s_asyncSize = size;
+    if (!size)
+	return false;
+    for (unsigned int i = 0; i < OUT_ASYNC_SHARDS; i++) {
+	s_asyncShards[i].data = new char[size];
+	s_asyncShards[i].used = 0;
+	s_asyncShards[i].dropped = 0;
+	s_asyncSpare[i] = new char[size];
+    }
+    s_asyncRunning = true;
+    s_asyncOut = true;
+    AsyncOutThread* thread = new AsyncOutThread;
+    if (thread->startup())
+	return true;
+    delete thread;
+    s_asyncRunning = false;
+    s_asyncOut = false;
+    s_asyncSize = 0;
+    for (unsigned int i = 0; i < OUT_ASYNC_SHARDS; i++) {
+	delete[] s_asyncShards[i].data;
+	delete[] s_asyncSpare[i];
+	s_asyncShards[i].data = 0;
+	s_asyncSpare[i] = 0;
+    }
+    lck.drop();
+    Debug(DebugWarn,"Could not start asynchronous output thread");
+    return false;
+}
+
+void Debugger::flushOutput(bool emergency)
+{
+    if (!s_asyncOut)
+	return;
+    if (emergency) {
+	async_drain(true);
+	return;
+    }
+    Lock lck(s_asyncDrain);
+    if (s_asyncOut)
+	async_drain();
+}
+
+u_int64_t Debugger::outputDropped()
+{
+#ifdef ATOMIC_OPS
+#ifdef _WINDOWS
+    return InterlockedExchangeAdd64((LONGLONG*)&s_asyncDropped,0);
+#else
+    return __sync_add_and_fetch(&s_asyncDropped,(u_int64_t)0);
+#endif
+#else
+    Lock lck(s_asyncCountMux);
+    return s_asyncDropped;
+#endif
+}
+
 void Debugger::setAlarmHook(void (*alarmFunc)(const char*,int,const char*,const char*))
 {
     s_alarms = alarmFunc;
@@ -31,7 +31,7 @@ ASNLib::ASNLib()
 ASNLib::~ASNLib()
 {}
 
-int ASNLib::decodeLength(DataBlock& data) {
+int ASNLib::decodeLength(AsnCursor& data) {
 
     XDebug(s_libName.c_str(),DebugAll,"::decodeLength() - from data='%p'",&data);
     int length = 0;
@@ -41,7 +41,7 @@ int ASNLib::decodeLength(DataBlock& data) {
 
 	lengthByte &= ~ASN_LONG_LENGTH;	/* turn MSB off */
 	if (lengthByte == 0) {
-	    data.cut(-1);
+	    data.skip(1);
 	    return IndefiniteForm;
 	}
 
@@ -51,12 +51,12 @@ int ASNLib::decodeLength(DataBlock& data) {
 	for (int i = 0 ; i < lengthByte ; i++)
 	    length = (length << 8) + data[1 + i];
 
-	data.cut(-lengthByte - 1);
+	data.skip(lengthByte + 1);
 	return length;
 
     } else { // one byte for length
 	length = (int) lengthByte;
-	data.cut(-1);
+	data.skip(1);
 	return length;
     }
 }
@@ -87,7 +87,7 @@ DataBlock ASNLib::buildLength(DataBlock& data)
    return lenDb;
 }
 
-int ASNLib::matchEOC(DataBlock& data)
+int ASNLib::matchEOC(AsnCursor& data)
 {
     /**
      * EoC = 00 00
@@ -96,14 +96,14 @@ int ASNLib::matchEOC(DataBlock& data)
     if (data.length() < 2)
 	return InvalidLengthOrTag;
     if (data[0] == 0 && data[1] == 0) {
-    	data.cut(-2);
+    	data.skip(2);
     	return 2;
     }
     return InvalidLengthOrTag;
 }
 
 
-int ASNLib::parseUntilEoC(DataBlock& data, int length)
+int ASNLib::parseUntilEoC(AsnCursor& data, int length)
 {
     if (length >= (int)data.length() || ASNLib::matchEOC(data) > 0)
 	return length;
@@ -112,7 +112,7 @@ int ASNLib::parseUntilEoC(DataBlock& data, int length)
 	AsnTag tag;
 	AsnTag::decode(tag,data);
 	length += tag.coding().length();
-	data.cut(-(int)tag.coding().length());
+	data.skip(tag.coding().length());
 	// compute length portion length
 	int initLen = data.length();
 	int len = ASNLib::decodeLength(data);
@@ -129,13 +129,13 @@ int ASNLib::parseUntilEoC(DataBlock& data, int length)
 	}
 	else {
 	    length += len;
-	    data.cut(-len);
+	    data.skip(len);
 	}
     }
     return length;
 }
 
-int ASNLib::decodeBoolean(DataBlock& data, bool* val, bool tagCheck)
+int ASNLib::decodeBoolean(AsnCursor& data, bool* val, bool tagCheck)
 {
     /**
      * boolean = 0x01 length byte (byte == 0 => false, byte != 0 => true)
@@ -152,7 +152,7 @@ int ASNLib::decodeBoolean(DataBlock& data, bool* val, bool tagCheck)
 	    XDebug(s_libName.c_str(),DebugAll,"::decodeBoolean() - Invalid Tag in data='%p'",&data);
 	    return InvalidLengthOrTag;
 	}
-	data.cut(-1);
+	data.skip(1);
     }
     int length = decodeLength(data);
     if (length < 0) {
@@ -165,14 +165,14 @@ int ASNLib::decodeBoolean(DataBlock& data, bool* val, bool tagCheck)
 	return InvalidLengthOrTag;
     }
     if (!val) {
-        data.cut(-1);
+        data.skip(1);
         DDebug(s_libName.c_str(),DebugAll,"::decodeBoolean() - Invalid buffer for return data");
         return InvalidContentsError;
     }
     *val = false;
     if ((data[0] & 0xFF) != 0)
 	*val = true;
-    data.cut(-1);
+    data.skip(1);
 #ifdef DEBUG
     Debug(s_libName.c_str(),DebugAll,"::decodeBoolean() - decoded boolean value from data='%p', consumed %u bytes",
     	&data, initLen - data.length());
@@ -180,7 +180,7 @@ int ASNLib::decodeBoolean(DataBlock& data, bool* val, bool tagCheck)
     return length;
 }
 
-int ASNLib::decodeInteger(DataBlock& data, u_int64_t& intVal, unsigned int bytes, bool tagCheck)
+int ASNLib::decodeInteger(AsnCursor& data, u_int64_t& intVal, unsigned int bytes, bool tagCheck)
 {
     /**
      * integer = 0x02 length byte {byte}*
@@ -198,7 +198,7 @@ int ASNLib::decodeInteger(DataBlock& data, u_int64_t& intVal, unsigned int bytes
 	    XDebug(s_libName.c_str(),DebugAll,"::decodeInteger() - Invalid Tag in data='%p'",&data);
 	    return InvalidLengthOrTag;
 	}
-	data.cut(-1);
+	data.skip(1);
     }
     int length = decodeLength(data);
     if (length < 0) {
@@ -225,7 +225,7 @@ int ASNLib::decodeInteger(DataBlock& data, u_int64_t& intVal, unsigned int bytes
 	j++;
     }
     intVal = (u_int64_t) value;
-    data.cut(-length);
+    data.skip(length);
 #ifdef DEBUG
     Debug(s_libName.c_str(),DebugAll,"::decodeInteger() - decoded integer value from  data='%p', consumed %u bytes",
     	&data, initLen - data.length());
@@ -233,7 +233,7 @@ int ASNLib::decodeInteger(DataBlock& data, u_int64_t& intVal, unsigned int bytes
     return length;
 }
 
-int ASNLib::decodeUINT8(DataBlock& data, u_int8_t* intVal, bool tagCheck)
+int ASNLib::decodeUINT8(AsnCursor& data, u_int8_t* intVal, bool tagCheck)
 {
     XDebug(s_libName.c_str(),DebugAll,"::decodeUINT8()");
     u_int64_t val;
@@ -246,7 +246,7 @@ int ASNLib::decodeUINT8(DataBlock& data, u_int8_t* intVal, bool tagCheck)
     return l;
 }
 
-int ASNLib::decodeUINT16(DataBlock& data, u_int16_t* intVal, bool tagCheck)
+int ASNLib::decodeUINT16(AsnCursor& data, u_int16_t* intVal, bool tagCheck)
 {
     XDebug(s_libName.c_str(),DebugAll,"::decodeUINT16() from data='%p'",&data);
     u_int64_t val;
@@ -259,7 +259,7 @@ int ASNLib::decodeUINT16(DataBlock& data, u_int16_t* intVal, bool tagCheck)
     return l;
 }
 
-int ASNLib::decodeUINT32(DataBlock& data, u_int32_t* intVal, bool tagCheck)
+int ASNLib::decodeUINT32(AsnCursor& data, u_int32_t* intVal, bool tagCheck)
 {
     XDebug(s_libName.c_str(),DebugAll,"::decodeUINT32() from data='%p'",&data);
     u_int64_t val;
@@ -272,7 +272,7 @@ int ASNLib::decodeUINT32(DataBlock& data, u_int32_t* intVal, bool tagCheck)
     return l;
 }
 
-int ASNLib::decodeUINT64(DataBlock& data, u_int64_t* intVal, bool tagCheck)
+int ASNLib::decodeUINT64(AsnCursor& data, u_int64_t* intVal, bool tagCheck)
 {
     XDebug(s_libName.c_str(),DebugAll,"::decodeUINT64() from data='%p'",&data);
     u_int64_t val;
@@ -285,7 +285,7 @@ int ASNLib::decodeUINT64(DataBlock& data, u_int64_t* intVal, bool tagCheck)
     return l;
 }
 
-int ASNLib::decodeINT8(DataBlock& data, int8_t* intVal, bool tagCheck)
+int ASNLib::decodeINT8(AsnCursor& data, int8_t* intVal, bool tagCheck)
 {
     XDebug(s_libName.c_str(),DebugAll,"::decodeINT8() from data='%p'",&data);
     u_int64_t val;
@@ -298,7 +298,7 @@ int ASNLib::decodeINT8(DataBlock& data, int8_t* intVal, bool tagCheck)
     return l;
 }
 
-int ASNLib::decodeINT16(DataBlock& data, int16_t* intVal, bool tagCheck)
+int ASNLib::decodeINT16(AsnCursor& data, int16_t* intVal, bool tagCheck)
 {
     XDebug(s_libName.c_str(),DebugAll,"::decodeINT16() from data='%p'",&data);
     u_int64_t val;
@@ -311,7 +311,7 @@ int ASNLib::decodeINT16(DataBlock& data, int16_t* intVal, bool tagCheck)
     return l;
 }
 
-int ASNLib::decodeINT32(DataBlock& data, int32_t* intVal, bool tagCheck)
+int ASNLib::decodeINT32(AsnCursor& data, int32_t* intVal, bool tagCheck)
 {
     XDebug(s_libName.c_str(),DebugAll,"::decodeINT32() from data='%p'",&data);
     u_int64_t val;
@@ -324,7 +324,7 @@ int ASNLib::decodeINT32(DataBlock& data, int32_t* intVal, bool tagCheck)
     return l;
 }
 
-int ASNLib::decodeINT64(DataBlock& data, int64_t* intVal, bool tagCheck)
+int ASNLib::decodeINT64(AsnCursor& data, int64_t* intVal, bool tagCheck)
 {
     XDebug(s_libName.c_str(),DebugAll,"::decodeINT64() from data='%p'",&data);
     u_int64_t val;
@@ -337,7 +337,7 @@ int ASNLib::decodeINT64(DataBlock& data, int64_t* intVal, bool tagCheck)
     return l;
 }
 
-int ASNLib::decodeBitString(DataBlock& data, String* val, bool tagCheck)
+int ASNLib::decodeBitString(AsnCursor& data, String* val, bool tagCheck)
 {
     /**
      * bitstring ::= 0x03 asnlength unusedBytes {byte}*
@@ -354,7 +354,7 @@ int ASNLib::decodeBitString(DataBlock& data, String* val, bool tagCheck)
 	    XDebug(s_libName.c_str(),DebugAll,"::decodeBitString() - Invalid Tag in data='%p'",&data);
 	    return InvalidLengthOrTag;
 	}
-	data.cut(-1);
+	data.skip(1);
     }
     int length = decodeLength(data);
     if (length < 0) {
@@ -372,12 +372,12 @@ int ASNLib::decodeBitString(DataBlock& data, String* val, bool tagCheck)
 	return InvalidLengthOrTag;
     }
     int unused = data[0];
-    data.cut(-1);
+    data.skip(1);
     length--;
     int j = 0;
     if (!val) {
         DDebug(s_libName.c_str(),DebugAll,"::decodeBitString() - Invalid buffer for return data");
-        data.cut(-length);
+        data.skip(length);
         return InvalidContentsError;
     }
     *val = "";
@@ -390,7 +390,7 @@ int ASNLib::decodeBitString(DataBlock& data, String* val, bool tagCheck)
 	j++;
     }
     *val = val->substr(0, length * 8 - unused);
-    data.cut(-length);
+    data.skip(length);
 #ifdef DEBUG
     Debug(s_libName.c_str(),DebugAll,"::decodeBitString() - decoded bit string value from  data='%p', consumed %u bytes",
     	&data, initLen - data.length());
@@ -398,7 +398,7 @@ int ASNLib::decodeBitString(DataBlock& data, String* val, bool tagCheck)
     return length;
 }
 
-int ASNLib::decodeOctetString(DataBlock& db, OctetString* strVal, bool tagCheck)
+int ASNLib::decodeOctetString(AsnCursor& db, OctetString* strVal, bool tagCheck)
 {
     /**
      *  octet string ::= 0x04 asnlength {byte}*
@@ -415,7 +415,7 @@ int ASNLib::decodeOctetString(DataBlock& db, OctetString* strVal, bool tagCheck)
 	    XDebug(s_libName.c_str(),DebugAll,"::decodeOctetString() - Invalid Tag in data='%p'",&db);
 	    return InvalidLengthOrTag;
 	}
-	db.cut(-1);
+	db.skip(1);
     }
     int length = decodeLength(db);
     if (length < 0) {
@@ -431,7 +431,7 @@ int ASNLib::decodeOctetString(DataBlock& db, OctetString* strVal, bool tagCheck)
         return InvalidContentsError;
     }
     strVal->assign((void*)db.data(0,length),length);
-    db.cut(-length);
+    db.skip(length);
 #ifdef DEBUG
     Debug(s_libName.c_str(),DebugAll,"::decodeOctetString() - decoded octet string value from  data='%p', consumed %u bytes",
     	&db, initLen - db.length());
@@ -439,7 +439,7 @@ int ASNLib::decodeOctetString(DataBlock& db, OctetString* strVal, bool tagCheck)
     return length;
 }
 
-int ASNLib::decodeNull(DataBlock& data, bool tagCheck)
+int ASNLib::decodeNull(AsnCursor& data, bool tagCheck)
 {
     /**
      * ASN.1 null := 0x05 00
@@ -453,7 +453,7 @@ int ASNLib::decodeNull(DataBlock& data, bool tagCheck)
 	    XDebug(s_libName.c_str(),DebugAll, "::decodeNull() - Invalid Tag in data='%p'",&data);
 	    return InvalidLengthOrTag;
 	}
-	data.cut(-1);
+	data.skip(1);
     }
     int length = decodeLength(data);
     if (length != 0) {
@@ -465,7 +465,7 @@ int ASNLib::decodeNull(DataBlock& data, bool tagCheck)
     return length;
 }
 
-int ASNLib::decodeOID(DataBlock& data, ASNObjId* obj, bool tagCheck)
+int ASNLib::decodeOID(AsnCursor& data, ASNObjId* obj, bool tagCheck)
 {
    /**
     * ASN.1 objid ::= 0x06 asnlength subidentifier {subidentifier}*
@@ -484,7 +484,7 @@ int ASNLib::decodeOID(DataBlock& data, ASNObjId* obj, bool tagCheck)
 	    XDebug(s_libName.c_str(),DebugAll,"::decodeOID() - Invalid Tag in data='%p'",&data);
 	    return InvalidLengthOrTag;
 	}
-	data.cut(-1);
+	data.skip(1);
     }
     int length = decodeLength(data);
     if (length < 0) {
@@ -533,7 +533,7 @@ int ASNLib::decodeOID(DataBlock& data, ASNObjId* obj, bool tagCheck)
       }
       j++;
     }
-    data.cut(-length);
+    data.skip(length);
     if (!obj) {
         DDebug(s_libName.c_str(),DebugAll,"::decodeOID() - Invalid buffer for return data");
         return InvalidContentsError;
@@ -546,7 +546,7 @@ int ASNLib::decodeOID(DataBlock& data, ASNObjId* obj, bool tagCheck)
     return length;
 }
 
-int ASNLib::decodeReal(DataBlock& db, float* realVal, bool tagCheck)
+int ASNLib::decodeReal(AsnCursor& db, float* realVal, bool tagCheck)
 {
     if (db.length() < 2)
 	return InvalidLengthOrTag;
@@ -556,7 +556,7 @@ int ASNLib::decodeReal(DataBlock& db, float* realVal, bool tagCheck)
 	    XDebug(s_libName.c_str(),DebugAll,"::decodeReal() - Invalid Tag in data='%p'",&db);
 	    return InvalidLengthOrTag;
 	}
-	db.cut(-1);
+	db.skip(1);
     }
     int length = decodeLength(db);
     if (length < 0) {
@@ -567,13 +567,13 @@ int ASNLib::decodeReal(DataBlock& db, float* realVal, bool tagCheck)
 	DDebug(s_libName.c_str(),DebugAll,"::decodeReal() - Invalid Length in data='%p'",&db);
 	return InvalidLengthOrTag;
     }
-    db.cut(-length);
+    db.skip(length);
     Debug(s_libName.c_str(),DebugInfo,"::decodeReal() - real value decoding not implemented, skipping over the %u bytes of the encoding",
     		initLen - db.length());
     return 0;
 }
 
-int ASNLib::decodeString(DataBlock& data, String* str, int* type, bool tagCheck)
+int ASNLib::decodeString(AsnCursor& data, String* str, int* type, bool tagCheck)
 {
     XDebug(s_libName.c_str(),DebugAll,"::decodeString() from data='%p'",&data);
     if (data.length() < 2)
@@ -592,7 +592,7 @@ int ASNLib::decodeString(DataBlock& data, String* str, int* type, bool tagCheck)
 	}
 	if (type)
 	    *type = data[0];
-	data.cut(-1);
+	data.skip(1);
     }
     int length = decodeLength(data);
     if (length < 0) {
@@ -608,7 +608,7 @@ int ASNLib::decodeString(DataBlock& data, String* str, int* type, bool tagCheck)
     String var = "";
     for (int i = 0; i < length; i++)
 	var += (char) (data[i] & 0x7f);
-    data.cut(-length);
+    data.skip(length);
     if (!str || !type) {
         DDebug(s_libName.c_str(),DebugAll,"::decodeString() - Invalid buffer for return data");
         return InvalidContentsError;
@@ -622,7 +622,7 @@ int ASNLib::decodeString(DataBlock& data, String* str, int* type, bool tagCheck)
 }
 
 
-int ASNLib::decodeUtf8(DataBlock& data, String* str, bool tagCheck)
+int ASNLib::decodeUtf8(AsnCursor& data, String* str, bool tagCheck)
 {
     XDebug(s_libName.c_str(),DebugAll,"::decodeUtf8() from data='%p'",&data);
     if (data.length() < 2)
@@ -635,7 +635,7 @@ int ASNLib::decodeUtf8(DataBlock& data, String* str, bool tagCheck)
 	    XDebug(s_libName.c_str(),DebugAll,"::decodeUtf8() - Invalid Tag in data='%p'",&data);
 	    return InvalidLengthOrTag;
 	}
-	data.cut(-1);
+	data.skip(1);
     }
     int length = decodeLength(data);
     if (length < 0) {
@@ -651,7 +651,7 @@ int ASNLib::decodeUtf8(DataBlock& data, String* str, bool tagCheck)
     String var = "";
     for (int i = 0; i < length; i++)
 	var += (char) (data[i]);
-    data.cut(-length);
+    data.skip(length);
     if (String::lenUtf8(var.c_str()) < 0)
 	return ParseError;
     if (!str) {
@@ -665,7 +665,7 @@ int ASNLib::decodeUtf8(DataBlock& data, String* str, bool tagCheck)
     return length;
 }
 
-int ASNLib::decodeGenTime(DataBlock& data, unsigned int* time, unsigned int* fractions, bool* utc, bool tagCheck)
+int ASNLib::decodeGenTime(AsnCursor& data, unsigned int* time, unsigned int* fractions, bool* utc, bool tagCheck)
 {
     XDebug(s_libName.c_str(),DebugAll,"::decodeGenTime() from data='%p'",&data);
     if (data.length() < 2)
@@ -678,7 +678,7 @@ int ASNLib::decodeGenTime(DataBlock& data, unsigned int* time, unsigned int* fra
 	    XDebug(s_libName.c_str(),DebugAll,"::decodeGenTime() - Invalid Tag in data='%p'",&data);
 	    return InvalidLengthOrTag;
 	}
-	data.cut(-1);
+	data.skip(1);
     }
     int length = decodeLength(data);
     if (length < 0) {
@@ -693,7 +693,7 @@ int ASNLib::decodeGenTime(DataBlock& data, unsigned int* time, unsigned int* fra
     String date = "";
     for (int i = 0; i < length; i++)
 	date += (char) (data[i]);
-    data.cut(-length);
+    data.skip(length);
 
     if (!(utc && fractions && time)) {
         DDebug(s_libName.c_str(),DebugAll,"::decodeGenTime() - Invalid buffer for return data");
@@ -761,7 +761,7 @@ int ASNLib::decodeGenTime(DataBlock& data, unsigned int* time, unsigned int* fra
     return length;
 }
 
-int ASNLib::decodeUTCTime(DataBlock& data, unsigned int* time, bool tagCheck)
+int ASNLib::decodeUTCTime(AsnCursor& data, unsigned int* time, bool tagCheck)
 {
     XDebug(s_libName.c_str(),DebugAll,"::decodeUTCTime() from data='%p'",&data);
     if (data.length() < 2)
@@ -774,7 +774,7 @@ int ASNLib::decodeUTCTime(DataBlock& data, unsigned int* time, bool tagCheck)
 	    XDebug(s_libName.c_str(),DebugAll,"::decodeUTCTime() - Invalid Tag in data='%p'",&data);
 	    return InvalidLengthOrTag;
 	}
-	data.cut(-1);
+	data.skip(1);
     }
     int length = decodeLength(data);
     if (length < 0) {
@@ -789,7 +789,7 @@ int ASNLib::decodeUTCTime(DataBlock& data, unsigned int* time, bool tagCheck)
     String date = "";
     for (int i = 0; i < length; i++)
 	date += (char) (data[i]);
-    data.cut(-length);
+    data.skip(length);
 
     if (!time) {
         DDebug(s_libName.c_str(),DebugAll,"::decodeUTCTime() - Invalid buffer for return data");
@@ -844,18 +844,18 @@ int ASNLib::decodeUTCTime(DataBlock& data, unsigned int* time, bool tagCheck)
     return length;
 }
 
-int ASNLib::decodeAny(DataBlock data, DataBlock* val, bool tagCheck)
+int ASNLib::decodeAny(const AsnCursor& data, DataBlock* val, bool tagCheck)
 {
     XDebug(s_libName.c_str(),DebugAll,"::decodeAny() from data='%p'",&data);
     if (!val) {
         DDebug(s_libName.c_str(),DebugAll,"::decodeAny() - Invalid buffer for return data");
         return InvalidContentsError;
     }
-    val->append(data);
+    val->append(data.data(),data.length());
     return data.length();
 }
 
-int ASNLib::decodeSequence(DataBlock& data, bool tagCheck)
+int ASNLib::decodeSequence(AsnCursor& data, bool tagCheck)
 {
     XDebug(s_libName.c_str(),DebugAll,"::decodeSequence() from data='%p'",&data);
     if (data.length() < 2)
@@ -868,7 +868,7 @@ int ASNLib::decodeSequence(DataBlock& data, bool tagCheck)
 	    DDebug(s_libName.c_str(),DebugAll,"::decodeSequence() - Invalid Tag in data='%p'",&data);
 	    return InvalidLengthOrTag;
 	}
-	data.cut(-1);
+	data.skip(1);
     }
     int length = decodeLength(data);
     if (length < 0)
@@ -879,7 +879,7 @@ int ASNLib::decodeSequence(DataBlock& data, bool tagCheck)
     return length;
 }
 
-int ASNLib::decodeSet(DataBlock& data, bool tagCheck)
+int ASNLib::decodeSet(AsnCursor& data, bool tagCheck)
 {
     XDebug(s_libName.c_str(),DebugAll,"::decodeSet() from data='%p",&data);
     if (data.length() < 2)
@@ -892,7 +892,7 @@ int ASNLib::decodeSet(DataBlock& data, bool tagCheck)
 	    DDebug(s_libName.c_str(),DebugAll,"::decodeSet() - Invalid Tag in data='%p'",&data);
 	    return InvalidLengthOrTag;
 	}
-	data.cut(-1);
+	data.skip(1);
     }
     int length = decodeLength(data);
 #ifdef DEBUG
@@ -904,6 +904,140 @@ int ASNLib::decodeSet(DataBlock& data, bool tagCheck)
     return length;
 }
 
+// Decode from a data block through a cursor, cut the consumed bytes from the block
+#define ASN_DECODE_BLOCK(call) \
+    AsnCursor cursor(data); \
+    int ret = call; \
+    data.cut(-(int)cursor.consumed()); \
+    return ret
+
+int ASNLib::decodeLength(DataBlock& data)
+{
+    ASN_DECODE_BLOCK(decodeLength(cursor));
+}
+
+int ASNLib::matchEOC(DataBlock& data)
+{
+    ASN_DECODE_BLOCK(matchEOC(cursor));
+}
+
+int ASNLib::parseUntilEoC(DataBlock& data, int length)
+{
+    ASN_DECODE_BLOCK(parseUntilEoC(cursor,length));
+}
+
+int ASNLib::decodeBoolean(DataBlock& data, bool* val, bool tagCheck)
+{
+    ASN_DECODE_BLOCK(decodeBoolean(cursor,val,tagCheck));
+}
+
+int ASNLib::decodeInteger(DataBlock& data, u_int64_t& intVal, unsigned int bytes, bool tagCheck)
+{
+    ASN_DECODE_BLOCK(decodeInteger(cursor,intVal,bytes,tagCheck));
+}
+
+int ASNLib::decodeUINT8(DataBlock& data, u_int8_t* intVal, bool tagCheck)
+{
+    ASN_DECODE_BLOCK(decodeUINT8(cursor,intVal,tagCheck));
+}
+
+int ASNLib::decodeUINT16(DataBlock& data, u_int16_t* intVal, bool tagCheck)
+{
+    ASN_DECODE_BLOCK(decodeUINT16(cursor,intVal,tagCheck));
+}
+
+int ASNLib::decodeUINT32(DataBlock& data, u_int32_t* intVal, bool tagCheck)
+{
+    ASN_DECODE_BLOCK(decodeUINT32(cursor,intVal,tagCheck));
+}
+
+int ASNLib::decodeUINT64(DataBlock& data, u_int64_t* intVal, bool tagCheck)
+{
+    ASN_DECODE_BLOCK(decodeUINT64(cursor,intVal,tagCheck));
+}
+
+int ASNLib::decodeINT8(DataBlock& data, int8_t* intVal, bool tagCheck)
+{
+    ASN_DECODE_BLOCK(decodeINT8(cursor,intVal,tagCheck));
+}
+
+int ASNLib::decodeINT16(DataBlock& data, int16_t* intVal, bool tagCheck)
+{
+    ASN_DECODE_BLOCK(decodeINT16(cursor,intVal,tagCheck));
+}
+
+int ASNLib::decodeINT32(DataBlock& data, int32_t* intVal, bool tagCheck)
+{
+    ASN_DECODE_BLOCK(decodeINT32(cursor,intVal,tagCheck));
+}
+
+int ASNLib::decodeINT64(DataBlock& data, int64_t* intVal, bool tagCheck)
+{
+    ASN_DECODE_BLOCK(decodeINT64(cursor,intVal,tagCheck));
+}
+
+int ASNLib::decodeBitString(DataBlock& data, String* val, bool tagCheck)
+{
+    ASN_DECODE_BLOCK(decodeBitString(cursor,val,tagCheck));
+}
+
+int ASNLib::decodeOctetString(DataBlock& data, OctetString* strVal, bool tagCheck)
+{
+    ASN_DECODE_BLOCK(decodeOctetString(cursor,strVal,tagCheck));
+}
+
+int ASNLib::decodeNull(DataBlock& data, bool tagCheck)
+{
+    ASN_DECODE_BLOCK(decodeNull(cursor,tagCheck));
+}
+
+int ASNLib::decodeOID(DataBlock& data, ASNObjId* obj, bool tagCheck)
+{
+    ASN_DECODE_BLOCK(decodeOID(cursor,obj,tagCheck));
+}
+
+int ASNLib::decodeReal(DataBlock& data, float* realVal, bool tagCheck)
+{
+    ASN_DECODE_BLOCK(decodeReal(cursor,realVal,tagCheck));
+}
+
+int ASNLib::decodeString(DataBlock& data, String* str, int* type, bool tagCheck)
+{
+    ASN_DECODE_BLOCK(decodeString(cursor,str,type,tagCheck));
+}
+
+int ASNLib::decodeUtf8(DataBlock& data, String* str, bool tagCheck)
+{
+    ASN_DECODE_BLOCK(decodeUtf8(cursor,str,tagCheck));
+}
+
+int ASNLib::decodeGenTime(DataBlock& data, unsigned int* time, unsigned int* fractions, bool* utc, bool tagCheck)
+{
+    ASN_DECODE_BLOCK(decodeGenTime(cursor,time,fractions,utc,tagCheck));
+}
+
+int ASNLib::decodeUTCTime(DataBlock& data, unsigned int* time, bool tagCheck)
+{
+    ASN_DECODE_BLOCK(decodeUTCTime(cursor,time,tagCheck));
+}
+
+int ASNLib::decodeAny(DataBlock data, DataBlock* val, bool tagCheck)
+{
+    return decodeAny(AsnCursor(data),val,tagCheck);
+}
+
+int ASNLib::decodeSequence(DataBlock& data, bool tagCheck)
+{
+    ASN_DECODE_BLOCK(decodeSequence(cursor,tagCheck));
+}
+
+int ASNLib::decodeSet(DataBlock& data, bool tagCheck)
+{
+    ASN_DECODE_BLOCK(decodeSet(cursor,tagCheck));
+}
+
+#undef ASN_DECODE_BLOCK
+
 DataBlock ASNLib::encodeBoolean(bool val, bool tagCheck)
 {
     /**
@@ -1236,7 +1370,7 @@ int ASNLib::encodeSet(DataBlock& data, bool tagCheck)
 /**
   * AsnTag
   */
-void AsnTag::decode(AsnTag& tag, DataBlock& data)
+void AsnTag::decode(AsnTag& tag, const AsnCursor& data)
 {
     XDebug(s_libName.c_str(),DebugAll,"AsnTag::decode()");
     tag.classType((Class)(data[0] & 0xc0));
@@ -1258,6 +1392,11 @@ void AsnTag::decode(AsnTag& tag, DataBlock& data)
     tag.encode();
 }
 
+void AsnTag::decode(AsnTag& tag, DataBlock& data)
+{
+    decode(tag,AsnCursor(data));
+}
+
 void AsnTag::encode(Class clas, Type type, unsigned int code, DataBlock& data)
 {
     XDebug(s_libName.c_str(),DebugAll,"AsnTag::encode(clas=0x%x, type=0x%x, code=%u)",clas,type,code);
@@ -47,6 +47,7 @@ namespace TelEngine {
 #define ASN_EXTENSION_ID	31
 #define IS_EXTENSION_ID(byte) (((byte) & ASN_EXTENSION_ID) == ASN_EXTENSION_ID)
 
+class AsnCursor;
 class AsnObject;
 class AsnValue;
 class ASNObjId;
@@ -102,6 +103,97 @@ public:
     }
 };
 
+/**
+ * Read only view over ASN.1 encoded data. Decoding through a cursor advances it
+ *  past the decoded value without modifying, copying or reallocating the data.
+ * The data viewed by the cursor must not change or be released while in use
+ * @short Read cursor over encoded data
+ */
+class YASN_API AsnCursor
+{
+public:
+    /**
+     * Constructor of an empty cursor
+     */
+    inline AsnCursor()
+	: m_start(0), m_data(0), m_end(0)
+	{}
+
+    /**
+     * Constructor of a cursor over the whole content of a data block
+     * @param data Data block to view
+     */
+    inline AsnCursor(const DataBlock& data)
+	: m_start((const uint8_t*)data.data()), m_data(m_start), m_end(m_start + data.length())
+	{}
+
+    /**
+     * Constructor of a cursor over a memory area
+     * @param data Pointer to the first byte to view
+     * @param len Number of bytes to view
+     */
+    inline AsnCursor(const void* data, unsigned int len)
+	: m_start((const uint8_t*)data), m_data(m_start), m_end(m_start + (data ? len : 0))
+	{}
+
+    /**
+     * Get the number of bytes left to decode
+     * @return Length of the data past the cursor
+     */
+    inline unsigned int length() const
+	{ return m_end - m_data; }
+
+    /**
+     * Check if there is nothing left to decode
+     * @return True if the cursor reached the end of the data
+     */
+    inline bool null() const
+	{ return m_data >= m_end; }
+
+    /**
+     * Get the data at the cursor
+     * @return Pointer to the first byte left to decode
+     */
+    inline void* data() const
+	{ return (void*)m_data; }
+
+    /**
+     * Get a pointer to a range of data past the cursor
+     * @param offs Offset from the cursor
+     * @param len Length of the range that must be available
+     * @return Pointer to the data, NULL if the range is out of bounds
+     */
+    inline void* data(unsigned int offs, unsigned int len = 1) const
+	{ return (offs + len <= length()) ? (void*)(m_data + offs) : 0; }
+
+    /**
+     * Get the byte at an offset from the cursor
+     * @param index Offset from the cursor
+     * @return The byte value (0-255), -1 if out of bounds like in DataBlock
+     */
+    inline int operator[](unsigned int index) const
+	{ return (index < length()) ? m_data[index] : -1; }
+
+    /**
+     * Advance the cursor
+     * @param len Number of bytes to skip, it is limited to the available data
+     */
+    inline void skip(unsigned int len)
+	{ m_data += (len < length()) ? len : length(); }
+
+    /**
+     * Get the number of bytes decoded since the cursor was built
+     * @return Offset of the cursor from the start of the data
+     */
+    inline unsigned int consumed() const
+	{ return m_data - m_start; }
+
+private:
+    const uint8_t* m_start;
+    const uint8_t* m_data;
+    const uint8_t* m_end;
+};
+
 /**
  * Abstract class implemented by all ASN.1 type objects
  * @short Base Class for ASN.1 objects
@@ -130,9 +222,24 @@ public:
 
     /**
      * Function to decode the parameters of this object from given data
-     * @param data DataBlock from which the object is decoded
+     * @param data Cursor over the data from which the object is decoded,
+     *  it is advanced past the decoded object
      */
-    virtual int decode(DataBlock& data) = 0;
+    virtual int decode(AsnCursor& data) = 0;
+
+    /**
+     * Function to decode the parameters of this object from a datablock
+     * @param data The DataBlock from which the object is decoded,
+     *  the decoded data is cut from its start
+     * @return Value returned by decode() from a cursor over the data
+     */
+    inline int decode(DataBlock& data)
+	{
+	    AsnCursor cursor(data);
+	    int ret = decode(cursor);
+	    data.cut(-(int)cursor.consumed());
+	    return ret;
+	}
 
     /**
      * Function to encode this object into a datablock
@@ -548,6 +655,13 @@ public:
      */
     static void decode(AsnTag& tag, DataBlock& data);
 
+    /**
+     * Decode an ASN.1 tag from the given data
+     * @param tag Tag to fill
+     * @param data Cursor over the data from which to decode the tag, it is not advanced
+     */
+    static void decode(AsnTag& tag, const AsnCursor& data);
+
     /**
      * Encode an ASN.1 tag and put the encoded form into the given data
      * @param clas Class of the tag
@@ -720,6 +834,13 @@ public:
      */
     static int decodeLength(DataBlock& data);
 
+    /**
+     * Decode the length of the block data containing the ASN.1 type data
+     * @param data Cursor over the input data, advanced past the consumed data
+     * @return The length of the data block containing data, -1 if it couldn't be decoded
+     */
+    static int decodeLength(AsnCursor& data);
+
     /**
      * Decode a boolean value from the encoded data
      * @param data Input block from which the boolean value should be extracted
@@ -729,6 +850,15 @@ public:
      */
     static int decodeBoolean(DataBlock& data, bool* val, bool tagCheck);
 
+    /**
+     * Decode a boolean value from the encoded data
+     * @param data Cursor over the input data, advanced past the consumed data
+     * @param val Pointer to a boolean to be filled with the decoded value
+     * @param tagCheck Flag for indicating if in the process of decoding the value the presence of the ASN.1 tag for boolean (0x01) should be verified
+     * @return Length of data consumed from the input data it the decoding was successful, -1 if the boolean value could not be decoded
+     */
+    static int decodeBoolean(AsnCursor& data, bool* val, bool tagCheck);
+
     /**
      * Decode an integer value from the encoded data
      * @param data Input block from which the integer value should be extracted
@@ -739,6 +869,16 @@ public:
      */
     static int decodeInteger(DataBlock& data, u_int64_t& intVal, unsigned int bytes, bool tagCheck);
 
+    /**
+     * Decode an integer value from the encoded data
+     * @param data Cursor over the input data, advanced past the consumed data
+     * @param intVal Integer to be filled with the decoded value
+     * @param bytes Width of the decoded integer field
+     * @param tagCheck Flag for indicating if in the process of decoding the value the presence of the ASN.1 tag for integer (0x02) should be verified
+     * @return Length of data consumed from the input data it the decoding was successful, -1 if the integer value could not be decoded
+     */
+    static int decodeInteger(AsnCursor& data, u_int64_t& intVal, unsigned int bytes, bool tagCheck);
+
     /**
      * Decode an unsigned integer value from the encoded data - helper function for casting from u_int64_t to u_int8_t in case of size constraints
      * @param data Input block from which the integer value should be extracted
@@ -748,6 +888,15 @@ public:
      */
     static int decodeUINT8(DataBlock& data, u_int8_t* intVal, bool tagCheck);
 
+    /**
+     * Decode an unsigned integer value from the encoded data - helper function for casting from u_int64_t to u_int8_t in case of size constraints
+     * @param data Cursor over the input data, advanced past the consumed data
+     * @param intVal Integer to be filled with the decoded value
+     * @param tagCheck Flag for indicating if in the process of decoding the value the presence of the ASN.1 tag for integer (0x02) should be verified
+     * @return Length of data consumed from the input data it the decoding was successful, -1 if the integer value could not be decoded
+     */
+    static int decodeUINT8(AsnCursor& data, u_int8_t* intVal, bool tagCheck);
+
     /**
      * Decode an unsigned integer value from the encoded data - helper function for casting from u_int64_t to u_int16_t in case of size constraints
      * @param data Input block from which the integer value should be extracted
@@ -757,6 +906,15 @@ public:
      */
     static int decodeUINT16(DataBlock& data, u_int16_t* intVal, bool tagCheck);
 
+    /**
+     * Decode an unsigned integer value from the encoded data - helper function for casting from u_int64_t to u_int16_t in case of size constraints
+     * @param data Cursor over the input data, advanced past the consumed data
+     * @param intVal Integer to be filled with the decoded value
+     * @param tagCheck Flag for indicating if in the process of decoding the value the presence of the ASN.1 tag for integer (0x02) should be verified
+     * @return Length of data consumed from the input data it the decoding was successful, -1 if the integer value could not be decoded
+     */
+    static int decodeUINT16(AsnCursor& data, u_int16_t* intVal, bool tagCheck);
+
     /**
      * Decode an unsigned integer value from the encoded data - helper function for casting from u_int64_t to u_int32_t in case of size constraints
      * @param data Input block from which the integer value should be extracted
@@ -766,6 +924,15 @@ public:
      */
     static int decodeUINT32(DataBlock& data, u_int32_t* intVal, bool tagCheck);
 
+    /**
+     * Decode an unsigned integer value from the encoded data - helper function for casting from u_int64_t to u_int32_t in case of size constraints
+     * @param data Cursor over the input data, advanced past the consumed data
+     * @param intVal Integer to be filled with the decoded value
+     * @param tagCheck Flag for indicating if in the process of decoding the value the presence of the ASN.1 tag for integer (0x02) should be verified
+     * @return Length of data consumed from the input data it the decoding was successful, -1 if the integer value could not be decoded
+     */
+    static int decodeUINT32(AsnCursor& data, u_int32_t* intVal, bool tagCheck);
+
     /**
      * Decode an unsigned integer value from the encoded data - helper function for casting in case of size constraints
      * @param data Input block from which the integer value should be extracted
@@ -775,6 +942,15 @@ public:
      */
     static int decodeUINT64(DataBlock& data, u_int64_t* intVal, bool tagCheck);
 
+    /**
+     * Decode an unsigned integer value from the encoded data - helper function for casting in case of size constraints
+     * @param data Cursor over the input data, advanced past the consumed data
+     * @param intVal Integer to be filled with the decoded value
+     * @param tagCheck Flag for indicating if in the process of decoding the value the presence of the ASN.1 tag for integer (0x02) should be verified
+     * @return Length of data consumed from the input data it the decoding was successful, -1 if the integer value could not be decoded
+     */
+    static int decodeUINT64(AsnCursor& data, u_int64_t* intVal, bool tagCheck);
+
     /**
      * Decode an integer value from the encoded data - helper function for casting from u_int64_t to int8_t in case of size constraints
      * @param data Input block from which the integer value should be extracted
@@ -784,6 +960,15 @@ public:
      */
     static int decodeINT8(DataBlock& data, int8_t* intVal, bool tagCheck);
 
+    /**
+     * Decode an integer value from the encoded data - helper function for casting from u_int64_t to int8_t in case of size constraints
+     * @param data Cursor over the input data, advanced past the consumed data
+     * @param intVal Integer to be filled with the decoded value
+     * @param tagCheck Flag for indicating if in the process of decoding the value the presence of the ASN.1 tag for integer (0x02) should be verified
+     * @return Length of data consumed from the input data it the decoding was successful, -1 if the integer value could not be decoded
+     */
+    static int decodeINT8(AsnCursor& data, int8_t* intVal, bool tagCheck);
+
     /**
      * Decode an integer value from the encoded data - helper function for casting from u_int64_t to int16_t in case of size constraints
      * @param data Input block from which the integer value should be extracted
@@ -793,6 +978,15 @@ public:
      */
     static int decodeINT16(DataBlock& data, int16_t* intVal, bool tagCheck);
 
+    /**
+     * Decode an integer value from the encoded data - helper function for casting from u_int64_t to int16_t in case of size constraints
+     * @param data Cursor over the input data, advanced past the consumed data
+     * @param intVal Integer to be filled with the decoded value
+     * @param tagCheck Flag for indicating if in the process of decoding the value the presence of the ASN.1 tag for integer (0x02) should be verified
+     * @return Length of data consumed from the input data it the decoding was successful, -1 if the integer value could not be decoded
+     */
+    static int decodeINT16(AsnCursor& data, int16_t* intVal, bool tagCheck);
+
     /**
      * Decode an integer value from the encoded data - helper function for casting from u_int64_t to int32_t in case of size constraints
      * @param data Input block from which the integer value should be extracted
@@ -802,6 +996,15 @@ public:
      */
     static int decodeINT32(DataBlock& data, int32_t* intVal, bool tagCheck);
 
+    /**
+     * Decode an integer value from the encoded data - helper function for casting from u_int64_t to int32_t in case of size constraints
+     * @param data Cursor over the input data, advanced past the consumed data
+     * @param intVal Integer to be filled with the decoded value
+     * @param tagCheck Flag for indicating if in the process of decoding the value the presence of the ASN.1 tag for integer (0x02) should be verified
+     * @return Length of data consumed from the input data it the decoding was successful, -1 if the integer value could not be decoded
+     */
+    static int decodeINT32(AsnCursor& data, int32_t* intVal, bool tagCheck);
+
     /**
      * Decode an integer value from the encoded data - helper function for casting in case of size constraints
      * @param data Input block from which the integer value should be extracted
@@ -811,6 +1014,15 @@ public:
      */
     static int decodeINT64(DataBlock& data, int64_t* intVal, bool tagCheck);
 
+    /**
+     * Decode an integer value from the encoded data - helper function for casting in case of size constraints
+     * @param data Cursor over the input data, advanced past the consumed data
+     * @param intVal Integer to be filled with the decoded value
+     * @param tagCheck Flag for indicating if in the process of decoding the value the presence of the ASN.1 tag for integer (0x02) should be verified
+     * @return Length of data consumed from the input data it the decoding was successful, -1 if the integer value could not be decoded
+     */
+    static int decodeINT64(AsnCursor& data, int64_t* intVal, bool tagCheck);
+
     /**
      * Decode a bitstring value from the encoded data
      * @param data Input block from which the bitstring value should be extracted
@@ -820,6 +1032,15 @@ public:
      */
     static int decodeBitString(DataBlock& data, String* val, bool tagCheck);
 
+    /**
+     * Decode a bitstring value from the encoded data
+     * @param data Cursor over the input data, advanced past the consumed data
+     * @param val String to be filled with the decoded value
+     * @param tagCheck Flag for indicating if in the process of decoding the value the presence of the ASN.1 tag for integer (0x03) should be verified
+     * @return Length of data consumed from the input data it the decoding was successful, -1 if the integer value could not be decoded
+     */
+    static int decodeBitString(AsnCursor& data, String* val, bool tagCheck);
+
     /**
      * Decode a string value from the encoded data
      * @param data Input block from which the octet string value should be extracted
@@ -829,6 +1050,15 @@ public:
      */
     static int decodeOctetString(DataBlock& data, OctetString* strVal, bool tagCheck);
 
+    /**
+     * Decode a string value from the encoded data
+     * @param data Cursor over the input data, advanced past the consumed data
+     * @param strVal String to be filled with the decoded value
+     * @param tagCheck Flag for indicating if in the process of decoding the value the presence of the ASN.1 tag for integer (0x04) should be verified
+     * @return Length of data consumed from the input data it the decoding was successful, -1 if the integer value could not be decoded
+     */
+    static int decodeOctetString(AsnCursor& data, OctetString* strVal, bool tagCheck);
+
     /**
      * Decode a null value from the encoded data
      * @param data Input block from which the null value should be extracted
@@ -837,6 +1067,14 @@ public:
      */
     static int decodeNull(DataBlock& data, bool tagCheck);
 
+    /**
+     * Decode a null value from the encoded data
+     * @param data Cursor over the input data, advanced past the consumed data
+     * @param tagCheck Flag for indicating if in the process of decoding the value the presence of the ASN.1 tag for integer (0x05) should be verified
+     * @return Length of data consumed from the input data it the decoding was successful, -1 if the integer value could not be decoded
+     */
+    static int decodeNull(AsnCursor& data, bool tagCheck);
+
     /**
      * Decode an object id value from the encoded data
      * @param data Input block from which the OID value should be extracted
@@ -846,6 +1084,15 @@ public:
      */
     static int decodeOID(DataBlock& data, ASNObjId* obj, bool tagCheck);
 
+    /**
+     * Decode an object id value from the encoded data
+     * @param data Cursor over the input data, advanced past the consumed data
+     * @param obj ASNObjId to be filled with the decoded value
+     * @param tagCheck Flag for indicating if in the process of decoding the value the presence of the ASN.1 tag for integer (0x06) should be verified
+     * @return Length of data consumed from the input data it the decoding was successful, -1 if the integer value could not be decoded
+     */
+    static int decodeOID(AsnCursor& data, ASNObjId* obj, bool tagCheck);
+
     /**
      * Decode a real value from the encoded data - not implemented
      * @param data Input block from which the real value should be extracted
@@ -855,6 +1102,15 @@ public:
      */
     static int decodeReal(DataBlock& data, float* realVal, bool tagCheck);
 
+    /**
+     * Decode a real value from the encoded data - not implemented
+     * @param data Cursor over the input data, advanced past the consumed data
+     * @param realVal Float to be filled with the decoded value
+     * @param tagCheck Flag for indicating if in the process of decoding the value the presence of the ASN.1 tag for integer (0x09) should be verified
+     * @return Length of data consumed from the input data it the decoding was successful, -1 if the integer value could not be decoded
+     */
+    static int decodeReal(AsnCursor& data, float* realVal, bool tagCheck);
+
     /**
      * Decode other types of ASN.1 strings from the encoded data (NumericString, PrintableString, VisibleString, IA5String)
      * @param data Input block from which the string value should be extracted
@@ -865,6 +1121,16 @@ public:
      */
     static int decodeString(DataBlock& data, String* str, int* type, bool tagCheck);
 
+    /**
+     * Decode other types of ASN.1 strings from the encoded data (NumericString, PrintableString, VisibleString, IA5String)
+     * @param data Cursor over the input data, advanced past the consumed data
+     * @param str String to be filled with the decoded value
+     * @param type Integer to be filled with the value indicating which type of string has been decoded
+     * @param tagCheck Flag for indicating if in the process of decoding the value the presence of the ASN.1 tag should be verified
+     * @return Length of data consumed from the input data it the decoding was successful, -1 if the integer value could not be decoded
+     */
+    static int decodeString(AsnCursor& data, String* str, int* type, bool tagCheck);
+
     /**
      * Decode an UTF8 string from the encoded data
      * @param data Input block from which the string value should be extracted
@@ -874,6 +1140,15 @@ public:
      */
     static int decodeUtf8(DataBlock& data, String* str, bool tagCheck);
 
+    /**
+     * Decode an UTF8 string from the encoded data
+     * @param data Cursor over the input data, advanced past the consumed data
+     * @param str String to be filled with the decoded value
+     * @param tagCheck Flag for indicating if in the process of decoding the value the presence of the ASN.1 tag (0x0c) should be verified
+     * @return Length of data consumed from the input data it the decoding was successful, -1 if the integer value could not be decoded
+     */
+    static int decodeUtf8(AsnCursor& data, String* str, bool tagCheck);
+
     /**
      * Decode a GeneralizedTime value from the encoded data
      * @param data Input block from which the value should be extracted
@@ -885,6 +1160,17 @@ public:
      */
     static int decodeGenTime(DataBlock& data, unsigned int* time, unsigned int* fractions, bool* utc, bool tagCheck);
 
+    /**
+     * Decode a GeneralizedTime value from the encoded data
+     * @param data Cursor over the input data, advanced past the consumed data
+     * @param time Integer to be filled with time in seconds since epoch
+     * @param fractions Integer to be filled with fractions of a second
+     * @param utc Flag indicating if the decode time value represent local time or UTC time
+     * @param tagCheck Flag for indicating if in the process of decoding the value the presence of the ASN.1 tag (0x18) should be verified
+     * @return Length of data consumed from the input data it the decoding was successful, -1 if the integer value could not be decoded
+     */
+    static int decodeGenTime(AsnCursor& data, unsigned int* time, unsigned int* fractions, bool* utc, bool tagCheck);
+
     /**
      * Decode a UTC time value from the encoded data
      * @param data Input block from which the value should be extracted
@@ -894,6 +1180,15 @@ public:
      */
     static int decodeUTCTime(DataBlock& data, unsigned int* time, bool tagCheck);
 
+    /**
+     * Decode a UTC time value from the encoded data
+     * @param data Cursor over the input data, advanced past the consumed data
+     * @param time Integer to be filled with time in seconds since epoch
+     * @param tagCheck Flag for indicating if in the process of decoding the value the presence of the ASN.1 tag (0x17) should be verified
+     * @return Length of data consumed from the input data it the decoding was successful, -1 if the integer value could not be decoded
+     */
+    static int decodeUTCTime(AsnCursor& data, unsigned int* time, bool tagCheck);
+
     /**
      * Decode a block of arbitrary data
      * @param data Input block from which the value should be extracted
@@ -903,6 +1198,15 @@ public:
      */
     static int decodeAny(DataBlock data, DataBlock* val, bool tagCheck);
 
+    /**
+     * Decode a block of arbitrary data
+     * @param data Cursor over the input data, it is not advanced
+     * @param val DataBlock in which the data shoulb be copied
+     * @param tagCheck Flag for indicating if in the process of decoding the value the presence of the ASN.1 should be verified
+     * @return Length of data consumed from the input data it the decoding was successful, -1 if the integer value could not be decoded
+     */
+    static int decodeAny(const AsnCursor& data, DataBlock* val, bool tagCheck);
+
     /**
      * Decode the header of an ASN.1 sequence ( decodes the tag and the length of the sequence)
      * @param data Input block from which the header should be extracted
@@ -911,6 +1215,14 @@ public:
      */
     static int decodeSequence(DataBlock& data, bool tagCheck);
 
+    /**
+     * Decode the header of an ASN.1 sequence ( decodes the tag and the length of the sequence)
+     * @param data Cursor over the input data, advanced past the consumed data
+     * @param tagCheck Flag for indicating if in the process of decoding the value the presence of the ASN.1 (0x30) should be verified
+     * @return Length of data consumed from the input data it the decoding was succesful, -1 if the integer value could not be decoded
+     */
+    static int decodeSequence(AsnCursor& data, bool tagCheck);
+
     /**
      * Decode the header of an ASN.1 set ( decodes the tag and the length of the sequence)
      * @param data Input block from which the header should be extracted
@@ -919,6 +1231,14 @@ public:
      */
     static int decodeSet(DataBlock& data, bool tagCheck);
 
+    /**
+     * Decode the header of an ASN.1 set ( decodes the tag and the length of the sequence)
+     * @param data Cursor over the input data, advanced past the consumed data
+     * @param tagCheck Flag for indicating if in the process of decoding the value the presence of the ASN.1 (0x31) should be verified
+     * @return Length of data consumed from the input data it the decoding was succesful, -1 if the integer value could not be decoded
+     */
+    static int decodeSet(AsnCursor& data, bool tagCheck);
+
     /**
      * Encode the length of the given data
      * @param data The data for which the length should be encoded
@@ -1046,6 +1366,13 @@ public:
      */
     static int matchEOC(DataBlock& data);
 
+    /**
+     * Verify the data for End Of Contents presence
+     * @param data Cursor over the input data, advanced past the consumed data
+     * @return Length of data consumed from the input data it the decoding was succesful, it should be 2 in case of success, -1 if the data doesn't match EoC
+     */
+    static int matchEOC(AsnCursor& data);
+
     /**
      * Extract length until a End Of Contents is found.
      * @param data Input block for which to determine the length to End Of Contents
@@ -1053,6 +1380,14 @@ public:
      * @return Length until End Of Contents
      */
     static int parseUntilEoC(DataBlock& data, int length = 0);
+
+    /**
+     * Extract length until a End Of Contents is found.
+     * @param data Cursor over the input data, advanced past the consumed data
+     * @param length Length to which to add determined length
+     * @return Length until End Of Contents
+     */
+    static int parseUntilEoC(AsnCursor& data, int length = 0);
 };
 
 }
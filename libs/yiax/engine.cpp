@@ -39,6 +39,31 @@ using namespace TelEngine;
 #define IAX2_ADJUSTTSOUT_OVER 120
 #define IAX2_ADJUSTTSOUT_UNDER 60
 
+// Socket read buffer length
+#define IAX2_READ_BUFLEN 1500
+// Maximum number of datagrams read from socket at once
+#define IAX2_READ_BATCH_MAX 64
+#define IAX2_READ_BATCH_DEF 16
+#ifdef MSG_WAITFORONE
+#define IAX2_READ_MMSG
+#endif
+
+#ifdef IAX2_READ_MMSG
+// Buffers used to read a batch of datagrams
+struct ReadBatch
+{
+    unsigned char bufs[IAX2_READ_BATCH_MAX][IAX2_READ_BUFLEN];
+    struct sockaddr_storage addrs[IAX2_READ_BATCH_MAX];
+    struct iovec iov[IAX2_READ_BATCH_MAX];
+    struct mmsghdr msgs[IAX2_READ_BATCH_MAX];
+};
+#endif
+
+// Trunk counters hash list length
+#define IAX2_TRUNKSTATS_HASH 64
+// Interval (in milliseconds) after unused trunk counters are removed
+#define IAX2_TRUNKSTATS_IDLE 60000
+
 
 // Build an MD5 digest from secret, address, integer value and engine run id
 // MD5(addr.host() + secret + addr.port() + t)
@@ -67,6 +92,7 @@ IAXEngine::IAXEngine(const char* iface, int port, u_int32_t format, u_int32_t ca
     m_callTokenAge(10),
     m_showCallTokenFailures(false),
     m_printMsg(true),
+    m_readBatch(IAX2_READ_BATCH_DEF),
     m_callerNumType(0),
     m_callingPres(0),
     m_format(format),
@@ -76,7 +102,10 @@ IAXEngine::IAXEngine(const char* iface, int port, u_int32_t format, u_int32_t ca
     m_adjustTsOutOverrun(IAX2_ADJUSTTSOUT_OVER),
     m_adjustTsOutUnderrun(IAX2_ADJUSTTSOUT_UNDER),
     m_mutexTrunk(false,"IAXEngine::Trunk"),
-    m_trunkInfoMutex(false,"IAXEngine::TrunkInfo")
+    m_trunkInfoMutex(false,"IAXEngine::TrunkInfo"),
+    m_trunkStatsMutex(false,"IAXEngine::TrunkStats"),
+    m_trunkStats(IAX2_TRUNKSTATS_HASH),
+    m_trunkStatsExpire(0)
 {
     debugName(m_name);
     if ((port <= 0) || port > 65535)
@@ -263,6 +292,92 @@ IAXTransaction* IAXEngine::findTransaction(const SocketAddr& addr, u_int16_t rCa
     return 0;
 }
 
+// Retrieve the trunk counters of a remote peer
+IAXTrunkStats* IAXEngine::trunkStats(const SocketAddr& addr, bool create)
+{
+    String id;
+    id << addr.host() << ":" << addr.port();
+    Lock lck(m_trunkStatsMutex);
+    IAXTrunkStats* st = static_cast<IAXTrunkStats*>(m_trunkStats[id]);
+    if (!st) {
+	if (!create)
+	    return 0;
+	expireTrunkStats(Time::msecNow());
+	st = new IAXTrunkStats(addr);
+	m_trunkStats.append(st);
+    }
+    return st->ref() ? st : 0;
+}
+
+// Remove the trunk counters of a remote peer, release the given reference
+void IAXEngine::removeTrunkStats(IAXTrunkStats*& stats)
+{
+    if (!stats)
+	return;
+    Lock lck(m_trunkStatsMutex);
+    m_trunkStats.remove(stats,true,true);
+    lck.drop();
+    TelEngine::destruct(stats);
+}
+
+// Remove counters not used by a trunk frame and not updated for some time
+// Trunk counters mutex must be locked
+void IAXEngine::expireTrunkStats(u_int64_t now)
+{
+    if (now < m_trunkStatsExpire)
+	return;
+    m_trunkStatsExpire = now + IAX2_TRUNKSTATS_IDLE / 4;
+    for (unsigned int i = 0; i < m_trunkStats.length(); i++) {
+	ObjList* l = m_trunkStats.getList(i);
+	for (l = l ? l->skipNull() : 0; l;) {
+	    IAXTrunkStats* st = static_cast<IAXTrunkStats*>(l->get());
+	    // referenced by the list only
+	    if (st->refcount() == 1 && st->lastUsed() + IAX2_TRUNKSTATS_IDLE < now) {
+		DDebug(this,DebugAll,"Removing idle trunk counters '%s' [%p]",
+		    st->toString().c_str(),this);
+		l->remove();
+		l = l->skipNull();
+	    }
+	    else
+		l = l->skipNext();
+	}
+    }
+}
+
+// Retrieve the trunk counters of all remote peers
+void IAXEngine::trunkStats(ObjList& dest)
+{
+    Lock lck(m_trunkStatsMutex);
+    expireTrunkStats(Time::msecNow());
+    for (unsigned int i = 0; i < m_trunkStats.length(); i++) {
+	ObjList* l = m_trunkStats.getList(i);
+	for (l = l ? l->skipNull() : 0; l; l = l->skipNext()) {
+	    IAXTrunkStats* st = static_cast<IAXTrunkStats*>(l->get());
+	    if (st->ref())
+		dest.append(st);
+	}
+    }
+}
+
+// Count a trunk frame received from a remote peer
+void IAXEngine::trunkReceived(const SocketAddr& addr, unsigned int minis, unsigned int bytes,
+    u_int16_t callNo)
+{
+    IAXTrunkStats* st = trunkStats(addr);
+    if (!st) {
+	// don't keep counters for any address sending us trunk frames
+	IAXTransaction* tr = minis ? findTransaction(addr,callNo) : 0;
+	if (!tr)
+	    return;
+	TelEngine::destruct(tr);
+	st = trunkStats(addr,true);
+	if (!st)
+	    return;
+    }
+    st->received(minis,bytes);
+    TelEngine::destruct(st);
+}
+
 void IAXEngine::sendInval(IAXFullFrame* frame, const SocketAddr& addr)
 {
     if (!frame)
@@ -381,6 +496,7 @@ void IAXEngine::initialize(const NamedList& params)
     m_showCallTokenFailures = params.getBoolValue("calltoken_printfailure");
     m_rejectMissingCallToken = params.getBoolValue("calltoken_rejectmissing",true);
     m_printMsg = params.getBoolValue("printmsg",true);
+    m_readBatch = params.getIntValue("read_batch",IAX2_READ_BATCH_DEF,1,IAX2_READ_BATCH_MAX);
     m_callerNumType = lookup(params["numtype"],IAXInfoElement::s_typeOfNumber);
     m_callingPres = lookup(params["presentation"],IAXInfoElement::s_presentation) |
 	lookup(params["screening"],IAXInfoElement::s_screening);
@@ -403,11 +519,55 @@ void IAXEngine::initialize(const NamedList& params)
 
 void IAXEngine::readSocket(SocketAddr& addr)
 {
-    unsigned char buf[1500];
+    unsigned char buf[IAX2_READ_BUFLEN];
+#ifdef IAX2_READ_MMSG
+    ReadBatch* rb = 0;
+#endif
 
     while (1) {
 	if (Thread::check(false))
 	    break;
+#ifdef IAX2_READ_MMSG
+	// Read as many datagrams as available (up to batch size) in a single call
+	// Batch size may change on reload, switch reading mode when it does
+	unsigned int n = m_readBatch;
+	if (n > 1) {
+	    // Buffers are too large for the thread stack
+	    if (!rb)
+		rb = new ReadBatch;
+	    for (unsigned int i = 0; i < n; i++) {
+		rb->iov[i].iov_base = rb->bufs[i];
+		rb->iov[i].iov_len = IAX2_READ_BUFLEN;
+		struct msghdr& hdr = rb->msgs[i].msg_hdr;
+		::memset(&hdr,0,sizeof(hdr));
+		hdr.msg_name = &rb->addrs[i];
+		hdr.msg_namelen = sizeof(rb->addrs[i]);
+		hdr.msg_iov = &rb->iov[i];
+		hdr.msg_iovlen = 1;
+	    }
+	    int got = ::recvmmsg(m_socket.handle(),rb->msgs,n,MSG_DONTWAIT,0);
+	    if (got <= 0) {
+		int err = Thread::lastError();
+		if (got < 0 && err != EAGAIN && err != EWOULDBLOCK && err != EINTR) {
+		    String tmp;
+		    Thread::errorString(tmp,err);
+		    Debug(this,DebugWarn,"Socket read error: %s (%d) [%p]",
+			tmp.c_str(),err,this);
+		}
+		Thread::idle(false);
+		continue;
+	    }
+	    for (int i = 0; i < got; i++) {
+		addr.assign((struct sockaddr*)&rb->addrs[i],rb->msgs[i].msg_hdr.msg_namelen);
+		addFrame(addr,rb->bufs[i],rb->msgs[i].msg_len);
+	    }
+	    continue;
+	}
+	if (rb) {
+	    delete rb;
+	    rb = 0;
+	}
+#endif
 	int len = m_socket.recvFrom(buf,sizeof(buf),addr);
 	if (len == Socket::socketError()) {
 	    if (!m_socket.canRetry()) {
@@ -421,6 +581,9 @@ void IAXEngine::readSocket(SocketAddr& addr)
 	}
 	addFrame(addr,buf,len);
     }
+#ifdef IAX2_READ_MMSG
+    delete rb;
+#endif
 }
 
 bool IAXEngine::writeSocket(const void* buf, int len, const SocketAddr& addr,
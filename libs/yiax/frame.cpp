@@ -1049,6 +1049,9 @@ IAXFrame* IAXFrame::parse(const unsigned char* buf, unsigned int len, IAXEngine*
 	if (buf[2] != 1)
 	    return 0;
 	bool tstamps = (buf[3] & 1) != 0;
+	unsigned int total = len;
+	unsigned int minis = 0;
+	u_int16_t firstCallNo = 0;
 	if (tstamps) {
 	    // Trunk timestamps (mini frames)
 	    buf += 8;
@@ -1067,6 +1070,8 @@ IAXFrame* IAXFrame::parse(const unsigned char* buf, unsigned int len, IAXEngine*
 		IAXFrame* frame = new IAXFrame(IAXFrame::Voice,scn,dcn,retrans,buf+6,dlen);
 		engine->addFrame(*addr,frame);
 		frame->deref();
+		if (!minis++)
+		    firstCallNo = scn;
 		dlen += 6;
 		buf += dlen;
 		len -= dlen;
@@ -1086,6 +1091,8 @@ IAXFrame* IAXFrame::parse(const unsigned char* buf, unsigned int len, IAXEngine*
 		scn = 0x7fff & ((buf[0] << 8) | buf[1]);
 		IAXTrunkFrameTrans* t = IAXTrunkFrameTrans::get(list,scn);
 		t->m_blocks.append(new DataBlock((void*)(buf+4),dlen));
+		if (!minis++)
+		    firstCallNo = scn;
 		dlen += 4;
 		buf += dlen;
 		len -= dlen;
@@ -1100,6 +1107,7 @@ IAXFrame* IAXFrame::parse(const unsigned char* buf, unsigned int len, IAXEngine*
 
 	    }
 	}
+	engine->trunkReceived(*addr,minis,total,firstCallNo);
 	return 0;
     }
     // Mini frame
@@ -1476,6 +1484,28 @@ void IAXTrunkInfo::dump(String& buf, const char* sep, bool out, bool in, bool ot
 }
 
 
+/*
+* IAXTrunkStats
+*/
+IAXTrunkStats::IAXTrunkStats(const SocketAddr& addr)
+    : Mutex(false,"IAXTrunkStats"),
+    m_addr(addr),
+    m_lastUsed(Time::msecNow()),
+    m_sentFrames(0), m_sentMinis(0), m_sentBytes(0),
+    m_recvFrames(0), m_recvMinis(0), m_recvBytes(0)
+{
+    m_id << addr.host() << ":" << addr.port();
+}
+
+// Dump counters
+void IAXTrunkStats::dump(String& buf, const char* sep)
+{
+    Lock lck(this);
+    buf << m_sentFrames << sep << m_sentMinis << sep << m_sentBytes;
+    buf << sep << m_recvFrames << sep << m_recvMinis << sep << m_recvBytes;
+}
+
+
 /*
 * IAXMetaTrunkFrame
 */
@@ -1483,6 +1513,7 @@ IAXMetaTrunkFrame::IAXMetaTrunkFrame(IAXEngine* engine, const SocketAddr& addr,
     bool timestamps, unsigned int maxLen, unsigned int sendInterval)
     : Mutex(false,"IAXMetaTrunkFrame"),
     m_calls(0), m_data(0), m_dataAddIdx(IAX2_TRUNKFRAME_HEADERLENGTH),
+    m_minis(0), m_stats(0),
     m_timeStamp(0), m_send(0), m_lastSentTs(0),
     m_sendInterval(sendInterval),
     m_engine(engine), m_addr(addr),
@@ -1503,6 +1534,8 @@ IAXMetaTrunkFrame::IAXMetaTrunkFrame(IAXEngine* engine, const SocketAddr& addr,
     // Meta command & Command data (use timestamps)
     m_data[2] = 1;
     m_data[3] = m_trunkTimestamps ? 1 : 0;
+    if (m_engine)
+	m_stats = m_engine->trunkStats(m_addr,true);
     XDebug(m_engine,DebugAll,"Trunk frame '%s:%d' created [%p]",
 	m_addr.host().c_str(),m_addr.port(),this);
 }
@@ -1515,6 +1548,11 @@ IAXMetaTrunkFrame::~IAXMetaTrunkFrame()
     else
 	Debug(m_engine,DebugMild,"Trunk frame '%s:%d' destroyed with %u calls [%p]",
 	    m_addr.host().c_str(),m_addr.port(),m_calls,this);
+    // there is a single trunk frame for a remote address, counters go with it
+    if (m_engine)
+	m_engine->removeTrunkStats(m_stats);
+    else
+	TelEngine::destruct(m_stats);
     delete[] m_data;
 }
 
@@ -1557,6 +1595,7 @@ unsigned int IAXMetaTrunkFrame::add(u_int16_t sCallNo, const DataBlock& data, u_
     }
     memcpy(m_data + m_dataAddIdx,data.data(),data.length());
     m_dataAddIdx += data.length();
+    m_minis++;
     return data.length();
 }
 
@@ -1601,7 +1640,10 @@ bool IAXMetaTrunkFrame::doSend(const Time& now, bool onTime)
 	m_addr.host().c_str(),m_addr.port(),m_dataAddIdx,m_lastSentTs,m_calls,this);
     setTimestamp(m_lastSentTs);
     bool b = m_engine->writeSocket(m_data,m_dataAddIdx,m_addr);
+    if (b && m_stats)
+	m_stats->sent(m_minis,m_dataAddIdx);
     m_dataAddIdx = IAX2_TRUNKFRAME_HEADERLENGTH;
+    m_minis = 0;
     return b;
 }
 
@@ -58,6 +58,7 @@ class IAXFullFrame;                      // This class holds an IAX full frame
 class IAXFrameOut;                       // This class holds an outgoing IAX full frame
 class IAXTrunkInfo;                      // Trunk info
 class IAXMetaTrunkFrame;                 // Meta trunk frame
+class IAXTrunkStats;                     // Trunk counters of a remote peer
 class IAXMediaData;                      // IAX2 transaction media data
 class IAXTransaction;                    // An IAX2 transaction
 class IAXEvent;                          // Event class
@@ -1541,6 +1542,86 @@ public:
     unsigned int m_pingInterval;         // Ping interval in milliseconds
 };
 
+/**
+ * This class holds the trunked media counters of a remote peer
+ * @short Trunk statistics
+ */
+class YIAX_API IAXTrunkStats : public RefObject, public Mutex
+{
+public:
+    /**
+     * Constructor
+     * @param addr Remote peer address
+     */
+    IAXTrunkStats(const SocketAddr& addr);
+
+    /**
+     * Get the remote peer address
+     * @return The remote peer address
+     */
+    inline const SocketAddr& addr() const
+	{ return m_addr; }
+
+    /**
+     * Get a string representation of this object
+     * @return The remote peer address as host:port
+     */
+    virtual const String& toString() const
+	{ return m_id; }
+
+    /**
+     * Get the time the counters were created or last updated
+     * @return Time in milliseconds
+     */
+    inline u_int64_t lastUsed() const
+	{ return m_lastUsed; }
+
+    /**
+     * Count a trunk frame sent to the peer
+     * @param minis Number of mini frames carried by the trunk frame
+     * @param bytes Trunk frame length
+     */
+    inline void sent(unsigned int minis, unsigned int bytes) {
+	    Lock lck(this);
+	    m_lastUsed = Time::msecNow();
+	    m_sentFrames++;
+	    m_sentMinis += minis;
+	    m_sentBytes += bytes;
+	}
+
+    /**
+     * Count a trunk frame received from the peer
+     * @param minis Number of mini frames carried by the trunk frame
+     * @param bytes Trunk frame length
+     */
+    inline void received(unsigned int minis, unsigned int bytes) {
+	    Lock lck(this);
+	    m_lastUsed = Time::msecNow();
+	    m_recvFrames++;
+	    m_recvMinis += minis;
+	    m_recvBytes += bytes;
+	}
+
+    /**
+     * Append the counters to a string as sent frames, mini frames, bytes
+     *  followed by received frames, mini frames, bytes
+     * @param buf Destination string
+     * @param sep Values separator
+     */
+    void dump(String& buf, const char* sep = "|");
+
+private:
+    SocketAddr m_addr;                   // Remote peer address
+    String m_id;                         // Remote peer address as host:port
+    u_int64_t m_lastUsed;                // Creation or last update time
+    u_int64_t m_sentFrames;              // Sent trunk frames
+    u_int64_t m_sentMinis;               // Mini frames sent in trunk frames
+    u_int64_t m_sentBytes;               // Sent trunk frames length
+    u_int64_t m_recvFrames;              // Received trunk frames
+    u_int64_t m_recvMinis;               // Mini frames received in trunk frames
+    u_int64_t m_recvBytes;               // Received trunk frames length
+};
+
 /**
  * Handle meta trunk frame with timestamps
  * @short Meta trunk frame
@@ -1667,6 +1748,8 @@ private:
     unsigned int m_calls;       // The number of calls using it
     u_int8_t* m_data;		// Data buffer
     u_int16_t m_dataAddIdx;	// Current add index
+    unsigned int m_minis;       // Number of mini frames in buffer
+    IAXTrunkStats* m_stats;     // Counters of the remote peer
     u_int64_t m_timeStamp;      // First time data was added
     u_int64_t m_send;           // Time to send
     u_int32_t m_lastSentTs;     // Last sent timestamp
@@ -3134,6 +3217,37 @@ public:
 	    return info != 0;
 	}
 
+    /**
+     * Retrieve the trunk counters of a remote peer
+     * @param addr Remote peer address
+     * @param create True to create the counters if not found
+     * @return Referenced pointer to the counters, 0 if not found
+     */
+    IAXTrunkStats* trunkStats(const SocketAddr& addr, bool create = false);
+
+    /**
+     * Retrieve the trunk counters of all remote peers
+     * @param dest List to be filled with referenced counters
+     */
+    void trunkStats(ObjList& dest);
+
+    /**
+     * Remove the trunk counters of a remote peer from engine
+     * @param stats Referenced counters to remove, the reference is released
+     */
+    void removeTrunkStats(IAXTrunkStats*& stats);
+
+    /**
+     * Count a trunk frame received from a remote peer.
+     * Counters are created only for peers with a trunk or a known transaction
+     * @param addr Remote peer address
+     * @param minis Number of mini frames carried by the trunk frame
+     * @param bytes Trunk frame length
+     * @param callNo Source call number of the first mini frame
+     */
+    void trunkReceived(const SocketAddr& addr, unsigned int minis, unsigned int bytes,
+	u_int16_t callNo);
+
     /**
      * Send an INVAL frame
      * @param frame Frame for which to send an INVAL frame
@@ -3312,6 +3426,13 @@ protected:
      */
     bool bind(const char* iface, int port, bool force);
 
+    /**
+     * Remove trunk counters not used by a trunk frame and idle for some time.
+     * Trunk counters mutex must be locked
+     * @param now Current time in milliseconds
+     */
+    void expireTrunkStats(u_int64_t now);
+
     int m_trunking;                             // Trunking capability: negative: ok, otherwise: not enabled
 
 private:
@@ -3334,6 +3455,7 @@ private:
     bool m_showCallTokenFailures;               // Print incoming call token failures to output
     bool m_rejectMissingCallToken;              // Reject/ignore incoming calls without call token if mandatory
     bool m_printMsg;                            // Print frame to output
+    unsigned int m_readBatch;                   // Max datagrams read from socket at once
     u_int8_t m_callerNumType;                   // Caller number type
     u_int8_t m_callingPres;                     // Caller presentation + screening
     // Media
@@ -3350,6 +3472,9 @@ private:
     ObjList m_trunkList;			// Trunk frames list
     Mutex m_trunkInfoMutex;                     // Trunk info mutex
     RefPointer<IAXTrunkInfo> m_trunkInfoDef;    // Defaults for trunk data
+    Mutex m_trunkStatsMutex;                    // Trunk counters mutex
+    HashList m_trunkStats;                      // Trunk counters of remote peers
+    u_int64_t m_trunkStatsExpire;               // Next time to check idle trunk counters
 };
 
 }
@@ -646,7 +646,7 @@ void JBConnect::connect()
 		return;
 	    int code = 0;
 	    if (Resolver::init())
-		code = Resolver::srvQuery(query,m_srvs,&error);
+		code = Resolver::cachedQuery(Resolver::Srv,query,m_srvs,&error);
 	    // Stop the timeout if not exiting
 	    if (exiting(sock) || !notifyConnecting(false,true)) {
 		terminated(0,false);
@@ -22,6 +22,9 @@
 
 using namespace TelEngine;
 
+// Number of lists in the remote endpoints index of a Call Agent
+#define EP_REMOTE_INDEX_SIZE 256
+
 /**
  * MGCPEndpoint
  */
@@ -30,7 +33,8 @@ MGCPEndpoint::MGCPEndpoint(MGCPEngine* engine, const char* user,
 	const char* host, int port, bool addPort)
     : MGCPEndpointId(user,host,port,addPort),
       Mutex(false,"MGCPEndpoint"),
-      m_engine(engine)
+      m_engine(engine),
+      m_remoteIndex((engine && !engine->gateway()) ? EP_REMOTE_INDEX_SIZE : 1)
 {
     if (!m_engine) {
 	Debug(DebugNote,"Can't construct endpoint without engine [%p]",this);
@@ -63,8 +67,10 @@ MGCPEpInfo* MGCPEndpoint::append(const char* endpoint, const char* host, int por
     MGCPEpInfo* ep = new MGCPEpInfo(endpoint,host,port,addPort);
     if (!ep->valid() || find(ep->id()))
 	TelEngine::destruct(ep);
-    else
+    else {
 	m_remote.append(ep);
+	m_remoteIndex.append(ep)->setDelete(false);
+    }
     return ep;
 }
 
@@ -72,7 +78,7 @@ MGCPEpInfo* MGCPEndpoint::append(const char* endpoint, const char* host, int por
 MGCPEpInfo* MGCPEndpoint::find(const String& epId)
 {
     Lock lock(this);
-    return static_cast<MGCPEpInfo*>(m_remote[epId]);
+    return static_cast<MGCPEpInfo*>(m_remoteIndex[epId]);
 }
 
 //  Find the info object associated with a remote peer by alias name
@@ -92,7 +98,8 @@ MGCPEpInfo* MGCPEndpoint::findAlias(const String& alias)
 // Find the info object associated with an unique remote peer
 MGCPEpInfo* MGCPEndpoint::peer()
 {
-    return (m_remote.count() == 1) ? static_cast<MGCPEpInfo*>(m_remote.get()) : 0;
+    ObjList* o = m_remote.skipNull();
+    return (o && !o->skipNext()) ? static_cast<MGCPEpInfo*>(o->get()) : 0;
 }
 
 /**
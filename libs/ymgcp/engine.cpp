@@ -57,6 +57,10 @@ using namespace TelEngine;
 #define TR_EXTRA_TIME 30000
 #define TR_EXTRA_TIME_MIN 10000
 
+#define TR_HASH_SIZE 1024                // Number of lists in the transactions table
+#define EP_INDEX_SIZE 512                // Number of lists in the endpoints index
+#define TR_TIMERS_GROW 64                // Minimum growth of the transactions timer queue
+
 
 /**
  * MGCPPrivateThread
@@ -101,7 +105,7 @@ void MGCPPrivateThread::run()
  */
 MGCPEngine::MGCPEngine(bool gateway, const char* name, const NamedList* params)
     : Mutex(true,"MGCPEngine"),
-    m_iterator(m_transactions),
+    m_transactions(TR_HASH_SIZE),
     m_gateway(gateway),
     m_initialized(false),
     m_nextId(1),
@@ -114,7 +118,11 @@ MGCPEngine::MGCPEngine(bool gateway, const char* name, const NamedList* params)
     m_extraTime(TR_EXTRA_TIME * 1000),
     m_parseParamToLower(true),
     m_provisional(true),
-    m_ackRequest(true)
+    m_ackRequest(true),
+    m_epIndex(EP_INDEX_SIZE),
+    m_timers(0),
+    m_timersCount(0),
+    m_timersSize(0)
 {
     debugName((name && *name) ? name : (gateway ? "mgcp_gw" : "mgcp_ca"));
 
@@ -133,6 +141,8 @@ MGCPEngine::~MGCPEngine()
     cleanup(false);
     if (m_recvBuf)
 	delete[] m_recvBuf;
+    if (m_timers)
+	delete[] m_timers;
     DDebug(this,DebugAll,"MGCPEngine::~MGCPEngine()");
 }
 
@@ -251,6 +261,7 @@ void MGCPEngine::attach(MGCPEndpoint* ep)
     Lock lock(this);
     if (!m_endpoints.find(ep)) {
 	m_endpoints.append(ep);
+	m_epIndex.append(ep)->setDelete(false);
 	Debug(this,DebugInfo,"Attached endpoint '%s'",ep->id().c_str());
     }
 }
@@ -267,13 +278,19 @@ void MGCPEngine::detach(MGCPEndpoint* ep, bool del, bool delTrans)
     Lock lock(this);
     // Remove transactions
     if (delTrans) {
-	ListIterator iter(m_transactions);
-	for (GenObject* o; 0 != (o = iter.get());) {
-	    MGCPTransaction* tr = static_cast<MGCPTransaction*>(o);
-	    if (ep->id() == tr->ep())
-		m_transactions.remove(tr,true);
+	for (unsigned int i = 0; i < m_transactions.length(); i++) {
+	    ObjList* l = m_transactions.getList(i);
+	    if (!l)
+		continue;
+	    ListIterator iter(*l);
+	    for (GenObject* o; 0 != (o = iter.get());) {
+		MGCPTransaction* tr = static_cast<MGCPTransaction*>(o);
+		if (ep->id() == tr->ep())
+		    removeTrans(tr,true);
+	    }
 	}
     }
+    m_epIndex.remove(ep,false,true);
     m_endpoints.remove(ep,del);
 }
 
@@ -288,14 +305,15 @@ MGCPEndpoint* MGCPEngine::findEp(MGCPEndpoint* ep)
 MGCPEndpoint* MGCPEngine::findEp(const String& epId)
 {
     Lock lock(this);
-    return static_cast<MGCPEndpoint*>(m_endpoints[epId]);
+    return static_cast<MGCPEndpoint*>(m_epIndex[epId]);
 }
 
 // find a transaction
 MGCPTransaction* MGCPEngine::findTrans(unsigned int id, bool outgoing)
 {
     Lock lock(this);
-    for (ObjList* o = m_transactions.skipNull(); o; o = o->skipNext()) {
+    ObjList* l = m_transactions.getHashList(transHash(id,outgoing));
+    for (ObjList* o = l ? l->skipNull() : 0; o; o = o->skipNext()) {
 	MGCPTransaction* tr = static_cast<MGCPTransaction*>(o->get());
 	if (outgoing == tr->outgoing() && id == tr->id())
 	    return tr;
@@ -499,20 +517,18 @@ void MGCPEngine::runProcess()
 }
 
 // Try to get an event from a transaction
+// Only the transactions whose check time is due are visited, the transaction
+//  queues itself again for its next timeout when it has no event to report
 MGCPEvent* MGCPEngine::getEvent(u_int64_t time)
 {
     lock();
     while (true) {
 	if (Thread::check(false))
 	    break;
-	MGCPTransaction* tr = static_cast<MGCPTransaction*>(m_iterator.get());
-        // End of iteration? NO: get a reference to the transaction
-	if (!tr) {
-	    m_iterator.assign(m_transactions);
+	MGCPTransaction* tr = m_timersCount ? m_timers[0] : 0;
+	if (!tr || tr->m_timerTime > time)
 	    break;
-	}
-	if (!tr->m_engineProcess)
-	    continue;
+	scheduleTrans(tr,0);
 	RefPointer<MGCPTransaction> sref = tr;
 	if (!sref)
 	    continue;
@@ -577,11 +593,17 @@ void MGCPEngine::cleanup(bool gracefully, const char* text)
     // Terminate transactions
     Lock mylock(this);
     if (gracefully)
-	for (ObjList* o = m_transactions.skipNull(); o; o = o->skipNext()) {
-	    MGCPTransaction* tr = static_cast<MGCPTransaction*>(o->get());
-	    if (!tr->outgoing())
-		tr->setResponse(400,text);
+	for (unsigned int i = 0; i < m_transactions.length(); i++) {
+	    ObjList* l = m_transactions.getList(i);
+	    for (ObjList* o = l ? l->skipNull() : 0; o; o = o->skipNext()) {
+		MGCPTransaction* tr = static_cast<MGCPTransaction*>(o->get());
+		if (!tr->outgoing())
+		    tr->setResponse(400,text);
+	    }
 	}
+    for (unsigned int i = 0; i < m_timersCount; i++)
+	m_timers[i]->m_timerPos = 0;
+    m_timersCount = 0;
     m_transactions.clear();
 
     // Check if we have any private threads to wait
@@ -638,7 +660,8 @@ void MGCPEngine::appendTrans(MGCPTransaction* trans)
 	return;
     Lock lock(this);
     DDebug(this,DebugAll,"Added transaction (%p)",trans);
-    m_transactions.append(trans);
+    m_transactions.append(trans,transHash(trans->id(),trans->outgoing()));
+    scheduleTrans(trans,Time::now());
 }
 
 // Remove a transaction from the list
@@ -648,7 +671,97 @@ void MGCPEngine::removeTrans(MGCPTransaction* trans, bool del)
 	return;
     Lock lock(this);
     DDebug(this,DebugAll,"Removed transaction (%p) del=%u",trans,del);
-    m_transactions.remove(trans,del);
+    scheduleTrans(trans,0);
+    m_transactions.remove(trans,transHash(trans->id(),trans->outgoing()),del);
+}
+
+// Schedule an engine processed transaction to be checked no later than a given time
+// The timer queue is a binary heap, each transaction knows its position in it
+void MGCPEngine::scheduleTrans(MGCPTransaction* trans, u_int64_t when)
+{
+    if (!trans)
+	return;
+    Lock lock(this);
+    unsigned int pos = trans->m_timerPos;
+    if (!when) {
+	if (!pos)
+	    return;
+	// Replace the removed entry with the last one
+	trans->m_timerPos = 0;
+	MGCPTransaction* last = m_timers[--m_timersCount];
+	if (last == trans)
+	    return;
+	m_timers[pos - 1] = last;
+	last->m_timerPos = pos;
+	timerUp(pos - 1);
+	timerDown(last->m_timerPos - 1);
+	return;
+    }
+    // Don't queue transactions processed by the user or already removed
+    if (!(trans->m_engineProcess &&
+	m_transactions.find(trans,transHash(trans->id(),trans->outgoing()))))
+	return;
+    // Keep the earliest time, the queued check will reschedule if needed
+    if (pos) {
+	if (when < trans->m_timerTime) {
+	    trans->m_timerTime = when;
+	    timerUp(pos - 1);
+	}
+	return;
+    }
+    if (m_timersCount >= m_timersSize) {
+	unsigned int size = m_timersSize * 2;
+	if (size < m_timersSize + TR_TIMERS_GROW)
+	    size = m_timersSize + TR_TIMERS_GROW;
+	MGCPTransaction** tmp = new MGCPTransaction*[size];
+	if (m_timers) {
+	    ::memcpy(tmp,m_timers,sizeof(MGCPTransaction*) * m_timersCount);
+	    delete[] m_timers;
+	}
+	m_timers = tmp;
+	m_timersSize = size;
+    }
+    m_timers[m_timersCount++] = trans;
+    trans->m_timerPos = m_timersCount;
+    trans->m_timerTime = when;
+    timerUp(m_timersCount - 1);
+}
+
+// Move a timer queue entry towards the head while it is earlier than its parent
+void MGCPEngine::timerUp(unsigned int pos)
+{
+    MGCPTransaction* trans = m_timers[pos];
+    while (pos) {
+	unsigned int parent = (pos - 1) / 2;
+	if (m_timers[parent]->m_timerTime <= trans->m_timerTime)
+	    break;
+	m_timers[pos] = m_timers[parent];
+	m_timers[pos]->m_timerPos = pos + 1;
+	pos = parent;
+    }
+    m_timers[pos] = trans;
+    trans->m_timerPos = pos + 1;
+}
+
+// Move a timer queue entry towards the tail while it is later than a child
+void MGCPEngine::timerDown(unsigned int pos)
+{
+    MGCPTransaction* trans = m_timers[pos];
+    while (true) {
+	unsigned int child = 2 * pos + 1;
+	if (child >= m_timersCount)
+	    break;
+	if (child + 1 < m_timersCount &&
+	    m_timers[child + 1]->m_timerTime < m_timers[child]->m_timerTime)
+	    child++;
+	if (trans->m_timerTime <= m_timers[child]->m_timerTime)
+	    break;
+	m_timers[pos] = m_timers[child];
+	m_timers[pos]->m_timerPos = pos + 1;
+	pos = child;
+    }
+    m_timers[pos] = trans;
+    trans->m_timerPos = pos + 1;
 }
 
 // Append a private thread to the list
@@ -27,6 +27,7 @@ MGCPTransaction::MGCPTransaction(MGCPEngine* engine, MGCPMessage* msg, bool outg
 	const SocketAddr& address, bool engineProcess)
     : Mutex(true,"MGCPTransaction"),
     m_state(Invalid),
+    m_id(0),
     m_outgoing(outgoing),
     m_address(address),
     m_engine(engine),
@@ -41,8 +42,13 @@ MGCPTransaction::MGCPTransaction(MGCPEngine* engine, MGCPMessage* msg, bool outg
     m_timeout(false),
     m_ackRequest(true),
     m_private(0),
-    m_engineProcess(engineProcess)
+    m_engineProcess(engineProcess),
+    m_timerTime(0),
+    m_timerPos(0)
 {
+    // The engine finds transactions by id, set it before appending
+    if (msg)
+	m_id = msg->transactionId();
     if (m_engine) {
 	ackRequest(m_engine->ackRequest());
 	m_engine->appendTrans(this);
@@ -56,7 +62,6 @@ MGCPTransaction::MGCPTransaction(MGCPEngine* engine, MGCPMessage* msg, bool outg
 	return;
     }
 
-    m_id = msg->transactionId();
     m_endpoint = m_cmd->endpointId();
     m_debug << "Transaction(" << (int)outgoing << "," << m_id << ")";
 
@@ -151,7 +156,18 @@ MGCPEvent* MGCPTransaction::getEvent(u_int64_t time)
     }
 #endif
 
-    return m_lastEvent;
+    // Nothing to report: wait in the engine queue for the next timeout
+    // The pending event will queue the transaction again when terminated
+    MGCPEvent* event = m_lastEvent;
+    if (!event && m_engine) {
+	u_int64_t next = m_nextRetrans;
+	if (next && next <= time)
+	    next = time + 1;
+	// The receiver locks the engine before the transaction
+	lock.drop();
+	m_engine->scheduleTrans(this,next);
+    }
+    return event;
 }
 
 // Explicitely transmit a provisional code
@@ -189,6 +205,10 @@ bool MGCPTransaction::setResponse(MGCPMessage* msg)
     if (!m_ackRequest)
 	changeState(Ack);
     initTimeout(Time(),false);
+    u_int64_t next = m_nextRetrans;
+    lock.drop();
+    if (m_engine)
+	m_engine->scheduleTrans(this,next);
     return true;
 }
 
@@ -324,6 +344,8 @@ void MGCPTransaction::processMessage(MGCPMessage* msg)
 
 	if (!ok)
 	    TelEngine::destruct(msg);
+	else if (m_engine)
+	    m_engine->scheduleTrans(this,Time::now());
 	return;
     }
 
@@ -340,6 +362,8 @@ void MGCPTransaction::processMessage(MGCPMessage* msg)
 	// Keep the ACK if not already received one
 	if (state() == Responded && !m_ack) {
 	    m_ack = msg;
+	    if (m_engine)
+		m_engine->scheduleTrans(this,Time::now());
 	    return;
 	}
 
@@ -405,6 +429,16 @@ void MGCPTransaction::eventTerminated(MGCPEvent* event)
 	return;
     DDebug(m_engine,DebugAll,"%s. Event (%p) terminated [%p]",m_debug.c_str(),event,this);
     m_lastEvent = 0;
+    if (m_engine)
+	m_engine->scheduleTrans(this,Time::now());
+}
+
+// Allow the engine to process this transaction from now on
+void MGCPTransaction::setEngineProcess()
+{
+    m_engineProcess = true;
+    if (m_engine)
+	m_engine->scheduleTrans(this,Time::now());
 }
 
 // Change transaction's state if the new state is a valid one
@@ -362,8 +362,7 @@ public:
      * Set the engine process flag. Allow the engine to process this transaction
      * (call getEvent() from engine process thread)
      */
-    inline void setEngineProcess()
-	{ m_engineProcess = true; }
+    void setEngineProcess();
 
     /**
      * Get an event from this transaction. Check timeouts
@@ -483,6 +482,8 @@ private:
     void* m_private;                     // Data used by this transaction's user
     String m_debug;                      // String used to identify the transaction in debug messages
     bool m_engineProcess;                // Process transaction (getEvent) from engine processor
+    u_int64_t m_timerTime;               // Time of the pending check in the engine timer queue
+    unsigned int m_timerPos;             // Position in the engine timer queue plus one, 0 if not queued
 };
 
 /**
@@ -713,7 +714,7 @@ public:
      * Clear the list or remote endpoints
      */
     inline void clear()
-	{ lock(); m_remote.clear(); unlock(); }
+	{ lock(); m_remoteIndex.clear(); m_remote.clear(); unlock(); }
 
     /**
      * Find the info object associated with a remote peer
@@ -738,6 +739,7 @@ public:
 private:
     MGCPEngine* m_engine;                // The engine owning this endpoint
     ObjList m_remote;                    // The remote endpoints
+    HashList m_remoteIndex;              // The remote endpoints indexed by id, not owned
 };
 
 /**
@@ -1120,16 +1122,20 @@ protected:
     ObjList m_endpoints;
 
     /**
-     * The transaction list
+     * The transactions, hashed by their id and direction
      */
-    ObjList m_transactions;
-
-    /**
-     * The transaction list iterator used to get events
-     */
-    ListIterator m_iterator;
+    HashList m_transactions;
 
 private:
+    // Hash value of a transaction id in the transactions table
+    static inline unsigned int transHash(unsigned int id, bool outgoing)
+	{ return (id << 1) | (outgoing ? 1 : 0); }
+    // Schedule an engine processed transaction to be checked no later than a given time
+    // A time of 0 removes the transaction from the timer queue
+    void scheduleTrans(MGCPTransaction* trans, u_int64_t when);
+    // Move a timer queue entry towards the head or the tail to restore the heap order
+    void timerUp(unsigned int pos);
+    void timerDown(unsigned int pos);
     // Append a private thread to the list
     void appendThread(MGCPPrivateThread* thread);
     // Remove private thread from the list without deleting it
@@ -1154,6 +1160,10 @@ private:
     bool m_ackRequest;                   // Remote is requested to send ACK
     ObjList m_knownCommands;             // The list of known commands
     ObjList m_threads;
+    HashList m_epIndex;                  // Endpoints indexed by id, not owned
+    MGCPTransaction** m_timers;          // Heap of transactions ordered by their check time
+    unsigned int m_timersCount;          // Number of transactions in the timer queue
+    unsigned int m_timersSize;           // Allocated length of the timer queue
 };
 
 }
@@ -37,7 +37,8 @@ class JsContext : public JsObject, public ScriptMutex
 public:
     inline JsContext(unsigned int instIdx = 0, unsigned int maxInst = 1)
 	: JsObject("Context",0), ScriptMutex(true,"JsContext"),
-	  m_trackObjs(0), m_trackObjsMtx(false,"JsObjTrack")
+	  m_trackObjs(0), m_trackObjsMtx(false,"JsObjTrack"),
+	  m_snapshot(0), m_snapInit(0), m_isSnapshot(false)
 	{
 	    setMutex(this);
 	    params().addParam(new ExpFunction("isNaN"));
@@ -62,10 +63,35 @@ public:
     void deletedObj(GenObject* obj);
     void trackObjs(unsigned int track = 0);
     ObjList* countAllocations();
+    void makeSnapshot(ScriptCode* code, JsParser::ContextInit init);
+    bool cloneFrom(JsContext* snapshot);
+    inline bool isSnapshot() const
+	{ return m_isSnapshot; }
 private:
     GenObject* resolveTop(ObjList& stack, const String& name, GenObject* context);
+    void unshare(const String& name);
     HashList* m_trackObjs;
     Mutex m_trackObjsMtx;
+    JsContext* m_snapshot;
+    RefPointer<ScriptCode> m_snapCode;
+    JsParser::ContextInit m_snapInit;
+    bool m_isSnapshot;
+};
+
+// Wrapper of a global object that is still shared with a snapshot context
+class ExpShared : public ExpWrapper
+{
+    YCLASS(ExpShared,ExpWrapper)
+public:
+    inline ExpShared(JsObject* obj, const NamedString& original)
+	: ExpWrapper(obj,original.name())
+	{
+	    obj->ref();
+	    static_cast<String&>(*this) = original;
+	    const ExpOperation* op = YOBJECT(ExpOperation,&original);
+	    if (op)
+		lineNumber(op->lineNumber());
+	}
 };
 
 class JsNull : public JsObject
@@ -595,6 +621,8 @@ static const NativeFields s_nativeFields;
 void JsContext::destroyed()
 {
     params().clearParams();
+    TelEngine::destruct(m_snapshot);
+    m_snapCode = 0;
     TelEngine::destruct(m_trackObjs);
     setMutex(0);
     JsObject::destroyed();
@@ -973,6 +1001,15 @@ bool JsContext::runAssign(ObjList& stack, const ExpOperation& oper, GenObject* c
     XDebug(DebugAll,"JsContext::runAssign '%s'='%s' (%s) [%p]",
 	oper.name().c_str(),oper.c_str(),oper.typeOf(),this);
     String name = oper.name();
+    if (m_snapshot) {
+	// Assigning into a shared global needs a private copy of it first
+	int dot = name.find('.');
+	if (dot > 0) {
+	    String top = name.substr(0,dot);
+	    if (resolveTop(stack,top,context) == this)
+		unshare(top);
+	}
+    }
     GenObject* o = resolve(stack,name,context);
     if (o && o != this) {
 	ExpExtender* ext = YOBJECT(ExpExtender,o);
@@ -986,6 +1023,65 @@ bool JsContext::runAssign(ObjList& stack, const ExpOperation& oper, GenObject* c
     return JsObject::runAssign(stack,oper,context);
 }
 
+void JsContext::makeSnapshot(ScriptCode* code, JsParser::ContextInit init)
+{
+    Lock mylock(this);
+    ObjList seen;
+    seen.append(static_cast<JsObject*>(this))->setDelete(false);
+    for (ObjList* l = params().paramList()->skipNull(); l; l = l->skipNext())
+	JsObject::freezeShared(YOBJECT(JsObject,l->get()),seen);
+    m_snapCode = code;
+    m_snapInit = init;
+    m_isSnapshot = true;
+    DDebug(DebugInfo,"JsContext made snapshot of %u objects [%p]",seen.count() - 1,this);
+}
+
+bool JsContext::cloneFrom(JsContext* snapshot)
+{
+    if (!(snapshot && snapshot->isSnapshot() && snapshot->ref()))
+	return false;
+    Lock mylock(this);
+    // Snapshot globals are never changed so they can be read without locking
+    m_snapshot = snapshot;
+    params().clearParams();
+    static_cast<String&>(params()) = snapshot->params();
+    for (ObjList* l = snapshot->params().paramList()->skipNull(); l; l = l->skipNext()) {
+	const NamedString* ns = static_cast<const NamedString*>(l->get());
+	JsObject* jso = YOBJECT(JsObject,ns);
+	if (jso)
+	    params().addParam(new ExpShared(jso,*ns));
+	else {
+	    const ExpOperation* op = YOBJECT(ExpOperation,ns);
+	    if (op)
+		params().addParam(op->clone());
+	    else
+		params().addParam(ns->name(),*ns);
+	}
+    }
+    return true;
+}
+
+// Replace a shared global by a private instance
+void JsContext::unshare(const String& name)
+{
+    NamedString* ns = params().getParam(name);
+    if (!(ns && YOBJECT(ExpShared,ns)))
+	return;
+    XDebug(DebugAll,"JsContext::unshare '%s' [%p]",name.c_str(),this);
+    ExpOperation* orig = static_cast<ExpOperation*>(params().paramList()->remove(ns,false));
+    if (m_snapshot->m_snapInit)
+	m_snapshot->m_snapInit(this);
+    if (m_snapshot->m_snapCode)
+	m_snapshot->m_snapCode->initialize(this);
+    if (params().getParam(name)) {
+	TelEngine::destruct(orig);
+	return;
+    }
+    // Nobody knows how to build it, keep the read-only shared instance
+    Debug(DebugMild,"Could not build private instance of shared '%s' [%p]",name.c_str(),this);
+    params().addParam(orig);
+}
+
 void JsContext::createdObj(GenObject* obj)
 {
     if (!m_trackObjs)
@@ -2251,7 +2347,7 @@ JsObject* JsCode::parseObject(ParsePoint& expr, bool constOnly, ScriptMutex* mtx
 	}
 	if (op->opcode() == OpcField)
 	    op->assign(op->name());
-	const_cast<String&>(op->name()) = name;
+	op->rename(name);
 	jso->params().setParam(op);
     }
     return jso;
@@ -3859,6 +3955,28 @@ ScriptContext* JsParser::createContext(unsigned int instIdx, unsigned int maxIns
     return new JsContext(instIdx,maxInst);
 }
 
+// Create Javascript context sharing the globals of a snapshot
+ScriptContext* JsParser::cloneContext(ScriptContext* snapshot, unsigned int instIdx, unsigned int maxInst) const
+{
+    JsContext* snap = YOBJECT(JsContext,snapshot);
+    if (!snap)
+	return 0;
+    JsContext* ctx = new JsContext(instIdx,maxInst);
+    if (!ctx->cloneFrom(snap))
+	TelEngine::destruct(ctx);
+    return ctx;
+}
+
+// Make a context suitable as snapshot for other contexts
+bool JsParser::snapshotContext(ScriptContext* context, ScriptCode* code, ContextInit init)
+{
+    JsContext* ctx = YOBJECT(JsContext,context);
+    if (!ctx || ctx->isSnapshot())
+	return false;
+    ctx->makeSnapshot(code,init);
+    return true;
+}
+
 ScriptRun* JsParser::createRunner(ScriptCode* code, ScriptContext* context, const char* title, 
                             unsigned int instIdx, unsigned int maxInst) const
 {
@@ -1296,6 +1296,17 @@ void JsObject::deepCopyParams(NamedList& dst, const NamedList& src, ScriptMutex*
     }
 }
 
+void JsObject::freezeShared(JsObject* obj, ObjList& seen)
+{
+    if (!obj || seen.find(obj))
+	return;
+    seen.append(obj)->setDelete(false);
+    obj->freeze();
+    obj->setMutex(0);
+    for (ObjList* l = obj->params().paramList()->skipNull(); l; l = l->skipNext())
+	freezeShared(YOBJECT(JsObject,l->get()),seen);
+}
+
 // Initialize standard globals in the execution context
 void JsObject::initialize(ScriptContext* context)
 {
@@ -1948,7 +1959,7 @@ void JsArray::push(ExpOperation* item)
     unsigned int pos = m_length;
     while (params().getParam(String(pos)))
 	pos++;
-    const_cast<String&>(item->name()) = pos;
+    item->rename(String(pos));
     params().addParam(item);
     setLength(pos + 1);
 }
@@ -2004,7 +2015,7 @@ JsObject* JsArray::runConstructor(ObjList& stack, const ExpOperation& oper, GenO
 	    TelEngine::destruct(op);
 	    break;
 	}
-	const_cast<String&>(op->name()) = i - 1;
+	op->rename(String(i - 1));
 	obj->params().paramList()->insert(op);
     }
     obj->setLength(len);
@@ -2028,7 +2039,7 @@ bool JsArray::runNative(ObjList& stack, const ExpOperation& oper, GenObject* con
 	if (!extractArgs(this,stack,oper,context,args))
 	    return false;
 	while (ExpOperation* op = static_cast<ExpOperation*>(args.remove(false))) {
-	    const_cast<String&>(op->name()) = (unsigned int)m_length++;
+	    op->rename(String((unsigned int)m_length++));
 	    params().addParam(op);
 	}
 	ExpEvaluator::pushOne(stack,new ExpOperation((int64_t)length()));
@@ -2089,7 +2100,7 @@ bool JsArray::runNative(ObjList& stack, const ExpOperation& oper, GenObject* con
 		    if (ns) {
 			ExpOperation* arg = YOBJECT(ExpOperation,ns);
 			arg = arg ? arg->clone() : new ExpOperation(*ns,0,true);
-			const_cast<String&>(arg->name()) = (unsigned int)array->m_length++;
+			arg->rename(String((unsigned int)array->m_length++));
 			array->params().addParam(arg);
 		    }
 		    else
@@ -2098,7 +2109,7 @@ bool JsArray::runNative(ObjList& stack, const ExpOperation& oper, GenObject* con
 		TelEngine::destruct(op);
 	    }
 	    else {
-		const_cast<String&>(op->name()) = (unsigned int)array->m_length++;
+		op->rename(String((unsigned int)array->m_length++));
 		array->params().addParam(op);
 	    }
 	}
@@ -2135,9 +2146,9 @@ bool JsArray::runNative(ObjList& stack, const ExpOperation& oper, GenObject* con
 	    NamedString* n1 = params().getParam(s1);
 	    NamedString* n2 = params().getParam(s2);
 	    if (n1)
-		const_cast<String&>(n1->name()) = s2;
+		n1->rename(s2);
 	    if (n2)
-		const_cast<String&>(n2->name()) = s1;
+		n2->rename(s1);
 	}
 	ref();
 	ExpEvaluator::pushOne(stack,new ExpWrapper(this));
@@ -2173,7 +2184,7 @@ bool JsArray::runNative(ObjList& stack, const ExpOperation& oper, GenObject* con
 		    setLength(i);
 		    break;
 		}
-		const_cast<String&>(ns->name()) = i;
+		ns->rename(String(i));
 	    }
 	}
 	else
@@ -2198,14 +2209,14 @@ bool JsArray::runNative(ObjList& stack, const ExpOperation& oper, GenObject* con
 		if (ns) {
 		    String index(i);
 		    params().clearParam(index);
-		    const_cast<String&>(ns->name()) = index;
+		    ns->rename(index);
 		}
 	    }
 	    for (int32_t i = shift - 1; i >= 0; i--) {
 		ExpOperation* op = popValue(stack,context);
 		if (!op)
 		    continue;
-	        const_cast<String&>(op->name()) = i;
+	        op->rename(String(i));
 		params().paramList()->insert(op);
 	    }
 	    setLength(length() + shift);
@@ -2367,7 +2378,7 @@ bool JsArray::runNativeSlice(ObjList& stack, const ExpOperation& oper, GenObject
 	}
 	ExpOperation* arg = YOBJECT(ExpOperation,ns);
 	arg = arg ? arg->clone() : new ExpOperation(*ns,0,true);
-	const_cast<String&>(arg->name()) = (unsigned int)array->m_length++;
+	arg->rename(String((unsigned int)array->m_length++));
 	array->params().addParam(arg);
     }
     ExpEvaluator::pushOne(stack,new ExpWrapper(array));
@@ -2421,7 +2432,7 @@ bool JsArray::runNativeSplice(ObjList& stack, const ExpOperation& oper, GenObjec
 	    op = new ExpOperation(*ns,0,true);
 	    TelEngine::destruct(ns);
 	}
-	const_cast<String&>(op->name()) = (unsigned int)removed->m_length++;
+	op->rename(String((unsigned int)removed->m_length++));
 	removed->params().addParam(op);
     }
 
@@ -2432,21 +2443,21 @@ bool JsArray::runNativeSplice(ObjList& stack, const ExpOperation& oper, GenObjec
 	for (int32_t i = m_length - 1; i >= begin + delCount; i--) {
 	    NamedString* ns = static_cast<NamedString*>((*params().paramList())[String(i)]);
 	    if (ns)
-		const_cast<String&>(ns->name()) = i + shiftIdx;
+		ns->rename(String(i + shiftIdx));
 	}
     }
     else if (shiftIdx < 0) {
 	for (int32_t i = begin + delCount; i < m_length; i++) {
 	    NamedString* ns = static_cast<NamedString*>((*params().paramList())[String(i)]);
 	    if (ns)
-		const_cast<String&>(ns->name()) = i + shiftIdx;
+		ns->rename(String(i + shiftIdx));
 	}
     }
     setLength(length() + shiftIdx);
     // insert the new elements
     for (int i = 0; i < argc; i++) {
 	ExpOperation* arg = static_cast<ExpOperation*>(args.remove(false));
-	const_cast<String&>(arg->name()) = (unsigned int)(begin + i);
+	arg->rename(String((unsigned int)(begin + i)));
 	params().addParam(arg);
     }
     ExpEvaluator::pushOne(stack,new ExpWrapper(removed));
@@ -2527,7 +2538,7 @@ bool JsArray::runNativeSort(ObjList& stack, const ExpOperation& oper, GenObject*
 	last = params().paramList()->last();
 	for (ObjList* o = sorted.skipNull();o; o = o->skipNull()) {
 	    ExpOperation* slice = static_cast<ExpOperation*>(o->remove(false));
-	    const_cast<String&>(slice->name()) = i++;
+	    slice->rename(String(i++));
 	    last = last->append(slice);
 	}
     }
@@ -2987,6 +2987,14 @@ public:
      */
     static void deepCopyParams(NamedList& dst, const NamedList& src, ScriptMutex* mtx);
 
+    /**
+     * Static helper method that makes an object and all objects it holds read-only
+     *  and detaches them from their mutex so they can be shared between contexts
+     * @param obj Object to process
+     * @param seen List of objects already processed, used to stop recursion
+     */
+    static void freezeShared(JsObject* obj, ObjList& seen);
+
     /**
      * Helper method to return the hierarchical structure of an object
      * @param obj Object to dump structure
@@ -3195,7 +3203,7 @@ public:
      * @param name Name to set as first assigned name
      */
     inline void firstName(const char* name)
-	{ if (m_func.name().null()) const_cast<String&>(m_func.name()) = name; }
+	{ if (m_func.name().null()) m_func.rename(name); }
 
     /**
      * Retrieve the name of the N-th formal argument
@@ -3681,6 +3689,12 @@ class YSCRIPT_API JsParser : public ScriptParser
 {
     YCLASS(JsParser,ScriptParser)
 public:
+    /**
+     * Callback used to rebuild in a context the globals shared from a snapshot
+     * @param context Context that lacks one or more globals
+     */
+    typedef void (*ContextInit)(ScriptContext* context);
+
     /**
      * Constructor
      * @param allowLink True to allow linking of the code, false otherwise.
@@ -3730,6 +3744,27 @@ public:
                             unsigned int instIdx = 0, unsigned int maxInst = 1) const
 	{ return createRunner(code(),context,title,instIdx,maxInst); }
 
+    /**
+     * Create a context sharing the global objects of a snapshot context.
+     * Shared globals are replaced by private instances on first assignment
+     * @param snapshot Context previously prepared by snapshotContext()
+     * @param instIdx Javascript context instance
+     * @param maxInst Number of context instances
+     * @return A new Javascript context, NULL if snapshot is not valid
+     */
+    ScriptContext* cloneContext(ScriptContext* snapshot, unsigned int instIdx = 0,
+	unsigned int maxInst = 1) const;
+
+    /**
+     * Turn an initialized context into a snapshot for cloneContext().
+     * All global objects of the context are made read-only and lose their mutex
+     * @param context Javascript context created by createContext()
+     * @param code Code whose globals are rebuilt when unsharing
+     * @param init Callback that rebuilds the other shared globals
+     * @return True on success, false if the context is not a Javascript one
+     */
+    static bool snapshotContext(ScriptContext* context, ScriptCode* code, ContextInit init);
+
     /**
      * Check if a script has a certain function or method
      * @param name Name of the function to check
@@ -32,6 +32,8 @@
 #define MIN_TICK_SLEEP 500
 #define DEF_TICK_SLEEP 5000
 #define MAX_TICK_SLEEP 50000
+// Longest sleep when all components have scheduled ticks
+#define MAX_IDLE_SLEEP 1000000
 
 namespace TelEngine {
 
@@ -143,7 +145,7 @@ void* SignallingFactory::buildInternal(const String& type, NamedList* name)
 
 
 SignallingComponent::SignallingComponent(const char* name, const NamedList* params, const char* type)
-    : m_engine(0), m_compType(type)
+    : m_engine(0), m_compType(type), m_tickTime(0), m_tickPolled(true)
 {
     if (params) {
 	name = params->getValue(YSTRING("debugname"),name);
@@ -274,6 +276,29 @@ unsigned long SignallingComponent::tickSleep(unsigned long usec) const
     return m_engine ? m_engine->tickSleep(usec) : 0;
 }
 
+void SignallingComponent::scheduleTicks()
+{
+    if (!m_tickPolled)
+	return;
+    m_tickPolled = false;
+    // tick once when inserted in an engine to learn the first deadline
+    tickNow();
+}
+
+void SignallingComponent::tickAt(u_int64_t usec)
+{
+    SignallingEngine* eng = m_engine;
+    if (eng)
+	eng->tickAt(this,usec);
+    else if (usec && !m_tickPolled && (!m_tickTime || (usec < m_tickTime)))
+	m_tickTime = usec;
+}
+
+u_int64_t SignallingComponent::nextTick(const Time& when)
+{
+    return 0;
+}
+
 void SignallingNotifier::notify(NamedList& notifs)
 {
     DDebug(DebugInfo,"SignallingNotifier::notify() [%p] stub",this);
@@ -291,7 +316,9 @@ long SignallingEngine::s_maxLockWait = MAX_LOCK_WAIT;
 SignallingEngine::SignallingEngine(const char* name)
     : Mutex(true,"SignallingEngine"),
       m_thread(0),
-      m_usecSleep(DEF_TICK_SLEEP), m_tickSleep(0)
+      m_usecSleep(DEF_TICK_SLEEP), m_tickSleep(0),
+      m_tickMutex(false,"SignallingTicks"),
+      m_tickWake(1,"SignallingTicks",0), m_tickNext(0)
 {
     debugName(name);
 }
@@ -396,6 +423,11 @@ void SignallingEngine::insert(SignallingComponent* component)
     component->m_engine = this;
     component->debugChain(this);
     m_components.append(component);
+    // make sure the worker gets to a new component quickly
+    if (component->m_tickPolled)
+	m_tickWake.unlock();
+    else
+	tickAt(component,Time::now());
 }
 
 void SignallingEngine::remove(SignallingComponent* component)
@@ -479,6 +511,7 @@ void SignallingEngine::stop()
     if (!m_thread)
 	return;
     m_thread->cancel(false);
+    m_tickWake.unlock();
     while (m_thread)
 	Thread::yield(true);
     Debug(this,DebugAll,"Engine stopped worker thread [%p]",this);
@@ -506,19 +539,86 @@ unsigned long SignallingEngine::tickSleep(unsigned long usec)
     return m_tickSleep;
 }
 
+// Set the deadline of a scheduled component, keep the earliest one
+void SignallingEngine::tickAt(SignallingComponent* component, u_int64_t usec)
+{
+    if (!usec)
+	return;
+    Lock mylock(m_tickMutex);
+    if (component->m_tickPolled)
+	return;
+    if (component->m_tickTime && (component->m_tickTime <= usec))
+	return;
+    component->m_tickTime = usec;
+    // wake up the worker only if it would sleep past the new deadline
+    if (!m_tickNext || (usec >= m_tickNext))
+	return;
+    m_tickNext = usec;
+    mylock.drop();
+    m_tickWake.unlock();
+}
+
 unsigned long SignallingEngine::timerTick(const Time& when)
 {
-    RefPointer<SignallingComponent> c;
     lock();
     m_tickSleep = m_usecSleep;
-    ListIterator iter(m_components);
-    while ((c = static_cast<SignallingComponent*>(iter.get()))) {
-	unlock();
+    // collect polled components and the scheduled ones that are due
+    ObjList due;
+    ObjList* tail = &due;
+    m_tickMutex.lock();
+    // all deadlines are checked below, no need to be woken up
+    m_tickNext = 0;
+    for (ObjList* l = m_components.skipNull(); l; l = l->skipNext()) {
+	SignallingComponent* c = static_cast<SignallingComponent*>(l->get());
+	if (!c->m_tickPolled) {
+	    if (!c->m_tickTime || (c->m_tickTime > when))
+		continue;
+	    // requests made while ticking will set a new deadline
+	    c->m_tickTime = 0;
+	}
+	if (c->ref())
+	    tail = tail->append(c);
+    }
+    m_tickMutex.unlock();
+    unlock();
+    for (ObjList* o = due.skipNull(); o; o = o->skipNext()) {
+	SignallingComponent* c = static_cast<SignallingComponent*>(o->get());
+	// skip components removed while we ticked others
+	if (c->engine() != this)
+	    continue;
 	c->timerTick(when);
-	c = 0;
-	lock();
+	if (c->m_tickPolled)
+	    continue;
+	u_int64_t next = c->nextTick(when);
+	// expired timers that were not handled are polled like before
+	if (next && (next <= when))
+	    next = when + m_usecSleep;
+	tickAt(c,next);
+    }
+    due.clear();
+    lock();
+    // sleep until the earliest deadline if no component needs polling
+    bool polled = false;
+    u_int64_t next = 0;
+    m_tickMutex.lock();
+    for (ObjList* l = m_components.skipNull(); l; l = l->skipNext()) {
+	SignallingComponent* comp = static_cast<SignallingComponent*>(l->get());
+	if (comp->m_tickPolled)
+	    polled = true;
+	else if (comp->m_tickTime && (!next || (comp->m_tickTime < next)))
+	    next = comp->m_tickTime;
+    }
+    unsigned long rval = polled ? m_tickSleep : MAX_IDLE_SLEEP;
+    u_int64_t now = Time::now();
+    if (next) {
+	// deadlines closer than the tick interval are coalesced
+	if (next < now + m_tickSleep)
+	    next = now + m_tickSleep;
+	if (next - now < rval)
+	    rval = (unsigned long)(next - now);
     }
-    unsigned long rval = m_tickSleep;
+    m_tickNext = now + rval;
+    m_tickMutex.unlock();
     m_tickSleep = m_usecSleep;
     unlock();
     return rval;
@@ -546,7 +646,9 @@ void SignallingThreadPrivate::run()
 	    Time t;
 	    unsigned long sleepTime = m_engine->timerTick(t);
 	    if (sleepTime) {
-		usleep(sleepTime,true);
+		// components with scheduled ticks may wake us up earlier
+		m_engine->m_tickWake.lock(sleepTime);
+		check();
 		continue;
 	    }
 	}
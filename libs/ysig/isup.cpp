@@ -48,6 +48,9 @@ using namespace TelEngine;
 #define ISUP_T34_DEFVAL 3000
 #define ISUP_T34_MAXVAL 4000
 
+// Number of lists in the circuit code call index
+#define ISUP_CALL_INDEX_SIZE 1024
+
 // Utility: check if 2 cic codes are in valid range, return range if valid, 0 otherwise
 static inline int checkValidRange(int code, int extra)
 {
@@ -2256,6 +2259,7 @@ SS7ISUPCall::SS7ISUPCall(SS7ISUP* controller, SignallingCircuit* cic,
     m_gracefully(true),
     m_circuitChanged(false),
     m_circuitTesting(false),
+    m_indexCic(0),
     m_inbandAvailable(false),
     m_replaceCounter(3),
     m_iamMsg(0),
@@ -2296,6 +2300,8 @@ SS7ISUPCall::SS7ISUPCall(SS7ISUP* controller, SignallingCircuit* cic,
 
 SS7ISUPCall::~SS7ISUPCall()
 {
+    if (isup())
+	isup()->unindexCall(this);
     TelEngine::destruct(m_iamMsg);
     TelEngine::destruct(m_sgmMsg);
     const char* timeout = 0;
@@ -2731,6 +2737,8 @@ bool SS7ISUPCall::replaceCircuit(SignallingCircuit* circuit, SS7MsgISUP* msg)
     if (controller())
 	controller()->releaseCircuit(m_circuit);
     m_circuit = circuit;
+    if (isup())
+	isup()->indexCall(this);
     Debug(isup(),DebugNote,"Call(%u). Circuit replaced by %u [%p]",oldId,id(),this);
     m_circuitChanged = true;
     return transmitIAM();
@@ -3350,6 +3358,7 @@ SS7ISUP::SS7ISUP(const NamedList& params, unsigned char sio)
       m_t21Interval(300000),             // Q.764 T21 (CGU global) 5..15 minutes
       m_t27Interval(ISUP_T27_DEFVAL),    // Q.764 T27 4 minutes
       m_t34Interval(ISUP_T34_DEFVAL),    // Q.764 T34 2..4 seconds
+      m_callIndex(ISUP_CALL_INDEX_SIZE),
       m_uptTimer(0),
       m_userPartAvail(true),
       m_uptMessage(SS7MsgISUP::UPT),
@@ -3435,6 +3444,7 @@ SS7ISUP::SS7ISUP(const NamedList& params, unsigned char sio)
     m_t9Interval = SignallingTimer::getInterval(params,"t9",ISUP_T9_MINVAL,ISUP_T9_DEFVAL,ISUP_T9_MAXVAL,true);
     m_t27Interval = SignallingTimer::getInterval(params,"t27",ISUP_T27_MINVAL,ISUP_T27_DEFVAL,ISUP_T27_MAXVAL,false);
     m_t34Interval = SignallingTimer::getInterval(params,"t34",ISUP_T34_MINVAL,ISUP_T34_DEFVAL,ISUP_T34_MAXVAL,false);
+    scheduleTicks();
 
     m_continuity = params.getValue(YSTRING("continuity"));
     m_confirmCCR = params.getBoolValue(YSTRING("confirm_ccr"),true);
@@ -3572,6 +3582,7 @@ void SS7ISUP::attach(SS7Layer3* network)
 {
     SS7Layer4::attach(network);
     m_l3LinkUp = network && network->operational();
+    tickNow();
 }
 
 // Append a point code to the list of point codes serviced by this controller
@@ -3736,10 +3747,13 @@ SignallingCall* SS7ISUP::call(SignallingMessage* msg, String& reason)
 	call = new SS7ISUPCall(this,cic,*m_defPoint,dest,true,sls,range);
 	call->ref();
 	m_calls.append(call);
+	indexCall(call);
 	SignallingEvent* event = new SignallingEvent(SignallingEvent::NewCall,msg,call);
 	// (re)start RSC timer if not currently reseting
-	if (!m_rscCic && m_rscTimer.interval())
+	if (!m_rscCic && m_rscTimer.interval()) {
 	    m_rscTimer.start();
+	    tickNow();
+	}
 	// Drop lock and send the event
 	mylock.drop();
 	if (!event->sendEvent()) {
@@ -3829,7 +3843,10 @@ void SS7ISUP::cleanup(const char* reason)
     m_rscTimer.stop();
     unlock();
     setCallsTerminate(terminate,true,reason);
+    lock();
     clearCalls();
+    m_callIndex.clear();
+    unlock();
 }
 
 // Remove all links with other layers. Disposes the memory
@@ -3837,6 +3854,7 @@ void SS7ISUP::destroyed()
 {
     lock();
     clearCalls();
+    m_callIndex.clear();
     unlock();
     SignallingCallControl::attach(0);
     SS7Layer4::destroyed();
@@ -4078,6 +4096,41 @@ void SS7ISUP::timerTick(const Time& when)
     }
 }
 
+u_int64_t SS7ISUP::nextTick(const Time& when)
+{
+    Lock mylock(this,SignallingEngine::maxLockWait());
+    if (!mylock.locked())
+	return when;
+    // network notifications tick us when it comes up
+    if (!m_l3LinkUp)
+	return 0;
+    // circuits are attached without notifying us
+    if (!circuits())
+	return when;
+    u_int64_t next = 0;
+    // all other operations wait for the remote user part test
+    if (m_remotePoint && !m_userPartAvail && m_uptTimer.interval()) {
+	if (!m_uptTimer.started())
+	    return when;
+	m_uptTimer.earliest(next);
+	return next;
+    }
+    m_lockTimer.earliest(next);
+    // the list is sorted by retransmission time, only the first one is checked
+    ObjList* o = m_pending.skipNull();
+    if (o) {
+	SignallingMessageTimer* m = static_cast<SignallingMessageTimer*>(o->get());
+	m->earliest(next);
+	m->global().earliest(next);
+    }
+    if (m_rscTimer.interval()) {
+	if (!m_rscTimer.started())
+	    return when;
+	m_rscTimer.earliest(next);
+    }
+    return next;
+}
+
 // Process a component control request
 bool SS7ISUP::control(NamedList& params)
 {
@@ -4163,6 +4216,7 @@ bool SS7ISUP::control(NamedList& params)
 		m_rscSpeedup,(unsigned int)m_rscTimer.interval());
 	    if (m_rscTimer.started())
 		m_rscTimer.start(Time::msecNow());
+	    tickNow();
 	    return TelEngine::controlReturn(&params,true);
 	case SS7MsgISUP::BLK:
 	case SS7MsgISUP::UBL:
@@ -4196,6 +4250,7 @@ bool SS7ISUP::control(NamedList& params)
 		m_uptTimer.stop();
 		m_userPartAvail = true;
 		m_lockTimer.start();
+		tickNow();
 		if (statusName() != oldStat) {
 		    NamedList params("");
 		    params.addParam("from",toString());
@@ -4238,6 +4293,8 @@ void SS7ISUP::notify(SS7Layer3* link, int sls)
 	m_uptTimer.stop();
 	m_userPartAvail = false;
     }
+    if (m_l3LinkUp)
+	tickNow();
     Debug(this,DebugInfo,
 	"L3 '%s' sls=%d is %soperational.%s Route is %s. Remote User Part is %savailable",
 	link->toString().safe(),sls,
@@ -4824,6 +4881,7 @@ bool SS7ISUP::processMSU(SS7MsgISUP::Type type, unsigned int cic,
 	const char* oldStat = statusName();
 	m_userPartAvail = true;
 	m_lockTimer.start();
+	tickNow();
 	Debug(this,DebugInfo,"Remote user part is available");
 	if (statusName() != oldStat) {
 	    NamedList params("");
@@ -4906,6 +4964,7 @@ void SS7ISUP::receivedUPU(SS7PointCode::Type type, const SS7PointCode node,
     Debug(this,DebugNote,"Remote User Part is unavailable (received UPU)");
     m_userPartAvail = false;
     m_uptTimer.start();
+    tickNow();
     if (statusName() != oldStat) {
 	NamedList params("");
 	params.addParam("from",toString());
@@ -4934,8 +4993,10 @@ SignallingEvent* SS7ISUP::processCircuitEvent(SignallingCircuitEvent*& event,
 		// Avoid notifying the same state
 		if (block != blocked) {
 		    event->circuit()->hwLock(block,false,true,true);
-		    if (!m_lockTimer.started())
+		    if (!m_lockTimer.started()) {
 			m_lockTimer.start();
+			tickNow();
+		    }
 		    if (block)
 			cicHwBlocked(event->circuit()->code(),String("1"));
 		}
@@ -4992,6 +5053,7 @@ bool SS7ISUP::startCircuitReset(SignallingCircuit*& cic, const String& timer)
 	    m = new SignallingMessageTimer(m_t16Interval,m_t17Interval);
 	m = m_pending.add(m);
 	if (m) {
+	    tickNow();
 	    cic->setLock(SignallingCircuit::Resetting);
 	    SS7MsgISUP* msg = new SS7MsgISUP(SS7MsgISUP::RSC,cic->code());
 	    msg->params().addParam("isup_pending_reason",timer,false);
@@ -5097,6 +5159,7 @@ void SS7ISUP::processCallMsg(SS7MsgISUP* msg, const SS7Label& label, int sls)
 	    call = new SS7ISUPCall(this,circuit,label.dpc(),label.opc(),false,label.sls(),
 		0,msg->type() == SS7MsgISUP::CCR);
 	    m_calls.append(call);
+	    indexCall(call);
 	    break;
 	}
 	// Congestion: send REL
@@ -5608,9 +5671,12 @@ bool SS7ISUP::blockCircuit(unsigned int cic, bool block, bool remote, bool hwFai
     return true;
 }
 
+// Calls stay in the list of the circuit they were indexed by until moved or removed
+// Check the circuit code as it may have been released meanwhile
 SS7ISUPCall* SS7ISUP::findCall(unsigned int cic)
 {
-    for (ObjList* o = m_calls.skipNull(); o; o = o->skipNext()) {
+    ObjList* l = m_callIndex.getHashList(cic);
+    for (ObjList* o = l ? l->skipNull() : 0; o; o = o->skipNext()) {
 	SS7ISUPCall* call = static_cast<SS7ISUPCall*>(o->get());
 	if (call->id() == cic)
 	    return call;
@@ -5618,6 +5684,24 @@ SS7ISUPCall* SS7ISUP::findCall(unsigned int cic)
     return 0;
 }
 
+void SS7ISUP::indexCall(SS7ISUPCall* call)
+{
+    if (!call)
+	return;
+    Lock mylock(this);
+    m_callIndex.remove(call,call->m_indexCic,false);
+    call->m_indexCic = call->id();
+    m_callIndex.append(call,call->m_indexCic)->setDelete(false);
+}
+
+void SS7ISUP::unindexCall(SS7ISUPCall* call)
+{
+    if (!call)
+	return;
+    Lock mylock(this);
+    m_callIndex.remove(call,call->m_indexCic,false);
+}
+
 // Utility used in sendLocalLock()
 // Check if a circuit has lock change flag set and can be locked (not busy)
 static inline bool canLock(SignallingCircuit* cic, bool hw)
@@ -5791,6 +5875,7 @@ bool SS7ISUP::sendLocalLock(const Time& when)
     else
 	m_lockTimer.stop();
     lock.drop();
+    tickNow();
     return transmitMessages(msgs);
 }
 
@@ -6021,6 +6106,7 @@ bool SS7ISUP::handleCicBlockCommand(const NamedList& p, bool block)
 	    t = new SignallingMessageTimer(m_t20Interval,m_t21Interval);
         t->message(msg);
 	m_pending.add(t);
+	tickNow();
 	msg->ref();
 	if (force)
 	    remove = block ? SS7MsgISUP::CGU : SS7MsgISUP::CGB;
@@ -6172,6 +6258,7 @@ SS7MsgISUP* SS7ISUP::buildCicBlock(SignallingCircuit* cic, bool block, bool forc
         t = new SignallingMessageTimer(m_t14Interval,m_t15Interval);
     t->message(m);
     m_pending.add(t);
+    tickNow();
     m->ref();
     return m;
 }
@@ -6228,6 +6315,7 @@ void SS7ISUP::replaceCircuit(unsigned int cic, const String& map, bool rel)
 		t = new SignallingMessageTimer(m_t16Interval,m_t17Interval);
 	    t->message(m);
 	    m_pending.add(t);
+	    tickNow();
 	}
     }
 }
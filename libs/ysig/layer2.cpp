@@ -49,6 +49,13 @@ static const TokenDict s_dict_control[] = {
     { 0, 0 }
 };
 
+// Lower a deadline to a time if it's set
+static inline void lowerTime(u_int64_t& next, u_int64_t time)
+{
+    if (time && (!next || (time < next)))
+	next = time;
+}
+
 SS7MSU::SS7MSU(unsigned char sio, const SS7Label label, void* value, unsigned int len)
 {
     DataBlock::assign(0,1 + label.length() + len);
@@ -172,6 +179,11 @@ void SS7Layer2::timerTick(const Time& when)
     }
 }
 
+u_int64_t SS7Layer2::nextTick(const Time& when)
+{
+    return m_notify ? when.usec() : 0;
+}
+
 void SS7Layer2::notify()
 {
     unsigned int wasUp = 0;
@@ -188,6 +200,7 @@ void SS7Layer2::notify()
     m_l2userMutex.lock();
     m_notify = true;
     m_l2userMutex.unlock();
+    tickNow();
     if (doNotify && engine()) {
 	String text(statusName());
 	if (wasUp)
@@ -312,6 +325,7 @@ SS7MTP2::SS7MTP2(const NamedList& params, unsigned int status)
     else if (m_maxErrors > 256)
 	m_maxErrors = 256;
     setDumper(params.getValue(YSTRING("layer2dump")));
+    scheduleTicks();
 }
 
 SS7MTP2::~SS7MTP2()
@@ -332,6 +346,7 @@ void SS7MTP2::setLocalStatus(unsigned int status)
 	statusName(m_lStatus,true),statusName(status,true),this);
     m_lStatus = status;
     m_fillTime = 0;
+    tickNow();
 }
 
 void SS7MTP2::setRemoteStatus(unsigned int status)
@@ -574,6 +589,20 @@ void SS7MTP2::timerTick(const Time& when)
     }
 }
 
+u_int64_t SS7MTP2::nextTick(const Time& when)
+{
+    u_int64_t next = SS7Layer2::nextTick(when);
+    Lock mylock(this,SignallingEngine::maxLockWait());
+    // a pending fill in or a busy mutex is handled by polling
+    if (!(mylock.locked() && m_fillTime))
+	return when;
+    lowerTime(next,m_fillTime);
+    lowerTime(next,m_interval);
+    lowerTime(next,m_abort);
+    lowerTime(next,m_resend);
+    return next;
+}
+
 // Transmit a MSU retaining a copy for retransmissions
 bool SS7MTP2::transmitMSU(const SS7MSU& msu)
 {
@@ -622,6 +651,7 @@ bool SS7MTP2::transmitMSU(const SS7MSU& msu)
 	m_abort = Time::now() + (1000 * m_abortMs);
     if (!m_resend)
 	m_resend = Time::now() + (1000 * m_resendMs);
+    tickNow();
     return ok;
 }
 
@@ -734,6 +764,7 @@ bool SS7MTP2::receivedPacket(const DataBlock& packet)
 	m_fillTime = 0;
     }
     unlock();
+    tickNow();
 
     if (len < 3)
 	return true;
@@ -742,6 +773,7 @@ bool SS7MTP2::receivedPacket(const DataBlock& packet)
 	return false;
     m_lastSeqRx = m_bsn = fsn;
     m_fillTime = 0;
+    tickNow();
     DDebug(this,DebugInfo,"New local bsn=%u/%d fsn=%u/%d [%p]",
 	m_bsn,m_bib,m_fsn,m_fib,this);
     SS7MSU msu((void*)(buf+3),len,false);
@@ -815,8 +847,10 @@ bool SS7MTP2::txPacket(const DataBlock& packet, bool repeat, SignallingInterface
 // Process incoming FISU
 void SS7MTP2::processFISU()
 {
-    if (m_fillLink && !aligned())
+    if (m_fillLink && !aligned()) {
 	m_fillTime = 0;
+	tickNow();
+    }
 }
 
 // Process incoming LSSU
@@ -957,6 +991,7 @@ bool SS7MTP2::startProving()
     // FIXME: assuming 64 kbit/s, 125 usec/octet
     m_interval = Time::now() + (125 * interval);
     unlock();
+    tickNow();
     return true;
 }
 
@@ -22,8 +22,49 @@
 #include "yatesig.h"
 #include <yatephone.h>
 #include <stdlib.h>
+#include <string.h>
 
 
+namespace TelEngine {
+
+// Open addressing hash index of a route table. Entries remember the order
+//  in which routes were appended so list order semantics are preserved
+class SS7RouteIndex
+{
+public:
+    inline SS7RouteIndex()
+	: m_slots(0), m_mask(0), m_count(0), m_seq(0),
+	  m_adjacent(0), m_adjCount(0), m_adjAlloc(0)
+	{ }
+    inline ~SS7RouteIndex()
+	{ delete[] m_slots; delete[] m_adjacent; }
+    void build(const ObjList& routes);
+    void add(SS7Route* route);
+    void remove(const SS7Route* route);
+    SS7Route* find(unsigned int packed, unsigned int* pos = 0) const;
+    SS7Route::State adjacentState(unsigned int packed) const;
+private:
+    struct Slot {
+	SS7Route* route;
+	unsigned int pos;
+    };
+    static inline unsigned int hash(unsigned int packed)
+	{ packed *= 0x9e3779b1; return packed ^ (packed >> 16); }
+    void resize(unsigned int size);
+    void place(SS7Route* route, unsigned int pos);
+    void insert(SS7Route* route, unsigned int pos);
+    Slot* m_slots;
+    unsigned int m_mask;
+    unsigned int m_count;
+    unsigned int m_seq;
+    // Adjacent (zero priority) routes sorted in table order
+    Slot* m_adjacent;
+    unsigned int m_adjCount;
+    unsigned int m_adjAlloc;
+};
+
+};
+
 using namespace TelEngine;
 
 static const TokenDict s_dict_control[] = {
@@ -52,6 +93,139 @@ const ObjList* SS7L3User::getNetRoutes(const SS7Layer3* network, SS7PointCode::T
 }
 
 
+// Rebuild the index from scratch out of a route table
+void SS7RouteIndex::build(const ObjList& routes)
+{
+    unsigned int size = 16;
+    for (unsigned int n = routes.count(); size < 2 * n; )
+	size <<= 1;
+    if (!m_slots || size != m_mask + 1) {
+	delete[] m_slots;
+	m_slots = new Slot[size];
+	m_mask = size - 1;
+    }
+    ::memset(m_slots,0,size * sizeof(Slot));
+    m_count = 0;
+    m_seq = 0;
+    m_adjCount = 0;
+    for (ObjList* o = routes.skipNull(); o; o = o->skipNext())
+	insert(static_cast<SS7Route*>(o->get()),m_seq++);
+}
+
+// Index a route just appended to the table, keep load factor at most 1/2
+void SS7RouteIndex::add(SS7Route* route)
+{
+    if (!route)
+	return;
+    if (!m_slots)
+	resize(16);
+    else if (2 * (m_count + 1) > m_mask + 1)
+	resize(2 * (m_mask + 1));
+    insert(route,m_seq++);
+}
+
+// Remove a route, shift back the following entries of its cluster
+void SS7RouteIndex::remove(const SS7Route* route)
+{
+    if (!(route && m_slots))
+	return;
+    unsigned int i = hash(route->packed()) & m_mask;
+    for (; m_slots[i].route != route; i = (i + 1) & m_mask)
+	if (!m_slots[i].route)
+	    return;
+    for (unsigned int j = (i + 1) & m_mask; m_slots[j].route; j = (j + 1) & m_mask) {
+	unsigned int k = hash(m_slots[j].route->packed()) & m_mask;
+	// entry can move to the hole only if its home slot is not in (i,j]
+	if ((i < j) ? (k <= i || k > j) : (k <= i && k > j)) {
+	    m_slots[i] = m_slots[j];
+	    i = j;
+	}
+    }
+    m_slots[i].route = 0;
+    m_count--;
+    for (unsigned int a = 0; a < m_adjCount; a++) {
+	if (m_adjacent[a].route != route)
+	    continue;
+	m_adjCount--;
+	::memmove(m_adjacent + a,m_adjacent + a + 1,(m_adjCount - a) * sizeof(Slot));
+	break;
+    }
+}
+
+// Find a route by packed point code, optionally return its position in table
+SS7Route* SS7RouteIndex::find(unsigned int packed, unsigned int* pos) const
+{
+    if (!m_slots)
+	return 0;
+    for (unsigned int i = hash(packed) & m_mask; m_slots[i].route; i = (i + 1) & m_mask) {
+	if (m_slots[i].route->packed() != packed)
+	    continue;
+	if (pos)
+	    *pos = m_slots[i].pos;
+	return m_slots[i].route;
+    }
+    return 0;
+}
+
+// Get the state of a route unless an adjacent route placed before it
+//  in the table is not available
+SS7Route::State SS7RouteIndex::adjacentState(unsigned int packed) const
+{
+    unsigned int pos = 0;
+    SS7Route* route = find(packed,&pos);
+    for (unsigned int a = 0; a < m_adjCount; a++) {
+	if (route && m_adjacent[a].pos >= pos)
+	    break;
+	SS7Route::State state = m_adjacent[a].route->state();
+	if (!(state & SS7Route::NotProhibited))
+	    return state;
+    }
+    return route ? route->state() : SS7Route::Unknown;
+}
+
+void SS7RouteIndex::resize(unsigned int size)
+{
+    Slot* old = m_slots;
+    unsigned int oldSize = old ? m_mask + 1 : 0;
+    m_slots = new Slot[size];
+    ::memset(m_slots,0,size * sizeof(Slot));
+    m_mask = size - 1;
+    m_count = 0;
+    for (unsigned int i = 0; i < oldSize; i++)
+	if (old[i].route)
+	    place(old[i].route,old[i].pos);
+    delete[] old;
+}
+
+void SS7RouteIndex::place(SS7Route* route, unsigned int pos)
+{
+    unsigned int i = hash(route->packed()) & m_mask;
+    while (m_slots[i].route)
+	i = (i + 1) & m_mask;
+    m_slots[i].route = route;
+    m_slots[i].pos = pos;
+    m_count++;
+}
+
+void SS7RouteIndex::insert(SS7Route* route, unsigned int pos)
+{
+    place(route,pos);
+    if (route->priority())
+	return;
+    if (m_adjCount >= m_adjAlloc) {
+	m_adjAlloc = m_adjAlloc ? 2 * m_adjAlloc : 4;
+	Slot* adj = new Slot[m_adjAlloc];
+	if (m_adjCount)
+	    ::memcpy(adj,m_adjacent,m_adjCount * sizeof(Slot));
+	delete[] m_adjacent;
+	m_adjacent = adj;
+    }
+    m_adjacent[m_adjCount].route = route;
+    m_adjacent[m_adjCount].pos = pos;
+    m_adjCount++;
+}
+
+
 // Constructor
 SS7Layer3::SS7Layer3(SS7PointCode::Type type)
     : SignallingComponent("SS7Layer3"),
@@ -59,11 +233,21 @@ SS7Layer3::SS7Layer3(SS7PointCode::Type type)
       m_l3userMutex(true,"SS7Layer3::l3user"),
       m_l3user(0), m_defNI(SS7MSU::National)
 {
-    for (unsigned int i = 0; i < YSS7_PCTYPE_COUNT; i++)
+    for (unsigned int i = 0; i < YSS7_PCTYPE_COUNT; i++) {
 	m_local[i] = 0;
+	m_routeIndex[i] = new SS7RouteIndex;
+    }
     setType(type);
 }
 
+// Destructor
+SS7Layer3::~SS7Layer3()
+{
+    attach(0);
+    for (unsigned int i = 0; i < YSS7_PCTYPE_COUNT; i++)
+	delete m_routeIndex[i];
+}
+
 // Initialize the Layer 3 component
 bool SS7Layer3::initialize(const NamedList* config)
 {
@@ -166,16 +350,17 @@ bool SS7Layer3::hasType(SS7PointCode::Type pcType) const
 bool SS7Layer3::buildRoutes(const NamedList& params)
 {
     Lock lock(m_routeMutex);
+    // Keep the tail of each list, appending to a long list is slow
+    ObjList* tail[YSS7_PCTYPE_COUNT];
     for (unsigned int i = 0; i < YSS7_PCTYPE_COUNT; i++) {
 	m_route[i].clear();
+	m_routeIndex[i]->build(m_route[i]);
 	m_local[i] = 0;
+	tail[i] = &m_route[i];
     }
-    unsigned int n = params.length();
     bool added = false;
-    for (unsigned int i= 0; i < n; i++) {
-	NamedString* ns = params.getParam(i);
-	if (!ns)
-	    continue;
+    for (const ObjList* l = params.paramList()->skipNull(); l; l = l->skipNext()) {
+	NamedString* ns = static_cast<NamedString*>(l->get());
 	unsigned int prio = 0;
 	unsigned int shift = 0;
 	unsigned int maxLength = MAX_TDM_MSU_SIZE;
@@ -233,7 +418,9 @@ bool SS7Layer3::buildRoutes(const NamedList& params)
 	    continue;
 	}
 	added = true;
-	m_route[(unsigned int)type - 1].append(new SS7Route(packed,type,prio,shift,maxLength));
+	SS7Route* r = new SS7Route(packed,type,prio,shift,maxLength);
+	tail[type - 1] = tail[type - 1]->append(r);
+	routeIndexAdd(type,r);
 	DDebug(this,DebugAll,"Added route '%s'",ns->c_str());
     }
     if (!added)
@@ -274,14 +461,10 @@ SS7Route::State SS7Layer3::getRouteState(SS7PointCode::Type type, unsigned int p
     if (type == SS7PointCode::Other || (unsigned int)type > YSS7_PCTYPE_COUNT || !packedPC)
 	return SS7Route::Unknown;
     Lock lock(m_routeMutex);
-    for (ObjList* o = m_route[type-1].skipNull(); o; o = o->skipNext()) {
-	SS7Route* route = static_cast<SS7Route*>(o->get());
-	if (route->packed() == packedPC)
-	    return route->state();
-	if (checkAdjacent && !route->priority() && !(route->state() & SS7Route::NotProhibited))
-	    return route->state();
-    }
-    return SS7Route::Unknown;
+    if (checkAdjacent)
+	return m_routeIndex[type-1]->adjacentState(packedPC);
+    SS7Route* route = m_routeIndex[type-1]->find(packedPC);
+    return route ? route->state() : SS7Route::Unknown;
 }
 
 bool SS7Layer3::maintenance(const SS7MSU& msu, const SS7Label& label, int sls)
@@ -448,54 +631,71 @@ SS7Route* SS7Layer3::findRoute(SS7PointCode::Type type, unsigned int packed)
     if (index >= YSS7_PCTYPE_COUNT)
 	return 0;
     Lock lock(m_routeMutex);
-    for (ObjList* o = m_route[index].skipNull(); o; o = o->skipNext()) {
-	SS7Route* route = static_cast<SS7Route*>(o->get());
-	if (route->packed() == packed)
-	    return route;
-    }
-    return 0;
+    return m_routeIndex[index]->find(packed);
+}
+
+// Index a route just appended to a route table
+void SS7Layer3::routeIndexAdd(SS7PointCode::Type type, SS7Route* route)
+{
+    if ((unsigned int)type && (unsigned int)type <= YSS7_PCTYPE_COUNT)
+	m_routeIndex[type - 1]->add(route);
+}
+
+// Remove a route from index before it's removed from its table
+void SS7Layer3::routeIndexRemove(SS7PointCode::Type type, const SS7Route* route)
+{
+    if ((unsigned int)type && (unsigned int)type <= YSS7_PCTYPE_COUNT)
+	m_routeIndex[type - 1]->remove(route);
+}
+
+// Rebuild the index of a route table
+void SS7Layer3::routeIndexBuild(SS7PointCode::Type type)
+{
+    if ((unsigned int)type && (unsigned int)type <= YSS7_PCTYPE_COUNT)
+	m_routeIndex[type - 1]->build(m_route[type - 1]);
 }
 
 void SS7Layer3::printRoutes()
 {
-    String s;
+    // Collect lines and join them once, the table may be very long
+    ObjList lines;
+    ObjList* tail = &lines;
     bool router = getObject(YSTRING("SS7Router")) != 0;
     for (unsigned int i = 0; i < YSS7_PCTYPE_COUNT; i++) {
 	ObjList* o = m_route[i].skipNull();
 	if (!o)
 	    continue;
 	SS7PointCode::Type type = (SS7PointCode::Type)(i + 1);
-	String tmp;
 	String sType = SS7PointCode::lookup(type);
 	sType << String(' ',(unsigned int)(8 - sType.length()));
 	if (m_local[i])
 	    sType << SS7PointCode(type,m_local[i]) << " > ";
 	for (; o; o = o->skipNext()) {
 	    SS7Route* route = static_cast<SS7Route*>(o->get());
-	    tmp << sType << SS7PointCode(type,route->m_packed);
+	    String* tmp = new String(sType);
+	    tail = tail->append(tmp);
+	    *tmp << SS7PointCode(type,route->m_packed);
 	    if (!router) {
-		tmp << " " << route->m_priority << " (" << route->stateName() << ")";
+		*tmp << " " << route->m_priority << " (" << route->stateName() << ")";
 		if (route->shift())
-		    tmp << " >> " << route->shift();
-		tmp << "\r\n";
+		    *tmp << " >> " << route->shift();
 		continue;
 	    }
-	    tmp << " (" << route->stateName() << ")";
+	    *tmp << " (" << route->stateName() << ")";
 	    for (ObjList* oo = route->m_networks.skipNull(); oo; oo = oo->skipNext()) {
 		GenPointer<SS7Layer3>* d = static_cast<GenPointer<SS7Layer3>*>(oo->get());
 		if (*d)
-		    tmp << " " << (*d)->toString() << "," <<
+		    *tmp << " " << (*d)->toString() << "," <<
 			(*d)->getRoutePriority(type,route->m_packed) << "," <<
 			SS7Route::stateName((*d)->getRouteState(type,route->m_packed));
 	    }
 	    if (route->shift())
-		tmp << " >> " << route->shift();
-	    tmp << "\r\n";
+		*tmp << " >> " << route->shift();
 	}
-	s << tmp;
     }
-    if (s) {
-	s = s.substr(0,s.length() - 2);
+    if (lines.skipNull()) {
+	String s;
+	s.append(lines,"\r\n");
 	Output("%s of '%s': [%p]\r\n%s",router?"Routing table":"Destinations",debugName(),this,s.c_str());
     }
     else
@@ -593,6 +793,7 @@ SS7MTP3::SS7MTP3(const NamedList& params)
 	TelEngine::destruct(l);
     }
     setDumper(params.getValue(YSTRING("layer3dump")));
+    scheduleTicks();
 }
 
 SS7MTP3::~SS7MTP3()
@@ -1203,6 +1404,7 @@ void SS7MTP3::notify(SS7Layer2* link)
 	    else
 		link->inhibit(0,SS7Layer2::Unchecked);
 	}
+	tickNow();
     }
     countLinks();
     String text;
@@ -1353,6 +1555,23 @@ void SS7MTP3::timerTick(const Time& when)
     }
 }
 
+u_int64_t SS7MTP3::nextTick(const Time& when)
+{
+    Lock mylock(this,SignallingEngine::maxLockWait());
+    if (!mylock.locked())
+	return when;
+    // only operational links are checked, others notify when they come up
+    u_int64_t next = 0;
+    for (ObjList* o = m_links.skipNull(); o; o = o->skipNext()) {
+	L2Pointer* p = static_cast<L2Pointer*>(o->get());
+	SS7Layer2* l2 = *p;
+	// checks are due strictly after their time
+	if (l2 && l2->m_checkTime && (!next || (l2->m_checkTime < next)) && l2->operational())
+	    next = l2->m_checkTime + 1;
+    }
+    return next;
+}
+
 void SS7MTP3::linkChecked(int sls, bool remote)
 {
     if (sls < 0)
@@ -1382,6 +1601,7 @@ void SS7MTP3::linkChecked(int sls, bool remote)
 		l2->inhibit(0,SS7Layer2::Unchecked);
 	    }
 	}
+	tickNow();
 	break;
     }
 }
@@ -0,0 +1,161 @@
+/**
+ * main-engineload.cpp
+ * This file is part of the YATE Project http://YATE.null.ro
+ *
+ * Yet Another Signalling Stack - implements the support for SS7, ISDN and PSTN
+ *
+ * Yet Another Telephony Engine - a fully featured software PBX and IVR
+ * Copyright (C) 2004-2023 Null Team
+ *
+ * This software is distributed under multiple licenses;
+ * see the COPYING file in the main directory for licensing
+ * information for this specific distribution.
+ *
+ * This use of this software may be subject to additional restrictions.
+ * See the LEGAL file in the main directory for details.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "yatesig.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+using namespace TelEngine;
+
+// Engine counting its worker thread ticks
+class LoadEngine : public SignallingEngine
+{
+public:
+    inline LoadEngine()
+	: SignallingEngine("engineload"), m_ticks(0)
+	{ }
+    virtual unsigned long timerTick(const Time& when)
+	{ m_ticks++; return SignallingEngine::timerTick(when); }
+    unsigned int m_ticks;
+};
+
+// Interface accepting all packets, the remote end never answers
+class LoadInterface : public SignallingInterface
+{
+public:
+    inline LoadInterface(const char* name)
+	: SignallingComponent(name)
+	{ scheduleTicks(); }
+    virtual bool control(Operation oper, NamedList* params = 0)
+	{ return true; }
+    static unsigned int s_packets;
+protected:
+    virtual bool transmitPacket(const DataBlock& packet, bool repeat, PacketType type)
+	{ s_packets++; return true; }
+};
+
+unsigned int LoadInterface::s_packets = 0;
+
+static void noOutput(const char* buf, int level)
+{
+}
+
+static u_int64_t cpuTime()
+{
+    struct rusage usage;
+    if (::getrusage(RUSAGE_SELF,&usage))
+	return 0;
+    return (u_int64_t)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000 +
+	usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+int main(int argc, const char** argv)
+{
+    unsigned int links = (argc > 1) ? ::atoi(argv[1]) : 0;
+    unsigned int secs = (argc > 2) ? ::atoi(argv[2]) : 0;
+    bool m2pa = (argc > 3) && !::strcmp(argv[3],"m2pa");
+    bool users = (argc > 4) && !::strcmp(argv[4],"users");
+    if (!links)
+	links = 200;
+    if (!secs)
+	secs = 5;
+    Debugger::enableOutput(true,true);
+    debugLevel(DebugWarn);
+    Output("Engine load test starting: %u %s links%s, %u seconds",
+	links,(m2pa ? "M2PA" : "MTP2"),(users ? " with ISUP and SCCP" : ""),secs);
+
+    // don't print the route tables of all linksets
+    Debugger::setOutput(noOutput);
+    LoadEngine* engine = new LoadEngine;
+    NamedList rParams("router");
+    rParams.addParam("local","ITU,1");
+    SS7Router* router = new SS7Router(rParams);
+    engine->insert(router);
+    if (users) {
+	// user parts wait for the network to come up
+	NamedList uParams("isup");
+	uParams.addParam("pointcodetype","ITU");
+	uParams.addParam("pointcode","1");
+	uParams.addParam("remotepointcode","2");
+	SS7ISUP* isup = new SS7ISUP(uParams);
+	isup->setPointCode(uParams);
+	engine->insert(isup);
+	router->attach(isup);
+	uParams.assign("sccp");
+	uParams.clearParams();
+	uParams.addParam("pointcodetype","ITU");
+	uParams.addParam("localpointcode","1");
+	SS7SCCP* sccp = new SS7SCCP(uParams);
+	engine->insert(sccp);
+	sccp->initialize(&uParams);
+	router->attach(sccp);
+    }
+    // One linkset of a single link to each adjacent node, links stay down
+    for (unsigned int i = 0; i < links; i++) {
+	String name("link");
+	name << i;
+	NamedList params(name);
+	params.addParam("local","ITU,1");
+	params.addParam("adjacent","ITU," + String(i + 2));
+	SS7MTP3* mtp3 = new SS7MTP3(params);
+	router->attach(mtp3);
+	params.clearParams();
+	params.addParam("autostart","true");
+	if (m2pa) {
+	    // no association, the link waits for the transport to come up
+	    mtp3->attach(new SS7M2PA(params));
+	    continue;
+	}
+	// the alignment is retried forever, fill in units sent every 20 ms
+	SS7MTP2* mtp2 = new SS7MTP2(params);
+	mtp2->SignallingReceiver::attach(new LoadInterface(name + "/iface"));
+	mtp3->attach(mtp2);
+	mtp2->control(SS7Layer2::Resume,&params);
+    }
+    Debugger::setOutput();
+    engine->start();
+    // let alignment start on all links before measuring
+    Thread::msleep(500);
+
+    unsigned int ticks = engine->m_ticks;
+    unsigned int packets = LoadInterface::s_packets;
+    u_int64_t cpu = cpuTime();
+    u_int64_t t = Time::now();
+    Thread::sleep(secs);
+    t = Time::now() - t;
+    cpu = cpuTime() - cpu;
+    ticks = engine->m_ticks - ticks;
+    packets = LoadInterface::s_packets - packets;
+    Output("Idle engine: %u ticks in " FMT64U " ms, %u ticks/s, %u fill in units sent, CPU " FMT64U " ms (" FMT64U ".%02u%%)",
+	ticks,t / 1000,(unsigned int)((u_int64_t)ticks * 1000000 / t),packets,cpu / 1000,
+	cpu * 100 / t,(unsigned int)(cpu * 10000 / t % 100));
+
+    engine->stop();
+    // the engine owns all components
+    delete engine;
+    Output("Engine load test stopped");
+    return 0;
+}
+
+/* vi: set ts=8 sw=4 sts=4 noet: */
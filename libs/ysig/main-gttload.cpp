@@ -0,0 +1,144 @@
+/**
+ * main-gttload.cpp
+ * This file is part of the YATE Project http://YATE.null.ro
+ *
+ * Yet Another Signalling Stack - implements the support for SS7, ISDN and PSTN
+ *
+ * Yet Another Telephony Engine - a fully featured software PBX and IVR
+ * Copyright (C) 2004-2023 Null Team
+ *
+ * This software is distributed under multiple licenses;
+ * see the COPYING file in the main directory for licensing
+ * information for this specific distribution.
+ *
+ * This use of this software may be subject to additional restrictions.
+ * See the LEGAL file in the main directory for details.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "yatesig.h"
+
+#include <stdlib.h>
+
+using namespace TelEngine;
+
+// Build the digits of a rule prefix or a Global Title
+static String digits(unsigned int prefix, unsigned int len)
+{
+    String s(prefix);
+    while (s.length() < len)
+	s << (char)('0' + (s.length() * 7 + prefix) % 10);
+    return s;
+}
+
+static void report(const char* name, unsigned int n, unsigned int ok, u_int64_t t)
+{
+    if (!t)
+	t = 1;
+    Output("%s: %u translations (%u found) in " FMT64U " ms, " FMT64U " per second",
+	name,n,ok,t / 1000,(u_int64_t)n * 1000000 / t);
+}
+
+// Translate a set of called party addresses, check the rewritten digits
+static void translate(PrefixGTT* gtt, const ObjList& addrs, unsigned int rounds, const char* name)
+{
+    unsigned int n = 0;
+    unsigned int ok = 0;
+    u_int64_t t = Time::now();
+    for (unsigned int r = 0; r < rounds; r++) {
+	for (ObjList* o = addrs.skipNull(); o; o = o->skipNext(), n++) {
+	    const NamedList& addr = *static_cast<NamedList*>(o->get());
+	    NamedList* route = gtt->routeGT(addr,"CalledPartyAddress","CallingPartyAddress");
+	    if (!route)
+		continue;
+	    if (route->getParam(YSTRING("pointcode")) && route->getParam(YSTRING("gt")))
+		ok++;
+	    TelEngine::destruct(route);
+	}
+    }
+    report(name,n,ok,Time::now() - t);
+}
+
+int main(int argc, const char** argv)
+{
+    unsigned int rules = (argc > 1) ? ::atoi(argv[1]) : 0;
+    unsigned int rounds = (argc > 2) ? ::atoi(argv[2]) : 0;
+    if (!rules)
+	rules = 100000;
+    if (!rounds)
+	rounds = 10;
+    Debugger::enableOutput(true,true);
+    debugLevel(DebugWarn);
+    Output("GTT load test starting: %u rules, %u rounds",rules,rounds);
+
+    // Prefixes of 6 to 9 digits, a few wildcard rules and some for other headers
+    String text;
+    ObjList lines;
+    ObjList* tail = &lines;
+    tail = tail->append(new String("; generated rules"));
+    tail = tail->append(new String(":::=route=gt,pointcode=1"));
+    tail = tail->append(new String("::international:4=route=gt,pointcode=2"));
+    for (unsigned int i = 0; i < rules; i++) {
+	String* s = new String;
+	switch (i % 4) {
+	    case 0:
+		*s << "0:e164:international:";
+		break;
+	    case 1:
+		*s << ":e164:international:";
+		break;
+	    case 2:
+		*s << "0::international:";
+		break;
+	    default:
+		*s << "0:e212::";
+	}
+	*s << digits(100000 + i,6 + i % 4) << "=route=ssn,pointcode=" << (1000 + i % 16000)
+	    << ",ssn=" << (6 + i % 3) << ",strip=2,prepend=" << (i % 10);
+	tail = tail->append(s);
+    }
+    text.append(lines,"\n");
+    lines.clear();
+
+    NamedList params("gttload");
+    PrefixGTT* gtt = new PrefixGTT(params);
+    u_int64_t t = Time::now();
+    if (!gtt->setRules(text,"generated")) {
+	TelEngine::destruct(gtt);
+	Output("GTT load test failed to compile the rules");
+	return 1;
+    }
+    Output("Compiled %u rules from %u bytes in " FMT64U " ms",gtt->rules(),text.length(),
+	(Time::now() - t) / 1000);
+
+    // Global Titles extending the rule prefixes and some matching no prefix
+    ObjList addrs;
+    tail = &addrs;
+    for (unsigned int i = 0; i < rules; i += 7) {
+	NamedList* addr = new NamedList("");
+	addr->addParam("CalledPartyAddress.route","gt");
+	addr->addParam("CalledPartyAddress.gt",digits(100000 + i,12));
+	addr->addParam("CalledPartyAddress.gt.translation","0");
+	addr->addParam("CalledPartyAddress.gt.plan","e164");
+	addr->addParam("CalledPartyAddress.gt.nature","international");
+	addr->addParam("CalledPartyAddress.gt.encoding","bcd");
+	addr->addParam("CallingPartyAddress.gt","40722000000");
+	tail = tail->append(addr);
+    }
+    translate(gtt,addrs,rounds,"routeGT");
+
+    // Reload the same rules while keeping the old table until replaced
+    t = Time::now();
+    gtt->setRules(text,"reloaded");
+    Output("Reloaded %u rules in " FMT64U " ms",gtt->rules(),(Time::now() - t) / 1000);
+    translate(gtt,addrs,rounds,"routeGT after reload");
+
+    TelEngine::destruct(gtt);
+    Output("GTT load test stopped");
+    return 0;
+}
+
+/* vi: set ts=8 sw=4 sts=4 noet: */
@@ -0,0 +1,115 @@
+/**
+ * main-isupload.cpp
+ * This file is part of the YATE Project http://YATE.null.ro
+ *
+ * Yet Another Signalling Stack - implements the support for SS7, ISDN and PSTN
+ *
+ * Yet Another Telephony Engine - a fully featured software PBX and IVR
+ * Copyright (C) 2004-2023 Null Team
+ *
+ * This software is distributed under multiple licenses;
+ * see the COPYING file in the main directory for licensing
+ * information for this specific distribution.
+ *
+ * This use of this software may be subject to additional restrictions.
+ * See the LEGAL file in the main directory for details.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "yatesig.h"
+
+#include <stdlib.h>
+
+using namespace TelEngine;
+
+// Circuit not attached to any hardware
+class LoadCircuit : public SignallingCircuit
+{
+public:
+    inline LoadCircuit(unsigned int code, SignallingCircuitGroup* group)
+	: SignallingCircuit(TDM,code,Idle,group)
+	{ }
+};
+
+// ISUP call controller receiving MSUs directly, not from a network
+class LoadISUP : public SS7ISUP
+{
+public:
+    inline LoadISUP(const NamedList& params)
+	: SS7ISUP(params)
+	{ }
+    inline HandledMSU inject(const SS7MSU& msu, const SS7Label& label)
+	{ return receivedMSU(msu,label,0,0); }
+};
+
+// Feed all MSUs in list to the controller, report the rate
+static void run(LoadISUP* isup, const SS7Label& label, const ObjList& msus,
+    unsigned int rounds, const char* name)
+{
+    unsigned int n = 0;
+    unsigned int ok = 0;
+    u_int64_t t = Time::now();
+    for (unsigned int r = 0; r < rounds; r++) {
+	for (ObjList* o = msus.skipNull(); o; o = o->skipNext(), n++)
+	    if (isup->inject(*static_cast<SS7MSU*>(o->get()),label).ok())
+		ok++;
+    }
+    t = Time::now() - t;
+    if (!t)
+	t = 1;
+    Output("%s: %u messages (%u handled) in " FMT64U " ms, " FMT64U " msg/s, %u calls",
+	name,n,ok,t / 1000,(u_int64_t)n * 1000000 / t,isup->calls().count());
+}
+
+int main(int argc, const char** argv)
+{
+    unsigned int cics = (argc > 1) ? ::atoi(argv[1]) : 0;
+    unsigned int rounds = (argc > 2) ? ::atoi(argv[2]) : 0;
+    if (!cics || cics > 0xfff)
+	cics = 1000;
+    if (!rounds)
+	rounds = 20;
+    Debugger::enableOutput(true,true);
+    debugLevel(DebugWarn);
+    Output("ISUP load test starting: %u circuits, %u rounds",cics,rounds);
+    SignallingCircuitGroup* group = new SignallingCircuitGroup(0,
+	SignallingCircuitGroup::Increment,"isupload");
+    for (unsigned int i = 1; i <= cics; i++)
+	group->insert(new LoadCircuit(i,group));
+    NamedList params("isupload");
+    params.addParam("pointcodetype","ITU");
+    params.addParam("pointcode","1-1-1");
+    params.addParam("remotepointcode","2-2-2");
+    LoadISUP* isup = new LoadISUP(params);
+    isup->setPointCode(params);
+    isup->SignallingCallControl::attach(group);
+    SS7PointCode local(1,1,1);
+    SS7PointCode remote(2,2,2);
+    SS7Label label(SS7PointCode::ITU,local,remote,0);
+    ObjList iam;
+    ObjList cpg;
+    for (unsigned int i = 1; i <= cics; i++) {
+	unsigned char lo = i & 0xff;
+	unsigned char hi = (i >> 8) & 0x0f;
+	// IAM: fixed part, called party number 123456, no optional part
+	unsigned char bufIam[] = { lo, hi, 0x01,
+	    0x00, 0x60, 0x01, 0x0a, 0x00, 0x02, 0x00, 0x05, 0x03, 0x10, 0x21, 0x43, 0x65 };
+	// CPG: event information alerting, no optional part
+	unsigned char bufCpg[] = { lo, hi, 0x2c, 0x01, 0x00 };
+	iam.append(new SS7MSU(SS7MSU::ISUP,SS7MSU::National,label,bufIam,sizeof(bufIam)));
+	cpg.append(new SS7MSU(SS7MSU::ISUP,SS7MSU::National,label,bufCpg,sizeof(bufCpg)));
+    }
+    // Setup one call on each circuit then feed progress messages to existing calls
+    run(isup,label,iam,1,"IAM");
+    run(isup,label,cpg,rounds,"CPG");
+    isup->cleanup();
+    TelEngine::destruct(isup);
+    TelEngine::destruct(group);
+    Output("ISUP load test stopped");
+    return 0;
+}
+
+/* vi: set ts=8 sw=4 sts=4 noet: */
@@ -0,0 +1,143 @@
+/**
+ * main-routeload.cpp
+ * This file is part of the YATE Project http://YATE.null.ro
+ *
+ * Yet Another Signalling Stack - implements the support for SS7, ISDN and PSTN
+ *
+ * Yet Another Telephony Engine - a fully featured software PBX and IVR
+ * Copyright (C) 2004-2023 Null Team
+ *
+ * This software is distributed under multiple licenses;
+ * see the COPYING file in the main directory for licensing
+ * information for this specific distribution.
+ *
+ * This use of this software may be subject to additional restrictions.
+ * See the LEGAL file in the main directory for details.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "yatesig.h"
+
+#include <stdlib.h>
+
+using namespace TelEngine;
+
+// Network accepting all MSUs without sending them anywhere
+class LoadNetwork : public SS7Layer3
+{
+public:
+    inline LoadNetwork()
+	: SS7Layer3(SS7PointCode::ITU), m_count(0)
+	{ }
+    virtual int transmitMSU(const SS7MSU& msu, const SS7Label& label, int sls = -1)
+	{ m_count++; return 0; }
+    virtual bool operational(int sls = -1) const
+	{ return true; }
+    inline bool hasRoute(unsigned int packed)
+	{ return findRoute(SS7PointCode::ITU,packed) != 0; }
+    inline unsigned int routes()
+	{ return getRoutes(SS7PointCode::ITU)->count(); }
+    unsigned int m_count;
+};
+
+static void noOutput(const char* buf, int level)
+{
+}
+
+static void report(const char* name, unsigned int n, unsigned int ok, u_int64_t t)
+{
+    if (!t)
+	t = 1;
+    Output("%s: %u lookups (%u found) in " FMT64U " ms, " FMT64U " per second",
+	name,n,ok,t / 1000,(u_int64_t)n * 1000000 / t);
+}
+
+int main(int argc, const char** argv)
+{
+    unsigned int routes = (argc > 1) ? ::atoi(argv[1]) : 0;
+    unsigned int rounds = (argc > 2) ? ::atoi(argv[2]) : 0;
+    if (!routes || routes > 16000)
+	routes = 4000;
+    if (!rounds)
+	rounds = 20;
+    Debugger::enableOutput(true,true);
+    debugLevel(DebugWarn);
+    Output("Route load test starting: %u routes, %u rounds",routes,rounds);
+    // Remote destinations followed by a few adjacent nodes, ITU point codes
+    NamedList params("routeload");
+    params.addParam("local","ITU,16383");
+    for (unsigned int i = 5; i < routes + 5; i++)
+	params.addParam("route","ITU," + String(i) + ",100");
+    for (unsigned int i = 1; i <= 4; i++)
+	params.addParam("adjacent","ITU," + String(i));
+    LoadNetwork* network = new LoadNetwork;
+    // don't print the whole route table
+    Debugger::setOutput(noOutput);
+    u_int64_t t = Time::now();
+    network->buildRoutes(params);
+    t = Time::now() - t;
+    Debugger::setOutput();
+    Output("Built %u routes in " FMT64U " ms",network->routes(),t / 1000);
+    NamedList rParams("router");
+    SS7Router* router = new SS7Router(rParams);
+    t = Time::now();
+    router->attach(network);
+    Output("Attached network to router in " FMT64U " ms",(Time::now() - t) / 1000);
+
+    unsigned int n = 0;
+    unsigned int ok = 0;
+    t = Time::now();
+    for (unsigned int r = 0; r < rounds; r++)
+	for (unsigned int i = 1; i <= routes + 8; i++, n++)
+	    if (network->hasRoute(i))
+		ok++;
+    report("findRoute",n,ok,Time::now() - t);
+
+    n = ok = 0;
+    t = Time::now();
+    for (unsigned int r = 0; r < rounds; r++)
+	for (unsigned int i = 1; i <= routes + 8; i++, n++)
+	    if (network->getRoutePriority(SS7PointCode::ITU,i) != (unsigned int)-1)
+		ok++;
+    report("getRoutePriority",n,ok,Time::now() - t);
+
+    // Routes are in unknown state, adjacent ones placed last are not checked
+    //  unless the destination is missing
+    n = ok = 0;
+    t = Time::now();
+    for (unsigned int r = 0; r < rounds; r++)
+	for (unsigned int i = 1; i <= routes + 8; i++, n++)
+	    if (network->getRouteState(SS7PointCode::ITU,i,true) == SS7Route::Unknown)
+		ok++;
+    report("getRouteState",n,ok,Time::now() - t);
+
+    // Maintenance MSUs are routed regardless of route state
+    ObjList msus;
+    for (unsigned int i = 1; i < routes + 5; i++) {
+	SS7Label label(SS7PointCode::ITU,i,16383,i & 0x0f);
+	unsigned char buf[] = { 0x11, 0x40, 0x55, 0xaa, 0x55, 0xaa };
+	msus.append(new SS7MSU(SS7MSU::MTN,SS7MSU::National,label,buf,sizeof(buf)));
+    }
+    n = ok = 0;
+    t = Time::now();
+    for (unsigned int r = 0; r < rounds; r++) {
+	for (ObjList* o = msus.skipNull(); o; o = o->skipNext(), n++) {
+	    const SS7MSU& msu = *static_cast<SS7MSU*>(o->get());
+	    SS7Label label(SS7PointCode::ITU,msu);
+	    if (router->transmitMSU(msu,label,label.sls()) >= 0)
+		ok++;
+	}
+    }
+    report("router transmitMSU",n,ok,Time::now() - t);
+
+    router->detach(network);
+    TelEngine::destruct(router);
+    TelEngine::destruct(network);
+    Output("Route load test stopped");
+    return 0;
+}
+
+/* vi: set ts=8 sw=4 sts=4 noet: */
@@ -0,0 +1,358 @@
+/**
+ * main-tcapload.cpp
+ * This file is part of the YATE Project http://YATE.null.ro
+ *
+ * Yet Another Signalling Stack - implements the support for SS7, ISDN and PSTN
+ *
+ * Yet Another Telephony Engine - a fully featured software PBX and IVR
+ * Copyright (C) 2004-2023 Null Team
+ *
+ * This software is distributed under multiple licenses;
+ * see the COPYING file in the main directory for licensing
+ * information for this specific distribution.
+ *
+ * This use of this software may be subject to additional restrictions.
+ * See the LEGAL file in the main directory for details.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "yatesig.h"
+#include "yateasn.h"
+
+#include <stdlib.h>
+
+using namespace TelEngine;
+
+// TCAP user accepting all dialogues and ending them right away unless asked to keep them
+class LoadUser : public TCAPUser
+{
+public:
+    inline LoadUser()
+	: TCAPUser("tcapload"), m_count(0), m_keep(false)
+	{ }
+    virtual bool tcapIndication(NamedList& params)
+	{
+	    m_count++;
+	    params.setParam("tcap.transaction.endNow",String::boolText(!m_keep));
+	    return true;
+	}
+    unsigned int m_count;
+    bool m_keep;
+};
+
+// ITU TCAP with a transaction timeout long enough to keep dialogues open
+class LoadTCAP : public SS7TCAPITU
+{
+public:
+    inline LoadTCAP(const NamedList& params)
+	: SignallingComponent(params.safe("SS7TCAPITU"),&params,"ss7-tcap-itu"),
+	  SS7TCAP(params), SS7TCAPITU(params)
+	{ m_trTimeout = 300000; }
+};
+
+// Build a BER tag - length - value, tag may be one or two bytes long
+static DataBlock tlv(unsigned int tag, const DataBlock& value)
+{
+    DataBlock data;
+    if (tag > 0xff)
+	data.append1(tag >> 8);
+    data.append1(tag);
+    unsigned int len = value.length();
+    unsigned char buf[3];
+    if (len < 0x80) {
+	buf[0] = len;
+	data.append(buf,1);
+    }
+    else if (len < 0x100) {
+	buf[0] = 0x81;
+	buf[1] = len;
+	data.append(buf,2);
+    }
+    else {
+	buf[0] = 0x82;
+	buf[1] = len >> 8;
+	buf[2] = len & 0xff;
+	data.append(buf,3);
+    }
+    data.append(value);
+    return data;
+}
+
+static DataBlock bytes(const char* hex)
+{
+    DataBlock data;
+    data.unHexify(hex);
+    return data;
+}
+
+static DataBlock filler(unsigned int len, unsigned char start)
+{
+    DataBlock data(0,len);
+    for (unsigned int i = 0; i < len; i++)
+	((unsigned char*)data.data())[i] = start + i;
+    return data;
+}
+
+// ITU dialogue portion with an AARQ for the given application context
+static DataBlock ituDialogue(const char* appCtxt)
+{
+    DataBlock aarq = bytes("80020780");
+    aarq += tlv(0xa1,bytes(appCtxt));
+    DataBlock ext = bytes("060700118605010101");
+    ext += tlv(0xa0,tlv(0x60,aarq));
+    return tlv(0x6b,tlv(0x28,ext));
+}
+
+// ITU Invoke component with local operation code and parameter sequence
+static DataBlock ituInvoke(unsigned char id, unsigned char opCode, const DataBlock& param)
+{
+    unsigned char buf[6] = { 0x02, 0x01, id, 0x02, 0x01, opCode };
+    DataBlock comp(buf,sizeof(buf));
+    comp += tlv(0x30,param);
+    return tlv(0xa1,comp);
+}
+
+static DataBlock ituBegin(unsigned int otid, const DataBlock& dialogue, const DataBlock& comps)
+{
+    unsigned char buf[4] = { (unsigned char)(otid >> 24), (unsigned char)(otid >> 16),
+	(unsigned char)(otid >> 8), (unsigned char)otid };
+    DataBlock msg = tlv(0x48,DataBlock(buf,4));
+    msg += dialogue;
+    msg += tlv(0x6c,comps);
+    return tlv(0x62,msg);
+}
+
+// ANSI Query With Permission carrying one InvokeLast component
+static DataBlock ansiQuery(unsigned int tid, const DataBlock& param)
+{
+    unsigned char buf[4] = { (unsigned char)(tid >> 24), (unsigned char)(tid >> 16),
+	(unsigned char)(tid >> 8), (unsigned char)tid };
+    DataBlock msg = tlv(0xc7,DataBlock(buf,4));
+    DataBlock comp = bytes("cf0101d0020301");
+    comp += tlv(0xf2,param);
+    msg += tlv(0xe8,tlv(0xe9,comp));
+    return tlv(0xe2,msg);
+}
+
+// Walk all BER elements in a block the way decoders did before cursors,
+//  copying constructed contents and cutting consumed data
+static unsigned int walkBlock(DataBlock& data)
+{
+    unsigned int n = 0;
+    while (data.length()) {
+	AsnTag tag;
+	AsnTag::decode(tag,data);
+	data.cut(-(int)tag.coding().length());
+	int len = ASNLib::decodeLength(data);
+	if (len < 0 || len > (int)data.length())
+	    break;
+	if (tag.type() == AsnTag::Constructor) {
+	    DataBlock inner(data.data(),len);
+	    n += walkBlock(inner);
+	}
+	else {
+	    OctetString val;
+	    val.assign(data.data(),len);
+	    n++;
+	}
+	data.cut(-len);
+    }
+    return n;
+}
+
+// Walk all BER elements in place using a cursor
+static unsigned int walkCursor(AsnCursor& data)
+{
+    unsigned int n = 0;
+    while (data.length()) {
+	AsnTag tag;
+	AsnTag::decode(tag,data);
+	data.skip(tag.coding().length());
+	int len = ASNLib::decodeLength(data);
+	if (len < 0 || len > (int)data.length())
+	    break;
+	if (tag.type() == AsnTag::Constructor) {
+	    AsnCursor inner(data.data(),len);
+	    n += walkCursor(inner);
+	}
+	else {
+	    OctetString val;
+	    val.assign(data.data(),len);
+	    n++;
+	}
+	data.skip(len);
+    }
+    return n;
+}
+
+// Decode all BER elements of the messages, report the rate
+static void walk(const ObjList& msgs, unsigned int rounds, bool cursor, const char* name)
+{
+    unsigned int n = 0;
+    unsigned int values = 0;
+    u_int64_t t = Time::now();
+    for (unsigned int r = 0; r < rounds; r++) {
+	for (ObjList* o = msgs.skipNull(); o; o = o->skipNext(), n++) {
+	    const DataBlock& data = *static_cast<DataBlock*>(o->get());
+	    if (cursor) {
+		AsnCursor c(data);
+		values += walkCursor(c);
+	    }
+	    else {
+		DataBlock copy(data);
+		values += walkBlock(copy);
+	    }
+	}
+    }
+    t = Time::now() - t;
+    if (!t)
+	t = 1;
+    Output("%s %s: %u messages, %u values in " FMT64U " ms, " FMT64U " msg/s",
+	name,(cursor ? "cursor" : "block"),n,values,t / 1000,(u_int64_t)n * 1000000 / t);
+}
+
+// Feed all messages to TCAP, report the rate
+static void run(SS7TCAP* tcap, LoadUser* user, const ObjList& msgs, unsigned int rounds, const char* name)
+{
+    NamedList params("");
+    params.addParam("CallingPartyAddress.pointcode","1");
+    params.addParam("CalledPartyAddress.pointcode","2");
+    unsigned int n = 0;
+    unsigned int bytes = 0;
+    unsigned int ok = 0;
+    user->m_count = 0;
+    u_int64_t t = 0;
+    for (unsigned int r = 0; r < rounds; r++) {
+	u_int64_t start = Time::now();
+	for (ObjList* o = msgs.skipNull(); o; o = o->skipNext(), n++) {
+	    DataBlock& data = *static_cast<DataBlock*>(o->get());
+	    bytes += data.length();
+	    SS7TCAPMessage* msg = new SS7TCAPMessage(params,data);
+	    if (tcap->processSCCPData(msg).ok())
+		ok++;
+	    TelEngine::destruct(msg);
+	}
+	t += Time::now() - start;
+	// drop the ended transactions
+	tcap->timerTick(Time());
+    }
+    if (!t)
+	t = 1;
+    Output("%s: %u messages (%u handled, %u to user), %u bytes each in " FMT64U " ms, " FMT64U " msg/s",
+	name,n,ok,user->m_count,n ? bytes / n : 0,t / 1000,(u_int64_t)n * 1000000 / t);
+}
+
+// Open dialogues left to wait for the user, report the cost of timer ticks
+static void ticks(SS7TCAP* tcap, LoadUser* user, const DataBlock& dialogue, const DataBlock& comps,
+    unsigned int count, unsigned int rounds)
+{
+    NamedList params("");
+    params.addParam("CallingPartyAddress.pointcode","1");
+    params.addParam("CalledPartyAddress.pointcode","2");
+    user->m_keep = true;
+    for (unsigned int i = 0; i < count; i++) {
+	DataBlock data = ituBegin(0x1000000 + i,dialogue,comps);
+	SS7TCAPMessage* msg = new SS7TCAPMessage(params,data);
+	tcap->processSCCPData(msg);
+	TelEngine::destruct(msg);
+    }
+    user->m_keep = false;
+    u_int64_t t = Time::now();
+    tcap->timerTick(Time());
+    Output("First timer tick with %u open dialogues in " FMT64U " us",count,Time::now() - t);
+    t = Time::now();
+    for (unsigned int r = 0; r < rounds; r++)
+	tcap->timerTick(Time());
+    t = Time::now() - t;
+    Output("Timer ticks with %u open dialogues: %u ticks in " FMT64U " ms, " FMT64U " us per tick",
+	count,rounds,t / 1000,t / rounds);
+    NamedList status("");
+    tcap->status(status);
+    Output("TCAP status: transactions=%s timers=%s",
+	status.getValue("transactions","?"),status.getValue("timers","?"));
+}
+
+int main(int argc, const char** argv)
+{
+    unsigned int count = (argc > 1) ? ::atoi(argv[1]) : 0;
+    unsigned int rounds = (argc > 2) ? ::atoi(argv[2]) : 0;
+    unsigned int dialogues = (argc > 3) ? ::atoi(argv[3]) : 0;
+    if (!count)
+	count = 1000;
+    if (!rounds)
+	rounds = 20;
+    if (!dialogues)
+	dialogues = 10000;
+    Debugger::enableOutput(true,true);
+    debugLevel(DebugWarn);
+    Output("TCAP load test starting: %u messages, %u rounds",count,rounds);
+    NamedList params("tcapload");
+    SS7TCAP* itu = new LoadTCAP(params);
+    SS7TCAP* ansi = new SS7TCAPANSI(params);
+    LoadUser* ituUser = new LoadUser;
+    LoadUser* ansiUser = new LoadUser;
+    ituUser->attach(itu);
+    ansiUser->attach(ansi);
+
+    // MAP sendRoutingInfoForSM, shortMsgGatewayContext-v3
+    DataBlock mapDialogue = ituDialogue("060704000001001403");
+    DataBlock sri = bytes("8007914477581005f98101ff8207914477581005f8");
+    // CAP InitialDP, CAP-v2-gsmSSF-to-gsmSCF
+    DataBlock capDialogue = ituDialogue("060704000001003201");
+    DataBlock idp = bytes("800101");
+    idp += tlv(0x82,bytes("8390214365870921"));
+    idp += tlv(0x83,bytes("0313214365870900"));
+    idp += tlv(0x85,bytes("0a"));
+    idp += tlv(0x8a,bytes("8490214365870921"));
+    idp += tlv(0xbb,bytes("8002808a"));
+    idp += tlv(0x9c,bytes("03"));
+    idp += tlv(0x9f32,bytes("5284100000000000"));
+    DataBlock loc = tlv(0x81,bytes("7021436587"));
+    loc += tlv(0xa3,bytes("8007220102000001"));
+    idp += tlv(0xbf34,loc);
+    idp += tlv(0x9f35,bytes("914477581005f8"));
+    idp += tlv(0x9f36,bytes("0000000000000000"));
+    idp += tlv(0x9f37,bytes("914477581005f9"));
+    idp += tlv(0x9f38,bytes("9121436587"));
+    idp += tlv(0x9f39,bytes("0221300170000000"));
+    // MAP mo-forwardSM with long user data, several components per message
+    DataBlock mo;
+    for (unsigned char i = 1; i <= 8; i++) {
+	DataBlock param = tlv(0x84,filler(140,i));
+	param += tlv(0x04,filler(60,i << 4));
+	mo += ituInvoke(i,46,param);
+    }
+
+    ObjList mapMsgs, capMsgs, bigMsgs, ansiMsgs;
+    for (unsigned int i = 0; i < count; i++) {
+	mapMsgs.append(new DataBlock(ituBegin(i,mapDialogue,ituInvoke(1,45,sri))));
+	capMsgs.append(new DataBlock(ituBegin(i,capDialogue,ituInvoke(1,0,idp))));
+	bigMsgs.append(new DataBlock(ituBegin(i,mapDialogue,mo)));
+	ansiMsgs.append(new DataBlock(ansiQuery(i,filler(40,i))));
+    }
+    walk(mapMsgs,rounds,false,"MAP SRI-SM");
+    walk(mapMsgs,rounds,true,"MAP SRI-SM");
+    walk(capMsgs,rounds,false,"CAP InitialDP");
+    walk(capMsgs,rounds,true,"CAP InitialDP");
+    walk(bigMsgs,rounds,false,"MAP MO-SM x8");
+    walk(bigMsgs,rounds,true,"MAP MO-SM x8");
+    run(itu,ituUser,mapMsgs,rounds,"MAP SRI-SM");
+    run(itu,ituUser,capMsgs,rounds,"CAP InitialDP");
+    run(itu,ituUser,bigMsgs,rounds,"MAP MO-SM x8");
+    run(ansi,ansiUser,ansiMsgs,rounds,"ANSI Query");
+    ticks(itu,ituUser,mapDialogue,ituInvoke(1,45,sri),dialogues,rounds * 10);
+
+    ituUser->attach(0);
+    ansiUser->attach(0);
+    TelEngine::destruct(ituUser);
+    TelEngine::destruct(ansiUser);
+    TelEngine::destruct(itu);
+    TelEngine::destruct(ansi);
+    Output("TCAP load test stopped");
+    return 0;
+}
+
+/* vi: set ts=8 sw=4 sts=4 noet: */
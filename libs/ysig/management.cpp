@@ -312,6 +312,7 @@ SS7Management::SS7Management(const NamedList& params, unsigned char sio)
     m_changeMsgs = params.getBoolValue(YSTRING("changemsgs"),m_changeMsgs);
     m_changeSets = params.getBoolValue(YSTRING("changesets"),m_changeSets);
     m_neighbours = params.getBoolValue(YSTRING("neighbours"),m_neighbours);
+    scheduleTicks();
 }
 
 
@@ -1105,6 +1106,7 @@ bool SS7Management::postpone(SS7MSU* msu, const SS7Label& label, int txSls,
 	lock();
 	m_pending.add(new SnmPending(msu,label,txSls,interval,global),when);
 	unlock();
+	tickNow();
 	return true;
     }
     TelEngine::destruct(msu);
@@ -1188,6 +1190,22 @@ void SS7Management::timerTick(const Time& when)
     }
 }
 
+u_int64_t SS7Management::nextTick(const Time& when)
+{
+    Lock mylock(this,SignallingEngine::maxLockWait());
+    if (!mylock.locked())
+	return when;
+    // the list is sorted by retransmission time, only the first one is checked
+    ObjList* o = m_pending.skipNull();
+    if (!o)
+	return 0;
+    SnmPending* msg = static_cast<SnmPending*>(o->get());
+    u_int64_t next = 0;
+    msg->earliest(next);
+    msg->global().earliest(next);
+    return next;
+}
+
 bool SS7Management::inhibit(const SS7Label& link, int setFlags, int clrFlags)
 {
     SS7Router* router = YOBJECT(SS7Router,SS7Layer4::network());
@@ -350,7 +350,8 @@ SS7Router::SS7Router(const NamedList& params)
       Mutex(true,"SS7Router"),
       m_changes(0), m_transfer(false), m_phase2(false), m_started(false),
       m_restart(0), m_isolate(0), m_statsMutex(false,"SS7RouterStats"),
-      m_trafficOk(0), m_trafficSent(0), m_routeTest(0), m_testRestricted(false),
+      m_trafficOk(0), m_trafficSent(0), m_routeTest(0), m_rerouteTime(0),
+      m_testRestricted(false),
       m_transferSilent(false), m_checkRoutes(false), m_autoAllowed(false),
       m_sendUnavail(true), m_sendProhibited(true),
       m_rxMsu(0), m_txMsu(0), m_fwdMsu(0), m_failMsu(0), m_congestions(0),
@@ -404,6 +405,7 @@ SS7Router::SS7Router(const NamedList& params)
 	}
 	attach(m_mngmt = YSIGCREATE(SS7Management,&mParams));
     }
+    scheduleTicks();
 }
 
 SS7Router::~SS7Router()
@@ -537,6 +539,7 @@ bool SS7Router::restart()
     m_restart.start();
     m_trafficOk.start();
     unlock();
+    tickNow();
     rerouteFlush();
     return true;
 }
@@ -765,6 +768,33 @@ void SS7Router::timerTick(const Time& when)
     }
 }
 
+u_int64_t SS7Router::nextTick(const Time& when)
+{
+    Lock mylock(this,SignallingEngine::maxLockWait());
+    if (!mylock.locked())
+	return when;
+    u_int64_t next = 0;
+    m_isolate.earliest(next);
+    if (m_started) {
+	m_routeTest.earliest(next);
+	m_trafficOk.earliest(next);
+	m_trafficSent.earliest(next);
+	if (m_rerouteTime && (!next || (m_rerouteTime < next)))
+	    next = m_rerouteTime;
+    }
+    else if (m_restart.started()) {
+	// an STP enters the second restart phase 5 seconds early
+	if (m_transfer && !m_phase2) {
+	    u_int64_t t = (m_restart.fireTime() - 5000 + 1) * 1000;
+	    if (!next || (t < next))
+		next = t;
+	}
+	else
+	    m_restart.earliest(next);
+    }
+    return next;
+}
+
 void SS7Router::restart2()
 {
     Lock mylock(this);
@@ -990,6 +1020,7 @@ void SS7Router::updateRoutes(SS7Layer3* network)
     removeRoutes(network);
     for (unsigned int i = 0; i < YSS7_PCTYPE_COUNT; i++) {
 	SS7PointCode::Type type = (SS7PointCode::Type)(i + 1);
+	ObjList* tail = m_route[i].last();
 	for (ObjList* o = network->m_route[i].skipNull(); o; o = o->skipNext()) {
 	    SS7Route* src = static_cast<SS7Route*>(o->get());
 	    SS7Route* dest = findRoute(type,src->packed());
@@ -1001,12 +1032,15 @@ void SS7Router::updateRoutes(SS7Layer3* network)
 	    }
 	    else {
 		dest = new SS7Route(*src);
-		m_route[i].append(dest);
+		tail = tail->append(dest);
+		routeIndexAdd(type,dest);
 	    }
 	    DDebug(this,DebugAll,"Add route type=%s packed=%u for network (%p,'%s') [%p]",
 		SS7PointCode::lookup(type),src->m_packed,network,network->toString().safe(),this);
 	    dest->attach(network,type);
 	}
+	// priorities may have changed, adjacent routes must be indexed again
+	routeIndexBuild(type);
     }
 }
 
@@ -1036,6 +1070,7 @@ void SS7Router::removeRoutes(SS7Layer3* network)
 			route->m_state = SS7Route::Prohibited;
 			routeChanged(route,type,0,network);
 		}
+		routeIndexRemove(type,route);
 		m_route[i].remove(route,true);
 	    }
 	}
@@ -1225,6 +1260,7 @@ bool SS7Router::setRouteState(SS7PointCode::Type type, unsigned int packedPC, SS
 	route->m_state = state;
 	if (state != SS7Route::Unknown)
 	    routeChanged(route,type,remotePC,network);
+	tickNow();
     }
     return true;
 }
@@ -1269,8 +1305,10 @@ bool SS7Router::setRouteSpecificState(SS7PointCode::Type type, unsigned int pack
 		// controlled reroute for the entire linkset if node is adjacent
 		if (!r->priority())
 		    reroute(l3);
-		else
+		else {
 		    route->reroute();
+		    tickNow();
+		}
 		r->m_state = state;
 	    }
 	}
@@ -1552,6 +1590,7 @@ void SS7Router::checkRoutes(const SS7Layer3* noResume)
 	Debug(this,DebugMild,"Node has become isolated! [%p]",this);
 	m_isolate.start();
 	m_trafficSent.stop();
+	tickNow();
 	// we are in an emergency - uninhibit any possible link
 	for (ObjList* o = m_layer3.skipNull(); o; o = o->skipNext()) {
 	    L3ViewPtr* p = static_cast<L3ViewPtr*>(o->get());
@@ -1612,20 +1651,27 @@ void SS7Router::reroute(const SS7Layer3* network)
 		r->reroute();
 	}
     }
+    tickNow();
 }
 
 // Check if routes have finished controlled rerouting
 void SS7Router::rerouteCheck(const Time& when)
 {
+    u_int64_t next = 0;
     Lock lock(m_routeMutex);
     for (unsigned int i = 0; i < YSS7_PCTYPE_COUNT; i++) {
 	SS7PointCode::Type type = static_cast<SS7PointCode::Type>(i+1);
 	const ObjList* l = getRoutes(type);
 	if (l)
 	    l = l->skipNull();
-	for (; l; l = l->skipNext())
-	    static_cast<SS7Route*>(l->get())->rerouteCheck(when);
+	for (; l; l = l->skipNext()) {
+	    SS7Route* r = static_cast<SS7Route*>(l->get());
+	    r->rerouteCheck(when);
+	    if (r->m_buffering && (!next || (r->m_buffering < next)))
+		next = r->m_buffering;
+	}
     }
+    m_rerouteTime = next;
 }
 
 // Flush the controlled rerouting buffer of all routes
@@ -1799,6 +1845,7 @@ void SS7Router::notify(SS7Layer3* network, int sls)
 			    notifyRoutes(SS7Route::Prohibited,network);
 			sendRestart(network);
 			m_trafficOk.start();
+			tickNow();
 		    }
 		}
 	    }
@@ -1877,8 +1924,10 @@ bool SS7Router::control(NamedList& params)
 	case SS7Router::Restart:
 	    return TelEngine::controlReturn(&params,restart());
 	case SS7Router::Traffic:
-	    if (!m_trafficSent.started())
+	    if (!m_trafficSent.started()) {
 		m_trafficSent.start();
+		tickNow();
+	    }
 	    sendRestart();
 	    // fall through
 	case SS7Router::Status:
@@ -1984,6 +2033,7 @@ bool SS7Router::control(NamedList& params)
 		    // advertise routes and availability to just restarted node
 		    if (!m_trafficSent.started()) {
 			m_trafficSent.start();
+			tickNow();
 			if (m_transfer)
 			    notifyRoutes(SS7Route::KnownState,pc.pack(type));
 			sendRestart(type,pc.pack(type));
@@ -1811,6 +1811,432 @@ void GTT::destroyed()
     SignallingComponent::destroyed();
 }
 
+/**
+ * class PrefixGTT
+ */
+
+// Node of a compiled digit trie, children of a node are stored contiguously
+//  in the order of their digit value
+struct GTTNode
+{
+    u_int16_t mask;      // bit N set if a child exists for digit N
+    unsigned int first;  // index of the first child
+    int rule;            // rule ending at this node, -1 if none
+};
+
+// Digit trie of the rules sharing the same translation, plan and nature
+class GTTTrie : public GenObject
+{
+public:
+    inline GTTTrie(int tt, int np, int nai)
+	: m_tt(tt), m_np(np), m_nai(nai), m_digits(0), m_nodes(0), m_size(0)
+	{ }
+    virtual ~GTTTrie()
+	{ delete[] m_nodes; }
+    inline bool matches(int tt, int np, int nai) const
+	{ return (m_tt < 0 || m_tt == tt) && (m_np < 0 || m_np == np) && (m_nai < 0 || m_nai == nai); }
+    inline bool same(int tt, int np, int nai) const
+	{ return m_tt == tt && m_np == np && m_nai == nai; }
+    inline unsigned int specific() const
+	{ return (m_tt >= 0) + (m_np >= 0) + (m_nai >= 0); }
+    void compile(const String** prefixes, const int* rules, unsigned int count);
+    int find(const char* digits, unsigned int& len) const;
+    int m_tt;
+    int m_np;
+    int m_nai;
+    ObjList m_pending;
+    unsigned int m_digits;
+private:
+    void fill(unsigned int node, const String** prefixes, const int* rules,
+	unsigned int lo, unsigned int hi, unsigned int depth);
+    GTTNode* m_nodes;
+    unsigned int m_size;
+};
+
+namespace TelEngine {
+
+// Compiled table of GTT rules, never changed once built
+class GTTRuleTable : public RefObject
+{
+public:
+    inline GTTRuleTable()
+	: m_results(0), m_count(0)
+	{ }
+    virtual ~GTTRuleTable()
+	{ delete[] m_results; }
+    bool build(const String& rules, const char* source, DebugEnabler* dbg);
+    const String* find(const NamedList& gt, const String& prefix) const;
+    inline unsigned int count() const
+	{ return m_count; }
+private:
+    ObjList m_tries;
+    String* m_results;
+    unsigned int m_count;
+};
+
+};
+
+// Rule waiting to be compiled into a trie
+class GTTPending : public String
+{
+public:
+    inline GTTPending(const String& prefix, int rule)
+	: String(prefix), m_rule(rule)
+	{ }
+    int m_rule;
+};
+
+// Number of set bits in each nibble value
+static const unsigned char s_nibbleBits[16] = {
+    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4
+};
+
+static inline unsigned int bitCount(u_int16_t val)
+{
+    return s_nibbleBits[val & 0x0f] + s_nibbleBits[(val >> 4) & 0x0f] +
+	s_nibbleBits[(val >> 8) & 0x0f] + s_nibbleBits[val >> 12];
+}
+
+// Value of a Global Title digit, -1 if not a digit
+static inline int gtDigit(char c)
+{
+    if (c >= '0' && c <= '9')
+	return c - '0';
+    if (c >= 'a' && c <= 'f')
+	return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+	return c - 'A' + 10;
+    return -1;
+}
+
+// Order rules by prefix, equal prefixes in the order they were loaded
+static int gttCompare(const void* a, const void* b)
+{
+    const GTTPending* p1 = *static_cast<const GTTPending* const*>(a);
+    const GTTPending* p2 = *static_cast<const GTTPending* const*>(b);
+    int res = ::strcmp(p1->c_str(),p2->c_str());
+    if (res)
+	return res;
+    return p1->m_rule - p2->m_rule;
+}
+
+void GTTTrie::compile(const String** prefixes, const int* rules, unsigned int count)
+{
+    delete[] m_nodes;
+    // each digit of each rule adds at most one node
+    m_nodes = new GTTNode[m_digits + 1];
+    m_size = 1;
+    fill(0,prefixes,rules,0,count,0);
+}
+
+// Fill a node from the sorted rules [lo,hi) sharing the first depth digits
+void GTTTrie::fill(unsigned int node, const String** prefixes, const int* rules,
+    unsigned int lo, unsigned int hi, unsigned int depth)
+{
+    m_nodes[node].rule = -1;
+    m_nodes[node].mask = 0;
+    m_nodes[node].first = 0;
+    if (lo < hi && prefixes[lo]->length() == depth) {
+	// duplicates were sorted after the first loaded rule, ignore them
+	m_nodes[node].rule = rules[lo];
+	while (lo < hi && prefixes[lo]->length() == depth)
+	    lo++;
+    }
+    if (lo >= hi)
+	return;
+    u_int16_t mask = 0;
+    for (unsigned int i = lo; i < hi; i++)
+	mask |= (1 << gtDigit(prefixes[i]->at(depth)));
+    unsigned int first = m_size;
+    m_size += bitCount(mask);
+    m_nodes[node].mask = mask;
+    m_nodes[node].first = first;
+    while (lo < hi) {
+	char c = prefixes[lo]->at(depth);
+	unsigned int end = lo + 1;
+	while (end < hi && prefixes[end]->at(depth) == c)
+	    end++;
+	fill(first++,prefixes,rules,lo,end,depth + 1);
+	lo = end;
+    }
+}
+
+// Find the rule with the longest prefix of the digits, spaces are skipped
+int GTTTrie::find(const char* digits, unsigned int& len) const
+{
+    int rule = -1;
+    if (!m_nodes)
+	return rule;
+    unsigned int node = 0;
+    unsigned int depth = 0;
+    for (;;) {
+	const GTTNode& n = m_nodes[node];
+	if (n.rule >= 0) {
+	    rule = n.rule;
+	    len = depth;
+	}
+	while (*digits == ' ')
+	    digits++;
+	int d = gtDigit(*digits++);
+	if (d < 0 || !(n.mask & (1 << d)))
+	    break;
+	node = n.first + bitCount(n.mask & ((1 << d) - 1));
+	depth++;
+    }
+    return rule;
+}
+
+bool GTTRuleTable::build(const String& rules, const char* source, DebugEnabler* dbg)
+{
+    unsigned int lines = 0;
+    for (const char* s = rules.c_str(); s && *s; s++)
+	if (*s == '\n')
+	    lines++;
+    m_results = new String[lines + 1];
+    m_count = 0;
+    unsigned int bad = 0;
+    unsigned int line = 0;
+    GTTTrie* last = 0;
+    ObjList* tail = &m_tries;
+    const char* s = rules.c_str();
+    while (s && *s) {
+	const char* eol = ::strchr(s,'\n');
+	unsigned int n = eol ? (eol - s) : ::strlen(s);
+	String str(s,n);
+	s = eol ? eol + 1 : 0;
+	line++;
+	str.trimBlanks();
+	if (str.null() || str[0] == ';' || str[0] == '#')
+	    continue;
+	// translation:plan:nature:prefix=results
+	int eq = str.find('=');
+	int c1 = str.find(':');
+	int c2 = (c1 >= 0) ? str.find(':',c1 + 1) : -1;
+	int c3 = (c2 >= 0) ? str.find(':',c2 + 1) : -1;
+	if (eq < 0 || c3 < 0 || c3 > eq) {
+	    Debug(dbg,DebugMild,"Invalid GTT rule at %s:%u",TelEngine::c_safe(source),line);
+	    bad++;
+	    continue;
+	}
+	// empty fields match any value, invalid ones are rejected
+	String tmp = str.substr(0,c1).trimBlanks();
+	int tt = tmp.null() ? -1 : tmp.toInteger(-2);
+	tmp = str.substr(c1 + 1,c2 - c1 - 1).trimBlanks();
+	int np = tmp.null() ? -1 : tmp.toInteger(s_numberingPlan,-2);
+	tmp = str.substr(c2 + 1,c3 - c2 - 1).trimBlanks();
+	int nai = tmp.null() ? -1 : tmp.toInteger(s_nai,-2);
+	String prefix = str.substr(c3 + 1,eq - c3 - 1).trimBlanks();
+	prefix.toLower();
+	bool ok = (tt >= -1 && tt < 256) && (np >= -1 && np < 16) && (nai >= -1 && nai < 128);
+	for (unsigned int i = 0; ok && i < prefix.length(); i++)
+	    ok = gtDigit(prefix[i]) >= 0;
+	if (!ok) {
+	    Debug(dbg,DebugMild,"Invalid GTT rule match '%s' at %s:%u",
+		str.substr(0,eq).c_str(),TelEngine::c_safe(source),line);
+	    bad++;
+	    continue;
+	}
+	// consecutive rules usually share the same header
+	GTTTrie* trie = (last && last->same(tt,np,nai)) ? last : 0;
+	for (ObjList* o = m_tries.skipNull(); !trie && o; o = o->skipNext()) {
+	    GTTTrie* t = static_cast<GTTTrie*>(o->get());
+	    if (t->same(tt,np,nai))
+		trie = t;
+	}
+	if (!trie) {
+	    trie = new GTTTrie(tt,np,nai);
+	    tail = tail->append(trie);
+	}
+	last = trie;
+	m_results[m_count] = str.substr(eq + 1).trimBlanks();
+	trie->m_pending.insert(new GTTPending(prefix,m_count));
+	trie->m_digits += prefix.length();
+	m_count++;
+    }
+    // a partial table would silently drop routes, keep the old one instead
+    if (bad) {
+	Debug(dbg,DebugWarn,"Rejected GTT rules from %s, %u valid, %u invalid",
+	    TelEngine::c_safe(source),m_count,bad);
+	return false;
+    }
+    for (ObjList* o = m_tries.skipNull(); o; o = o->skipNext()) {
+	GTTTrie* trie = static_cast<GTTTrie*>(o->get());
+	unsigned int n = trie->m_pending.count();
+	GTTPending** pending = new GTTPending*[n];
+	unsigned int i = 0;
+	for (ObjList* p = trie->m_pending.skipNull(); p; p = p->skipNext())
+	    pending[i++] = static_cast<GTTPending*>(p->get());
+	::qsort(pending,n,sizeof(GTTPending*),gttCompare);
+	const String** prefixes = new const String*[n];
+	int* ruleIdx = new int[n];
+	for (i = 0; i < n; i++) {
+	    prefixes[i] = pending[i];
+	    ruleIdx[i] = pending[i]->m_rule;
+	    if (i && *pending[i] == *pending[i - 1])
+		Debug(dbg,DebugMild,"Duplicate GTT rule prefix '%s' in %s, using the first one",
+		    pending[i]->c_str(),TelEngine::c_safe(source));
+	}
+	trie->compile(prefixes,ruleIdx,n);
+	delete[] ruleIdx;
+	delete[] prefixes;
+	delete[] pending;
+	trie->m_pending.clear();
+    }
+    Debug(dbg,DebugInfo,"Loaded %u GTT rules in %u tries from %s",
+	m_count,m_tries.count(),TelEngine::c_safe(source));
+    return true;
+}
+
+// Find the longest match, on equal length the more specific header wins
+const String* GTTRuleTable::find(const NamedList& gt, const String& prefix) const
+{
+    const String* digits = gt.getParam(prefix + ".gt");
+    if (!digits)
+	return 0;
+    int tt = gt.getIntValue(prefix + ".gt.translation",-1);
+    int np = gt.getIntValue(prefix + ".gt.plan",s_numberingPlan,-1);
+    int nai = gt.getIntValue(prefix + ".gt.nature",s_nai,-1);
+    int rule = -1;
+    unsigned int len = 0;
+    unsigned int spec = 0;
+    for (ObjList* o = m_tries.skipNull(); o; o = o->skipNext()) {
+	const GTTTrie* trie = static_cast<const GTTTrie*>(o->get());
+	if (!trie->matches(tt,np,nai))
+	    continue;
+	unsigned int l = 0;
+	int r = trie->find(digits->c_str(),l);
+	if (r < 0)
+	    continue;
+	if (rule < 0 || l > len || (l == len && trie->specific() > spec)) {
+	    rule = r;
+	    len = l;
+	    spec = trie->specific();
+	}
+    }
+    return (rule >= 0) ? &m_results[rule] : 0;
+}
+
+PrefixGTT::PrefixGTT(const NamedList& config)
+    : SignallingComponent(config.safe("GTT"),&config,"ss7-gtt"),
+      GTT(config),
+      m_tableMutex(false,"PrefixGTT"),
+      m_table(0)
+{
+}
+
+PrefixGTT::~PrefixGTT()
+{
+    TelEngine::destruct(m_table);
+}
+
+bool PrefixGTT::initialize(const NamedList* config)
+{
+    if (config) {
+	const String& file = (*config)[YSTRING("rules")];
+	if (file)
+	    loadRules(file);
+	else {
+	    // rules removed from configuration
+	    Lock lock(m_tableMutex);
+	    GTTRuleTable* old = m_table;
+	    m_table = 0;
+	    lock.drop();
+	    if (old)
+		Debug(this,DebugInfo,"Cleared %u GTT rules",old->count());
+	    TelEngine::destruct(old);
+	}
+    }
+    return GTT::initialize(config);
+}
+
+bool PrefixGTT::loadRules(const String& file)
+{
+    File f;
+    if (!f.openPath(file)) {
+	Debug(this,DebugWarn,"Failed to open GTT rules file '%s': %d",file.c_str(),f.error());
+	return false;
+    }
+    int64_t len = f.length();
+    if (len < 0 || len > 0x7fffffff) {
+	Debug(this,DebugWarn,"Failed to get the size of GTT rules file '%s'",file.c_str());
+	return false;
+    }
+    DataBlock buf(0,(unsigned int)len);
+    if (len && f.readData(buf.data(),(int)len) != (int)len) {
+	Debug(this,DebugWarn,"Failed to read GTT rules file '%s': %d",file.c_str(),f.error());
+	return false;
+    }
+    return setRules(String((const char*)buf.data(),(int)len),file);
+}
+
+bool PrefixGTT::setRules(const String& rules, const char* source)
+{
+    GTTRuleTable* table = new GTTRuleTable;
+    if (!table->build(rules,source,this)) {
+	TelEngine::destruct(table);
+	return false;
+    }
+    // readers keep a reference to the old table while translating
+    Lock lock(m_tableMutex);
+    GTTRuleTable* old = m_table;
+    m_table = table;
+    lock.drop();
+    TelEngine::destruct(old);
+    return true;
+}
+
+unsigned int PrefixGTT::rules()
+{
+    Lock lock(m_tableMutex);
+    return m_table ? m_table->count() : 0;
+}
+
+NamedList* PrefixGTT::routeGT(const NamedList& gt, const String& prefix, const String& nextPrefix)
+{
+    Lock lock(m_tableMutex);
+    RefPointer<GTTRuleTable> table = m_table;
+    lock.drop();
+    if (!table)
+	return 0;
+    const String* res = table->find(gt,prefix);
+    if (!res)
+	return 0;
+    NamedList* route = new NamedList(toString());
+    route->copySubParams(gt,prefix + ".");
+    int strip = 0;
+    String prepend;
+    bool rewrite = false;
+    ObjList* list = res->split(',',false);
+    for (ObjList* o = list->skipNull(); o; o = o->skipNext()) {
+	String* s = static_cast<String*>(o->get());
+	int pos = s->find('=');
+	if (pos <= 0)
+	    continue;
+	String name = s->substr(0,pos).trimBlanks();
+	String value = s->substr(pos + 1).trimBlanks();
+	if (name == YSTRING("strip")) {
+	    strip = value.toInteger(0,0,0);
+	    rewrite = true;
+	}
+	else if (name == YSTRING("prepend")) {
+	    prepend = value;
+	    rewrite = true;
+	}
+	else
+	    route->setParam(name,value);
+    }
+    TelEngine::destruct(list);
+    if (rewrite) {
+	const String& digits = (*route)[YSTRING("gt")];
+	if (strip > (int)digits.length())
+	    strip = digits.length();
+	route->setParam("gt",prepend + digits.substr(strip));
+    }
+    XDebug(this,DebugAll,"Translated GT '%s' to route '%s' [%p]",
+	gt.getValue(prefix + ".gt"),res->c_str(),this);
+    return route;
+}
+
 /**
  * SCCPManagement
  */
@@ -1821,6 +2247,7 @@ SCCPManagement::SCCPManagement(const NamedList& params, SS7PointCode::Type type)
     m_subsystemFailure(0), m_routeFailure(0), m_autoAppend(false), m_printMessages(false)
 {
     DDebug(DebugAll,"Creating SCCP management (%p)",this);
+    scheduleTicks();
     // stat.info timer
     m_testTimeout = params.getIntValue(YSTRING("test-timer"),5000);
     if (m_testTimeout < 5000)
@@ -2179,6 +2606,7 @@ void SCCPManagement::handleCoordinateChanged(unsigned char ssn, int smi, const N
     sub->startCoord();
     sub->setState(WaitForGrant);
     TelEngine::destruct(sub);
+    tickNow();
 }
 
 SccpRemote* SCCPManagement::getRemoteSccp(int pointcode)
@@ -2383,6 +2811,19 @@ void SCCPManagement::timerTick(const Time& when)
     }
 }
 
+u_int64_t SCCPManagement::nextTick(const Time& when)
+{
+    Lock mylock(this,SignallingEngine::maxLockWait());
+    if (!mylock.locked())
+	return when;
+    u_int64_t next = 0;
+    for (ObjList* o = m_localSubsystems.skipNull();o;o = o->skipNext())
+	static_cast<SccpLocalSubsystem*>(o->get())->earliest(next);
+    for (ObjList* o = m_statusTest.skipNull();o;o = o->skipNext())
+	static_cast<SubsystemStatusTest*>(o->get())->earliest(next);
+    return next;
+}
+
 void SCCPManagement::stopSst(SccpRemote* remoteSccp, SccpSubsystem* rSubsystem, SccpSubsystem* less)
 {
     if (!remoteSccp)
@@ -2433,6 +2874,7 @@ void SCCPManagement::startSst(SccpRemote* remoteSccp, SccpSubsystem* rSubsystem)
     }
     m_statusTest.append(sst);
     lock.drop();
+    tickNow();
     if (!sendSST(remoteSccp,rSubsystem))
 	sst->setAllowed(false);
 }
@@ -2537,6 +2979,7 @@ void SCCPManagement::sccpUnavailable(const SS7PointCode& pointcode, unsigned cha
 	TelEngine::destruct(sub);
 	m_statusTest.append(sst);
 	sst->setAllowed(false);
+	tickNow();
     }
     lock.drop();
     localBroadcast(SCCP::StatusIndication,rsccp->getPackedPointcode(),-1,SccpRemoteInaccessible);
@@ -2594,6 +3037,13 @@ bool SccpLocalSubsystem::timeout()
     return false;
 }
 
+void SccpLocalSubsystem::earliest(u_int64_t& usec)
+{
+    Lock lock(this);
+    m_coordTimer.earliest(usec);
+    m_ignoreTestsTimer.earliest(usec);
+}
+
 void SccpLocalSubsystem::manageTimeout(SCCPManagement* mgm)
 {
     if (!mgm)
@@ -2814,6 +3264,7 @@ SS7SCCP::SS7SCCP(const NamedList& params)
     m_printMsg(false), m_extendedDebug(false), m_endpoint(true)
 {
     DDebug(this,DebugInfo,"Creating new SS7SCCP [%p]",this);
+    scheduleTicks();
 #ifdef DEBUG
     if (debugAt(DebugAll)) {
 	String tmp;
@@ -2947,6 +3398,21 @@ void SS7SCCP::timerTick(const Time& when)
    unlock();
 }
 
+u_int64_t SS7SCCP::nextTick(const Time& when)
+{
+    Lock mylock(this,SignallingEngine::maxLockWait());
+    if (!mylock.locked())
+	return when;
+    // reassembly expires strictly after its time
+    u_int64_t next = 0;
+    for (ObjList* o = m_reassembleList.skipNull(); o; o = o->skipNext()) {
+	u_int64_t t = static_cast<SS7MsgSccpReassemble*>(o->get())->expireTime();
+	if (t && (!next || (t < next)))
+	    next = t;
+    }
+    return next ? (next + 1) * 1000 : 0;
+}
+
 void SS7SCCP::ajustMessageParams(NamedList& params, SS7MsgSCCP::Type type)
 {
     if (type == SS7MsgSCCP::UDT || type == SS7MsgSCCP::UDTS)
@@ -3579,6 +4045,7 @@ SS7MsgSccpReassemble::Return SS7SCCP::reassembleSegment(SS7MsgSCCP* segment,
 	}
 	SS7MsgSccpReassemble* reass = new SS7MsgSccpReassemble(segment,label,m_segTimeout);
 	m_reassembleList.append(reass);
+	tickNow();
 	return SS7MsgSccpReassemble::Accepted;
     }
 
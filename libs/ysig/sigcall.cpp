@@ -27,6 +27,9 @@
 
 using namespace TelEngine;
 
+// Circuits with local codes below this value are found by direct indexing
+#define CIC_INDEX_MAX 65536
+
 const TokenDict SignallingCircuit::s_lockNames[] = {
     {"localhw",            LockLocalHWFail},
     {"localmaint",         LockLocalMaint},
@@ -741,6 +744,7 @@ SignallingCircuitGroup::SignallingCircuitGroup(unsigned int base, int strategy,
     : SignallingComponent(name),
       Mutex(true,"SignallingCircuitGroup"),
       m_range(String::empty(),name,strategy),
+      m_index(false,64),
       m_base(base)
 {
     setName(name);
@@ -766,6 +770,8 @@ SignallingCircuit* SignallingCircuitGroup::find(unsigned int cic, bool local)
     Lock mylock(this);
     if (cic >= m_range.m_last)
 	return 0;
+    if (cic < CIC_INDEX_MAX)
+	return static_cast<SignallingCircuit*>(m_index.at(cic));
     ObjList* l = m_circuits.skipNull();
     for (; l; l = l->skipNext()) {
 	SignallingCircuit* c = static_cast<SignallingCircuit*>(l->get());
@@ -804,6 +810,11 @@ bool SignallingCircuitGroup::insert(SignallingCircuit* circuit)
     circuit->m_group = this;
     m_circuits.append(circuit);
     m_range.add(circuit->code());
+    if (circuit->code() < CIC_INDEX_MAX) {
+	if (circuit->code() >= m_index.length())
+	    m_index.resize(circuit->code() + 1,true);
+	m_index.set(circuit,circuit->code());
+    }
     return true;
 }
 
@@ -815,6 +826,8 @@ void SignallingCircuitGroup::remove(SignallingCircuit* circuit)
     Lock mylock(this);
     if (!m_circuits.remove(circuit,false))
 	return;
+    if (circuit->code() < CIC_INDEX_MAX)
+	m_index.take(circuit->code());
     circuit->m_group = 0;
     m_range.remove(circuit->code());
     // TODO: remove from all ranges
@@ -1112,6 +1125,7 @@ void SignallingCircuitGroup::clearAll()
     }
     m_circuits.clear();
     m_ranges.clear();
+    m_index.clear();
 }
 
 
@@ -1016,6 +1016,19 @@ static const TokenDict s_m2pa_dict_control[] = {
     { 0, 0 }
 };
 
+// Requests a tick of a scheduled component when leaving the current scope
+class TickOnExit
+{
+public:
+    inline TickOnExit(SignallingComponent* comp)
+	: m_comp(comp)
+	{ }
+    inline ~TickOnExit()
+	{ m_comp->tickNow(); }
+private:
+    SignallingComponent* m_comp;
+};
+
 SS7M2PA::SS7M2PA(const NamedList& params)
     : SignallingComponent(params.safe("SS7M2PA"),&params,"ss7-m2pa"),
       SIGTRAN(5,3565),
@@ -1054,6 +1067,7 @@ SS7M2PA::SS7M2PA(const NamedList& params)
 	m_maxQueueSize = 16;
     if (m_maxQueueSize > 65356)
 	m_maxQueueSize = 65356;
+    scheduleTicks();
     DDebug(this,DebugAll,"Creating SS7M2PA [%p]",this);
 }
 
@@ -1142,6 +1156,8 @@ bool SS7M2PA::processMSG(unsigned char msgVersion, unsigned char msgClass,
     }
     if (m_dumpMsg)
 	dumpMsg(msgVersion,msgClass,msgType,msg,streamId,false);
+    // received messages change timers, check them after releasing the lock
+    TickOnExit tick(this);
     Lock lock(m_mutex);
     if (!operational() && msgType == UserData)
 	return false;
@@ -1307,6 +1323,24 @@ void SS7M2PA::timerTick(const Time& when)
     }
 }
 
+u_int64_t SS7M2PA::nextTick(const Time& when)
+{
+    u_int64_t next = SS7Layer2::nextTick(when);
+    Lock lock(m_mutex,SignallingEngine::maxLockWait());
+    // proving state is retransmitted at random ticks so keep polling
+    if (!lock.locked() || m_t4.started())
+	return when;
+    m_t1.earliest(next);
+    m_t2.earliest(next);
+    m_t3.earliest(next);
+    m_ackTimer.earliest(next);
+    m_confTimer.earliest(next);
+    m_oosTimer.earliest(next);
+    m_waitOosTimer.earliest(next);
+    m_connFailTimer.earliest(next);
+    return next;
+}
+
 bool SS7M2PA::removeFrame(u_int32_t bsn)
 {
     Lock lock(m_mutex);
@@ -1802,6 +1836,7 @@ bool SS7M2PA::transmitMSU(const SS7MSU& msu)
 	dumpMsg(1,M2PA,1,packet,1,true);
     if (!m_ackTimer.started())
 	m_ackTimer.start();
+    tickNow();
     return transmitMSG(1,M2PA,1,packet,1);
 }
 
@@ -38,6 +38,12 @@ static void dumpData(int debugLevel, SS7TCAP* tcap, String message, void* obj, N
 	    message.safe(),obj,tmp.c_str(),str.c_str());
     }
 }
+
+static void dumpData(int debugLevel, SS7TCAP* tcap, String message, void* obj, NamedList& params,
+		    const AsnCursor& data)
+{
+    dumpData(debugLevel,tcap,message,obj,params,DataBlock(data.data(),data.length()));
+}
 #endif
 
 TCAPUser::~TCAPUser()
@@ -204,6 +210,98 @@ static void compPrefix(String& prefix, unsigned int index, bool endSep = false)
     prefix << "." << index << (endSep ? "." : "");
 }
 
+namespace TelEngine {
+
+// Pending check of a transaction, identified by its local ID
+class SS7TCAPTimerEntry : public String
+{
+public:
+    inline SS7TCAPTimerEntry(const String& tid, u_int64_t when)
+	: String(tid), m_when(when)
+	{ }
+    u_int64_t m_when;
+};
+
+// Hashed timer wheel of transaction checks. Entries are never cancelled,
+//  a transaction rescheduled or removed leaves a stale entry behind which
+//  is dropped when it expires
+class SS7TCAPTimers
+{
+public:
+    SS7TCAPTimers(unsigned int slots, unsigned int tick);
+    ~SS7TCAPTimers();
+    void add(const String& tid, u_int64_t when);
+    SS7TCAPTimerEntry* get(u_int64_t now);
+    inline unsigned int count() const
+	{ return m_count; }
+    inline unsigned int tick() const
+	{ return m_tick; }
+private:
+    ObjList* m_slots;
+    unsigned int m_size;
+    unsigned int m_tick;
+    u_int64_t m_next;
+    unsigned int m_count;
+};
+
+};
+
+SS7TCAPTimers::SS7TCAPTimers(unsigned int slots, unsigned int tick)
+    : m_slots(0), m_size(slots), m_tick(tick), m_next(0), m_count(0)
+{
+    m_slots = new ObjList[m_size];
+}
+
+SS7TCAPTimers::~SS7TCAPTimers()
+{
+    delete[] m_slots;
+}
+
+// Insert an entry, the wheel position is never in the already visited past
+void SS7TCAPTimers::add(const String& tid, u_int64_t when)
+{
+    u_int64_t tick = when / m_tick;
+    if (tick < m_next)
+	tick = m_next;
+    m_slots[tick % m_size].insert(new SS7TCAPTimerEntry(tid,when));
+    m_count++;
+}
+
+// Retrieve and remove one expired entry, visits only the slots of elapsed ticks
+SS7TCAPTimerEntry* SS7TCAPTimers::get(u_int64_t now)
+{
+    u_int64_t tick = now / m_tick;
+    if (tick >= m_next + m_size)
+	m_next = tick - m_size + 1;
+    for (;;) {
+	for (ObjList* l = m_slots[m_next % m_size].skipNull(); l; l = l->skipNext()) {
+	    SS7TCAPTimerEntry* e = static_cast<SS7TCAPTimerEntry*>(l->get());
+	    if (e->m_when <= now) {
+		l->remove(false);
+		m_count--;
+		return e;
+	    }
+	}
+	if (m_next >= tick)
+	    return 0;
+	m_next++;
+    }
+}
+
+// Schedules a transaction check when leaving a request or message processing method
+class TCAPCheckTransaction
+{
+public:
+    inline TCAPCheckTransaction(SS7TCAP* tcap, const NamedList& params)
+	: m_tcap(tcap), m_params(params)
+	{ }
+    inline ~TCAPCheckTransaction()
+	{ m_tcap->checkTransaction(m_params[s_tcapLocalTID]); }
+private:
+    SS7TCAP* m_tcap;
+    const NamedList& m_params;
+};
+
 /**
  * SS7TCAP implementation
  */
@@ -266,12 +364,16 @@ SS7TCAP::SS7TCAP(const NamedList& params)
       m_remoteTypePC(SS7PointCode::Other),
       m_trTimeout(300),
       m_transactionsMtx(true,"TCAPTransactions"),
+      m_transactions(1024),
+      m_timers(0),
       m_tcapType(UnknownTCAP),
       m_idsPool(0)
 {
     Debug(this,DebugAll,"SS7TCAP::SS7TCAP() [%p] created",this);
     m_recvMsgs = m_sentMsgs = m_discardMsgs = m_normalMsgs = m_abnormalMsgs = 0;
     m_ssnStatus = SCCPManagement::UserOutOfService;
+    m_timers = new SS7TCAPTimers(1024,100);
+    scheduleTicks();
 }
 
 SS7TCAP::~SS7TCAP()
@@ -291,6 +393,7 @@ SS7TCAP::~SS7TCAP()
 	m_users.setDelete(false);
     }
     m_transactions.clear();
+    delete m_timers;
     m_inQueue.clear();
 
 }
@@ -498,6 +601,8 @@ void SS7TCAP::enqueue(SS7TCAPMessage* msg)
     Lock lock(m_inQueueMtx);
     m_inQueue.append(msg);
     XDebug(this,DebugAll,"SS7TCAP::enqueue(). Enqueued transaction wrapper (%p) [%p]",msg,this);
+    lock.drop();
+    tickNow();
 }
 
 SS7TCAPMessage* SS7TCAP::dequeue()
@@ -590,6 +695,9 @@ void SS7TCAP::status(NamedList& status)
     status.setParam("totalDiscarded",String(m_discardMsgs));
     status.setParam("totalNormal",String(m_normalMsgs));
     status.setParam("totalAbnormal",String(m_abnormalMsgs));
+    Lock lock(m_transactionsMtx);
+    status.setParam("transactions",String(m_transactions.count()));
+    status.setParam("timers",String(m_timers->count()));
 }
 
 void SS7TCAP::userStatus(NamedList& status)
@@ -599,11 +707,8 @@ void SS7TCAP::userStatus(NamedList& status)
 
 SS7TCAPTransaction* SS7TCAP::getTransaction(const String& tid)
 {
-    SS7TCAPTransaction* tr = 0;
     Lock lock(m_transactionsMtx);
-    ObjList* o = m_transactions.find(tid);
-    if (o)
-	tr = static_cast<SS7TCAPTransaction*>(o->get());
+    SS7TCAPTransaction* tr = static_cast<SS7TCAPTransaction*>(m_transactions[tid]);
     if (tr && tr->ref())
 	return tr;
     return 0;
@@ -612,7 +717,35 @@ SS7TCAPTransaction* SS7TCAP::getTransaction(const String& tid)
 void SS7TCAP::removeTransaction(SS7TCAPTransaction* tr)
 {
     Lock lock(m_transactionsMtx);
-    m_transactions.remove(tr);
+    m_transactions.remove(tr,true,true);
+}
+
+void SS7TCAP::addTransaction(SS7TCAPTransaction* tr)
+{
+    if (!(tr && tr->ref()))
+	return;
+    Lock lock(m_transactionsMtx);
+    m_transactions.append(tr);
+}
+
+void SS7TCAP::checkTransaction(const String& tid)
+{
+    if (tid.null())
+	return;
+    Lock lock(m_transactionsMtx);
+    SS7TCAPTransaction* tr = static_cast<SS7TCAPTransaction*>(m_transactions[tid]);
+    if (tr)
+	scheduleTransaction(tr,Time::msecNow());
+}
+
+// Keep only the earliest pending check of a transaction, later ones become stale
+void SS7TCAP::scheduleTransaction(SS7TCAPTransaction* tr, u_int64_t when)
+{
+    if (tr->m_checkTime && tr->m_checkTime <= when)
+	return;
+    tr->m_checkTime = when;
+    m_timers->add(tr->toString(),when);
+    tickAt(when * 1000);
 }
 
 void SS7TCAP::timerTick(const Time& when)
@@ -627,17 +760,24 @@ void SS7TCAP::timerTick(const Time& when)
 	msg = dequeue();
     }
 
-    // update/handle rest of transactions
+    // collect the transactions that changed or whose timers expired
+    u_int64_t now = when.msec();
+    ObjList due;
+    ObjList* tail = &due;
     Lock lock(m_transactionsMtx);
-    ListIterator iter(m_transactions);
-    for (;;) {
-	SS7TCAPTransaction* tr = static_cast<SS7TCAPTransaction*>(iter.get());
-	// End of iteration?
-	if (!tr)
-	    break;
-	if (!tr->ref())
-	    continue;
-	lock.drop();
+    while (SS7TCAPTimerEntry* e = m_timers->get(now)) {
+	SS7TCAPTransaction* tr = static_cast<SS7TCAPTransaction*>(m_transactions[*e]);
+	if (tr && tr->m_checkTime == e->m_when && tr->ref()) {
+	    tr->m_checkTime = 0;
+	    tail = tail->append(tr);
+	}
+	delete e;
+    }
+    lock.drop();
+
+    // update/handle them
+    for (ObjList* o = due.skipNull(); o; o = o->skipNext()) {
+	SS7TCAPTransaction* tr = static_cast<SS7TCAPTransaction*>(o->get());
 	NamedList params("");
 	DataBlock data;
 	if (tr->transactionState() != SS7TCAPTransaction::Idle)
@@ -654,14 +794,32 @@ void SS7TCAP::timerTick(const Time& when)
 	    tr->setState(SS7TCAPTransaction::Idle);
 	}
 
-	if (tr->transactionState() == SS7TCAPTransaction::Idle)
+	if (tr->transactionState() == SS7TCAPTransaction::Idle) {
 	    removeTransaction(tr);
-	TelEngine::destruct(tr);
-	if (!lock.acquire(m_transactionsMtx))
-	    break;
+	    continue;
+	}
+	// timers fire strictly after their timeout time
+	u_int64_t next = tr->nextTimeout();
+	if (!next)
+	    continue;
+	lock.acquire(m_transactionsMtx);
+	scheduleTransaction(tr,next + 1);
+	lock.drop();
     }
 }
 
+u_int64_t SS7TCAP::nextTick(const Time& when)
+{
+    Lock lock(m_inQueueMtx,SignallingEngine::maxLockWait());
+    if (!lock.locked() || m_inQueue.skipNull())
+	return when;
+    lock.drop();
+    lock.acquire(m_transactionsMtx);
+    if (!m_timers->count())
+	return 0;
+    return (when.msec() + m_timers->tick()) * 1000;
+}
+
 HandledMSU SS7TCAP::processSCCPData(SS7TCAPMessage* msg)
 {
     HandledMSU result;
@@ -670,9 +828,12 @@ HandledMSU SS7TCAP::processSCCPData(SS7TCAPMessage* msg)
     XDebug(this,DebugAll,"SS7TCAP::processSCCPData(msg=[%p]) [%p]",msg,this);
 
     NamedList& msgParams = msg->msgParams();
+    TCAPCheckTransaction check(this,msgParams);
     DataBlock& msgData = msg->msgData();
+    // decode in place, the message data is left untouched
+    AsnCursor cursor(msgData);
 
-    SS7TCAPError transactError = decodeTransactionPart(msgParams,msgData);
+    SS7TCAPError transactError = decodeTransactionPart(msgParams,cursor);
     if (transactError.error() != SS7TCAPError::NoError)
 	return handleError(transactError,msgParams,msgData);
 
@@ -702,10 +863,7 @@ HandledMSU SS7TCAP::processSCCPData(SS7TCAPMessage* msg)
 		String newID;
 		allocTransactionID(newID);
 		tr = buildTransaction(type,newID,msgParams,false);
-		tr->ref();
-		m_transactionsMtx.lock();
-		m_transactions.append(tr);
-		m_transactionsMtx.unlock();
+		addTransaction(tr);
 		msgParams.setParam(s_tcapLocalTID,newID);
 	    }
 	    break;
@@ -738,7 +896,7 @@ HandledMSU SS7TCAP::processSCCPData(SS7TCAPMessage* msg)
 	    return result;
     }
     if (tr) {
-	transactError = tr->handleData(msgParams,msgData);
+	transactError = tr->handleData(msgParams,cursor);
 	if (transactError.error() != SS7TCAPError::NoError) {
 	    result = handleError(transactError,msgParams,msgData,tr);
 	    TelEngine::destruct(tr);
@@ -783,6 +941,7 @@ SS7TCAPError SS7TCAP::userRequest(NamedList& params)
 #endif
 
     NamedString* req = params.getParam(s_tcapRequest);
+    TCAPCheckTransaction check(this,params);
 
     NamedString* otid = params.getParam(s_tcapLocalTID);
     NamedString* user = params.getParam(s_tcapUser);
@@ -824,10 +983,7 @@ SS7TCAPError SS7TCAP::userRequest(NamedList& params)
 		tr = buildTransaction((SS7TCAP::TCAPUserTransActions)type,otid,params,true);
 		if (!TelEngine::null(user))
 		    tr->setUserName(user);
-		tr->ref();
-		m_transactionsMtx.lock();
-		m_transactions.append(tr);
-		m_transactionsMtx.unlock();
+		addTransaction(tr);
 		break;
 	    case SS7TCAP::TC_Continue:
 	    case SS7TCAP::TC_ConversationWithPerm:
@@ -1223,7 +1379,8 @@ SS7TCAPTransaction::SS7TCAPTransaction(SS7TCAP* tcap, SS7TCAP::TCAPUserTransActi
 	const String& transactID, NamedList& params, u_int64_t timeout, bool initLocal)
     : Mutex(true,"TcapTransaction"),
       m_tcap(tcap), m_tcapType(SS7TCAP::UnknownTCAP), m_userName(""), m_localID(transactID), m_type(type),
-      m_localSCCPAddr(""), m_remoteSCCPAddr(""), m_basicEnd(true), m_endNow(false), m_timeout(timeout)
+      m_localSCCPAddr(""), m_remoteSCCPAddr(""), m_basicEnd(true), m_endNow(false), m_timeout(timeout),
+      m_checkTime(0)
 {
 
     DDebug(m_tcap,DebugAll,"SS7TCAPTransaction(tcap = '%s' [%p], transactID = %s) created [%p]",
@@ -1262,7 +1419,7 @@ SS7TCAPError SS7TCAPTransaction::update(SS7TCAP::TCAPUserTransActions type, Name
     return error;
 }
 
-SS7TCAPError SS7TCAPTransaction::buildComponentError(SS7TCAPError& error, NamedList& params, DataBlock& data)
+SS7TCAPError SS7TCAPTransaction::buildComponentError(SS7TCAPError& error, NamedList& params, AsnCursor& data)
 {
     if (error.error() == SS7TCAPError::NoError)
 	return error;
@@ -1520,6 +1677,18 @@ void SS7TCAPTransaction::checkComponents()
     }
 }
 
+u_int64_t SS7TCAPTransaction::nextTimeout()
+{
+    Lock l(this);
+    u_int64_t next = m_timeout.fireTime();
+    for (ObjList* o = m_components.skipNull(); o; o = o->skipNext()) {
+	u_int64_t t = static_cast<SS7TCAPComponent*>(o->get())->opTimeout();
+	if (t && (!next || t < next))
+	    next = t;
+    }
+    return next;
+}
+
 void SS7TCAPTransaction::setTransmitState(TransactionTransmit state)
 {
     Lock l(this);
@@ -1573,7 +1742,7 @@ void SS7TCAPTransaction::addSCCPAddressing(NamedList& fillParams, bool local)
     }
 }
 
-SS7TCAPError SS7TCAPTransaction::handleData(NamedList& params, DataBlock& data)
+SS7TCAPError SS7TCAPTransaction::handleData(NamedList& params, AsnCursor& data)
 {
     DDebug(tcap(),DebugAll,"SS7TCAPTransaction::handleData() transactionID=%s data length=%u [%p]",m_localID.c_str(),
 	   data.length(),this);
@@ -1865,7 +2034,7 @@ SS7TCAPTransaction* SS7TCAPANSI::buildTransaction(SS7TCAP::TCAPUserTransActions
     return new SS7TCAPTransactionANSI(this,type,transactID,params,m_trTimeout,initLocal);
 }
 
-SS7TCAPError SS7TCAPANSI::decodeTransactionPart(NamedList& params, DataBlock& data)
+SS7TCAPError SS7TCAPANSI::decodeTransactionPart(NamedList& params, AsnCursor& data)
 {
     SS7TCAPError error(SS7TCAP::ANSITCAP);
     if (data.length() < 2)  // should find out which is the minimal TCAP message length
@@ -1873,7 +2042,7 @@ SS7TCAPError SS7TCAPANSI::decodeTransactionPart(NamedList& params, DataBlock& da
 
     // decode message type
     u_int8_t msgType = data[0];
-    data.cut(-1);
+    data.skip(1);
 
     const PrimitiveMapping* map = mapTransPrimitivesANSI(-1,msgType);
     if (map) {
@@ -1891,7 +2060,7 @@ SS7TCAPError SS7TCAPANSI::decodeTransactionPart(NamedList& params, DataBlock& da
 	error.setError(SS7TCAPError::Transact_IncorrectTransactionPortion);
 	return error; // check it
     }
-    data.cut(-1);
+    data.skip(1);
 
     // if we'll detect an error, it should be a BadlyStructuredTransaction error
     error.setError(SS7TCAPError::Transact_BadlyStructuredTransaction);
@@ -1904,10 +2073,10 @@ SS7TCAPError SS7TCAPANSI::decodeTransactionPart(NamedList& params, DataBlock& da
     String tid1, tid2;
     if (len  > 0 ) {
 	tid1.hexify(data.data(),4,' ');
-	data.cut(-4);
+	data.skip(4);
 	if (len == 8) {
 	    tid2.hexify(data.data(),4,' ');
-	    data.cut(-4);
+	    data.skip(4);
 	}
     }
     switch (msgType) {
@@ -2020,7 +2189,7 @@ SS7TCAPTransactionANSI::~SS7TCAPTransactionANSI()
 	   m_localID.c_str(),m_userName.c_str(),tcap()->refcount(),this);
 }
 
-SS7TCAPError SS7TCAPTransactionANSI::handleData(NamedList& params, DataBlock& data)
+SS7TCAPError SS7TCAPTransactionANSI::handleData(NamedList& params, AsnCursor& data)
 {
     XDebug(tcap(),DebugAll,"SS7TCAPTransactionANSI::handleData() transactionID=%s data length=%u [%p]",m_localID.c_str(),
 	   data.length(),this);
@@ -2141,7 +2310,7 @@ SS7TCAPError SS7TCAPTransactionANSI::update(SS7TCAP::TCAPUserTransActions type,
     return error;
 }
 
-SS7TCAPError SS7TCAPTransactionANSI::decodeDialogPortion(NamedList& params, DataBlock& data)
+SS7TCAPError SS7TCAPTransactionANSI::decodeDialogPortion(NamedList& params, AsnCursor& data)
 {
     XDebug(tcap(),DebugAll,"SS7TCAPTransactionANSI::decodeDialogPortion() for transaction with localID=%s [%p]",
 	m_localID.c_str(),this);
@@ -2152,7 +2321,7 @@ SS7TCAPError SS7TCAPTransactionANSI::decodeDialogPortion(NamedList& params, Data
     // dialog is not present
     if (tag != SS7TCAPANSI::DialogPortionTag) // 0xf9
 	return error;
-    data.cut(-1);
+    data.skip(1);
 
     // dialog portion is present, decode dialog length
     int len = ASNLib::decodeLength(data);
@@ -2164,7 +2333,7 @@ SS7TCAPError SS7TCAPTransactionANSI::decodeDialogPortion(NamedList& params, Data
     tag = data[0];
     // check for protocol version
     if (data[0] == SS7TCAPANSI::ProtocolVersionTag) { //0xda
-	data.cut(-1);
+	data.skip(1);
 	// decode protocol version
 	u_int8_t proto;
 	len = ASNLib::decodeUINT8(data,&proto,false);
@@ -2178,7 +2347,7 @@ SS7TCAPError SS7TCAPTransactionANSI::decodeDialogPortion(NamedList& params, Data
     tag = data[0];
     // check for Application Context
     if (tag == SS7TCAPANSI::IntApplicationContextTag || tag == SS7TCAPANSI::OIDApplicationContextTag) { // 0xdb , 0xdc
-	data.cut(-1);
+	data.skip(1);
 	 if (tag == SS7TCAPANSI::IntApplicationContextTag) { //0xdb
 	    u_int64_t val = 0;
 	    len = ASNLib::decodeInteger(data,val,sizeof(int),false);
@@ -2202,7 +2371,7 @@ SS7TCAPError SS7TCAPTransactionANSI::decodeDialogPortion(NamedList& params, Data
     // check for user information
     tag = data[0];
     if (tag == SS7TCAPANSI::UserInformationTag) {// 0xfd
-	data.cut(-1);
+	data.skip(1);
 	len = ASNLib::decodeLength(data);
 	if (len < 0) {
 	    error.setError(SS7TCAPError::Dialog_BadlyStructuredDialoguePortion);
@@ -2214,7 +2383,7 @@ SS7TCAPError SS7TCAPTransactionANSI::decodeDialogPortion(NamedList& params, Data
 	    error.setError(SS7TCAPError::Dialog_BadlyStructuredDialoguePortion);
 	    return error;
 	}
-	data.cut(-1);
+	data.skip(1);
 
 	len = ASNLib::decodeLength(data);
 	if (len < 0 || len > (int)data.length()) {
@@ -2224,7 +2393,7 @@ SS7TCAPError SS7TCAPTransactionANSI::decodeDialogPortion(NamedList& params, Data
 	// direct Reference
 	tag = data[0];
 	if (tag == SS7TCAPANSI::DirectReferenceTag) { // 0x06
-	    data.cut(-1);
+	    data.skip(1);
 	    ASNObjId oid;
 	    len = ASNLib::decodeOID(data,&oid,false);
 	    if (len < 0) {
@@ -2236,7 +2405,7 @@ SS7TCAPError SS7TCAPTransactionANSI::decodeDialogPortion(NamedList& params, Data
 	// data Descriptor
 	tag = data[0];
 	if (tag == SS7TCAPANSI::DataDescriptorTag) { // 0x07
-	    data.cut(-1);
+	    data.skip(1);
 	    String str;
 	    int type;
 	    len = ASNLib::decodeString(data,&str,&type,false);
@@ -2250,18 +2419,16 @@ SS7TCAPError SS7TCAPTransactionANSI::decodeDialogPortion(NamedList& params, Data
 	tag = data[0];
 	if (tag == SS7TCAPANSI::SingleASNTypePEncTag || tag == SS7TCAPANSI::SingleASNTypeCEncTag ||
 	    tag == SS7TCAPANSI::OctetAlignEncTag || tag == SS7TCAPANSI::ArbitraryEncTag) {
-	    data.cut(-1);
+	    data.skip(1);
 	    len = ASNLib::decodeLength(data);
 	    if (len < 0) {
 		error.setError(SS7TCAPError::Dialog_BadlyStructuredDialoguePortion);
 		return error;
 	    }
-	    DataBlock d((void*)data.data(0,len),len);
-	    data.cut(-len);
-
 	    // put encoding context in hexified form
 	    String dataHexified;
-	    dataHexified.hexify(d.data(),d.length(),' ');
+	    dataHexified.hexify(data.data(0,len),len,' ');
+	    data.skip(len);
 	    params.setParam(s_tcapEncodingContent,dataHexified);
 	    // put encoding identifier
 	    switch (tag) {
@@ -2286,7 +2453,7 @@ SS7TCAPError SS7TCAPTransactionANSI::decodeDialogPortion(NamedList& params, Data
     // check for security context
     tag = data[0];
     if (tag == SS7TCAPANSI::IntSecurityContextTag || tag == SS7TCAPANSI::OIDSecurityContextTag) {
-	data.cut(-1);
+	data.skip(1);
 	if (tag == SS7TCAPANSI::IntSecurityContextTag) { //0x80
 	    int val = 0;
 	    len = ASNLib::decodeINT32(data,&val,false);
@@ -2310,7 +2477,7 @@ SS7TCAPError SS7TCAPTransactionANSI::decodeDialogPortion(NamedList& params, Data
     // check for Confidentiality information
     tag = data[0];
     if (tag == SS7TCAPANSI::ConfidentialityTag) { // 0xa2
-	data.cut(-1);
+	data.skip(1);
 	len = ASNLib::decodeLength(data);
 	if (len < 0) {
 	    error.setError(SS7TCAPError::Dialog_BadlyStructuredDialoguePortion);
@@ -2318,7 +2485,7 @@ SS7TCAPError SS7TCAPTransactionANSI::decodeDialogPortion(NamedList& params, Data
 	}
 	tag = data[0];
 	if (tag == SS7TCAPANSI::IntSecurityContextTag || tag == SS7TCAPANSI::OIDSecurityContextTag) {
-	    data.cut(-1);
+	    data.skip(1);
 	    if (tag == SS7TCAPANSI::IntSecurityContextTag) { //0x80
 		int val = 0;
 		len = ASNLib::decodeINT32(data,&val,false);
@@ -2520,13 +2687,13 @@ void SS7TCAPTransactionANSI::encodeDialogPortion(NamedList& params, DataBlock& d
 #endif
 }
 
-SS7TCAPError SS7TCAPTransactionANSI::decodePAbort(SS7TCAPTransaction* tr, NamedList& params, DataBlock& data)
+SS7TCAPError SS7TCAPTransactionANSI::decodePAbort(SS7TCAPTransaction* tr, NamedList& params, AsnCursor& data)
 {
     u_int8_t tag = data[0];
     SS7TCAPError error(SS7TCAP::ANSITCAP);
     if (tag == SS7TCAPANSI::PCauseTag || tag == SS7TCAPANSI::UserAbortPTag ||  tag == SS7TCAPANSI::UserAbortCTag) {
 	SS7TCAPError error(SS7TCAP::ANSITCAP);
-	data.cut(-1);
+	data.skip(1);
 	if (tag == SS7TCAPANSI::PCauseTag) {
 	    u_int8_t pCode = 0;
 	    int len = ASNLib::decodeUINT8(data,&pCode,false);
@@ -2545,7 +2712,7 @@ SS7TCAPError SS7TCAPTransactionANSI::decodePAbort(SS7TCAPTransaction* tr, NamedL
 	    }
 	    String str;
 	    str.hexify(data.data(0,len),len,' ');
-	    data.cut(-len);
+	    data.skip(len);
 	    params.setParam(s_tcapAbortCause,(tag == SS7TCAPANSI::UserAbortPTag ? "userAbortP" : "userAbortC"));
 	    params.setParam(s_tcapAbortInfo,str);
 	    if (tr)
@@ -2619,7 +2786,7 @@ void SS7TCAPTransactionANSI::updateToEnd()
 	setTransactionType(SS7TCAP::TC_Response);
 }
 
-SS7TCAPError SS7TCAPTransactionANSI::decodeComponents(NamedList& params, DataBlock& data)
+SS7TCAPError SS7TCAPTransactionANSI::decodeComponents(NamedList& params, AsnCursor& data)
 {
     XDebug(tcap(),DebugAll,"SS7TCAPTransactionANSI::decodeComponents() [%p] - data length=%u",this,data.length());
 
@@ -2634,7 +2801,7 @@ SS7TCAPError SS7TCAPTransactionANSI::decodeComponents(NamedList& params, DataBlo
 	error.setError(SS7TCAPError::General_IncorrectComponentPortion);
 	return error;
     }
-    data.cut(-1);
+    data.skip(1);
 
     // decode length of component portion
     int len = ASNLib::decodeLength(data);
@@ -2651,7 +2818,7 @@ SS7TCAPError SS7TCAPTransactionANSI::decodeComponents(NamedList& params, DataBlo
 	compCount++;
 	// decode component type
 	u_int8_t compType = data[0];
-	data.cut(-1);
+	data.skip(1);
 
 	// verify component length
 	len = ASNLib::decodeLength(data);
@@ -2666,7 +2833,7 @@ SS7TCAPError SS7TCAPTransactionANSI::decodeComponents(NamedList& params, DataBlo
 	    error.setError(SS7TCAPError::General_BadlyStructuredCompPortion);
 	    break;
 	}
-	data.cut(-1);
+	data.skip(1);
 
 	// obtain component ID(s)
 	u_int16_t compIDs;
@@ -2719,7 +2886,7 @@ SS7TCAPError SS7TCAPTransactionANSI::decodeComponents(NamedList& params, DataBlo
 	// decode Operation Code
 	tag = data[0];
 	if (tag == SS7TCAPANSI::OperationNationalTag || tag == SS7TCAPANSI::OperationPrivateTag) {
-	    data.cut(-1);
+	    data.skip(1);
 
 	    int opCode = 0;
 	    len = ASNLib::decodeINT32(data,&opCode,false);
@@ -2738,7 +2905,7 @@ SS7TCAPError SS7TCAPTransactionANSI::decodeComponents(NamedList& params, DataBlo
 	// decode  Error Code
 	tag = data[0];
 	if (tag == SS7TCAPANSI::ErrorNationalTag || tag == SS7TCAPANSI::ErrorPrivateTag) { // 0xd3, 0xd4
-	    data.cut(-1);
+	    data.skip(1);
 
 	    int errCode = 0;
 	    len = ASNLib::decodeINT32(data,&errCode,false);
@@ -2756,7 +2923,7 @@ SS7TCAPError SS7TCAPTransactionANSI::decodeComponents(NamedList& params, DataBlo
 	// decode Problem
 	tag = data[0];
 	if (tag == SS7TCAPANSI::ProblemCodeTag) { // 0xd5
-	    data.cut(-1);
+	    data.skip(1);
 	    u_int16_t problemCode = 0;
 	    len = ASNLib::decodeUINT16(data,&problemCode,false);
 	    if (len != 2) {
@@ -2769,14 +2936,14 @@ SS7TCAPError SS7TCAPTransactionANSI::decodeComponents(NamedList& params, DataBlo
 	tag = data[0];
 	String dataHexified = "";
 	if (tag == SS7TCAPANSI::ParameterSetTag || tag == SS7TCAPANSI::ParameterSeqTag) { // 0xf2 0x30
-		data.cut(-1);
+		data.skip(1);
 		len = ASNLib::decodeLength(data);
 		if (len < 0 || len > (int)data.length()) {
 		    error.setError(SS7TCAPError::General_BadlyStructuredCompPortion);
 		    break;
 		}
 		DataBlock d((void*)data.data(0,len),len);
-		data.cut(-len);
+		data.skip(len);
 		d.insert(ASNLib::buildLength(d));
 		d.insert(DataBlock(&tag,1));
 		dataHexified.hexify(d.data(),d.length(),' ');
@@ -3112,7 +3279,7 @@ SS7TCAPTransaction* SS7TCAPITU::buildTransaction(SS7TCAP::TCAPUserTransActions t
     return new SS7TCAPTransactionITU(this,type,transactID,params,m_trTimeout,initLocal);
 }
 
-SS7TCAPError SS7TCAPITU::decodeTransactionPart(NamedList& params, DataBlock& data)
+SS7TCAPError SS7TCAPITU::decodeTransactionPart(NamedList& params, AsnCursor& data)
 {
     SS7TCAPError error(SS7TCAP::ITUTCAP);
     if (data.length() < 2)
@@ -3120,7 +3287,7 @@ SS7TCAPError SS7TCAPITU::decodeTransactionPart(NamedList& params, DataBlock& dat
 
     // decode message type
     u_int8_t msgType = data[0];
-    data.cut(-1);
+    data.skip(1);
 
     const PrimitiveMapping* map = mapTransPrimitivesITU(-1,msgType);
     if (map) {
@@ -3165,7 +3332,7 @@ SS7TCAPError SS7TCAPITU::decodeTransactionPart(NamedList& params, DataBlock& dat
 	    error.setError(SS7TCAPError::Transact_IncorrectTransactionPortion);
 	    return error;
 	}
-	data.cut(-1);
+	data.skip(1);
 
 	len = ASNLib::decodeLength(data);
 	if (len < 1 || len > 4 || len > (int)data.length()) {
@@ -3173,7 +3340,7 @@ SS7TCAPError SS7TCAPITU::decodeTransactionPart(NamedList& params, DataBlock& dat
 	    return error;
 	}
 	str.hexify(data.data(),len,' ');
-	data.cut(-len);
+	data.skip(len);
 	params.setParam(s_tcapRemoteTID,str);
     }
 
@@ -3184,7 +3351,7 @@ SS7TCAPError SS7TCAPITU::decodeTransactionPart(NamedList& params, DataBlock& dat
 	    error.setError(SS7TCAPError::Transact_IncorrectTransactionPortion);
 	    return error;
 	}
-	data.cut(-1);
+	data.skip(1);
 
 	len = ASNLib::decodeLength(data);
 	if (len < 1 || len > 4 || len > (int)data.length()) {
@@ -3192,7 +3359,7 @@ SS7TCAPError SS7TCAPITU::decodeTransactionPart(NamedList& params, DataBlock& dat
 	    return error;
 	}
 	str.hexify(data.data(),len,' ');
-	data.cut(-len);
+	data.skip(len);
 	params.setParam(s_tcapLocalTID,str);
     }
 
@@ -3304,7 +3471,7 @@ SS7TCAPTransactionITU::~SS7TCAPTransactionITU()
 	   m_localID.c_str(),m_userName.c_str(),this);
 }
 
-SS7TCAPError SS7TCAPTransactionITU::handleData(NamedList& params, DataBlock& data)
+SS7TCAPError SS7TCAPTransactionITU::handleData(NamedList& params, AsnCursor& data)
 {
     DDebug(tcap(),DebugAll,"SS7TCAPTransactionITU::handleData() transactionID=%s data length=%u [%p]",m_localID.c_str(),
 	   data.length(),this);
@@ -3336,7 +3503,7 @@ SS7TCAPError SS7TCAPTransactionITU::handleData(NamedList& params, DataBlock& dat
     return error;
 }
 
-bool SS7TCAPTransactionITU::testForDialog(DataBlock& data)
+bool SS7TCAPTransactionITU::testForDialog(AsnCursor& data)
 {
     return (data.length() && data[0] == SS7TCAPITU::DialogPortionTag);
 }
@@ -3752,7 +3919,7 @@ void SS7TCAPTransactionITU::encodePAbort(SS7TCAPTransaction* tr, NamedList& para
 #endif
 }
 
-SS7TCAPError SS7TCAPTransactionITU::decodePAbort(SS7TCAPTransaction* tr, NamedList& params, DataBlock& data)
+SS7TCAPError SS7TCAPTransactionITU::decodePAbort(SS7TCAPTransaction* tr, NamedList& params, AsnCursor& data)
 {
     u_int8_t tag = data[0];
     SS7TCAPError error(SS7TCAP::ITUTCAP);
@@ -3762,7 +3929,7 @@ SS7TCAPError SS7TCAPTransactionITU::decodePAbort(SS7TCAPTransaction* tr, NamedLi
     if (!tri)
 	return error;
     if (tag == SS7TCAPITU::PCauseTag) {
-	data.cut(-1);
+	data.skip(1);
 	u_int8_t pCode = 0;
 	int len = ASNLib::decodeUINT8(data,&pCode,false);
 	if (len != 1) {
@@ -3792,7 +3959,7 @@ void SS7TCAPTransactionITU::updateToEnd()
 	m_basicEnd = false;
 }
 
-SS7TCAPError SS7TCAPTransactionITU::decodeDialogPortion(NamedList& params, DataBlock& data)
+SS7TCAPError SS7TCAPTransactionITU::decodeDialogPortion(NamedList& params, AsnCursor& data)
 {
     DDebug(tcap(),DebugAll,"SS7TCAPTransactionITU::decodeDialogPortion() for transaction with localID=%s [%p]",
     m_localID.c_str(),this);
@@ -3803,7 +3970,7 @@ SS7TCAPError SS7TCAPTransactionITU::decodeDialogPortion(NamedList& params, DataB
     // dialog is not present
     if (tag != SS7TCAPITU::DialogPortionTag) // 0x6b
 	return error;
-    data.cut(-1);
+    data.skip(1);
 
     // dialog portion is present, decode dialog length
     int len = ASNLib::decodeLength(data);
@@ -3817,7 +3984,7 @@ SS7TCAPError SS7TCAPTransactionITU::decodeDialogPortion(NamedList& params, DataB
 	error.setError(SS7TCAPError::Dialog_BadlyStructuredDialoguePortion);
 	return error;
     }
-    data.cut(-1);
+    data.skip(1);
 
     len = ASNLib::decodeLength(data);
     if (len < 0 || len > (int)data.length()) {
@@ -3840,7 +4007,7 @@ SS7TCAPError SS7TCAPTransactionITU::decodeDialogPortion(NamedList& params, DataB
 	error.setError(SS7TCAPError::Dialog_BadlyStructuredDialoguePortion);
 	return error;
     }
-    data.cut(-1);
+    data.skip(1);
 
     len = ASNLib::decodeLength(data);
     if (len < 0 || len > (int)data.length()) {
@@ -3853,7 +4020,7 @@ SS7TCAPError SS7TCAPTransactionITU::decodeDialogPortion(NamedList& params, DataB
 	error.setError(SS7TCAPError::Dialog_BadlyStructuredDialoguePortion);
 	return error;
     }
-    data.cut(-1);
+    data.skip(1);
     params.setParam(s_tcapDialoguePduType,lookup(dialogPDU,s_dialogPDUs));
 
     len = ASNLib::decodeLength(data);
@@ -3864,7 +4031,7 @@ SS7TCAPError SS7TCAPTransactionITU::decodeDialogPortion(NamedList& params, DataB
 
     // check for protocol version or abort-source
     if (data[0] == SS7TCAPITU::ProtocolVersionTag) { //0x80 bitstring
-	data.cut(-1);
+	data.skip(1);
 	if (dialogPDU != ABRTDialogTag) {
 	    // decode protocol version
 	    String proto;
@@ -3885,7 +4052,7 @@ SS7TCAPError SS7TCAPTransactionITU::decodeDialogPortion(NamedList& params, DataB
 
     // check for Application Context Tag  length OID tag length
     if (data[0] == SS7TCAPITU::ApplicationContextTag) { // 0xa1
-	data.cut(-1);
+	data.skip(1);
 	len = ASNLib::decodeLength(data);
 	if (len < 0 || len > (int)data.length()) {
 	    error.setError(SS7TCAPError::Dialog_BadlyStructuredDialoguePortion);
@@ -3901,7 +4068,7 @@ SS7TCAPError SS7TCAPTransactionITU::decodeDialogPortion(NamedList& params, DataB
     }
 
     if (data[0] == ResultTag) {
-	data.cut(-1);
+	data.skip(1);
 	len = ASNLib::decodeLength(data);
 	if (len < 0 || len > (int)data.length()) {
 	    error.setError(SS7TCAPError::Dialog_BadlyStructuredDialoguePortion);
@@ -3913,11 +4080,11 @@ SS7TCAPError SS7TCAPTransactionITU::decodeDialogPortion(NamedList& params, DataB
     }
 
     if (data[0] == ResultDiagnosticTag) {
-	data.cut(-1);
+	data.skip(1);
 	len = ASNLib::decodeLength(data);
 	if (data[0] == ResultDiagnosticUserTag || data[0]== ResultDiagnosticProviderTag) {
 	    tag = data[0];
-	    data.cut(-1);
+	    data.skip(1);
 	    len = ASNLib::decodeLength(data);
 	    if (len < 0 || len > (int)data.length()) {
 		error.setError(SS7TCAPError::Dialog_BadlyStructuredDialoguePortion);
@@ -3937,7 +4104,7 @@ SS7TCAPError SS7TCAPTransactionITU::decodeDialogPortion(NamedList& params, DataB
     }
     // check for user information
     if (data[0] == SS7TCAPITU::UserInformationTag) {// 0xfd
-	data.cut(-1);
+	data.skip(1);
 	len = ASNLib::decodeLength(data);
 	if (len < 0) {
 	    error.setError(SS7TCAPError::Dialog_BadlyStructuredDialoguePortion);
@@ -3949,7 +4116,7 @@ SS7TCAPError SS7TCAPTransactionITU::decodeDialogPortion(NamedList& params, DataB
 	    error.setError(SS7TCAPError::Dialog_BadlyStructuredDialoguePortion);
 	    return error;
 	}
-	data.cut(-1);
+	data.skip(1);
 
 	len = ASNLib::decodeLength(data);
 	if (len < 0 || len > (int)data.length()) {
@@ -3960,7 +4127,7 @@ SS7TCAPError SS7TCAPTransactionITU::decodeDialogPortion(NamedList& params, DataB
 	// direct Reference
 	tag = data[0];
 	if (tag == SS7TCAPITU::DirectReferenceTag) { // 0x06
-	    data.cut(-1);
+	    data.skip(1);
 	    ASNObjId oid;
 	    len = ASNLib::decodeOID(data,&oid,false);
 	    if (len < 0) {
@@ -3973,7 +4140,7 @@ SS7TCAPError SS7TCAPTransactionITU::decodeDialogPortion(NamedList& params, DataB
 	// data Descriptor
 	tag = data[0];
 	if (tag == SS7TCAPITU::DataDescriptorTag) { // 0x07
-	    data.cut(-1);
+	    data.skip(1);
 	    String str;
 	    int type;
 	    len = ASNLib::decodeString(data,&str,&type,false);
@@ -3988,18 +4155,16 @@ SS7TCAPError SS7TCAPTransactionITU::decodeDialogPortion(NamedList& params, DataB
 	tag = data[0];
 	if (tag == SS7TCAPITU::SingleASNTypePEncTag || tag == SS7TCAPITU::SingleASNTypeCEncTag ||
 	    tag == SS7TCAPITU::OctetAlignEncTag || tag == SS7TCAPITU::ArbitraryEncTag) {
-	    data.cut(-1);
+	    data.skip(1);
 	    len = ASNLib::decodeLength(data);
 	    if (len < 0) {
 		error.setError(SS7TCAPError::Dialog_BadlyStructuredDialoguePortion);
 		return error;
 	    }
-	    DataBlock d((void*)data.data(0,len),len);
-	    data.cut(-len);
-
 	    // put encoding context in hexified form
 	    String dataHexified;
-	    dataHexified.hexify(d.data(),d.length(),' ');
+	    dataHexified.hexify(data.data(0,len),len,' ');
+	    data.skip(len);
 	    params.setParam(s_tcapEncodingContent,dataHexified);
 	    // put encoding identifier
 	    switch (tag) {
@@ -4179,7 +4344,7 @@ void SS7TCAPTransactionITU::encodeDialogPortion(NamedList& params, DataBlock& da
 #endif
 }
 
-SS7TCAPError SS7TCAPTransactionITU::decodeComponents(NamedList& params, DataBlock& data)
+SS7TCAPError SS7TCAPTransactionITU::decodeComponents(NamedList& params, AsnCursor& data)
 {
     XDebug(tcap(),DebugAll,"SS7TCAPTransactionITU::decodeComponents() [%p] - data length=%u",this,data.length());
 
@@ -4194,7 +4359,7 @@ SS7TCAPError SS7TCAPTransactionITU::decodeComponents(NamedList& params, DataBloc
 	error.setError(SS7TCAPError::General_IncorrectComponentPortion);
 	return error;
     }
-    data.cut(-1);
+    data.skip(1);
 
     // decode length of component portion
     int len = ASNLib::decodeLength(data);
@@ -4211,7 +4376,7 @@ SS7TCAPError SS7TCAPTransactionITU::decodeComponents(NamedList& params, DataBloc
 	compCount++;
 	// decode component type
 	u_int8_t compType = data[0];
-	data.cut(-1);
+	data.skip(1);
 
 	// verify component length
 	len = ASNLib::decodeLength(data);
@@ -4236,7 +4401,7 @@ SS7TCAPError SS7TCAPTransactionITU::decodeComponents(NamedList& params, DataBloc
 		break;
 	    }
 	} else {
-	    data.cut(-1);
+	    data.skip(1);
 
 	    // obtain component ID(s)
 	    len = ASNLib::decodeUINT16(data,&compID,false);
@@ -4252,7 +4417,7 @@ SS7TCAPError SS7TCAPTransactionITU::decodeComponents(NamedList& params, DataBloc
 	    case Invoke:
 		params.setParam(compParam + "." + s_tcapRemoteCID,String(compID));
 		if (data[0] == SS7TCAPITU::LinkedIDTag) {
-		    data.cut(-1);
+		    data.skip(1);
 		    u_int16_t linkID;
 		    len = ASNLib::decodeUINT16(data,&linkID,false);
 		    if (len < 0) {
@@ -4293,19 +4458,19 @@ SS7TCAPError SS7TCAPTransactionITU::decodeComponents(NamedList& params, DataBloc
 	    compType == ReturnResultNotLast) {
 	    tag = data[0];
 	    if (tag == SS7TCAPITU::ParameterSeqTag) {
-		data.cut(-1);
+		data.skip(1);
 		len = ASNLib::decodeLength(data);
 	    }
 	    tag = data[0];
 	    if (tag == SS7TCAPITU::LocalTag) {
-		data.cut(-1);
+		data.skip(1);
 		int opCode = 0;
 		len = ASNLib::decodeINT32(data,&opCode,false);
 		params.setParam(compParam +"." + s_tcapOpCodeType,"local");
 		params.setParam(compParam + "." + s_tcapOpCode,String(opCode));
 	    }
 	    else if (tag == SS7TCAPITU::GlobalTag) {
-		data.cut(-1);
+		data.skip(1);
 		ASNObjId obj;
 		len = ASNLib::decodeOID(data,&obj,false);
 		params.setParam(compParam + "." + s_tcapOpCodeType,"global");
@@ -4321,14 +4486,14 @@ SS7TCAPError SS7TCAPTransactionITU::decodeComponents(NamedList& params, DataBloc
 	if (compType == ReturnError) {
 	    tag = data[0];
 	    if (tag == SS7TCAPITU::LocalTag) {
-		data.cut(-1);
+		data.skip(1);
 		int opCode = 0;
 		len = ASNLib::decodeINT32(data,&opCode,false);
 		params.setParam(compParam + "." + s_tcapErrCodeType,"local");
 		params.setParam(compParam + "." + s_tcapErrCode,String(opCode));
 	    }
 	    else if (tag == SS7TCAPITU::GlobalTag) {
-		data.cut(-1);
+		data.skip(1);
 		ASNObjId obj;
 		len = ASNLib::decodeOID(data,&obj,false);
 		params.setParam(compParam + "." + s_tcapErrCodeType,"global");
@@ -4343,7 +4508,7 @@ SS7TCAPError SS7TCAPTransactionITU::decodeComponents(NamedList& params, DataBloc
 	// decode Problem
 	if (compType == Reject) {
 	    tag = data[0];
-	    data.cut(-1);
+	    data.skip(1);
 	    u_int16_t problemCode = 0x0 | (tag << 8);
 	    u_int8_t code = 0;
 	    len = ASNLib::decodeUINT8(data,&code,false);
@@ -4353,10 +4518,11 @@ SS7TCAPError SS7TCAPTransactionITU::decodeComponents(NamedList& params, DataBloc
 	else {
 	// decode Parameters (Set or Sequence) as payload
 	    int payloadLen = data.length() - (initLength - compLength);
-	    DataBlock d((void*)data.data(0,payloadLen),payloadLen);
-	    data.cut(-payloadLen);
 	    String dataHexified = "";
-	    dataHexified.hexify(d.data(),d.length(),' ');
+	    if (payloadLen > 0) {
+		dataHexified.hexify(data.data(0,payloadLen),payloadLen,' ');
+		data.skip(payloadLen);
+	    }
 	    params.setParam(compParam,dataHexified);
 	}
 	if (initLength - data.length() != compLength) { // check we consumed the announced component length
@@ -45,6 +45,9 @@
  */
 namespace TelEngine {
 
+// ASN.1 library classes
+class AsnCursor;                         // Read cursor over BER encoded data
+
 // Signalling classes
 class SignallingDumper;                  // A generic data dumper
 class SignallingDumpable;                // A component that can dump data
@@ -87,6 +90,8 @@ class SIGAdaptUser;                      // Abstract Adaptation User SIGTRAN
 class ASPUser;                           // Abstract SS7 ASP user interface
 class SCCP;                              // Abstract SS7 SCCP interface
 class GTT;                               // Abstract SCCP Global Title Translation interface
+class PrefixGTT;                         // SCCP Global Title Translation by prefix rules
+class GTTRuleTable;                      // Compiled rules of a prefix GTT
 class SCCPManagement;                    // Abstract SCCP Management interface
 class SCCPUser;                          // Abstract SS7 SCCP user interface
 class TCAPUser;                          // Abstract SS7 TCAP user interface
@@ -96,6 +101,7 @@ class SS7L3User;                         // Abstract user of SS7 layer 3 (networ
 class SS7Layer3;                         // Abstract SS7 layer 3 (network) message transfer part
 class SS7Layer4;                         // Abstract SS7 layer 4 (application) protocol
 class SS7Route;                          // A SS7 MSU route
+class SS7RouteIndex;                     // Hashed index of a SS7 route table
 class SS7Router;                         // Main router for SS7 message transfer and applications
 class SS7M2PA;                           // SIGTRAN MTP2 User Peer-to-Peer Adaptation Layer
 class SS7M2UA;                           // SIGTRAN MTP2 User Adaptation Layer
@@ -128,6 +134,7 @@ class SS7TCAPANSI;                       // SS7 ANSI TCAP implementation
 class SS7TCAPTransactionANSI;            // SS7 TCAP ANSI Transaction
 class SS7TCAPITU;                        // SS7 ITU TCAP implementation
 class SS7TCAPTransactionITU;             // SS7 TCAP ITU Transaction
+class SS7TCAPTimers;                     // Timer wheel of SS7 TCAP transactions
 // ISDN
 class ISDNLayer2;                        // Abstract ISDN layer 2 (Q.921) message transport
 class ISDNLayer3;                        // Abstract ISDN layer 3 (Q.931) message transport
@@ -477,6 +484,18 @@ public:
     inline bool timeout(u_int64_t time = Time::msecNow()) const
 	{ return started() && (m_timeout < time); }
 
+    /**
+     * Lower a deadline to the time this timer will be detected as timed out
+     * @param usec Deadline in usec to update, 0 if not set yet
+     */
+    inline void earliest(u_int64_t& usec) const {
+	    if (!started())
+		return;
+	    u_int64_t t = (m_timeout + 1) * 1000;
+	    if (!usec || t < usec)
+		usec = t;
+	}
+
     /**
      * Retrieve a timer interval from a list of parameters.
      * @param params The list of parameters
@@ -628,7 +647,8 @@ protected:
 
 /**
  * Interface to an abstract signalling component that is managed by an engine.
- * The engine will periodically poll each component to keep them alive.
+ * The engine will periodically poll each component to keep them alive,
+ *  components that schedule their ticks are called only at their deadlines.
  * @short Abstract signalling component that can be managed by the engine
  */
 class YSIG_API SignallingComponent : public RefObject, public DebugEnabler
@@ -713,6 +733,27 @@ public:
     inline const String& componentType() const
 	{ return m_compType; }
 
+    /**
+     * Check if the component's ticks are scheduled by deadline instead of polled
+     * @return True if the component uses deadline scheduling
+     */
+    inline bool tickScheduled() const
+	{ return !m_tickPolled; }
+
+    /**
+     * Request a timerTick() call of a scheduled component no later than a given time.
+     * Can be called from any thread, an earlier pending request is kept
+     * @param usec Absolute time in usec of the requested tick
+     */
+    void tickAt(u_int64_t usec);
+
+    /**
+     * Request a timerTick() call of a scheduled component as soon as possible.
+     * Should be called after receiving data or changing timers outside timerTick()
+     */
+    inline void tickNow()
+	{ tickAt(Time::now()); }
+
 protected:
     /**
      * Constructor with a default empty component name
@@ -770,10 +811,29 @@ protected:
      */
     unsigned long tickSleep(unsigned long usec = 1000000) const;
 
+    /**
+     * Switch the component from being polled on every engine tick to deadline
+     *  scheduling. The engine will call timerTick() only when the time
+     *  returned by nextTick() is reached or after tickAt() or tickNow() requests.
+     * Should be called from the constructor of components that implement nextTick()
+     */
+    void scheduleTicks();
+
+    /**
+     * Retrieve the time when a scheduled component needs the next timerTick().
+     * Called by the engine right after each timerTick() of the component,
+     *  a time not in the future makes the engine poll it at default interval
+     * @param when Time used as base in the last timerTick()
+     * @return Absolute time in usec of the earliest pending timer, 0 if none
+     */
+    virtual u_int64_t nextTick(const Time& when);
+
 private:
     SignallingEngine* m_engine;
     String m_name;
     String m_compType;
+    u_int64_t m_tickTime;
+    bool m_tickPolled;
 };
 
 /**
@@ -963,10 +1023,14 @@ protected:
     ObjList m_components;
 
 private:
+    void tickAt(SignallingComponent* component, u_int64_t usec);
     SignallingThreadPrivate* m_thread;
     SignallingNotifier* m_notifier;
     unsigned long m_usecSleep;
     unsigned long m_tickSleep;
+    Mutex m_tickMutex;                   // Protects the deadlines of scheduled components
+    Semaphore m_tickWake;                // Wakes up the worker before its planned time
+    u_int64_t m_tickNext;                // Planned worker wake up time, 0 while ticking
     static long s_maxLockWait;
 };
 
@@ -2359,6 +2423,7 @@ private:
     ObjList m_spans;                     // The spans belonging to this group
     ObjList m_ranges;                    // Additional circuit ranges
     SignallingCircuitRange m_range;      // Range containing all circuits belonging to this group
+    ObjVector m_index;                   // Circuits indexed by their local code
     unsigned int m_base;
 };
 
@@ -5218,6 +5283,81 @@ private:
 
 };
 
+/**
+ * A SCCP Global Title translator that matches the called party address
+ *  against a table of rules compiled into digit tries. Each rule matches
+ *  a translation type, numbering plan, nature of address and a prefix of
+ *  the Global Title digits, the longest matching prefix wins.
+ * Rules are loaded from a text file, one rule per line:
+ *  translation:plan:nature:prefix=name=value,name=value...
+ * Empty translation, plan or nature match any value. The resulting
+ *  parameters (route, pointcode, ssn, gt...) replace the ones of the called
+ *  party address, the special strip and prepend parameters rewrite the
+ *  Global Title digits.
+ * A new table is built aside and replaces the old one at once so the rules
+ *  can be reloaded while translating.
+ * @short SCCP GTT using a table of prefix rules
+ */
+class YSIG_API PrefixGTT : public GTT
+{
+    YCLASS(PrefixGTT,GTT)
+public:
+    /**
+     * Constructor
+     * @param config Configuration of this component
+     */
+    PrefixGTT(const NamedList& config);
+
+    /**
+     * Destructor
+     */
+    virtual ~PrefixGTT();
+
+    /**
+     * Initialize this GTT, loads the rules file if one is configured or
+     *  clears the rules if none is
+     * @param config Optional configuration parameters override
+     * @return True if the GTT was attached to a SCCP
+     */
+    virtual bool initialize(const NamedList* config);
+
+    /**
+     * Translate a Global Title using the current rules table
+     * @param gt The original global title used for message routing
+     * @param prefix Prefix of the called party address parameters
+     * @param nextPrefix Prefix of the calling party address parameters
+     * @return A new SCCP called party address or null if no rule matched
+     */
+    virtual NamedList* routeGT(const NamedList& gt, const String& prefix, const String& nextPrefix);
+
+    /**
+     * Load the rules from a file and replace the current table
+     * @param file Path of the rules file
+     * @return True if the file was loaded, the old table is kept on failure
+     *  or if any rule is invalid. A file without rules clears the table
+     */
+    bool loadRules(const String& file);
+
+    /**
+     * Compile rules held in a buffer and replace the current table
+     * @param rules Text of the rules, one per line
+     * @param source Name of the rules source used in debug messages
+     * @return True if the rules were compiled, the old table is kept on failure
+     *  or if any rule is invalid. Text without rules clears the table
+     */
+    bool setRules(const String& rules, const char* source = 0);
+
+    /**
+     * Get the number of rules in the current table
+     * @return Number of rules in use
+     */
+    unsigned int rules();
+
+private:
+    Mutex m_tableMutex;
+    GTTRuleTable* m_table;
+};
+
 /**
  * An interface to a SS7 Signalling Connection Control Part
  * @short Abstract SS7 SCCP interface
@@ -5406,6 +5546,13 @@ public:
      */
     inline bool timeout()
 	{ return m_statusInfo.started() && m_statusInfo.timeout(); }
+
+    /**
+     * Lower a deadline to the time this test times out
+     * @param usec Deadline in usec to update, 0 if not set yet
+     */
+    inline void earliest(u_int64_t& usec) const
+	{ m_statusInfo.earliest(usec); }
     /**
      * Get the subsystem who caused this test
      * @return The subsystem for who this test was initiated
@@ -5870,6 +6017,13 @@ protected:
      */
     virtual void timerTick(const Time& when);
 
+    /**
+     * Retrieve the time of the next tick needed by a scheduled layer 2
+     * @param when Time used as base in the last timerTick()
+     * @return Time in usec of the next tick, 0 if no notification is pending
+     */
+    virtual u_int64_t nextTick(const Time& when);
+
     /**
      * Push a received Message Signal Unit up the protocol stack
      * @param msu Message data, starting with Service Indicator Octet
@@ -6240,8 +6394,7 @@ public:
     /**
      * Destructor
      */
-    virtual ~SS7Layer3()
-	 { attach(0); }
+    virtual ~SS7Layer3();
 
     /**
      * Initialize the network layer, connect it to the SS7 router
@@ -6620,10 +6773,35 @@ protected:
     /** Mutex to lock routing list operations */
     Mutex m_routeMutex;
 
-    /** Outgoing point codes serviced by a network (for each point code type) */
+    /** Outgoing point codes serviced by a network (for each point code type).
+     *  Lookups go through a hashed index, keep it in sync when modifying a list */
     ObjList m_route[YSS7_PCTYPE_COUNT];
 
+    /**
+     * Add a route just appended to a route table to the lookup index.
+     * Must be called with m_routeMutex locked
+     * @param type Point Code type of the route table
+     * @param route The route to index
+     */
+    void routeIndexAdd(SS7PointCode::Type type, SS7Route* route);
+
+    /**
+     * Remove a route from the lookup index before removing it from the route table.
+     * Must be called with m_routeMutex locked
+     * @param type Point Code type of the route table
+     * @param route The route to remove from index
+     */
+    void routeIndexRemove(SS7PointCode::Type type, const SS7Route* route);
+
+    /**
+     * Rebuild the lookup index of a route table from scratch.
+     * Must be called with m_routeMutex locked
+     * @param type Point Code type of the route table
+     */
+    void routeIndexBuild(SS7PointCode::Type type);
+
 private:
+    SS7RouteIndex* m_routeIndex[YSS7_PCTYPE_COUNT];
     Mutex m_l3userMutex;                 // Mutex to lock L3 user pointer
     SS7L3User* m_l3user;
     SS7PointCode::Type m_cpType[4];      // Map incoming MSUs net indicators to point code type
@@ -7013,6 +7191,13 @@ protected:
      */
     virtual void timerTick(const Time& when);
 
+    /**
+     * Retrieve the time of the earliest router timer or end of controlled rerouting
+     * @param when Time used as base in the last timerTick()
+     * @return Time in usec of the next tick, 0 if nothing is pending
+     */
+    virtual u_int64_t nextTick(const Time& when);
+
     /**
      * Process a MSU received from the Layer 3 component
      * @param msu Message data, starting with Service Indicator Octet
@@ -7129,6 +7314,7 @@ private:
     SignallingTimer m_trafficOk;
     SignallingTimer m_trafficSent;
     SignallingTimer m_routeTest;
+    u_int64_t m_rerouteTime;
     bool m_testRestricted;
     bool m_transferSilent;
     bool m_checkRoutes;
@@ -7345,6 +7531,13 @@ protected:
      */
     virtual void timerTick(const Time& when);
 
+    /**
+     * Retrieve the time when the earliest M2PA timer expires
+     * @param when Time used as base in the last timerTick()
+     * @return Time in usec of the next tick, 0 if no timer is running
+     */
+    virtual u_int64_t nextTick(const Time& when);
+
     /**
      * Check if the link is aligned.
      * The link may not be operational, the other side may be still proving.
@@ -7651,6 +7844,13 @@ protected:
      */
     virtual void timerTick(const Time& when);
 
+    /**
+     * Retrieve the earliest of the fill in, proving and retransmission times
+     * @param when Time used as base in the last timerTick()
+     * @return Time in usec of the next tick
+     */
+    virtual u_int64_t nextTick(const Time& when);
+
     /**
      * Process a Signalling Packet received by the hardware interface
      * @return True if message was successfully processed
@@ -7924,6 +8124,13 @@ protected:
      */
     virtual void timerTick(const Time& when);
 
+    /**
+     * Retrieve the time of the earliest link check of operational links
+     * @param when Time used as base in the last timerTick()
+     * @return Time in usec of the next link check, 0 if none is pending
+     */
+    virtual u_int64_t nextTick(const Time& when);
+
     /**
      * Callback called from maintenance when valid SLTA or SLTM are received
      * @param sls Link that was checked by maintenance
@@ -8520,6 +8727,13 @@ protected:
      */
     virtual void timerTick(const Time& when);
 
+    /**
+     * Retrieve the time of the earliest retransmission or expiration
+     * @param when Time used as base in the last timerTick()
+     * @return Time in usec of the next tick, 0 if no message is pending
+     */
+    virtual u_int64_t nextTick(const Time& when);
+
 private:
     bool postpone(SS7MSU* msu, const SS7Label& label, int txSls,
 	u_int64_t interval, u_int64_t global = 0, bool force = false, const Time& when = Time());
@@ -8797,6 +9011,7 @@ private:
     bool m_gracefully;                   // Terminate gracefully: send RLC
     bool m_circuitChanged;               // Circuit change flag
     bool m_circuitTesting;               // The circuit is tested for continuity
+    unsigned int m_indexCic;             // Circuit code used to index this call in controller
     bool m_inbandAvailable;              // Inband data is available
     int m_replaceCounter;                // Circuit replace counter
     String m_format;                     // Data format used by the circuit
@@ -9049,6 +9264,14 @@ protected:
      */
     virtual void timerTick(const Time& when);
 
+    /**
+     * Retrieve the time of the earliest user part test, locking, pending
+     *  operation or circuit reset timer
+     * @param when Time used as base in the last timerTick()
+     * @return Time in usec of the next tick, 0 if nothing is pending
+     */
+    virtual u_int64_t nextTick(const Time& when);
+
     /**
      * Process a notification generated by the attached network layer
      * @param link Network or linkset that generated the notification
@@ -9151,6 +9374,12 @@ private:
     // Find a call by its circuit identification code
     // This method is not thread safe
     SS7ISUPCall* findCall(unsigned int cic);
+    // Add a call to the circuit code index or move it after its circuit changed
+    // This method is thread safe
+    void indexCall(SS7ISUPCall* call);
+    // Remove a call from the circuit code index
+    // This method is thread safe
+    void unindexCall(SS7ISUPCall* call);
     // Find a call by its circuit identification code
     // This method is thread safe
     inline void findCall(unsigned int cic, RefPointer<SS7ISUPCall>& call) {
@@ -9236,6 +9465,7 @@ private:
     u_int64_t m_t27Interval;             // Q.764 T27 Reset after Cont. Check failure
     u_int64_t m_t34Interval;             // Q.764 T34 Segmentation receive timout
     SignallingMessageTimerList m_pending;// Pending messages (RSC ...)
+    HashList m_callIndex;                // Calls indexed by circuit code, not owned
     // Remote User Part test
     SignallingTimer m_uptTimer;          // Timer for UPT
     bool m_userPartAvail;                // Flag indicating the remote User Part availability
@@ -9481,6 +9711,13 @@ protected:
      */
     virtual void timerTick(const Time& when);
 
+    /**
+     * Retrieve the time of the earliest subsystem or status test timer
+     * @param when Time used as base in the last timerTick()
+     * @return Time in usec of the next tick, 0 if nothing is pending
+     */
+    virtual u_int64_t nextTick(const Time& when);
+
     inline SS7SCCP* sccp()
 	{ return m_sccp; }
 
@@ -9877,6 +10114,13 @@ public:
     inline bool timeout()
 	{ return m_timeout > 0 ? Time::msecNow() > m_timeout : false; }
 
+    /**
+     * Get the time this reassemble process expires
+     * @return Expiration time in msec, 0 if not set
+     */
+    inline u_int64_t expireTime() const
+	{ return m_timeout; }
+
     /**
      * Helper method to verify if all segments have arrived
      * @return True if all segments arrived
@@ -10055,6 +10299,12 @@ public:
      */
     void setIgnoreTests(bool ignore);
 
+    /**
+     * Lower a deadline to the time a timer of this subsystem fires
+     * @param usec Deadline in usec to update, 0 if not set yet
+     */
+    void earliest(u_int64_t& usec);
+
     /**
      * Check if coordinate change timer has timed out
      * @return True if coordinate change timer has timed out
@@ -10625,6 +10875,13 @@ protected:
      */
     virtual void timerTick(const Time& when);
 
+    /**
+     * Retrieve the time when the oldest message reassembly expires
+     * @param when Time used as base in the last timerTick()
+     * @return Time in usec of the next tick, 0 if nothing is pending
+     */
+    virtual u_int64_t nextTick(const Time& when);
+
     /**
      * Reassemble a message segment
      * @param segment The message segment
@@ -11008,12 +11265,33 @@ public:
      */
     void removeTransaction(SS7TCAPTransaction* tr);
 
+    /**
+     * Add a newly built transaction to the transactions table, keeps a reference to it
+     * @param tr The transaction to add
+     */
+    void addTransaction(SS7TCAPTransaction* tr);
+
+    /**
+     * Schedule a transaction to be checked on the next timer tick,
+     *  should be called after the transaction or its components changed
+     * @param tid Local id of the transaction
+     */
+    void checkTransaction(const String& tid);
+
     /**
      * Method called periodically to do processing and timeout checks
      * @param when Time to use as computing base for events and timeouts
      */
     virtual void timerTick(const Time& when);
 
+    /**
+     * Retrieve the time of the next tick, pending transaction checks are
+     *  visited at the granularity of the timer wheel
+     * @param when Time used as base in the last timerTick()
+     * @return Time in usec of the next tick, 0 if no check is pending
+     */
+    virtual u_int64_t nextTick(const Time& when);
+
     /**
      * Send to TCAP users a decode message
      * @param params Message in NamedList form
@@ -11142,7 +11420,7 @@ public:
 	{ return lookup(comp,s_compPrimitives,TC_Unknown); }
 
 protected:
-    virtual SS7TCAPError decodeTransactionPart(NamedList& params, DataBlock& data) = 0;
+    virtual SS7TCAPError decodeTransactionPart(NamedList& params, AsnCursor& data) = 0;
     virtual void encodeTransactionPart(NamedList& params, DataBlock& data) = 0;
     bool sendSCCPNotify(NamedList& params);
     // list of TCAP users attached to this TCAP instance
@@ -11160,9 +11438,11 @@ protected:
     SS7PointCode::Type m_remoteTypePC;
     u_int64_t m_trTimeout;
 
-    // list of current TCAP transactions
+    // current TCAP transactions, hashed by local transaction ID
     Mutex m_transactionsMtx;
-    ObjList m_transactions;
+    HashList m_transactions;
+    // transactions waiting for their timeouts, locked by m_transactionsMtx
+    SS7TCAPTimers* m_timers;
     // type of TCAP
     TCAPType m_tcapType;
 
@@ -11178,6 +11458,10 @@ protected:
 
     // Subsystem Status
     SCCPManagement::LocalBroadcast m_ssnStatus;
+
+private:
+    // Must be called with m_transactionsMtx locked
+    void scheduleTransaction(SS7TCAPTransaction* tr, u_int64_t when);
 };
 
 class YSIG_API SS7TCAPError
@@ -11309,6 +11593,7 @@ private:
  */
 class YSIG_API SS7TCAPTransaction : public RefObject, public Mutex
 {
+    friend class SS7TCAP;
 public:
     enum TransactionState {
 	Idle                      = 0,
@@ -11346,7 +11631,7 @@ public:
      * @param data Data to decode
      * @return A TCAP error encountered whilst decoding
      */
-    virtual SS7TCAPError handleData(NamedList& params, DataBlock& data) = 0;
+    virtual SS7TCAPError handleData(NamedList& params, AsnCursor& data) = 0;
 
     /**
      * An update request for this transaction
@@ -11369,10 +11654,10 @@ public:
      * Build a Reject component in answer to an encoutered error during decoding of the component portion
      * @param error The encountered error
      * @param params Decoded TCAP message parameters
-     * @param data DataBlock containing the rest of the coded TCAP message
+     * @param data Cursor over the rest of the coded TCAP message
      * @return A report error
      */
-    virtual SS7TCAPError buildComponentError(SS7TCAPError& error, NamedList& params, DataBlock& data);
+    virtual SS7TCAPError buildComponentError(SS7TCAPError& error, NamedList& params, AsnCursor& data);
 
     /**
      * Update components
@@ -11517,6 +11802,12 @@ public:
     inline bool timedOut()
 	{ return m_timeout.timeout(); }
 
+    /**
+     * Get the earliest time at which the transaction or one of its components times out
+     * @return Time in milliseconds of the nearest timeout, 0 if no timer is running
+     */
+    u_int64_t nextTimeout();
+
     /**
      * Find a component with given id
      * @param id Id of component to find
@@ -11543,10 +11834,10 @@ public:
 
     /**
      * @param params NamedList reference to fill with the decoded dialog information
-     * @param data DataBlock reference from which to decode the dialog information
+     * @param data Cursor from which to decode the dialog information, advanced past it
      * @return A TCAP error encountered whilst decoding
      */
-    virtual SS7TCAPError decodeDialogPortion(NamedList& params, DataBlock& data) = 0;
+    virtual SS7TCAPError decodeDialogPortion(NamedList& params, AsnCursor& data) = 0;
 
     /**
      * @param params NamedList reference from which to take the dialog information to encode
@@ -11556,10 +11847,10 @@ public:
 
     /**
      * @param params NamedList reference to fill with the decoded component information
-     * @param data DataBlock reference from which to decode the component information
+     * @param data Cursor from which to decode the component information, advanced past it
      * @return A TCAP error encountered whilst decoding
      */
-    virtual SS7TCAPError decodeComponents(NamedList& params, DataBlock& data) = 0;
+    virtual SS7TCAPError decodeComponents(NamedList& params, AsnCursor& data) = 0;
 
     /**
      * @param params NamedList reference from which to take the component information to encode
@@ -11585,6 +11876,9 @@ protected:
     bool m_basicEnd; // basic or prearranged end (specified by user when sending a Response)
     bool m_endNow; // delete immediately after sending
     SignallingTimer m_timeout;
+
+private:
+    u_int64_t m_checkTime; // time of the pending check in the TCAP timer wheel, 0 if none
 };
 
 /**
@@ -11694,6 +11988,13 @@ public:
     inline bool timedOut()
 	{ return m_opTimer.timeout(); }
 
+    /**
+     * Get the time the operation timer of this component fires
+     * @return Time in milliseconds of the timeout, 0 if the timer is not running
+     */
+    inline u_int64_t opTimeout() const
+	{ return m_opTimer.fireTime(); }
+
     /**
      * Set component state
      * @param state The state to be set
@@ -11815,7 +12116,7 @@ public:
 	bool initLocal = true);
 
 private:
-    SS7TCAPError decodeTransactionPart(NamedList& params, DataBlock& data);
+    SS7TCAPError decodeTransactionPart(NamedList& params, AsnCursor& data);
     void encodeTransactionPart(NamedList& params, DataBlock& data);
 };
 
@@ -11871,7 +12172,7 @@ public:
      * @param data Data to decode
      * @return A TCAP error encountered whilst decoding
      */
-    virtual SS7TCAPError handleData(NamedList& params, DataBlock& data);
+    virtual SS7TCAPError handleData(NamedList& params, AsnCursor& data);
 
     /**
      * An update request for this transaction
@@ -11902,9 +12203,9 @@ public:
      * Decode P-Abort TCAP message portion
      * @param tr The transaction on which the abort was signalled
      * @param params NamedList reference to fill with the decoded P-Abort information
-     * @param data DataBlock reference from which to decode P-Abort information
+     * @param data Cursor from which to decode P-Abort information, advanced past it
      */
-    static SS7TCAPError decodePAbort(SS7TCAPTransaction* tr, NamedList& params, DataBlock& data);
+    static SS7TCAPError decodePAbort(SS7TCAPTransaction* tr, NamedList& params, AsnCursor& data);
 
     /**
      * Update the state of this transaction to end the transaction
@@ -11930,9 +12231,9 @@ public:
     static const TokenDict s_ansiTransactTypes[];
 
 private:
-    SS7TCAPError decodeDialogPortion(NamedList& params, DataBlock& data);
+    SS7TCAPError decodeDialogPortion(NamedList& params, AsnCursor& data);
     void encodeDialogPortion(NamedList& params, DataBlock& data);
-    SS7TCAPError decodeComponents(NamedList& params, DataBlock& data);
+    SS7TCAPError decodeComponents(NamedList& params, AsnCursor& data);
     void encodeComponents(NamedList& params, DataBlock& data);
 
     SS7TCAP::TCAPUserTransActions m_prevType;
@@ -12001,7 +12302,7 @@ public:
 	bool initLocal = true);
 
 private:
-    SS7TCAPError decodeTransactionPart(NamedList& params, DataBlock& data);
+    SS7TCAPError decodeTransactionPart(NamedList& params, AsnCursor& data);
     void encodeTransactionPart(NamedList& params, DataBlock& data);
 };
 
@@ -12077,7 +12378,7 @@ public:
      * @param data Data to decode
      * @return A TCAP error encountered whilst decoding
      */
-    virtual SS7TCAPError handleData(NamedList& params, DataBlock& data);
+    virtual SS7TCAPError handleData(NamedList& params, AsnCursor& data);
 
     /**
      * An update request for this transaction
@@ -12108,10 +12409,10 @@ public:
      * Decode P-Abort TCAP message portion
      * @param tr The transaction on which the abort was signalled
      * @param params NamedList reference to fill with the decoded P-Abort information
-     * @param data DataBlock reference from which to decode P-Abort information
+     * @param data Cursor from which to decode P-Abort information, advanced past it
      * @return A report error
      */
-    static SS7TCAPError decodePAbort(SS7TCAPTransaction* tr, NamedList& params, DataBlock& data);
+    static SS7TCAPError decodePAbort(SS7TCAPTransaction* tr, NamedList& params, AsnCursor& data);
 
     /**
      * Update the state of this transaction to end the transaction
@@ -12130,7 +12431,7 @@ public:
      * @param data Data from which the transaction is decoded
      * @return True if dialog portion is present, false otherwise
      */
-    bool testForDialog(DataBlock& data);
+    bool testForDialog(AsnCursor& data);
 
     /**
      * Encode dialog portion of transaction
@@ -12145,7 +12446,7 @@ public:
      * @param data Data to decodeCaps
      * @return A report error
      */
-    SS7TCAPError decodeDialogPortion(NamedList& params, DataBlock& data);
+    SS7TCAPError decodeDialogPortion(NamedList& params, AsnCursor& data);
 
     /**
      * Update transaction state
@@ -12177,7 +12478,7 @@ public:
     static const TokenDict s_resultPDUValues[];
 
 private:
-    SS7TCAPError decodeComponents(NamedList& params, DataBlock& data);
+    SS7TCAPError decodeComponents(NamedList& params, AsnCursor& data);
     void encodeComponents(NamedList& params, DataBlock& data);
 
     String m_appCtxt;
@@ -13,7 +13,7 @@ ObjectName::ObjectName()
 
 ObjectName::ObjectName(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -21,7 +21,7 @@ ObjectName::~ObjectName()
 {
 }
 
-int ObjectName::decode(DataBlock& data)
+int ObjectName::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeOID(data,&m_ObjectName,true);
@@ -57,7 +57,7 @@ ObjectSyntax::ObjectSyntax(void* data, int len)
 	m_simple = new SimpleSyntax();
 	m_application_wide = new ApplicationSyntax();
 
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -67,7 +67,7 @@ ObjectSyntax::~ObjectSyntax()
 	TelEngine::destruct(m_application_wide);
 }
 
-int ObjectSyntax::decode(DataBlock& data)
+int ObjectSyntax::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = m_simple->decode(data);
@@ -110,7 +110,7 @@ SimpleSyntax::SimpleSyntax()
 
 SimpleSyntax::SimpleSyntax(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -118,7 +118,7 @@ SimpleSyntax::~SimpleSyntax()
 {
 }
 
-int SimpleSyntax::decode(DataBlock& data)
+int SimpleSyntax::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeINT32(data,&m_integer_value,true);
@@ -196,7 +196,7 @@ ApplicationSyntax::ApplicationSyntax(void* data, int len)
 	m_big_counter_value = new Counter64();
 	m_unsigned_integer_value = new Unsigned32();
 
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -210,7 +210,7 @@ ApplicationSyntax::~ApplicationSyntax()
 	TelEngine::destruct(m_unsigned_integer_value);
 }
 
-int ApplicationSyntax::decode(DataBlock& data)
+int ApplicationSyntax::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = m_ipAddress_value->decode(data);
@@ -285,7 +285,7 @@ IpAddress::IpAddress()
 
 IpAddress::IpAddress(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -293,14 +293,14 @@ IpAddress::~IpAddress()
 {
 }
 
-int IpAddress::decode(DataBlock& data)
+int IpAddress::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = -1;
 	if (data.length() < 2)
 		return ASNLib::InvalidLengthOrTag;
 	if (data[0] == tag_IpAddress) {
-		data.cut(-1);
+		data.skip(1);
 		length = ASNLib::decodeOctetString(data,&m_IpAddress,false);
 		if (length != s_IpAddressSize)
 			DDebug(DebugAll,"Constraint break error");
@@ -338,7 +338,7 @@ Counter32::Counter32()
 
 Counter32::Counter32(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -346,14 +346,14 @@ Counter32::~Counter32()
 {
 }
 
-int Counter32::decode(DataBlock& data)
+int Counter32::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = -1;
 	if (data.length() < 2)
 		return ASNLib::InvalidLengthOrTag;
 	if (data[0] == tag_Counter32) {
-		data.cut(-1);
+		data.skip(1);
 		length = ASNLib::decodeUINT32(data,&m_Counter32,false);
 		if (m_Counter32 < s_Counter32MinSize)
 			DDebug(DebugAll,"Constraint break error");
@@ -393,7 +393,7 @@ Unsigned32::Unsigned32()
 
 Unsigned32::Unsigned32(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -401,14 +401,14 @@ Unsigned32::~Unsigned32()
 {
 }
 
-int Unsigned32::decode(DataBlock& data)
+int Unsigned32::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = -1;
 	if (data.length() < 2)
 		return ASNLib::InvalidLengthOrTag;
 	if (data[0] == tag_Unsigned32) {
-		data.cut(-1);
+		data.skip(1);
 		length = ASNLib::decodeUINT32(data,&m_Unsigned32,false);
 		if (m_Unsigned32 < s_Unsigned32MinSize)
 			DDebug(DebugAll,"Constraint break error");
@@ -451,7 +451,7 @@ Gauge32::Gauge32(void* data, int len)
 {
 	m_Gauge32 = new Unsigned32();
 
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -460,7 +460,7 @@ Gauge32::~Gauge32()
 	TelEngine::destruct(m_Gauge32);
 }
 
-int Gauge32::decode(DataBlock& data)
+int Gauge32::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = m_Gauge32->decode(data);
@@ -489,7 +489,7 @@ TimeTicks::TimeTicks()
 
 TimeTicks::TimeTicks(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -497,14 +497,14 @@ TimeTicks::~TimeTicks()
 {
 }
 
-int TimeTicks::decode(DataBlock& data)
+int TimeTicks::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = -1;
 	if (data.length() < 2)
 		return ASNLib::InvalidLengthOrTag;
 	if (data[0] == tag_TimeTicks) {
-		data.cut(-1);
+		data.skip(1);
 		length = ASNLib::decodeUINT32(data,&m_TimeTicks,false);
 		if (m_TimeTicks < s_TimeTicksMinSize)
 			DDebug(DebugAll,"Constraint break error");
@@ -544,7 +544,7 @@ Opaque::Opaque()
 
 Opaque::Opaque(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -552,14 +552,14 @@ Opaque::~Opaque()
 {
 }
 
-int Opaque::decode(DataBlock& data)
+int Opaque::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = -1;
 	if (data.length() < 2)
 		return ASNLib::InvalidLengthOrTag;
 	if (data[0] == tag_Opaque) {
-		data.cut(-1);
+		data.skip(1);
 		length = ASNLib::decodeOctetString(data,&m_Opaque,false);
 	}
 	return length;
@@ -595,7 +595,7 @@ Counter64::Counter64()
 
 Counter64::Counter64(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -603,14 +603,14 @@ Counter64::~Counter64()
 {
 }
 
-int Counter64::decode(DataBlock& data)
+int Counter64::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = -1;
 	if (data.length() < 2)
 		return ASNLib::InvalidLengthOrTag;
 	if (data[0] == tag_Counter64) {
-		data.cut(-1);
+		data.skip(1);
 		length = ASNLib::decodeUINT64(data,&m_Counter64,false);
 		if (m_Counter64 < s_Counter64MinSize)
 			DDebug(DebugAll,"Constraint break error");
@@ -667,7 +667,7 @@ PDUs::PDUs(void* data, int len)
 	m_snmpV2_trap = new SNMPv2_Trap_PDU();
 	m_report = new Report_PDU();
 
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -683,7 +683,7 @@ PDUs::~PDUs()
 	TelEngine::destruct(m_report);
 }
 
-int PDUs::decode(DataBlock& data)
+int PDUs::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = m_get_request->decode(data);
@@ -776,7 +776,7 @@ GetRequest_PDU::GetRequest_PDU()
 GetRequest_PDU::GetRequest_PDU(void* data, int len)
 {
 	m_GetRequest_PDU = new PDU();
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -785,14 +785,14 @@ GetRequest_PDU::~GetRequest_PDU()
 	TelEngine::destruct(m_GetRequest_PDU);
 }
 
-int GetRequest_PDU::decode(DataBlock& data)
+int GetRequest_PDU::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = -1;
 	if (data.length() < 2)
 		return ASNLib::InvalidLengthOrTag;
 	if (data[0] == tag_GetRequest_PDU) {
-		data.cut(-1);
+		data.skip(1);
 		length = m_GetRequest_PDU->decode(data);
 	}
 	return length;
@@ -828,7 +828,7 @@ GetNextRequest_PDU::GetNextRequest_PDU()
 GetNextRequest_PDU::GetNextRequest_PDU(void* data, int len)
 {
 	m_GetNextRequest_PDU = new PDU();
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -837,14 +837,14 @@ GetNextRequest_PDU::~GetNextRequest_PDU()
 	TelEngine::destruct(m_GetNextRequest_PDU);
 }
 
-int GetNextRequest_PDU::decode(DataBlock& data)
+int GetNextRequest_PDU::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = -1;
 	if (data.length() < 2)
 		return ASNLib::InvalidLengthOrTag;
 	if (data[0] == tag_GetNextRequest_PDU) {
-		data.cut(-1);
+		data.skip(1);
 		length = m_GetNextRequest_PDU->decode(data);
 	}
 	return length;
@@ -880,7 +880,7 @@ Response_PDU::Response_PDU()
 Response_PDU::Response_PDU(void* data, int len)
 {
 	m_Response_PDU = new PDU();
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -889,14 +889,14 @@ Response_PDU::~Response_PDU()
 	TelEngine::destruct(m_Response_PDU);
 }
 
-int Response_PDU::decode(DataBlock& data)
+int Response_PDU::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = -1;
 	if (data.length() < 2)
 		return ASNLib::InvalidLengthOrTag;
 	if (data[0] == tag_Response_PDU) {
-		data.cut(-1);
+		data.skip(1);
 		length = m_Response_PDU->decode(data);
 	}
 	return length;
@@ -932,7 +932,7 @@ SetRequest_PDU::SetRequest_PDU()
 SetRequest_PDU::SetRequest_PDU(void* data, int len)
 {
 	m_SetRequest_PDU = new PDU();
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -941,14 +941,14 @@ SetRequest_PDU::~SetRequest_PDU()
 	TelEngine::destruct(m_SetRequest_PDU);
 }
 
-int SetRequest_PDU::decode(DataBlock& data)
+int SetRequest_PDU::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = -1;
 	if (data.length() < 2)
 		return ASNLib::InvalidLengthOrTag;
 	if (data[0] == tag_SetRequest_PDU) {
-		data.cut(-1);
+		data.skip(1);
 		length = m_SetRequest_PDU->decode(data);
 	}
 	return length;
@@ -984,7 +984,7 @@ GetBulkRequest_PDU::GetBulkRequest_PDU()
 GetBulkRequest_PDU::GetBulkRequest_PDU(void* data, int len)
 {
 	m_GetBulkRequest_PDU = new BulkPDU();
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -993,14 +993,14 @@ GetBulkRequest_PDU::~GetBulkRequest_PDU()
 	TelEngine::destruct(m_GetBulkRequest_PDU);
 }
 
-int GetBulkRequest_PDU::decode(DataBlock& data)
+int GetBulkRequest_PDU::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = -1;
 	if (data.length() < 2)
 		return ASNLib::InvalidLengthOrTag;
 	if (data[0] == tag_GetBulkRequest_PDU) {
-		data.cut(-1);
+		data.skip(1);
 		length = m_GetBulkRequest_PDU->decode(data);
 	}
 	return length;
@@ -1036,7 +1036,7 @@ InformRequest_PDU::InformRequest_PDU()
 InformRequest_PDU::InformRequest_PDU(void* data, int len)
 {
 	m_InformRequest_PDU = new PDU();
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -1045,14 +1045,14 @@ InformRequest_PDU::~InformRequest_PDU()
 	TelEngine::destruct(m_InformRequest_PDU);
 }
 
-int InformRequest_PDU::decode(DataBlock& data)
+int InformRequest_PDU::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = -1;
 	if (data.length() < 2)
 		return ASNLib::InvalidLengthOrTag;
 	if (data[0] == tag_InformRequest_PDU) {
-		data.cut(-1);
+		data.skip(1);
 		length = m_InformRequest_PDU->decode(data);
 	}
 	return length;
@@ -1088,7 +1088,7 @@ SNMPv2_Trap_PDU::SNMPv2_Trap_PDU()
 SNMPv2_Trap_PDU::SNMPv2_Trap_PDU(void* data, int len)
 {
 	m_SNMPv2_Trap_PDU = new PDU();
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -1097,14 +1097,14 @@ SNMPv2_Trap_PDU::~SNMPv2_Trap_PDU()
 	TelEngine::destruct(m_SNMPv2_Trap_PDU);
 }
 
-int SNMPv2_Trap_PDU::decode(DataBlock& data)
+int SNMPv2_Trap_PDU::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = -1;
 	if (data.length() < 2)
 		return ASNLib::InvalidLengthOrTag;
 	if (data[0] == tag_SNMPv2_Trap_PDU) {
-		data.cut(-1);
+		data.skip(1);
 		length = m_SNMPv2_Trap_PDU->decode(data);
 	}
 	return length;
@@ -1140,7 +1140,7 @@ Report_PDU::Report_PDU()
 Report_PDU::Report_PDU(void* data, int len)
 {
 	m_Report_PDU = new PDU();
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -1149,14 +1149,14 @@ Report_PDU::~Report_PDU()
 	TelEngine::destruct(m_Report_PDU);
 }
 
-int Report_PDU::decode(DataBlock& data)
+int Report_PDU::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = -1;
 	if (data.length() < 2)
 		return ASNLib::InvalidLengthOrTag;
 	if (data[0] == tag_Report_PDU) {
-		data.cut(-1);
+		data.skip(1);
 		length = m_Report_PDU->decode(data);
 	}
 	return length;
@@ -1192,7 +1192,7 @@ PDU::PDU()
 PDU::PDU(void* data, int len)
 {
 	m_variable_bindings = new VarBindList();
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -1201,7 +1201,7 @@ PDU::~PDU()
 	TelEngine::destruct(m_variable_bindings);
 }
 
-int PDU::decode(DataBlock& data)
+int PDU::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeSequence(data,false);
@@ -1259,7 +1259,7 @@ BulkPDU::BulkPDU()
 BulkPDU::BulkPDU(void* data, int len)
 {
 	m_variable_bindings = new VarBindList();
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -1268,7 +1268,7 @@ BulkPDU::~BulkPDU()
 	TelEngine::destruct(m_variable_bindings);
 }
 
-int BulkPDU::decode(DataBlock& data)
+int BulkPDU::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeSequence(data,false);
@@ -1330,7 +1330,7 @@ VarBind::VarBind(void* data, int len)
 {
 	m_name = new ObjectName();
 	m_value = new ObjectSyntax();
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -1340,7 +1340,7 @@ VarBind::~VarBind()
 	TelEngine::destruct(m_value);
 }
 
-int VarBind::decode(DataBlock& data)
+int VarBind::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeSequence(data,true);
@@ -1361,7 +1361,7 @@ int VarBind::decode(DataBlock& data)
 	if (data.length() < 2)
 		return ASNLib::InvalidLengthOrTag;
 	if (data[0] == tag_noSuchObject) {
-		data.cut(-1);
+		data.skip(1);
 		length = ASNLib::decodeNull(data,false);
 	}
 	if (length >= 0) {
@@ -1372,7 +1372,7 @@ int VarBind::decode(DataBlock& data)
 	if (data.length() < 2)
 		return ASNLib::InvalidLengthOrTag;
 	if (data[0] == tag_noSuchInstance) {
-		data.cut(-1);
+		data.skip(1);
 		length = ASNLib::decodeNull(data,false);
 	}
 	if (length >= 0) {
@@ -1383,7 +1383,7 @@ int VarBind::decode(DataBlock& data)
 	if (data.length() < 2)
 		return ASNLib::InvalidLengthOrTag;
 	if (data[0] == tag_endOfMibView) {
-		data.cut(-1);
+		data.skip(1);
 		length = ASNLib::decodeNull(data,false);
 	}
 	if (length >= 0) {
@@ -1463,7 +1463,7 @@ VarBindList::VarBindList()
 
 VarBindList::VarBindList(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -1471,7 +1471,7 @@ VarBindList::~VarBindList()
 {
 }
 
-int VarBindList::decode(DataBlock& data)
+int VarBindList::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = 0;
@@ -1526,7 +1526,7 @@ DisplayString::DisplayString()
 
 DisplayString::DisplayString(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -1534,7 +1534,7 @@ DisplayString::~DisplayString()
 {
 }
 
-int DisplayString::decode(DataBlock& data)
+int DisplayString::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeOctetString(data,&m_DisplayString,true);
@@ -1569,7 +1569,7 @@ PhysAddress::PhysAddress()
 
 PhysAddress::PhysAddress(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -1577,7 +1577,7 @@ PhysAddress::~PhysAddress()
 {
 }
 
-int PhysAddress::decode(DataBlock& data)
+int PhysAddress::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeOctetString(data,&m_PhysAddress,true);
@@ -1608,7 +1608,7 @@ MacAddress::MacAddress()
 
 MacAddress::MacAddress(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -1616,7 +1616,7 @@ MacAddress::~MacAddress()
 {
 }
 
-int MacAddress::decode(DataBlock& data)
+int MacAddress::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeOctetString(data,&m_MacAddress,true);
@@ -1649,7 +1649,7 @@ TruthValue::TruthValue()
 
 TruthValue::TruthValue(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -1657,7 +1657,7 @@ TruthValue::~TruthValue()
 {
 }
 
-int TruthValue::decode(DataBlock& data)
+int TruthValue::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeINT32(data,&m_TruthValue,true);
@@ -1690,7 +1690,7 @@ TestAndIncr::TestAndIncr()
 
 TestAndIncr::TestAndIncr(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -1698,7 +1698,7 @@ TestAndIncr::~TestAndIncr()
 {
 }
 
-int TestAndIncr::decode(DataBlock& data)
+int TestAndIncr::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeUINT32(data,&m_TestAndIncr,true);
@@ -1733,7 +1733,7 @@ AutonomousType::AutonomousType()
 
 AutonomousType::AutonomousType(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -1741,7 +1741,7 @@ AutonomousType::~AutonomousType()
 {
 }
 
-int AutonomousType::decode(DataBlock& data)
+int AutonomousType::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeOID(data,&m_AutonomousType,true);
@@ -1772,7 +1772,7 @@ InstancePointer::InstancePointer()
 
 InstancePointer::InstancePointer(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -1780,7 +1780,7 @@ InstancePointer::~InstancePointer()
 {
 }
 
-int InstancePointer::decode(DataBlock& data)
+int InstancePointer::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeOID(data,&m_InstancePointer,true);
@@ -1811,7 +1811,7 @@ VariablePointer::VariablePointer()
 
 VariablePointer::VariablePointer(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -1819,7 +1819,7 @@ VariablePointer::~VariablePointer()
 {
 }
 
-int VariablePointer::decode(DataBlock& data)
+int VariablePointer::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeOID(data,&m_VariablePointer,true);
@@ -1850,7 +1850,7 @@ RowPointer::RowPointer()
 
 RowPointer::RowPointer(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -1858,7 +1858,7 @@ RowPointer::~RowPointer()
 {
 }
 
-int RowPointer::decode(DataBlock& data)
+int RowPointer::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeOID(data,&m_RowPointer,true);
@@ -1889,7 +1889,7 @@ RowStatus::RowStatus()
 
 RowStatus::RowStatus(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -1897,7 +1897,7 @@ RowStatus::~RowStatus()
 {
 }
 
-int RowStatus::decode(DataBlock& data)
+int RowStatus::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeINT32(data,&m_RowStatus,true);
@@ -1930,7 +1930,7 @@ TimeStamp::TimeStamp()
 
 TimeStamp::TimeStamp(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -1938,7 +1938,7 @@ TimeStamp::~TimeStamp()
 {
 }
 
-int TimeStamp::decode(DataBlock& data)
+int TimeStamp::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = m_TimeStamp->decode(data);
@@ -1967,7 +1967,7 @@ TimeInterval::TimeInterval()
 
 TimeInterval::TimeInterval(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -1975,7 +1975,7 @@ TimeInterval::~TimeInterval()
 {
 }
 
-int TimeInterval::decode(DataBlock& data)
+int TimeInterval::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeUINT32(data,&m_TimeInterval,true);
@@ -2010,7 +2010,7 @@ DateAndTime::DateAndTime()
 
 DateAndTime::DateAndTime(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -2018,7 +2018,7 @@ DateAndTime::~DateAndTime()
 {
 }
 
-int DateAndTime::decode(DataBlock& data)
+int DateAndTime::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeOctetString(data,&m_DateAndTime,true);
@@ -2054,7 +2054,7 @@ StorageType::StorageType()
 
 StorageType::StorageType(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -2062,7 +2062,7 @@ StorageType::~StorageType()
 {
 }
 
-int StorageType::decode(DataBlock& data)
+int StorageType::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeINT32(data,&m_StorageType,true);
@@ -2095,7 +2095,7 @@ TDomain::TDomain()
 
 TDomain::TDomain(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -2103,7 +2103,7 @@ TDomain::~TDomain()
 {
 }
 
-int TDomain::decode(DataBlock& data)
+int TDomain::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeOID(data,&m_TDomain,true);
@@ -2134,7 +2134,7 @@ TAddress::TAddress()
 
 TAddress::TAddress(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -2142,7 +2142,7 @@ TAddress::~TAddress()
 {
 }
 
-int TAddress::decode(DataBlock& data)
+int TAddress::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeOctetString(data,&m_TAddress,true);
@@ -2181,7 +2181,7 @@ SNMPv3Message::SNMPv3Message(void* data, int len)
 {
 	m_msgGlobalData = new HeaderData();
 	m_msgData = new ScopedPduData();
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -2191,7 +2191,7 @@ SNMPv3Message::~SNMPv3Message()
 	TelEngine::destruct(m_msgData);
 }
 
-int SNMPv3Message::decode(DataBlock& data)
+int SNMPv3Message::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeSequence(data,true);
@@ -2240,7 +2240,7 @@ HeaderData::HeaderData()
 
 HeaderData::HeaderData(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -2248,7 +2248,7 @@ HeaderData::~HeaderData()
 {
 }
 
-int HeaderData::decode(DataBlock& data)
+int HeaderData::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeSequence(data,true);
@@ -2311,7 +2311,7 @@ ScopedPduData::ScopedPduData()
 ScopedPduData::ScopedPduData(void* data, int len)
 {
 	m_plaintext = new ScopedPDU();
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -2320,7 +2320,7 @@ ScopedPduData::~ScopedPduData()
 	TelEngine::destruct(m_plaintext);
 }
 
-int ScopedPduData::decode(DataBlock& data)
+int ScopedPduData::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = m_plaintext->decode(data);
@@ -2365,7 +2365,7 @@ ScopedPDU::ScopedPDU()
 
 ScopedPDU::ScopedPDU(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -2373,7 +2373,7 @@ ScopedPDU::~ScopedPDU()
 {
 }
 
-int ScopedPDU::decode(DataBlock& data)
+int ScopedPDU::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeSequence(data,true);
@@ -2419,7 +2419,7 @@ Message::Message()
 
 Message::Message(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -2427,7 +2427,7 @@ Message::~Message()
 {
 }
 
-int Message::decode(DataBlock& data)
+int Message::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeSequence(data,true);
@@ -2475,7 +2475,7 @@ KeyChange::KeyChange()
 
 KeyChange::KeyChange(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -2483,7 +2483,7 @@ KeyChange::~KeyChange()
 {
 }
 
-int KeyChange::decode(DataBlock& data)
+int KeyChange::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeOctetString(data,&m_KeyChange,true);
@@ -2539,7 +2539,7 @@ UsmUserEntry::UsmUserEntry(void* data, int len)
 	m_usmUserStorageType = new StorageType();
 	m_usmUserStatus = new RowStatus();
 
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -2559,7 +2559,7 @@ UsmUserEntry::~UsmUserEntry()
 	TelEngine::destruct(m_usmUserStatus);
 }
 
-int UsmUserEntry::decode(DataBlock& data)
+int UsmUserEntry::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeSequence(data,true);
@@ -2621,7 +2621,7 @@ SnmpEngineID::SnmpEngineID()
 
 SnmpEngineID::SnmpEngineID(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -2629,7 +2629,7 @@ SnmpEngineID::~SnmpEngineID()
 {
 }
 
-int SnmpEngineID::decode(DataBlock& data)
+int SnmpEngineID::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeOctetString(data,&m_SnmpEngineID,true);
@@ -2664,7 +2664,7 @@ SnmpSecurityModel::SnmpSecurityModel()
 
 SnmpSecurityModel::SnmpSecurityModel(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -2672,7 +2672,7 @@ SnmpSecurityModel::~SnmpSecurityModel()
 {
 }
 
-int SnmpSecurityModel::decode(DataBlock& data)
+int SnmpSecurityModel::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeUINT32(data,&m_SnmpSecurityModel,true);
@@ -2707,7 +2707,7 @@ SnmpMessageProcessingModel::SnmpMessageProcessingModel()
 
 SnmpMessageProcessingModel::SnmpMessageProcessingModel(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -2715,7 +2715,7 @@ SnmpMessageProcessingModel::~SnmpMessageProcessingModel()
 {
 }
 
-int SnmpMessageProcessingModel::decode(DataBlock& data)
+int SnmpMessageProcessingModel::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeUINT32(data,&m_SnmpMessageProcessingModel,true);
@@ -2750,7 +2750,7 @@ SnmpSecurityLevel::SnmpSecurityLevel()
 
 SnmpSecurityLevel::SnmpSecurityLevel(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -2758,7 +2758,7 @@ SnmpSecurityLevel::~SnmpSecurityLevel()
 {
 }
 
-int SnmpSecurityLevel::decode(DataBlock& data)
+int SnmpSecurityLevel::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeINT32(data,&m_SnmpSecurityLevel,true);
@@ -2791,7 +2791,7 @@ SnmpAdminString::SnmpAdminString()
 
 SnmpAdminString::SnmpAdminString(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -2799,7 +2799,7 @@ SnmpAdminString::~SnmpAdminString()
 {
 }
 
-int SnmpAdminString::decode(DataBlock& data)
+int SnmpAdminString::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeOctetString(data,&m_SnmpAdminString,true);
@@ -2834,7 +2834,7 @@ UsmSecurityParameters::UsmSecurityParameters()
 
 UsmSecurityParameters::UsmSecurityParameters(void* data, int len)
 {
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -2842,7 +2842,7 @@ UsmSecurityParameters::~UsmSecurityParameters()
 {
 }
 
-int UsmSecurityParameters::decode(DataBlock& data)
+int UsmSecurityParameters::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeSequence(data,true);
@@ -2912,7 +2912,7 @@ SysOREntry::SysOREntry(void* data, int len)
 	m_sysORDescr = new DisplayString();
 	m_sysORUpTime = new TimeStamp();
 
-	DataBlock db(data,len);
+	AsnCursor db(data,len);
 	decode(db);
 }
 
@@ -2922,7 +2922,7 @@ SysOREntry::~SysOREntry()
 	TelEngine::destruct(m_sysORUpTime);
 }
 
-int SysOREntry::decode(DataBlock& data)
+int SysOREntry::decode(AsnCursor& data)
 {
 	int length = 0;
 	length = ASNLib::decodeSequence(data,true);
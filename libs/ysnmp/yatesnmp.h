@@ -97,7 +97,8 @@ public:
 	ObjectName();
 	ObjectName(void* data, int len);
 	~ObjectName();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -119,7 +120,8 @@ public:
 	ObjectSyntax();
 	ObjectSyntax(void* data, int len);
 	~ObjectSyntax();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -149,7 +151,8 @@ public:
 	SimpleSyntax();
 	SimpleSyntax(void* data, int len);
 	~SimpleSyntax();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -179,7 +182,8 @@ public:
 	ApplicationSyntax();
 	ApplicationSyntax(void* data, int len);
 	~ApplicationSyntax();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -197,7 +201,8 @@ public:
 	IpAddress();
 	IpAddress(void* data, int len);
 	~IpAddress();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -216,7 +221,8 @@ public:
 	Counter32();
 	Counter32(void* data, int len);
 	~Counter32();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -235,7 +241,8 @@ public:
 	Unsigned32();
 	Unsigned32(void* data, int len);
 	~Unsigned32();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -250,7 +257,8 @@ public:
 	Gauge32();
 	Gauge32(void* data, int len);
 	~Gauge32();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -269,7 +277,8 @@ public:
 	TimeTicks();
 	TimeTicks(void* data, int len);
 	~TimeTicks();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -286,7 +295,8 @@ public:
 	Opaque();
 	Opaque(void* data, int len);
 	~Opaque();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -305,7 +315,8 @@ public:
 	Counter64();
 	Counter64(void* data, int len);
 	~Counter64();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -339,7 +350,8 @@ public:
 	PDUs();
 	PDUs(void* data, int len);
 	~PDUs();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -355,7 +367,8 @@ public:
 	GetRequest_PDU();
 	GetRequest_PDU(void* data, int len);
 	~GetRequest_PDU();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -371,7 +384,8 @@ public:
 	GetNextRequest_PDU();
 	GetNextRequest_PDU(void* data, int len);
 	~GetNextRequest_PDU();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -387,7 +401,8 @@ public:
 	Response_PDU();
 	Response_PDU(void* data, int len);
 	~Response_PDU();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -403,7 +418,8 @@ public:
 	SetRequest_PDU();
 	SetRequest_PDU(void* data, int len);
 	~SetRequest_PDU();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -419,7 +435,8 @@ public:
 	GetBulkRequest_PDU();
 	GetBulkRequest_PDU(void* data, int len);
 	~GetBulkRequest_PDU();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -435,7 +452,8 @@ public:
 	InformRequest_PDU();
 	InformRequest_PDU(void* data, int len);
 	~InformRequest_PDU();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -451,7 +469,8 @@ public:
 	SNMPv2_Trap_PDU();
 	SNMPv2_Trap_PDU(void* data, int len);
 	~SNMPv2_Trap_PDU();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -467,7 +486,8 @@ public:
 	Report_PDU();
 	Report_PDU(void* data, int len);
 	~Report_PDU();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -512,7 +532,8 @@ public:
 	PDU();
 	PDU(void* data, int len);
 	~PDU();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -540,7 +561,8 @@ public:
 	BulkPDU();
 	BulkPDU(void* data, int len);
 	~BulkPDU();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -575,7 +597,8 @@ public:
 	VarBind();
 	VarBind(void* data, int len);
 	~VarBind();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -592,7 +615,8 @@ public:
 	VarBindList();
 	VarBindList(void* data, int len);
 	~VarBindList();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -610,7 +634,8 @@ public:
 	DisplayString();
 	DisplayString(void* data, int len);
 	~DisplayString();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -626,7 +651,8 @@ public:
 	PhysAddress();
 	PhysAddress(void* data, int len);
 	~PhysAddress();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -643,7 +669,8 @@ public:
 	MacAddress();
 	MacAddress(void* data, int len);
 	~MacAddress();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -661,7 +688,8 @@ public:
 	TruthValue();
 	TruthValue(void* data, int len);
 	~TruthValue();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -679,7 +707,8 @@ public:
 	TestAndIncr();
 	TestAndIncr(void* data, int len);
 	~TestAndIncr();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -694,7 +723,8 @@ public:
 	AutonomousType();
 	AutonomousType(void* data, int len);
 	~AutonomousType();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -709,7 +739,8 @@ public:
 	InstancePointer();
 	InstancePointer(void* data, int len);
 	~InstancePointer();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -724,7 +755,8 @@ public:
 	VariablePointer();
 	VariablePointer(void* data, int len);
 	~VariablePointer();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -739,7 +771,8 @@ public:
 	RowPointer();
 	RowPointer(void* data, int len);
 	~RowPointer();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -761,7 +794,8 @@ public:
 	RowStatus();
 	RowStatus(void* data, int len);
 	~RowStatus();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -776,7 +810,8 @@ public:
 	TimeStamp();
 	TimeStamp(void* data, int len);
 	~TimeStamp();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -794,7 +829,8 @@ public:
 	TimeInterval();
 	TimeInterval(void* data, int len);
 	~TimeInterval();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -812,7 +848,8 @@ public:
 	DateAndTime();
 	DateAndTime(void* data, int len);
 	~DateAndTime();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -833,7 +870,8 @@ public:
 	StorageType();
 	StorageType(void* data, int len);
 	~StorageType();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -848,7 +886,8 @@ public:
 	TDomain();
 	TDomain(void* data, int len);
 	~TDomain();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -866,7 +905,8 @@ public:
 	TAddress();
 	TAddress(void* data, int len);
 	~TAddress();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -889,7 +929,8 @@ public:
 	SNMPv3Message();
 	SNMPv3Message(void* data, int len);
 	~SNMPv3Message();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -919,7 +960,8 @@ public:
 	HeaderData();
 	HeaderData(void* data, int len);
 	~HeaderData();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -942,7 +984,8 @@ public:
 	ScopedPduData();
 	ScopedPduData(void* data, int len);
 	~ScopedPduData();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -962,7 +1005,8 @@ public:
 	ScopedPDU();
 	ScopedPDU(void* data, int len);
 	~ScopedPDU();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -984,7 +1028,8 @@ public:
 	Message();
 	Message(void* data, int len);
 	~Message();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -1000,7 +1045,8 @@ public:
 	KeyChange();
 	KeyChange(void* data, int len);
 	~KeyChange();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -1029,7 +1075,8 @@ public:
 	UsmUserEntry();
 	UsmUserEntry(void* data, int len);
 	~UsmUserEntry();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -1047,7 +1094,8 @@ public:
 	SnmpEngineID();
 	SnmpEngineID(void* data, int len);
 	~SnmpEngineID();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -1065,7 +1113,8 @@ public:
 	SnmpSecurityModel();
 	SnmpSecurityModel(void* data, int len);
 	~SnmpSecurityModel();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -1083,7 +1132,8 @@ public:
 	SnmpMessageProcessingModel();
 	SnmpMessageProcessingModel(void* data, int len);
 	~SnmpMessageProcessingModel();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -1102,7 +1152,8 @@ public:
 	SnmpSecurityLevel();
 	SnmpSecurityLevel(void* data, int len);
 	~SnmpSecurityLevel();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -1120,7 +1171,8 @@ public:
 	SnmpAdminString();
 	SnmpAdminString(void* data, int len);
 	~SnmpAdminString();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -1153,7 +1205,8 @@ public:
 	UsmSecurityParameters();
 	UsmSecurityParameters(void* data, int len);
 	~UsmSecurityParameters();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -1173,7 +1226,8 @@ public:
 	SysOREntry();
 	SysOREntry(void* data, int len);
 	~SysOREntry();
-	int decode(DataBlock& data);
+	int decode(AsnCursor& data);
+	using AsnObject::decode;
 	int encode(DataBlock& data);
 	void getParams(NamedList* params);
 	void setParams(NamedList* params);
@@ -29,6 +29,9 @@
 using namespace TelEngine;
 namespace { // anonymous
 
+// Number of buckets in the CDR and hungup guard indexes
+#define CDR_HASH_SIZE 1024
+
 enum {
     CdrStart,
     CdrCall,
@@ -84,6 +87,38 @@ public:
     virtual bool received(Message &msg);
 };
 
+// Entry of a timer wheel, cancelled entries are freed when their slot is visited
+class WheelEntry : public GenObject
+{
+    friend class TimerWheel;
+public:
+    inline WheelEntry(GenObject* obj, u_int64_t when)
+	: m_obj(obj), m_when(when)
+	{ }
+private:
+    GenObject* m_obj;
+    u_int64_t m_when;
+};
+
+// Hashed timer wheel holding objects it doesn't own until their expiration time
+class TimerWheel
+{
+public:
+    TimerWheel(unsigned int slots, unsigned int tick);
+    ~TimerWheel();
+    WheelEntry* add(GenObject* obj, u_int64_t when);
+    void cancel(WheelEntry*& entry);
+    GenObject* get(u_int64_t now);
+    inline unsigned int count() const
+	{ return m_count; }
+private:
+    ObjList* m_slots;
+    unsigned int m_size;
+    unsigned int m_tick;
+    u_int64_t m_next;
+    unsigned int m_count;
+};
+
 // Collects CDR information and emits the call.cdr messages when needed
 class CdrBuilder : public NamedList
 {
@@ -94,8 +129,11 @@ public:
     bool update(const Message& msg, int type, u_int64_t val);
     void emit(const char *operation = 0);
     String getStatus() const;
+    void statusTime(u_int64_t msec);
+    void emitStatus(const Time& now);
+    inline u_int64_t statusTime() const
+	{ return m_statusTime; }
     static CdrBuilder* find(String &id);
-    u_int64_t m_statusTime;
 private:
     u_int64_t
 	m_start,
@@ -109,6 +147,8 @@ private:
     bool m_first;
     bool m_write;
     String m_traceId;
+    u_int64_t m_statusTime;
+    WheelEntry* m_statusEntry;
 };
 
 // CDR extra parameter name with an overwrite flag
@@ -181,8 +221,11 @@ private:
 };
 
 
-static ObjList s_cdrs;
-static ObjList s_hungup;
+// Hungup guards expire with 100ms resolution, status updates are checked with 1s
+static TimerWheel s_hungupWheel(128,100000);
+static TimerWheel s_statusWheel(1024,1000000);
+static HashList s_hungup(CDR_HASH_SIZE);
+static HashList s_cdrs(CDR_HASH_SIZE);
 CustomTimer m_startTime;
 CustomTimer m_answerTime;
 CustomTimer m_hangupTime;
@@ -297,18 +340,90 @@ static const char* printTime(char* buf, u_int64_t usec, int count)
 static void expireHungup()
 {
     Time t;
-    while (Hungup* h = static_cast<Hungup*>(s_hungup.get())) {
-	if (h->expires() > t.usec())
-	    return;
+    while (Hungup* h = static_cast<Hungup*>(s_hungupWheel.get(t.usec()))) {
 	DDebug("cdrbuild",DebugInfo,"Expiring hungup guard for '%s'",h->c_str());
-	s_hungup.remove(h);
+	s_hungup.remove(h,true,true);
+    }
+}
+
+// Remember a hungup channel for the guard interval
+static void addHungup(const String& id, bool emitHangup)
+{
+    Hungup* h = new Hungup(id,emitHangup);
+    s_hungup.append(h);
+    s_hungupWheel.add(h,h->expires());
+}
+
+
+TimerWheel::TimerWheel(unsigned int slots, unsigned int tick)
+    : m_slots(0), m_size(slots), m_tick(tick), m_next(0), m_count(0)
+{
+    m_slots = new ObjList[m_size];
+}
+
+TimerWheel::~TimerWheel()
+{
+    delete[] m_slots;
+}
+
+// Insert an object, the wheel position is never in the already visited past
+WheelEntry* TimerWheel::add(GenObject* obj, u_int64_t when)
+{
+    u_int64_t tick = when / m_tick;
+    if (tick < m_next)
+	tick = m_next;
+    WheelEntry* e = new WheelEntry(obj,when);
+    m_slots[tick % m_size].append(e);
+    m_count++;
+    return e;
+}
+
+void TimerWheel::cancel(WheelEntry*& entry)
+{
+    if (!entry)
+	return;
+    entry->m_obj = 0;
+    entry = 0;
+    m_count--;
+}
+
+// Retrieve and remove one expired object, visits only the slots of elapsed ticks
+GenObject* TimerWheel::get(u_int64_t now)
+{
+    u_int64_t tick = now / m_tick;
+    if (tick >= m_next + m_size)
+	m_next = tick - m_size + 1;
+    for (;;) {
+	ObjList* l = &m_slots[m_next % m_size];
+	while (l) {
+	    WheelEntry* e = static_cast<WheelEntry*>(l->get());
+	    if (!e) {
+		l = l->next();
+		continue;
+	    }
+	    if (!e->m_obj) {
+		// cancelled, the list item now holds the next entry
+		l->remove();
+		continue;
+	    }
+	    if (e->m_when <= now) {
+		GenObject* obj = e->m_obj;
+		l->remove();
+		m_count--;
+		return obj;
+	    }
+	    l = l->next();
+	}
+	if (m_next >= tick)
+	    return 0;
+	m_next++;
     }
 }
 
 
 CdrBuilder::CdrBuilder(const char *name)
     : NamedList(name), m_dir("unknown"), m_status("unknown"),
-      m_first(true), m_write(true)
+      m_first(true), m_write(true), m_statusEntry(0)
 {
     m_statusTime = m_start = m_call = m_ringing = m_answer = m_hangup = 0;
     m_cdrId = ++s_seq;
@@ -321,9 +436,10 @@ CdrBuilder::~CdrBuilder()
 	if (!getParam("reason"))
 	    addParam("reason","CDR shutdown");
     }
+    s_statusWheel.cancel(m_statusEntry);
     emit("finalize");
-    if (Hungup::s_exp && !s_hungup.find(*this))
-	s_hungup.append(new Hungup(*this,false));
+    if (Hungup::s_exp && !null() && !s_hungup.find(*this))
+	addHungup(*this,false);
 }
 
 void CdrBuilder::emit(const char *operation)
@@ -428,6 +544,23 @@ String CdrBuilder::getStatus() const
     return s;
 }
 
+// Schedule the next status emission, zero or -1 to never emit
+void CdrBuilder::statusTime(u_int64_t msec)
+{
+    m_statusTime = msec;
+    s_statusWheel.cancel(m_statusEntry);
+    if (msec && (msec != (u_int64_t)-1))
+	m_statusEntry = s_statusWheel.add(this,msec * 1000);
+}
+
+// Emit a scheduled status, the wheel entry was already consumed
+void CdrBuilder::emitStatus(const Time& now)
+{
+    m_statusEntry = 0;
+    emit("status");
+    statusTime(s_statusUpdate ? (now.msec() + s_statusUpdate) : (u_int64_t)-1);
+}
+
 void CdrBuilder::update(int type, u_int64_t val, const char* status)
 {
     switch (type) {
@@ -460,6 +593,8 @@ bool CdrBuilder::update(const Message& msg, int type, u_int64_t val)
     if (type == CdrDrop) {
 	TraceDebug(m_traceId,"cdrbuild",DebugNote,"%s CDR for '%s'",
 	    (m_first ? "Dropping" : "Closing"),c_str());
+	// remove from index while the name is still set
+	unsigned int h = hash();
 	// if we didn't generate an initialize generate no finalize
 	if (m_first)
 	    clear();
@@ -471,7 +606,7 @@ bool CdrBuilder::update(const Message& msg, int type, u_int64_t val)
 	    if (reason)
 		setParam("reason",reason);
 	}
-	s_cdrs.remove(this);
+	s_cdrs.remove(this,h);
 	return true;
     }
     // cdrwrite must be consistent over all emitted messages so we read it once
@@ -512,7 +647,7 @@ bool CdrBuilder::update(const Message& msg, int type, u_int64_t val)
     update(type,val);
 
     if (type == CdrHangup) {
-	s_cdrs.remove(this);
+	s_cdrs.remove(this,true,true);
 	// object is now destroyed, "this" no longer valid
 	return false;
     }
@@ -590,7 +725,7 @@ bool CdrHandler::received(Message &msg)
 		expireHungup();
 		if (Hungup::s_exp && !s_hungup.find(id))
 		    // remember to emit a finalize if we ever see a startup
-		    s_hungup.append(new Hungup(id,true));
+		    addHungup(id,true);
 		else
 		    level = DebugMild;
 		break;
@@ -598,8 +733,8 @@ bool CdrHandler::received(Message &msg)
     }
     if (b) {
 	rval = b->update(msg,type,msg.msgTime().usec());
-	if (type == CdrAnswer && !b->m_statusTime)
-	    b->m_statusTime = Time::msecNow() + (s_statusAnswer ? 0 : s_statusUpdate);
+	if (type == CdrAnswer && !b->statusTime())
+	    b->statusTime(Time::msecNow() + (s_statusAnswer ? 0 : s_statusUpdate));
     } else
 	Debug("cdrbuild",level,"Got message '%s' for untracked id '%s'",
 	    msg.c_str(),id.c_str());
@@ -610,8 +745,8 @@ bool CdrHandler::received(Message &msg)
 	if (id && (b = CdrBuilder::find(id))) {
 	    b->update(type,msg.msgTime().usec(),msg.getValue("status"));
 	    b->emit();
-	    if (type == CdrAnswer && !b->m_statusTime)
-		b->m_statusTime = Time::msecNow() + (s_statusAnswer ? 0 : s_statusUpdate);
+	    if (type == CdrAnswer && !b->statusTime())
+		b->statusTime(Time::msecNow() + (s_statusAnswer ? 0 : s_statusUpdate));
 	}
     }
     return rval;
@@ -629,16 +764,17 @@ bool StatusHandler::received(Message &msg)
     st << ";cdrs=" << s_cdrs.count() << ",hungup=" << s_hungup.count();
     if (msg.getBoolValue(YSTRING("details"),true)) {
 	st << ";";
-	ObjList *l = &s_cdrs;
 	bool first = true;
-	for (; l; l=l->next()) {
-	    CdrBuilder *b = static_cast<CdrBuilder *>(l->get());
-	    if (b) {
-		if (first)
-		    first = false;
-		else
-		    st << ",";
-		st << *b << "=" << b->getStatus();
+	for (unsigned int i = 0; i < s_cdrs.length(); i++) {
+	    for (ObjList* l = s_cdrs.getList(i); l; l = l->next()) {
+		CdrBuilder *b = static_cast<CdrBuilder *>(l->get());
+		if (b) {
+		    if (first)
+			first = false;
+		    else
+			st << ",";
+		    st << *b << "=" << b->getStatus();
+		}
 	    }
 	}
     }
@@ -662,32 +798,14 @@ bool CommandHandler::received(Message &msg)
 
 void StatusThread::run()
 {
-    // Check if we should emit cdr status
-    Time now;
-    s_mutex.lock();
-    for (ObjList* o = s_cdrs.skipNull();o;o = o->skipNext()) {
-	CdrBuilder* cdr = static_cast<CdrBuilder*>(o->get());
-	if (cdr->getStatus() != YSTRING("answered"))
-	    continue;
-	if (cdr->m_statusTime && (cdr->m_statusTime < now.msec())) {
-	    cdr->emit("status");
-	    cdr->m_statusTime = s_statusUpdate ? (now.msec() + s_statusUpdate) : (u_int64_t)-1;
-	}
-    }
-    s_mutex.unlock();
-
-    // Check cdrs for timeout and emit cdr status
+    // Emit cdr status only for records whose scheduled time was reached
     while (!m_exit) {
-	Thread::msleep(m_maxSleep);
 	Lock lock(s_mutex);
 	Time t;
-	for (ObjList* o = s_cdrs.skipNull();o;o = o->skipNext()) {
-	    CdrBuilder* cdr = static_cast<CdrBuilder*>(o->get());
-	    if (cdr->m_statusTime && (cdr->m_statusTime < t.msec())) {
-		cdr->emit("status");
-		cdr->m_statusTime = s_statusUpdate ? (t.msec() + s_statusUpdate) : (u_int64_t)-1;
-	    }
-	}
+	while (CdrBuilder* cdr = static_cast<CdrBuilder*>(s_statusWheel.get(t.usec())))
+	    cdr->emitStatus(t);
+	lock.drop();
+	Thread::msleep(m_maxSleep);
     }
 }
 
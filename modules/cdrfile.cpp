@@ -26,12 +26,7 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <string.h>
-
-#ifdef _WINDOWS
-#define EOLN "\r\n"
-#else
-#define EOLN "\n"
-#endif
+#include <stdio.h>
 
 using namespace TelEngine;
 namespace { // anonymous
@@ -52,37 +47,106 @@ INIT_PLUGIN(CdrFilePlugin);
 
 class CdrFileHandler : public MessageHandler, public Mutex
 {
+    friend class CdrFileWriter;
 public:
     CdrFileHandler(const char *name)
 	: MessageHandler(name,100,__plugin.name()),
 	  Mutex(false,"CdrFileHandler"),
-	  m_file(-1), m_combined(false)
+	  m_active(false), m_combined(false), m_mode(0640),
+	  m_fileMutex(true,"CdrFileWrite"), m_fileSize(0), m_fileTime(0),
+	  m_wakeup(1,"CdrFileWakeup",0), m_writer(0), m_stopping(false), m_queueTail(&m_queue)
 	{ }
     virtual ~CdrFileHandler();
     virtual bool received(Message &msg);
-    void init(const char *fname, bool tabsep, bool combined, const char* format, int mode);
+    void init(const char *fname, bool tabsep, bool combined, const char* format, int mode,
+	const NamedList& params);
+    void stop();
+    void status(String& str);
 private:
-    int m_file;
+    void run();
+    void flush();
+    void writeLines(ObjList& lines, unsigned int count);
+    void openFile();
+    void closeFile();
+    void rotate();
+    File m_file;
+    // File was opened, stays set while it is rotated
+    bool m_active;
     bool m_combined;
     String m_format;
+    String m_fileName;
+    int m_mode;
+    // Protects the file descriptor and serializes writes
+    Mutex m_fileMutex;
+    int64_t m_fileSize;
+    u_int32_t m_fileTime;
+    // Asynchronous writer
+    Semaphore m_wakeup;
+    Thread* m_writer;
+    bool m_stopping;
+    ObjList m_queue;
+    ObjList* m_queueTail;
+    // Settings and statistics
+    BatchFileWriter m_batch;
+};
+
+// Thread that writes the buffered CDRs to disk
+class CdrFileWriter : public Thread
+{
+public:
+    inline CdrFileWriter(CdrFileHandler* handler)
+	: Thread("CDR File"), m_handler(handler)
+	{ }
+    virtual ~CdrFileWriter()
+	{
+	    Lock lock(m_handler);
+	    if (m_handler->m_writer == this)
+		m_handler->m_writer = 0;
+	}
+    virtual void run()
+	{ m_handler->run(); }
+private:
+    CdrFileHandler* m_handler;
+};
+
+// Stop the writer and flush buffered CDRs on engine halt
+class HaltHandler : public MessageHandler
+{
+public:
+    inline HaltHandler(CdrFileHandler* handler)
+	: MessageHandler("engine.halt",200,__plugin.name()),
+	  m_handler(handler)
+	{ }
+    virtual bool received(Message &msg)
+	{ m_handler->stop(); return false; }
+private:
+    CdrFileHandler* m_handler;
+};
+
+class StatusHandler : public MessageHandler
+{
+public:
+    inline StatusHandler(CdrFileHandler* handler)
+	: MessageHandler("engine.status",100,__plugin.name()),
+	  m_handler(handler)
+	{ }
+    virtual bool received(Message &msg);
+private:
+    CdrFileHandler* m_handler;
 };
 
 CdrFileHandler::~CdrFileHandler()
 {
-    Lock lock(this);
-    if (m_file >= 0) {
-	::close(m_file);
-	m_file = -1;
-    }
+    stop();
+    Lock lock(m_fileMutex);
+    closeFile();
 }
 
-void CdrFileHandler::init(const char *fname, bool tabsep, bool combined, const char* format, int mode)
+void CdrFileHandler::init(const char *fname, bool tabsep, bool combined, const char* format, int mode,
+    const NamedList& params)
 {
+    Lock flock(m_fileMutex);
     Lock lock(this);
-    if (m_file >= 0) {
-	::close(m_file);
-	m_file = -1;
-    }
     m_format = format;
     m_combined = combined;
     if (m_format.null()) {
@@ -104,12 +168,145 @@ void CdrFileHandler::init(const char *fname, bool tabsep, bool combined, const c
 		    ",${billtime},${ringtime},${duration},\"${direction}\",\"${status}\",\"${reason}\""
 	      );
     }
-    if (fname) {
-	m_file = ::open(fname,O_WRONLY|O_CREAT|O_APPEND|O_LARGEFILE,mode);
-	if (m_file < 0)
-	    Alarm("cdrfile","system",DebugWarn,"Failed to open or create '%s': %s (%d)",
-		fname,::strerror(errno),errno);
+    lock.drop();
+    // Write what was buffered using the old settings
+    if (m_file.valid())
+	flush();
+    closeFile();
+    m_fileName = fname;
+    m_mode = mode;
+    lock.acquire(this);
+    m_batch.setup(params);
+    lock.drop();
+    openFile();
+    lock.acquire(this);
+    m_active = m_file.valid();
+    if (m_batch.flushInterval() && m_active && !(m_writer || m_stopping)) {
+	m_writer = new CdrFileWriter(this);
+	if (!m_writer->startup()) {
+	    Debug(__plugin.name(),DebugWarn,"Failed to start CDR writer thread, writing synchronously");
+	    m_writer = 0;
+	}
+    }
+    else if (!m_batch.flushInterval() && m_writer)
+	m_wakeup.unlock();
+}
+
+// Must be called with the file mutex locked
+void CdrFileHandler::openFile()
+{
+    if (m_fileName.null())
+	return;
+#ifdef _WINDOWS
+    m_file.openPath(m_fileName,true,false,true,true,true);
+#else
+    int fd = ::open(m_fileName,O_WRONLY|O_CREAT|O_APPEND|O_LARGEFILE,m_mode);
+    if (fd >= 0)
+	m_file.attach(fd);
+#endif
+    if (!m_file.valid()) {
+	Alarm("cdrfile","system",DebugWarn,"Failed to open or create '%s': %s (%d)",
+	    m_fileName.c_str(),::strerror(errno),errno);
+	return;
     }
+    m_fileSize = m_file.length();
+    m_fileTime = Time::secNow();
+}
+
+// Must be called with the file mutex locked
+void CdrFileHandler::closeFile()
+{
+    if (!m_file.valid())
+	return;
+    if (m_batch.fsync() != BatchFileWriter::FsyncNone)
+	BatchFileWriter::sync(m_file);
+    m_file.terminate();
+}
+
+// Rename the current file appending a timestamp, start a new one
+// Must be called with the file mutex locked
+void CdrFileHandler::rotate()
+{
+    closeFile();
+    int err = 0;
+    Lock lock(this);
+    if (!m_batch.rotate(m_fileName,&err))
+	Alarm("cdrfile","system",DebugWarn,"Failed to rotate '%s': %s (%d)",
+	    m_fileName.c_str(),::strerror(err),err);
+    lock.drop();
+    openFile();
+}
+
+// Write a list of lines to the file using as few system calls as possible
+// Must be called with the file mutex locked
+void CdrFileHandler::writeLines(ObjList& lines, unsigned int count)
+{
+    if (!count)
+	return;
+    u_int64_t start = Time::now();
+    if (m_batch.needRotate(m_fileSize,m_fileTime))
+	rotate();
+    bool ok = m_batch.writeLines(m_file,lines,true,&m_fileSize);
+    u_int64_t dt = Time::now() - start;
+    Lock lock(this);
+    if (!ok && m_file.valid())
+	Alarm("cdrfile","system",DebugWarn,"Failed to write %u CDRs to '%s': %s (%d)",
+	    count,m_fileName.c_str(),::strerror(errno),errno);
+    m_batch.flushed(ok ? count : 0,ok ? 0 : 1,dt);
+}
+
+// Take the buffered lines and write them to disk
+void CdrFileHandler::flush()
+{
+    Lock flock(m_fileMutex);
+    Lock lock(this);
+    unsigned int count = m_batch.dequeued();
+    if (!count)
+	return;
+    ObjList lines;
+    ObjList* tail = &lines;
+    while (GenObject* o = m_queue.remove(false))
+	tail = tail->append(o);
+    m_queueTail = &m_queue;
+    lock.drop();
+    writeLines(lines,count);
+}
+
+void CdrFileHandler::run()
+{
+    while (!(m_stopping || Thread::check(false))) {
+	m_wakeup.lock(1000 * (long)m_batch.flushInterval());
+	if (m_stopping || !m_batch.flushInterval())
+	    break;
+	flush();
+    }
+    lock();
+    m_writer = 0;
+    unlock();
+    flush();
+    Debug(__plugin.name(),DebugInfo,"CDR writer thread stopped");
+}
+
+// Stop the writer thread, CDRs are written synchronously from now on
+void CdrFileHandler::stop()
+{
+    lock();
+    m_stopping = true;
+    bool wait = (m_writer != 0);
+    unlock();
+    if (wait) {
+	m_wakeup.unlock();
+	while (m_writer)
+	    Thread::idle();
+    }
+    flush();
+}
+
+void CdrFileHandler::status(String& str)
+{
+    Lock lock(this);
+    m_batch.status(str);
+    str << ",async=" << String::boolText(m_writer != 0);
 }
 
 bool CdrFileHandler::received(Message &msg)
@@ -123,15 +320,39 @@ bool CdrFileHandler::received(Message &msg)
         return false;
 
     Lock lock(this);
-    if ((m_file >= 0) && m_format) {
-	String str = m_format;
-	str += EOLN;
-	msg.replaceParams(str);
-	YIGNORE(::write(m_file,str.c_str(),str.length()));
+    if (!m_active || m_format.null())
+	return false;
+    String* str = new String(m_format);
+    msg.replaceParams(*str);
+    m_batch.queued(str->length() + 1);
+    m_queueTail = m_queueTail->append(str);
+    if (!m_writer) {
+	lock.drop();
+	flush();
+	return false;
+    }
+    if (m_batch.flushNow())
+	m_wakeup.unlock();
+    // Disk can't keep up, throttle the callers
+    while (m_writer && m_batch.overflow()) {
+	lock.drop();
+	Thread::idle();
+	lock.acquire(this);
     }
     return false;
 };
 
+bool StatusHandler::received(Message &msg)
+{
+    const String* sel = msg.getParam(YSTRING("module"));
+    if (!(TelEngine::null(sel) || (*sel == YSTRING("cdrfile"))))
+	return false;
+    String st("name=cdrfile,type=cdr;");
+    m_handler->status(st);
+    msg.retValue() << st << "\r\n";
+    return false;
+}
+
 CdrFilePlugin::CdrFilePlugin()
     : Plugin("cdrfile",true),
       m_handler(0)
@@ -142,6 +363,8 @@ CdrFilePlugin::CdrFilePlugin()
 CdrFilePlugin::~CdrFilePlugin()
 {
     Output("Unloading module CdrFile");
+    if (m_handler)
+	m_handler->stop();
 }
 
 void CdrFilePlugin::initialize()
@@ -153,12 +376,17 @@ void CdrFilePlugin::initialize()
     if (file && !m_handler) {
 	m_handler = new CdrFileHandler("call.cdr");
 	Engine::install(m_handler);
+	Engine::install(new HaltHandler(m_handler));
+	Engine::install(new StatusHandler(m_handler));
     }
-    if (m_handler)
+    if (m_handler) {
+	const NamedList* general = cfg.getSection("general");
 	m_handler->init(file,cfg.getBoolValue("general","tabs",true),
 	    cfg.getBoolValue("general","combined",false),
 	    cfg.getValue("general","format"),
-	    cfg.getIntValue("general","mode",0640));
+	    cfg.getIntValue("general","mode",0640),
+	    general ? *general : NamedList::empty());
+    }
 }
 
 }; // anonymous namespace
@@ -134,7 +134,7 @@ bool EnumHandler::resolve(Message& msg,bool canRedirect,const ObjList* domains)
 	const String* s = static_cast<const String*>(l->get());
 	if (!s || s->null())
 	    continue;
-	int result = Resolver::naptrQuery(tmp + *s,res);
+	int result = Resolver::cachedQuery(Resolver::Naptr,tmp + *s,res);
 	if ((result == 0) && res.skipNull())
 	    break;
     }
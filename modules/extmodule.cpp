@@ -31,6 +31,13 @@
 
 #include <sys/stat.h>
 #include <sys/wait.h>
+#include <poll.h>
+#endif
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#define EXT_SHM
 #endif
 
 #include <string.h>
@@ -60,6 +67,20 @@ namespace { // anonymous
 // Safety wait time after we flushed watchers, relays or messages (in ms)
 #define WAIT_FLUSH 5
 
+// Length of the frame header in binary framing mode
+#define FRAME_HEADER 4
+
+// Shared memory transport, layout must match share/scripts/libyateshm.h
+#define SHM_MAGIC 0x59534d31
+// Minimum size of each shared memory ring
+#define MIN_SHM_SIZE 65536
+// Maximum size of each shared memory ring
+#define MAX_SHM_SIZE 16777216
+// Descriptors of the shared memory and the engine and application notifiers in scripts
+#define SHM_FD_MEMORY 5
+#define SHM_FD_NOTIFY_APP 6
+#define SHM_FD_NOTIFY_ENGINE 7
+
 static Configuration s_cfg;
 static ObjList s_chans;
 static ObjList s_modules;
@@ -68,6 +89,7 @@ static Mutex s_uses(false,"ExtModUse");
 static int s_waitFlush = WAIT_FLUSH;
 static int s_timeout = MSG_TIMEOUT;
 static int s_maxQueue = DEF_MAXQUEUE;
+static unsigned int s_shmSize = 0;
 static bool s_settime = false;
 static bool s_timebomb = false;
 static bool s_pluginSafe = true;
@@ -200,6 +222,8 @@ public:
     bool decode(const char *s);
     inline const Message* msg() const
 	{ return &m_msg; }
+    virtual const String& toString() const
+	{ return m_id; }
 };
 
 // Yet Another of Maciek's ideas
@@ -220,6 +244,61 @@ private:
     ObjList m_watched;
 };
 
+// One direction of the shared memory transport, each field on its own cache line
+struct ShmRing
+{
+    // Total octets written, modified only by the producer
+    uint32_t head;
+    uint32_t pad1[15];
+    // Total octets read, modified only by the consumer
+    uint32_t tail;
+    uint32_t pad2[15];
+    // Set by the consumer before it sleeps on the notifier
+    uint32_t waiting;
+    uint32_t pad3[15];
+    // Set by the producer before it sleeps waiting for free space
+    uint32_t full;
+    uint32_t pad4[15];
+};
+
+struct ShmHeader
+{
+    uint32_t magic;
+    // Size of the data area of each ring, a power of 2
+    uint32_t size;
+    uint32_t pad[14];
+    // Ring 0 carries data from engine to application, ring 1 the other way
+    ShmRing rings[2];
+};
+
+// Shared memory rings and event notifiers used by a script on the same host
+// Records are a native order 32 bit length followed by a command line
+class ExtModShm
+{
+public:
+    ExtModShm();
+    ~ExtModShm();
+    bool init(unsigned int size);
+    void childSetup();
+    int write(const char* data, unsigned int len);
+    uint32_t inHead() const;
+    int read(DataBlock& buf, uint32_t head);
+    bool prepareWait();
+    void endWait();
+    inline int notifyFd() const
+	{ return m_notifyEngine; }
+private:
+    void copyIn(unsigned char* data, uint32_t pos, const void* src, unsigned int len);
+    void copyOut(const unsigned char* data, uint32_t pos, void* dest, unsigned int len);
+    int m_fd;
+    int m_notifyApp;
+    int m_notifyEngine;
+    ShmHeader* m_hdr;
+    unsigned char* m_data[2];
+    uint32_t m_size;
+    size_t m_mapped;
+};
+
 class ExtModReceiver : public MessageReceiver, public Mutex, public DebugEnabler
 {
     friend class MsgWatcher;
@@ -229,15 +308,20 @@ public:
 	RoleGlobal,
 	RoleChannel
     };
+    enum {
+	OutKeep,
+	OutFraming,
+	OutShm
+    };
     static ExtModReceiver* build(const char *script, const char *args, bool ref = false,
 	File* ain = 0, File* aout = 0, ExtModChan *chan = 0);
-    static ExtModReceiver* build(const char* name, Stream* io, ExtModChan* chan = 0,
+    static ExtModReceiver* build(const char* name, Socket* io, ExtModChan* chan = 0,
 	int role = RoleUnknown, const char* conn = 0);
     static ExtModReceiver* find(const String& script, const String& arg);
     virtual void destruct();
     virtual bool received(Message& msg, int id);
     bool processLine(const char* line);
-    bool outputLine(const char* line);
+    bool outputLine(const char* line, int switchOut = OutKeep);
     void reportError(const char* line);
     void returnMsg(const Message* msg, const char* id, bool accepted);
     bool addWatched(const String& name);
@@ -270,13 +354,15 @@ public:
 private:
     ExtModReceiver(const char* script, const char* args,
 	File* ain, File* aout, ExtModChan* chan);
-    ExtModReceiver(const char* name, Stream* io, ExtModChan* chan,
+    ExtModReceiver(const char* name, Socket* io, ExtModChan* chan,
 	int role, const char* conn);
     bool create(const char* script, const char* args);
     void closeIn();
     void closeOut();
     void closeAudio();
     bool outputLineInternal(const char* line, int len);
+    void waitInput();
+    int processShm(uint32_t head);
     void debugMsgInstResult(bool ok, const char* oper, const char* name, const char* extra = 0);
 
     int m_role;
@@ -287,6 +373,7 @@ private:
     pid_t m_pid;
     Stream* m_in;
     Stream* m_out;
+    int m_inFd;
     File* m_ain;
     File* m_aout;
     ExtModChan* m_chan;
@@ -296,6 +383,11 @@ private:
     bool m_setdata;
     bool m_settime;
     bool m_writing;
+    bool m_binIn;
+    bool m_binOut;
+    ExtModShm* m_shm;
+    bool m_shmIn;
+    bool m_shmOut;
     int m_maxQueue;
     int m_timeout;
     bool m_timebomb;
@@ -303,7 +395,7 @@ private:
     bool m_scripted;
     DataBlock m_buffer;
     String m_script, m_args;
-    ObjList m_waiting;
+    HashList m_waiting;
     ObjList m_relays;
     String m_trackName;
     String m_reason;
@@ -642,7 +734,8 @@ void ExtModChan::disconnected(bool final, const char *reason)
 
 
 MsgHolder::MsgHolder(Message &msg)
-    : m_msg(msg), m_ret(false)
+    : Semaphore(1,"ExtModHolder",0),
+      m_msg(msg), m_ret(false)
 {
     // the address of this object should be unique
     char buf[64];
@@ -656,6 +749,201 @@ bool MsgHolder::decode(const char *s)
 }
 
 
+ExtModShm::ExtModShm()
+    : m_fd(-1), m_notifyApp(-1), m_notifyEngine(-1),
+      m_hdr(0), m_size(0), m_mapped(0)
+{
+    m_data[0] = m_data[1] = 0;
+}
+
+ExtModShm::~ExtModShm()
+{
+#ifdef EXT_SHM
+    if (m_hdr)
+	::munmap(m_hdr,m_mapped);
+    if (m_fd >= 0)
+	::close(m_fd);
+    if (m_notifyApp >= 0)
+	::close(m_notifyApp);
+    if (m_notifyEngine >= 0)
+	::close(m_notifyEngine);
+#endif
+}
+
+#ifdef EXT_SHM
+// Move a descriptor above the ones we will dup2() to in the child
+static int highFd(int fd)
+{
+    if (fd < 0)
+	return fd;
+    int h = ::fcntl(fd,F_DUPFD,SHM_FD_NOTIFY_ENGINE + 1);
+    ::close(fd);
+    return h;
+}
+#endif
+
+// Create the shared memory and notifiers, size is rounded up to a power of 2
+bool ExtModShm::init(unsigned int size)
+{
+#ifdef EXT_SHM
+    m_size = MIN_SHM_SIZE;
+    while (m_size < size && m_size < MAX_SHM_SIZE)
+	m_size <<= 1;
+    m_mapped = sizeof(ShmHeader) + 2 * m_size;
+    m_fd = highFd(::memfd_create("yate-extmodule",0));
+    if ((m_fd < 0) || ::ftruncate(m_fd,m_mapped))
+	return false;
+    void* p = ::mmap(0,m_mapped,PROT_READ | PROT_WRITE,MAP_SHARED,m_fd,0);
+    if (p == MAP_FAILED)
+	return false;
+    m_hdr = static_cast<ShmHeader*>(p);
+    m_hdr->size = m_size;
+    m_data[0] = reinterpret_cast<unsigned char*>(m_hdr + 1);
+    m_data[1] = m_data[0] + m_size;
+    m_notifyApp = highFd(::eventfd(0,EFD_NONBLOCK));
+    m_notifyEngine = highFd(::eventfd(0,EFD_NONBLOCK));
+    if ((m_notifyApp < 0) || (m_notifyEngine < 0))
+	return false;
+    __atomic_store_n(&m_hdr->magic,SHM_MAGIC,__ATOMIC_RELEASE);
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Place the descriptors at their well known numbers, called in the child process
+void ExtModShm::childSetup()
+{
+#ifdef EXT_SHM
+    ::dup2(m_fd,SHM_FD_MEMORY);
+    ::dup2(m_notifyApp,SHM_FD_NOTIFY_APP);
+    ::dup2(m_notifyEngine,SHM_FD_NOTIFY_ENGINE);
+#endif
+}
+
+void ExtModShm::copyIn(unsigned char* data, uint32_t pos, const void* src, unsigned int len)
+{
+    uint32_t offs = pos & (m_size - 1);
+    uint32_t first = m_size - offs;
+    if (first >= len)
+	::memcpy(data + offs,src,len);
+    else {
+	::memcpy(data + offs,src,first);
+	::memcpy(data,static_cast<const unsigned char*>(src) + first,len - first);
+    }
+}
+
+void ExtModShm::copyOut(const unsigned char* data, uint32_t pos, void* dest, unsigned int len)
+{
+    uint32_t offs = pos & (m_size - 1);
+    uint32_t first = m_size - offs;
+    if (first >= len)
+	::memcpy(dest,data + offs,len);
+    else {
+	::memcpy(dest,data + offs,first);
+	::memcpy(static_cast<unsigned char*>(dest) + first,data,len - first);
+    }
+}
+
+// Write a record to the application, return 1 on success, 0 if the ring is full
+//  and -1 if the record can never fit
+int ExtModShm::write(const char* data, unsigned int len)
+{
+#ifdef EXT_SHM
+    ShmRing& ring = m_hdr->rings[0];
+    uint32_t need = len + sizeof(uint32_t);
+    if (need > m_size)
+	return -1;
+    uint32_t head = ring.head;
+    uint32_t tail = __atomic_load_n(&ring.tail,__ATOMIC_ACQUIRE);
+    if (m_size - (head - tail) < need)
+	return 0;
+    uint32_t l = len;
+    copyIn(m_data[0],head,&l,sizeof(l));
+    copyIn(m_data[0],head + sizeof(l),data,len);
+    __atomic_store_n(&ring.head,head + need,__ATOMIC_RELEASE);
+    // wake up the application only if it's sleeping
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring.waiting,__ATOMIC_RELAXED)) {
+	uint64_t one = 1;
+	YIGNORE(::write(m_notifyApp,&one,sizeof(one)));
+    }
+    return 1;
+#else
+    return -1;
+#endif
+}
+
+// Snapshot of the data written by the application
+uint32_t ExtModShm::inHead() const
+{
+#ifdef EXT_SHM
+    return __atomic_load_n(&m_hdr->rings[1].head,__ATOMIC_ACQUIRE);
+#else
+    return 0;
+#endif
+}
+
+// Read a record from the application if any was written before head
+// Return 1 if a record was read, 0 if there is none, -1 if the ring is corrupted
+int ExtModShm::read(DataBlock& buf, uint32_t head)
+{
+#ifndef EXT_SHM
+    return 0;
+#else
+    ShmRing& ring = m_hdr->rings[1];
+    uint32_t tail = ring.tail;
+    if (tail == head)
+	return 0;
+    // the ring is writable by the application, never trust its content
+    uint32_t avail = head - tail;
+    if (avail > m_size || avail < sizeof(uint32_t))
+	return -1;
+    uint32_t len = 0;
+    copyOut(m_data[1],tail,&len,sizeof(len));
+    if (len > avail - sizeof(len))
+	return -1;
+    buf.resize(len + 1);
+    unsigned char* d = buf.data(0);
+    copyOut(m_data[1],tail + sizeof(len),d,len);
+    d[len] = 0;
+    __atomic_store_n(&ring.tail,tail + len + (uint32_t)sizeof(len),__ATOMIC_RELEASE);
+    // wake up the application if it waits for free space
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring.full,__ATOMIC_RELAXED)) {
+	uint64_t one = 1;
+	YIGNORE(::write(m_notifyApp,&one,sizeof(one)));
+    }
+    return 1;
+#endif
+}
+
+// Announce we are going to sleep, return false if data arrived meanwhile
+bool ExtModShm::prepareWait()
+{
+#ifndef EXT_SHM
+    return true;
+#else
+    ShmRing& ring = m_hdr->rings[1];
+    __atomic_store_n(&ring.waiting,1,__ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring.head,__ATOMIC_ACQUIRE) == ring.tail)
+	return true;
+    __atomic_store_n(&ring.waiting,0,__ATOMIC_RELAXED);
+    return false;
+#endif
+}
+
+void ExtModShm::endWait()
+{
+#ifdef EXT_SHM
+    uint64_t cnt;
+    YIGNORE(::read(m_notifyEngine,&cnt,sizeof(cnt)));
+    __atomic_store_n(&m_hdr->rings[1].waiting,0,__ATOMIC_RELAXED);
+#endif
+}
+
+
 ExtMessage::~ExtMessage()
 {
     if (m_receiver) {
@@ -769,7 +1057,7 @@ ExtModReceiver* ExtModReceiver::build(const char* script, const char* args, bool
     return recv->start() ? recv : 0;
 }
 
-ExtModReceiver* ExtModReceiver::build(const char* name, Stream* io, ExtModChan* chan,
+ExtModReceiver* ExtModReceiver::build(const char* name, Socket* io, ExtModChan* chan,
     int role, const char* conn)
 {
     ExtModReceiver* recv = new ExtModReceiver(name,io,chan,role,conn);
@@ -813,11 +1101,12 @@ bool ExtModReceiver::unuse()
 ExtModReceiver::ExtModReceiver(const char* script, const char* args, File* ain, File* aout, ExtModChan* chan)
     : Mutex(true,"ExtModReceiver"),
       m_role(RoleUnknown), m_dead(false), m_quit(false), m_use(1), m_qLength(0), m_pid(-1),
-      m_in(0), m_out(0), m_ain(ain), m_aout(aout),
+      m_in(0), m_out(0), m_inFd(-1), m_ain(ain), m_aout(aout),
       m_chan(chan), m_watcher(0),
       m_selfWatch(false), m_reenter(false), m_setdata(true), m_settime(s_settime), m_writing(false),
+      m_binIn(false), m_binOut(false), m_shm(0), m_shmIn(false), m_shmOut(false),
       m_maxQueue(s_maxQueue), m_timeout(s_timeout), m_timebomb(s_timebomb), m_restart(false), m_scripted(false),
-      m_buffer(0,DEF_INCOMING_LINE), m_script(script), m_args(args), m_trackName(s_trackName)
+      m_buffer(0,DEF_INCOMING_LINE), m_script(script), m_args(args), m_waiting(64), m_trackName(s_trackName)
 {
     debugChain(&__plugin);
     debugName(m_script);
@@ -831,20 +1120,25 @@ ExtModReceiver::ExtModReceiver(const char* script, const char* args, File* ain,
     s_mutex.unlock();
 }
 
-ExtModReceiver::ExtModReceiver(const char* name, Stream* io, ExtModChan* chan, int role, const char* conn)
+ExtModReceiver::ExtModReceiver(const char* name, Socket* io, ExtModChan* chan, int role, const char* conn)
     : Mutex(true,"ExtModReceiver"),
       m_role(role), m_dead(false), m_quit(false), m_use(1), m_qLength(0), m_pid(-1),
-      m_in(io), m_out(io), m_ain(0), m_aout(0),
+      m_in(io), m_out(io), m_inFd(-1), m_ain(0), m_aout(0),
       m_chan(chan), m_watcher(0),
       m_selfWatch(false), m_reenter(false), m_setdata(true), m_settime(s_settime), m_writing(false),
+      m_binIn(false), m_binOut(false), m_shm(0), m_shmIn(false), m_shmOut(false),
       m_maxQueue(s_maxQueue), m_timeout(s_timeout), m_timebomb(s_timebomb), m_restart(false), m_scripted(false),
-      m_buffer(0,DEF_INCOMING_LINE), m_script(name), m_args(conn), m_trackName(s_trackName)
+      m_buffer(0,DEF_INCOMING_LINE), m_script(name), m_args(conn), m_waiting(64), m_trackName(s_trackName)
 {
     debugChain(&__plugin);
     debugName(m_script);
     m_script.trimBlanks();
     m_args.trimBlanks();
     m_desc << "ExtModChan[" << m_script << "]";
+#ifndef _WINDOWS
+    if (io)
+	m_inFd = io->handle();
+#endif
     Debug(&__plugin,DebugAll,"%s args='%s' io=(%p) chan=(%p) created [%p]",
 	desc(),m_args.safe(),io,chan,this);
     if (chan)
@@ -875,6 +1169,10 @@ void ExtModReceiver::destruct()
     tmp = m_out;
     m_out = 0;
     delete tmp;
+    m_shmIn = m_shmOut = false;
+    ExtModShm* shm = m_shm;
+    m_shm = 0;
+    delete shm;
     unlock();
     Debug(&__plugin,DebugAll,"%s args='%s' destroyed [%p]",desc(),m_args.safe(),this);
     Thread::yield();
@@ -946,8 +1244,16 @@ bool ExtModReceiver::flush()
 	    p->setDelete(false);
     }
     bool flushed = false;
-    if (m_waiting.get()) {
+    if (m_waiting.count()) {
 	Debug(&__plugin,DebugInfo,"%s releasing %u pending messages [%p]",desc(),m_qLength,this);
+	// Wake up the dispatchers, they will find their message is no longer waiting
+	for (unsigned int i = 0; i < m_waiting.length(); i++) {
+	    for (ObjList* l = m_waiting.getList(i); l; l = l->next()) {
+		MsgHolder* h = static_cast<MsgHolder*>(l->get());
+		if (h)
+		    h->unlock();
+	    }
+	}
 	m_waiting.clear();
 	m_qLength = 0;
 	needWait = flushed = true;
@@ -1066,18 +1372,26 @@ bool ExtModReceiver::received(Message &msg, int id)
 	fail = true;
     }
     unlock();
-    // would be nice to lock the MsgHolder and wait for it to unlock from some
-    //  other thread - unfortunately this does not work with all mutexes
-    // sorry, Maciek - have to do it work in Windows too :-(
+    // the MsgHolder semaphore is signaled when the answer is received
+    //  or when pending messages are flushed
+    unsigned int hash = h.m_id.hash();
     while (ok) {
-	h.lock(Thread::idleUsec());
+	long maxwait = 1000000;
+	if (tout) {
+	    u_int64_t now = Time::now();
+	    if (now >= tout)
+		maxwait = 0;
+	    else if (tout - now < (u_int64_t)maxwait)
+		maxwait = (long)(tout - now);
+	}
+	h.lock(maxwait);
 	lock();
-	ok = (m_waiting.find(&h) != 0);
-	if (ok && tout && (Time::now() > tout)) {
+	ok = (m_waiting.find(&h,hash) != 0);
+	if (ok && tout && (Time::now() >= tout)) {
 	    Alarm(&__plugin,"performance",DebugWarn,
 		"%s message %p '%s' did not return in %d msec [%p]"
 		,desc(),&msg,msg.c_str(),m_timeout,this);
-	    if (m_waiting.remove(&h,false) && (m_qLength > 0))
+	    if (m_waiting.remove(&h,hash,false) && (m_qLength > 0))
 		m_qLength--;
 	    ok = false;
 	    fail = true;
@@ -1118,10 +1432,21 @@ bool ExtModReceiver::create(const char *script, const char *args)
 	::close(ext2yate[1]);
 	return false;
     }
+    ExtModShm* shm = 0;
+    if (s_shmSize) {
+	shm = new ExtModShm;
+	if (!shm->init(s_shmSize)) {
+	    Debug(&__plugin,DebugMild,"Unable to create shared memory for %s: %d %s",
+		info.safe(),errno,strerror(errno));
+	    delete shm;
+	    shm = 0;
+	}
+    }
     pid = ::fork();
     if (pid < 0) {
 	Debug(&__plugin,DebugWarn,"Failed to fork() %s: %d %s",
 	    info.safe(),errno,strerror(errno));
+	delete shm;
 	::close(yate2ext[0]);
 	::close(yate2ext[1]);
 	::close(ext2yate[0]);
@@ -1149,8 +1474,11 @@ bool ExtModReceiver::create(const char *script, const char *args)
 	    ::dup2(m_aout->handle(), STDERR_FILENO+2);
 	else
 	    ::close(STDERR_FILENO+2);
-	// Blindly close everything but stdin/out/err/audio
-	for (x=STDERR_FILENO+3;x<1024;x++)
+	// Set shared memory and notifiers
+	if (shm)
+	    shm->childSetup();
+	// Blindly close everything but stdin/out/err/audio/shared memory
+	for (x=(shm ? SHM_FD_NOTIFY_ENGINE+1 : STDERR_FILENO+3);x<1024;x++)
 	    ::close(x);
 	// Execute script
 	debugExec(true,info);
@@ -1164,7 +1492,9 @@ bool ExtModReceiver::create(const char *script, const char *args)
     else
 	Debug(&__plugin,DebugInfo,"Launched external script %s",info.safe());
     m_in = new File(ext2yate[0]);
+    m_inFd = ext2yate[0];
     m_out = new File(yate2ext[1]);
+    m_shm = shm;
 
     // close what we're not using in the parent
     close(ext2yate[1]);
@@ -1234,6 +1564,8 @@ void ExtModReceiver::run()
     for (;;) {
 	if (!use())
 	    return;
+	// records written before this point may follow data still in the pipe
+	uint32_t shmHead = m_shmIn ? m_shm->inHead() : 0;
 	lock();
 	char* buffer = static_cast<char*>(m_buffer.data());
 	int bufspace = m_buffer.length() - posinbuf - 1;
@@ -1247,6 +1579,9 @@ void ExtModReceiver::run()
 	    return;
 	}
 	if (!readsize) {
+	    // the application may have written more before exiting
+	    if (m_shmIn && (processShm(m_shm->inHead()) < 0))
+		return;
 	    if (m_in)
 		Debug(&__plugin,DebugInfo,"%s read EOF on %p [%p]",desc(),m_in,this);
 	    closeIn();
@@ -1262,7 +1597,14 @@ void ExtModReceiver::run()
 	    Lock mylock(this);
 	    if (m_in && m_in->canRetry()) {
 		mylock.drop();
-		Thread::idle();
+		if (m_shmIn) {
+		    int res = processShm(shmHead);
+		    if (res < 0)
+			return;
+		    if (res > 0)
+			continue;
+		}
+		waitInput();
 		continue;
 	    }
 	    if (!m_quit)
@@ -1278,20 +1620,43 @@ void ExtModReceiver::run()
 	}
 	buffer[totalsize] = 0;
 	for (;;) {
-	    char *eoline = ::strchr(buffer,'\n');
-	    if (!eoline && ((int)::strlen(buffer) < totalsize))
-		eoline=buffer+::strlen(buffer);
-	    if (!eoline)
-		break;
-	    *eoline = 0;
-	    if ((eoline > buffer) && (eoline[-1] == '\r'))
-		eoline[-1] = 0;
-	    readsize = eoline-buffer+1;
-	    if (buffer[0]) {
-		invalid = invalid && (buffer[0] != '%' || buffer[1] != '%');
+	    char* line = buffer;
+	    // byte following the line that gets overwritten by the terminator
+	    int saved = -1;
+	    if (m_binIn) {
+		if (totalsize < FRAME_HEADER)
+		    break;
+		const unsigned char* h = (const unsigned char*)buffer;
+		unsigned int flen = ((unsigned int)h[0] << 24) | ((unsigned int)h[1] << 16) |
+		    ((unsigned int)h[2] << 8) | h[3];
+		if (flen >= m_buffer.length() - FRAME_HEADER) {
+		    Debug(&__plugin,DebugWarn,"%s frame of length %u overflows buffer of length %u, closing [%p]",
+			desc(),flen,m_buffer.length(),this);
+		    return;
+		}
+		readsize = FRAME_HEADER + flen;
+		if (totalsize < readsize)
+		    break;
+		line = buffer + FRAME_HEADER;
+		saved = (unsigned char)buffer[readsize];
+		buffer[readsize] = 0;
+	    }
+	    else {
+		char *eoline = ::strchr(buffer,'\n');
+		if (!eoline && ((int)::strlen(buffer) < totalsize))
+		    eoline=buffer+::strlen(buffer);
+		if (!eoline)
+		    break;
+		*eoline = 0;
+		if ((eoline > buffer) && (eoline[-1] == '\r'))
+		    eoline[-1] = 0;
+		readsize = eoline-buffer+1;
+	    }
+	    if (line[0]) {
+		invalid = invalid && (line[0] != '%' || line[1] != '%');
 		if (!use())
 		    return;
-		bool goOut = processLine(buffer);
+		bool goOut = processLine(line);
 		if (unuse() || goOut)
 		    return;
 		if (totalsize >= (int)m_buffer.length()) {
@@ -1302,13 +1667,15 @@ void ExtModReceiver::run()
 	    }
 	    totalsize -= readsize;
 	    buffer = static_cast<char*>(m_buffer.data());
+	    if (saved >= 0)
+		buffer[readsize] = (char)saved;
 	    ::memmove(buffer,buffer+readsize,totalsize+1);
 	}
 	posinbuf = totalsize;
     }
 }
 
-bool ExtModReceiver::outputLine(const char* line)
+bool ExtModReceiver::outputLine(const char* line, int switchOut)
 {
     if (TelEngine::null(line))
 	return true;
@@ -1337,6 +1704,17 @@ bool ExtModReceiver::outputLine(const char* line)
 	Thread::idle();
     }
     bool ok = outputLineInternal(line,len);
+    // switch while still holding the writer so no other line gets in between
+    if (ok) {
+	switch (switchOut) {
+	    case OutFraming:
+		m_binOut = !m_binOut;
+		break;
+	    case OutShm:
+		m_shmOut = true;
+		break;
+	}
+    }
     m_writing = false;
     unuse();
     return ok;
@@ -1345,6 +1723,41 @@ bool ExtModReceiver::outputLine(const char* line)
 bool ExtModReceiver::outputLineInternal(const char* line, int len)
 {
     DDebug(&__plugin,DebugAll,"%s outputLine len=%d '%s' [%p]",desc(),len,line,this);
+    if (m_shmOut) {
+	uint64_t tout = (m_timeout > 0) ? (Time::now() + 1000 * (uint64_t)m_timeout) : 0;
+	for (;;) {
+	    if (m_dead || !m_shm)
+		return false;
+	    int res = m_shm->write(line,len);
+	    if (res > 0)
+		return true;
+	    if (res < 0) {
+		Debug(&__plugin,DebugWarn,"%s line of length %d does not fit in shared memory [%p]",
+		    desc(),len,this);
+		return false;
+	    }
+	    if (tout && tout < Time::now())
+		return false;
+	    Thread::idle();
+	}
+    }
+    // build the whole frame so it goes out in a single write
+    DataBlock frame(0,len + (m_binOut ? FRAME_HEADER : 1));
+    unsigned char* d = frame.data(0);
+    if (m_binOut) {
+	// length prefixed frame, network byte order, no line terminator
+	d[0] = (unsigned char)(len >> 24);
+	d[1] = (unsigned char)(len >> 16);
+	d[2] = (unsigned char)(len >> 8);
+	d[3] = (unsigned char)len;
+	::memcpy(d + FRAME_HEADER,line,len);
+    }
+    else {
+	::memcpy(d,line,len);
+	d[len] = '\n';
+    }
+    line = (const char*)d;
+    len = frame.length();
     // since m_out can be non-blocking (the socket) we have to loop
     while (m_out && m_out->valid() && (len > 0) && !m_dead) {
 	int w = m_out->writeData(line,len);
@@ -1359,19 +1772,69 @@ bool ExtModReceiver::outputLineInternal(const char* line, int len)
 	if (len > 0)
 	    Thread::idle();
     }
-    char nl = '\n';
-    for (;;) {
-	if (m_dead || !m_out)
-	    return false;
-	int w = m_out->writeData(&nl,1);
-	if ((w < 0) && m_out && m_out->canRetry())
-	    w = 0;
-	if (w > 0)
-	    return true;
-	if (w < 0)
-	    return false;
-	Thread::idle();
+    return (len <= 0) && !m_dead;
+}
+
+// Process records received in shared memory
+// Return -1 if the receiver must stop, 0 if there was nothing to process
+int ExtModReceiver::processShm(uint32_t head)
+{
+    int res = 0;
+    DataBlock buf;
+    while (m_shm) {
+	int rd = m_shm->read(buf,head);
+	if (!rd)
+	    break;
+	if (rd < 0) {
+	    Debug(&__plugin,DebugWarn,"%s invalid record in shared memory, closing [%p]",
+		desc(),this);
+	    // the application can no longer be talked to, stop using the rings
+	    lock();
+	    m_shmIn = m_shmOut = false;
+	    unlock();
+	    return -1;
+	}
+	const char* line = (const char*)buf.data();
+	if (!line[0])
+	    continue;
+	res = 1;
+	if (!use())
+	    return -1;
+	bool goOut = processLine(line);
+	if (unuse() || goOut)
+	    return -1;
+    }
+    return res;
+}
+
+// Wait for input to become available instead of sleeping a full idle interval
+void ExtModReceiver::waitInput()
+{
+#ifndef _WINDOWS
+    if (m_shmIn && m_shm) {
+	if (!m_shm->prepareWait())
+	    return;
+	struct pollfd pfd[2];
+	pfd[0].fd = m_shm->notifyFd();
+	pfd[0].events = POLLIN;
+	pfd[0].revents = 0;
+	pfd[1].fd = m_inFd;
+	pfd[1].events = POLLIN;
+	pfd[1].revents = 0;
+	::poll(pfd,(m_inFd >= 0) ? 2 : 1,Thread::idleMsec());
+	m_shm->endWait();
+	return;
+    }
+    if (m_inFd >= 0) {
+	struct pollfd pfd;
+	pfd.fd = m_inFd;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	::poll(&pfd,1,Thread::idleMsec());
+	return;
     }
+#endif
+    Thread::idle();
 }
 
 void ExtModReceiver::reportError(const char* line)
@@ -1434,14 +1897,23 @@ bool ExtModReceiver::processLine(const char* line)
 	    }
 	    else
 		role = id;
-	    DDebug(&__plugin,DebugAll,"%s role '%s' chan '%s' type '%s' [%p]",
-		desc(),role.c_str(),chan.c_str(),type.c_str(),this);
-	    if (role == "global") {
-		m_role = RoleGlobal;
-		return false;
+	    String framing;
+	    sep = type.find(':');
+	    if (sep >= 0) {
+		framing = type.substr(sep+1);
+		type = type.substr(0,sep);
+	    }
+	    DDebug(&__plugin,DebugAll,"%s role '%s' chan '%s' type '%s' framing '%s' [%p]",
+		desc(),role.c_str(),chan.c_str(),type.c_str(),framing.c_str(),this);
+	    if (framing && (framing != YSTRING("text")) && (framing != YSTRING("binary"))) {
+		Debug(&__plugin,DebugWarn,"%s unknown framing '%s' received [%p]",
+		    desc(),framing.c_str(),this);
+		return true;
 	    }
-	    else if (role == "channel") {
-		m_role = RoleChannel;
+	    if ((role == "global") || (role == "channel")) {
+		m_role = (role == "global") ? RoleGlobal : RoleChannel;
+		// there is no answer to connect so both directions switch now
+		m_binIn = m_binOut = (framing == YSTRING("binary"));
 		return false;
 	    }
 	    Debug(&__plugin,DebugWarn,"%s unknown role '%s' received [%p]",desc(),role.c_str(),this);
@@ -1452,23 +1924,25 @@ bool ExtModReceiver::processLine(const char* line)
 	return true;
     }
     else if (id.startsWith("%%<message:")) {
+	// the message id is the first field, use it to find the waiting holder
+	const char* hid = line + 11;
+	const char* sep = ::strchr(hid,':');
+	String hidStr(hid,sep ? (int)(sep - hid) : -1);
+	hidStr = String::msgUnescape(hidStr);
 	Lock mylock(this);
-	ObjList *p = &m_waiting;
-	for (; p; p=p->next()) {
-	    MsgHolder *msg = static_cast<MsgHolder *>(p->get());
-	    if (msg && msg->decode(line)) {
-		DDebug(&__plugin,DebugInfo,"%s matched message %p [%p]",desc(),msg->msg(),this);
-		if (m_chan && (m_chan->waitMsg() == msg->msg())) {
-		    DDebug(&__plugin,DebugNote,"%s entering wait mode on channel %p [%p]",
-			desc(),m_chan,this);
-		    m_chan->waitMsg(0);
-		    m_chan->waiting(true);
-		}
-		msg->unlock();
-		if (p->remove(false) && (m_qLength > 0))
-		    m_qLength--;
-		return false;
+	MsgHolder *msg = static_cast<MsgHolder *>(m_waiting[hidStr]);
+	if (msg && msg->decode(line)) {
+	    DDebug(&__plugin,DebugInfo,"%s matched message %p [%p]",desc(),msg->msg(),this);
+	    if (m_chan && (m_chan->waitMsg() == msg->msg())) {
+		DDebug(&__plugin,DebugNote,"%s entering wait mode on channel %p [%p]",
+		    desc(),m_chan,this);
+		m_chan->waitMsg(0);
+		m_chan->waiting(true);
 	    }
+	    if (m_waiting.remove(msg,hidStr.hash(),false) && (m_qLength > 0))
+		m_qLength--;
+	    msg->unlock();
+	    return false;
 	}
 	Debug(&__plugin,(m_dead ? DebugInfo : DebugWarn),
 	    "%s unmatched%s message: %s [%p]",desc(),(m_dead ? " dead" : ""),line,this);
@@ -1566,6 +2040,7 @@ bool ExtModReceiver::processLine(const char* line)
 	    val.trimBlanks();
 	    id = id.substr(0,col);
 	    bool ok = false;
+	    int switchOut = OutKeep;
 	    Lock mylock(this);
 	    if (m_dead)
 		return false;
@@ -1617,6 +2092,31 @@ bool ExtModReceiver::processLine(const char* line)
 		val = m_buffer.length();
 		ok = true;
 	    }
+	    else if (id == "framing") {
+		// the application switches its output right after the request,
+		//  our output switches right after the answer
+		if (val.null())
+		    ok = true;
+		else if ((val == YSTRING("binary")) || (val == YSTRING("text"))) {
+		    m_binIn = (val == YSTRING("binary"));
+		    if (m_binIn != m_binOut)
+			switchOut = OutFraming;
+		    ok = true;
+		}
+		val = m_binIn ? "binary" : "text";
+	    }
+	    else if (id == "transport") {
+		// switching to shared memory is one way only, the answer is the
+		//  last line sent through the pipe
+		if (val.null() || (val == (m_shmIn ? "shm" : "pipe")))
+		    ok = true;
+		else if ((val == YSTRING("shm")) && m_shm) {
+		    m_shmIn = true;
+		    switchOut = OutShm;
+		    ok = true;
+		}
+		val = m_shmIn ? "shm" : "pipe";
+	    }
 	    else if (id == "restart") {
 		m_restart = m_scripted && (RoleGlobal == m_role) && val.toBoolean(m_restart);
 		val = m_restart;
@@ -1696,7 +2196,7 @@ bool ExtModReceiver::processLine(const char* line)
 		desc(),id.c_str(),val.c_str(),ok ? "ok" : "failed",this);
 	    String out("%%<setlocal:");
 	    out << id << ":" << val << ":" << ok;
-	    outputLine(out);
+	    outputLine(out,switchOut);
 	    return false;
 	}
     }
@@ -1741,16 +2241,12 @@ bool ExtModReceiver::processLine(const char* line)
 	    id = m->id();
 	    if (id && !chan) {
 		// Copy the user data pointer from waiting message with same id
-		ObjList *p = &m_waiting;
-		for (; p; p=p->next()) {
-		    MsgHolder *h = static_cast<MsgHolder *>(p->get());
-		    if (h && (h->m_id == id)) {
-			RefObject* ud = h->m_msg.userData();
-			Debug(&__plugin,DebugAll,"%s copying data pointer %p from %p '%s' [%p]",
-			    desc(),ud,h->msg(),h->msg()->c_str(),this);
-			m->userData(ud);
-			break;
-		    }
+		MsgHolder *h = static_cast<MsgHolder *>(m_waiting[id]);
+		if (h) {
+		    RefObject* ud = h->m_msg.userData();
+		    Debug(&__plugin,DebugAll,"%s copying data pointer %p from %p '%s' [%p]",
+			desc(),ud,h->msg(),h->msg()->c_str(),this);
+		    m->userData(ud);
 		}
 	    }
 	    if (m_settime || !m->msgTime())
@@ -1994,6 +2490,7 @@ void ExtModulePlugin::initialize()
     s_cfg.load();
     NamedList& gen = *s_cfg.createSection(YSTRING("general"));
     s_maxQueue = s_cfg.getIntValue("general","maxqueue",DEF_MAXQUEUE,0,MAX_MAXQUEUE);
+    s_shmSize = s_cfg.getIntValue("general","shm_size",0,0,MAX_SHM_SIZE);
     s_timeout = s_cfg.getIntValue("general","timeout",MSG_TIMEOUT);
     s_timebomb = s_cfg.getBoolValue("general","timebomb",false);
     s_settime = s_cfg.getBoolValue("general","settime",false);
@@ -174,6 +174,7 @@ public:
     void msgPostExecute(const Message& msg, bool handled);
     inline JsParser& parser()
 	{ return m_assistCode; }
+    static void snapshotInit(ScriptContext* context);
 protected:
     virtual void statusParams(String& str);
     virtual bool commandExecute(String& retVal, const String& line);
@@ -181,7 +182,10 @@ protected:
 private:
     bool evalContext(String& retVal, const String& cmd, ScriptContext* context = 0, ScriptInfo* si = 0);
     void clearPostHook();
+    ScriptContext* assistSnapshot();
     JsParser m_assistCode;
+    ScriptContext* m_assistSnap;
+    unsigned int m_snapClones;
     MessagePostHook* m_postHook;
     bool m_started;
 };
@@ -353,9 +357,9 @@ public:
 	Ended,
 	Hangup
     };
-    inline JsAssist(ChanAssistList* list, const String& id, ScriptRun* runner)
+    inline JsAssist(ChanAssistList* list, const String& id, ScriptRun* runner, bool cloned = false)
 	: ChanAssist(list, id), ScriptInfoHolder(0,ScriptInfo::Route),
-	  m_runner(runner), m_state(NotStarted), m_handled(false), m_repeat(false)
+	  m_runner(runner), m_state(NotStarted), m_handled(false), m_repeat(false), m_cloned(cloned)
 	{ attachScriptInfo(runner); }
     virtual ~JsAssist();
     virtual void msgStartup(Message& msg);
@@ -392,6 +396,7 @@ private:
     State m_state;
     bool m_handled;
     bool m_repeat;
+    bool m_cloned;
     RefPointer<JsMessage> m_message;
 };
 
@@ -2107,6 +2112,7 @@ static bool s_allowLink = true;
 static bool s_trackObj = false;
 static unsigned int s_trackCreation = 0;
 static bool s_autoExt = true;
+static bool s_routeSnapshot = false;
 static unsigned int s_maxFile = 500000;
 
 const TokenDict ScriptInfo::s_type[] = {
@@ -2183,13 +2189,7 @@ static void contextInit(ScriptRun* runner, const char* name = 0, bool autoExt =
     bool allowSingleton = ctx->instanceIndex() < 2 && si
 	&& (si->type() == ScriptInfo::Static || si->type() == ScriptInfo::Dynamic);
     JsMessage::initialize(ctx,allowSingleton);
-    JsFile::initialize(ctx);
-    JsConfigFile::initialize(ctx);
-    JsXML::initialize(ctx);
-    JsHasher::initialize(ctx);
-    JsJSON::initialize(ctx);
-    JsDNS::initialize(ctx);
-    JsXPath::initialize(ctx);
+    JsModule::snapshotInit(ctx);
     if (autoExt)
 	contextLoad(ctx,name);
 }
@@ -4150,7 +4150,7 @@ bool JsMessage::runNative(ObjList& stack, const ExpOperation& oper, GenObject* c
 
 			    for (ObjList* o = from->paramList()->skipNull(); o; o = o->skipNext()) {
 				NamedString* ns = static_cast<NamedString*>(o->get());
-				const_cast<String&>(ns->name()) = prefix + "." + ns->name();
+				ns->rename(prefix + "." + ns->name());
 			    }
 			    prefix += ".";
 			}
@@ -7606,7 +7606,7 @@ void JsDNS::runQuery(ObjList& stack, const String& name, Resolver::Type type, Ge
     }
     JsArray* jsa = 0;
     ObjList res;
-    if (Resolver::query(type,name,res) == 0) {
+    if (Resolver::cachedQuery(type,name,res) == 0) {
 	jsa = new JsArray(context,lineNo,mutex());
 	switch (type) {
 	    case Resolver::A4:
@@ -8154,7 +8154,8 @@ bool JsAssist::init()
     if (!m_runner)
 	return false;
     contextInit(m_runner,id(),s_autoExt,this);
-    if (ScriptRun::Invalid == m_runner->reset(true))
+    // A context cloned from snapshot already holds the script globals
+    if (ScriptRun::Invalid == m_runner->reset(!m_cloned))
 	return false;
     ScriptContext* ctx = m_runner->context();
     ctx->trackObjs(s_trackCreation);
@@ -8899,7 +8900,7 @@ static const char* s_cmdsLine = "  javascript {info|eval[=context] instructions.
 
 JsModule::JsModule()
     : ChanAssistList("javascript",true),
-      m_postHook(0), m_started(Engine::started())
+      m_assistSnap(0), m_snapClones(0), m_postHook(0), m_started(Engine::started())
 {
     Output("Loaded module Javascript");
 }
@@ -8908,6 +8909,41 @@ JsModule::~JsModule()
 {
     Output("Unloading module Javascript");
     clearPostHook();
+    TelEngine::destruct(m_assistSnap);
+}
+
+// Initialize the global objects that are stateless and can be shared from a snapshot
+void JsModule::snapshotInit(ScriptContext* context)
+{
+    JsObject::initialize(context);
+    JsFile::initialize(context);
+    JsConfigFile::initialize(context);
+    JsXML::initialize(context);
+    JsHasher::initialize(context);
+    JsJSON::initialize(context);
+    JsDNS::initialize(context);
+    JsXPath::initialize(context);
+}
+
+// Retrieve the routing script snapshot, build it if needed
+// Must be called with JsGlobal::s_mutex locked
+ScriptContext* JsModule::assistSnapshot()
+{
+    if (m_assistSnap || !s_routeSnapshot)
+	return m_assistSnap;
+    ScriptCode* code = m_assistCode.code();
+    if (!code)
+	return 0;
+    ScriptContext* ctx = m_assistCode.createContext();
+    snapshotInit(ctx);
+    if (code->initialize(ctx) && JsParser::snapshotContext(ctx,code,snapshotInit)) {
+	DDebug(this,DebugInfo,"Built routing script snapshot (%p)",ctx);
+	m_assistSnap = ctx;
+	m_snapClones = 0;
+    }
+    else
+	TelEngine::destruct(ctx);
+    return m_assistSnap;
 }
 
 void JsModule::clearPostHook()
@@ -8935,7 +8971,9 @@ void JsModule::statusParams(String& str)
     Lock lck(JsGlobal::s_mutex);
     str << "globals=" << JsGlobal::globals().count()
 	<< ",handlers=" << JsGlobal::handlers().count()
-	<< ",posthooks=" << JsGlobal::posthooks().count();
+	<< ",posthooks=" << JsGlobal::posthooks().count()
+	<< ",snapshot=" << String::boolText(0 != m_assistSnap)
+	<< ",cloned=" << m_snapClones;
     lck.acquire(this);
     str << ",routing=" << calls().count();
 }
@@ -9318,12 +9356,20 @@ ChanAssist* JsModule::create(Message& msg, const String& id)
     if ((msg == YSTRING("chan.startup")) && (msg[YSTRING("direction")] == YSTRING("outgoing")))
 	return 0;
     Lock lck(JsGlobal::s_mutex);
-    ScriptRun* runner = m_assistCode.createRunner(0,NATIVE_TITLE);
+    ScriptContext* ctx = assistSnapshot();
+    if (ctx) {
+	ctx = m_assistCode.cloneContext(ctx);
+	if (ctx)
+	    m_snapClones++;
+    }
+    ScriptRun* runner = m_assistCode.createRunner(ctx,NATIVE_TITLE);
     lck.drop();
+    bool cloned = (0 != ctx);
+    TelEngine::destruct(ctx);
     if (!runner)
 	return 0;
     DDebug(this,DebugInfo,"Creating Javascript for '%s'",id.c_str());
-    JsAssist* ca = new JsAssist(this,id,runner);
+    JsAssist* ca = new JsAssist(this,id,runner,cloned);
     if (ca->init())
 	return ca;
     TelEngine::destruct(ca);
@@ -9360,6 +9406,7 @@ void JsModule::initialize()
     s_libsPath = tmp;
     s_maxFile = cfg.getIntValue("general","max_length",500000,32768,2097152);
     s_autoExt = cfg.getBoolValue("general","auto_extensions",true);
+    bool snap = cfg.getBoolValue("general","route_snapshot");
     s_allowAbort = cfg.getBoolValue("general","allow_abort");
     s_trackObj = cfg.getBoolValue("general","track_objects");
     s_trackCreation = cfg.getIntValue("general","track_obj_life",s_trackCreation,0);
@@ -9376,7 +9423,12 @@ void JsModule::initialize()
     tmp = cfg.getValue("general","routing");
     Engine::runParams().replaceParams(tmp);
     Lock lck(JsGlobal::s_mutex);
+    if (snap != s_routeSnapshot) {
+	s_routeSnapshot = snap;
+	TelEngine::destruct(m_assistSnap);
+    }
     if (changed || m_assistCode.scriptChanged(tmp,s_basePath,s_libsPath)) {
+	TelEngine::destruct(m_assistSnap);
 	m_assistCode.clear();
 	m_assistCode.setMaxFileLen(s_maxFile);
 	m_assistCode.link(s_allowLink);
@@ -97,6 +97,84 @@ public:
     virtual bool received(Message &msg);
 };
 
+// Node of the literal prefix trie, children are kept in a sibling chain
+class PrefixNode
+{
+public:
+    inline PrefixNode(char c = 0)
+	: m_char(c), m_child(0), m_next(0), m_rules(0), m_count(0), m_alloc(0)
+	{ }
+    ~PrefixNode();
+    PrefixNode* child(char c) const;
+    PrefixNode* addChild(char c, unsigned int& nodes);
+    void addRule(unsigned int index);
+    inline unsigned int count() const
+	{ return m_count; }
+    inline unsigned int rule(unsigned int idx) const
+	{ return m_rules[idx]; }
+
+private:
+    char m_char;
+    PrefixNode* m_child;
+    PrefixNode* m_next;
+    unsigned int* m_rules;
+    unsigned int m_count;
+    unsigned int m_alloc;
+};
+
+// Iteration state over the candidate rules of one compiled context
+class RuleCursor
+{
+public:
+    inline RuleCursor(bool all = false)
+	: m_all(all), m_match(m_fixed), m_count(0), m_alloc(sizeof(m_fixed) / sizeof(unsigned int)),
+	  m_matchPos(0), m_otherPos(0)
+	{ }
+    inline ~RuleCursor()
+	{ if (m_match != m_fixed) delete[] m_match; }
+    void addMatch(unsigned int index);
+    void sortMatches();
+
+    bool m_all;
+    unsigned int* m_match;
+    unsigned int m_count;
+    unsigned int m_alloc;
+    unsigned int m_matchPos;
+    unsigned int m_otherPos;
+
+private:
+    unsigned int m_fixed[32];
+};
+
+// A routing section with literal prefix rules indexed in a trie
+class RegexContext : public String
+{
+public:
+    RegexContext(const NamedList& sect, bool extended, bool insensitive, bool trie);
+    ~RegexContext();
+    inline unsigned int count() const
+	{ return m_count; }
+    inline unsigned int literal() const
+	{ return m_literal; }
+    inline unsigned int nodes() const
+	{ return m_nodes; }
+    inline const NamedString* rule(unsigned int index) const
+	{ return m_rules[index]; }
+    void lookup(RuleCursor& cursor, const String& str) const;
+    unsigned int next(RuleCursor& cursor, unsigned int index) const;
+    static unsigned int literalPrefix(const String& rule, const String& value,
+	bool extended, bool insensitive);
+
+private:
+    const NamedString** m_rules;
+    unsigned int m_count;
+    unsigned int* m_others;
+    unsigned int m_otherCount;
+    unsigned int m_literal;
+    unsigned int m_nodes;
+    PrefixNode m_root;
+};
+
 class RegexConfig: public RefObject
 {
 public:
@@ -113,15 +191,25 @@ public:
     bool oneContext(Message &msg, String &str, const String &context, String &ret,
 	const String& trace = String::empty(), int traceLevel = DebugNote, ObjList* traceLst = 0,
 	bool warn = false, int depth = 0);
+    void lookupDone(u_int64_t usec);
+    void statusParams(String& str);
     inline unsigned int sectCount() const
 	{ return m_cfg.count(); }
 
 private:
+    void compile();
     Configuration m_cfg;
     bool m_extended;
     bool m_insensitive;
     int m_maxDepth;
     String m_defRule;
+    HashList m_compiled;
+    unsigned int m_rules;
+    unsigned int m_literal;
+    unsigned int m_nodes;
+    u_int64_t m_compileTime;
+    AtomicUInt64 m_lookups;
+    AtomicUInt64 m_lookupTime;
 };
 
 class RegexRoutePlugin : public Module
@@ -605,9 +693,189 @@ static GenericHandler* findHandler(unsigned int hash)
     return 0;
 }
 
+PrefixNode::~PrefixNode()
+{
+    delete m_child;
+    delete m_next;
+    delete[] m_rules;
+}
+
+// Find a direct child node by character
+PrefixNode* PrefixNode::child(char c) const
+{
+    for (PrefixNode* n = m_child; n; n = n->m_next)
+	if (n->m_char == c)
+	    return n;
+    return 0;
+}
+
+// Find or create a direct child node
+PrefixNode* PrefixNode::addChild(char c, unsigned int& nodes)
+{
+    PrefixNode* n = child(c);
+    if (!n) {
+	n = new PrefixNode(c);
+	n->m_next = m_child;
+	m_child = n;
+	nodes++;
+    }
+    return n;
+}
+
+// Add a rule index, rules are added in increasing order
+void PrefixNode::addRule(unsigned int index)
+{
+    if (m_count >= m_alloc) {
+	m_alloc = m_alloc ? 2 * m_alloc : 2;
+	unsigned int* tmp = new unsigned int[m_alloc];
+	if (m_count)
+	    ::memcpy(tmp,m_rules,m_count * sizeof(unsigned int));
+	delete[] m_rules;
+	m_rules = tmp;
+    }
+    m_rules[m_count++] = index;
+}
+
+
+void RuleCursor::addMatch(unsigned int index)
+{
+    if (m_count >= m_alloc) {
+	m_alloc *= 2;
+	unsigned int* tmp = new unsigned int[m_alloc];
+	::memcpy(tmp,m_match,m_count * sizeof(unsigned int));
+	if (m_match != m_fixed)
+	    delete[] m_match;
+	m_match = tmp;
+    }
+    m_match[m_count++] = index;
+}
+
+// Sort matched rules by index, there are usually just a few of them
+void RuleCursor::sortMatches()
+{
+    for (unsigned int i = 1; i < m_count; i++) {
+	unsigned int idx = m_match[i];
+	unsigned int j = i;
+	for (; j && m_match[j - 1] > idx; j--)
+	    m_match[j] = m_match[j - 1];
+	m_match[j] = idx;
+    }
+}
+
+
+RegexContext::RegexContext(const NamedList& sect, bool extended, bool insensitive, bool trie)
+    : String(sect),
+      m_rules(0), m_count(sect.length()), m_others(0), m_otherCount(0),
+      m_literal(0), m_nodes(0)
+{
+    m_rules = new const NamedString*[m_count];
+    m_others = new unsigned int[m_count];
+    unsigned int i = 0;
+    for (const ObjList* o = sect.paramList(); o && (i < m_count); o = o->next(), i++) {
+	const NamedString* n = static_cast<const NamedString*>(o->get());
+	m_rules[i] = n;
+	if (!n)
+	    continue;
+	unsigned int len = trie ? literalPrefix(n->name(),*n,extended,insensitive) : 0;
+	if (!len) {
+	    m_others[m_otherCount++] = i;
+	    continue;
+	}
+	PrefixNode* node = &m_root;
+	for (unsigned int j = 1; j <= len; j++)
+	    node = node->addChild(n->name().at(j),m_nodes);
+	node->addRule(i);
+	m_literal++;
+    }
+    for (; i < m_count; i++)
+	m_rules[i] = 0;
+}
+
+RegexContext::~RegexContext()
+{
+    delete[] m_rules;
+    delete[] m_others;
+}
+
+// Collect the literal prefix rules matching the start of a string
+void RegexContext::lookup(RuleCursor& cursor, const String& str) const
+{
+    cursor.m_count = 0;
+    cursor.m_matchPos = 0;
+    if (!m_literal)
+	return;
+    // matching is done on the trimmed string
+    const char* s = str.c_str();
+    while (*s == ' ' || *s == '\t')
+	s++;
+    const PrefixNode* node = &m_root;
+    for (; *s; s++) {
+	node = node->child(*s);
+	if (!node)
+	    break;
+	for (unsigned int j = 0; j < node->count(); j++)
+	    cursor.addMatch(node->rule(j));
+    }
+    cursor.sortMatches();
+}
+
+// Get the index of the first rule that needs evaluation, starting from index
+unsigned int RegexContext::next(RuleCursor& cursor, unsigned int index) const
+{
+    if (cursor.m_all)
+	return index;
+    while (cursor.m_otherPos < m_otherCount && m_others[cursor.m_otherPos] < index)
+	cursor.m_otherPos++;
+    while (cursor.m_matchPos < cursor.m_count && cursor.m_match[cursor.m_matchPos] < index)
+	cursor.m_matchPos++;
+    unsigned int ret = m_count;
+    if (cursor.m_otherPos < m_otherCount)
+	ret = m_others[cursor.m_otherPos];
+    if (cursor.m_matchPos < cursor.m_count && cursor.m_match[cursor.m_matchPos] < ret)
+	ret = cursor.m_match[cursor.m_matchPos];
+    return ret;
+}
+
+// Get the length of the literal prefix a rule requires, zero if none
+unsigned int RegexContext::literalPrefix(const String& rule, const String& value,
+    bool extended, bool insensitive)
+{
+    // block start lines and 'or' chains are evaluated even if the rule fails
+    static Regexp s_blockStart("^\\(.*=[[:space:]]*\\)\\?{$");
+    if (rule.length() < 2 || rule.at(0) != '^' || rule.endsWith("^")
+	    || s_blockStart.matches(value) || value.startsWith("or",true))
+	return 0;
+    // alternation can bypass the anchored prefix
+    if (rule.find('|') >= 0)
+	return 0;
+    unsigned int len = 1;
+    for (; len < rule.length(); len++) {
+	char c = rule.at(len);
+	if ((c >= '0' && c <= '9') || c == '#' || c == '@' || c == '_' || c == '-'
+		|| c == ':' || c == '/' || c == '%' || c == ',')
+	    continue;
+	if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+	    if (insensitive)
+		break;
+	    continue;
+	}
+	if (c == '+' && !extended)
+	    continue;
+	break;
+    }
+    // a quantifier applies to the last literal character
+    const char* rest = rule.c_str() + len;
+    if ((rest[0] == '*') || (extended && (rest[0] == '?' || rest[0] == '+' || rest[0] == '{'))
+	    || (!extended && rest[0] == '\\' && (rest[1] == '?' || rest[1] == '+' || rest[1] == '{')))
+	len--;
+    return len - 1;
+}
+
+
 RegexConfig::RegexConfig(const String& confName)
     : m_extended(false), m_insensitive(false),
-    m_maxDepth(5)
+    m_maxDepth(5),
+    m_rules(0), m_literal(0), m_nodes(0), m_compileTime(0)
 {
     Debug(&__plugin,DebugAll,"Creating new RegexConfig for configuration name '%s' [%p]",
 	confName.c_str(),this);
@@ -631,6 +899,7 @@ void RegexConfig::initialize(bool first)
 	depth = 100;
     m_maxDepth = depth;
     m_defRule = m_cfg.getValue("priorities","defaultrule",DEFAULT_RULE);
+    compile();
 
     const char* trackName = m_cfg.getBoolValue("priorities","trackparam",true) ?
 	__plugin.name().c_str() : (const char*)0;
@@ -699,6 +968,43 @@ void RegexConfig::initialize(bool first)
 
 #undef CHECK_HANDLER
 
+// Build the rule index of all sections
+void RegexConfig::compile()
+{
+    u_int64_t t = Time::now();
+    bool trie = m_cfg.getBoolValue("priorities","prefixtrie",true);
+    unsigned int n = m_cfg.sections();
+    for (unsigned int i = 0; i < n; i++) {
+	const NamedList* sect = m_cfg.getSection(i);
+	if (!sect || m_compiled[*sect])
+	    continue;
+	RegexContext* ctx = new RegexContext(*sect,m_extended,m_insensitive,trie);
+	m_rules += ctx->count();
+	m_literal += ctx->literal();
+	m_nodes += ctx->nodes();
+	m_compiled.append(ctx);
+    }
+    m_compileTime = Time::now() - t;
+    Debug(&__plugin,DebugInfo,"Compiled %u rules, %u literal prefixes in %u trie nodes in " FMT64U " usec",
+	m_rules,m_literal,m_nodes,m_compileTime);
+}
+
+// Account the duration of a top level context search
+void RegexConfig::lookupDone(u_int64_t usec)
+{
+    m_lookups.inc();
+    m_lookupTime.add(usec);
+}
+
+void RegexConfig::statusParams(String& str)
+{
+    str << ",rules=" << m_rules << ",literal=" << m_literal << ",nodes=" << m_nodes;
+    str << ",compiled=" << (unsigned int)m_compileTime;
+    u_int64_t lookups = m_lookups.valueAtomic();
+    str << ",lookups=" << lookups;
+    str << ",lookupavg=" << (unsigned int)(lookups ? (m_lookupTime.valueAtomic() / lookups) : 0);
+}
+
 // helper function to set the default regexp
 void RegexConfig::setDefault(Regexp& reg)
 {
@@ -824,13 +1130,16 @@ bool RegexConfig::oneContext(Message &msg, String &str, const String &context, S
     }
 
     TRACE_RULE(traceLevel,trace,traceLst,"Searching match for %s",str.c_str());
-    NamedList *l = m_cfg.getSection(context);
+    const RegexContext* l = static_cast<const RegexContext*>(m_compiled[context]);
     if (l) {
 	unsigned int blockDepth = 0;
 	BlockState blockStack[BLOCK_STACK];
-	unsigned int len = l->length();
-	for (unsigned int i = 0; i < len; i++) {
-	    const NamedString* n = l->getParam(i);
+	// when tracing evaluate all rules so they show in the trace
+	RuleCursor cursor(!(trace.null() && !traceLst));
+	l->lookup(cursor,str);
+	unsigned int len = l->count();
+	for (unsigned int i = l->next(cursor,0); i < len; i = l->next(cursor,i + 1)) {
+	    const NamedString* n = l->rule(i);
 	    if (!n)
 		continue;
 	    BlockState blockThis = (blockDepth > 0) ? blockStack[blockDepth-1] : BlockRun;
@@ -1005,16 +1314,21 @@ bool RegexConfig::oneContext(Message &msg, String &str, const String &context, S
 		((val.startSkip("@include") || val.startSkip("@call")) && !(warn = false))) {
 		NDebug(&__plugin,DebugAll,"Including context '%s' by rule #%u '%s'",
 		    val.c_str(),i+1,n->name().c_str());
+		String old = str;
 		if (oneContext(msg,str,val,ret,trace,traceLevel,traceLst,warn,depth+1)) {
 		    DDebug(&__plugin,DebugAll,"Returning true from context '%s'", context.c_str());
 		    return true;
 		}
+		// the included context may have changed the match string
+		if (str != old)
+		    l->lookup(cursor,str);
 	    }
 	    else if (val.startSkip("match") || val.startSkip("newmatch")) {
 		if (!val.null()) {
 		    NDebug(&__plugin,DebugAll,"Setting match string '%s' by rule #%u '%s' in context '%s'",
 			val.c_str(),i+1,n->name().c_str(),context.c_str());
 		    str = val;
+		    l->lookup(cursor,str);
 		}
 	    }
 	    else if (val.startSkip("rename")) {
@@ -1093,7 +1407,10 @@ bool RouteHandler::received(Message &msg)
     Lock lock(s_mutex);
     RefPointer<RegexConfig> cfg = s_cfg;
     lock.drop();
-    if (cfg && cfg->oneContext(msg,called,context,msg.retValue(),traceID,traceLvl,traceLst)) {
+    bool ok = cfg && cfg->oneContext(msg,called,context,msg.retValue(),traceID,traceLvl,traceLst);
+    if (cfg)
+	cfg->lookupDone(Time::now() - tmr);
+    if (ok) {
 	TRACE_DBG_ONLY(DebugInfo,traceID,traceLst,"Routing %s to '%s' in context '%s' via '%s' in " FMT64U " usec",
 	    msg.getValue(YSTRING("route_type"),"call"),called.c_str(),context,
 	    msg.retValue().c_str(),Time::now()-tmr);
@@ -1128,7 +1445,10 @@ bool PrerouteHandler::received(Message &msg)
     Lock lock(s_mutex);
     RefPointer<RegexConfig> cfg = s_cfg;
     lock.drop();
-    if (cfg && cfg->oneContext(msg,caller,"contexts",ret,traceID,traceLvl,traceLst)) {
+    bool ok = cfg && cfg->oneContext(msg,caller,"contexts",ret,traceID,traceLvl,traceLst);
+    if (cfg)
+	cfg->lookupDone(Time::now() - tmr);
+    if (ok) {
 	TRACE_DBG_ONLY(DebugInfo,traceID,traceLst,"Classifying caller '%s' in context '%s' in " FMT64 " usec",
 	    caller.c_str(),ret.c_str(),Time::now()-tmr);
 	if (ret == YSTRING("-") || ret == YSTRING("error"))
@@ -1186,6 +1506,7 @@ GenericHandler::~GenericHandler()
 bool GenericHandler::received(Message &msg)
 {
     DDebug(DebugAll,"Handling message '%s' [%p]",c_str(),this);
+    u_int64_t tmr = Time::now();
     s_processing.inc();
 
     String what(m_match);
@@ -1200,6 +1521,8 @@ bool GenericHandler::received(Message &msg)
     RefPointer<RegexConfig> cfg = s_cfg;
     lock.drop();
     bool ok = cfg && cfg->oneContext(msg,what,m_context,msg.retValue(),traceID,traceLvl,traceLst);
+    if (cfg)
+	cfg->lookupDone(Time::now() - tmr);
     dumpTraceToMsg(msg,traceLst);
     s_processing.dec();
     return ok;
@@ -1271,6 +1594,7 @@ void RegexRoutePlugin::statusParams(String& str)
     Lock lock(s_mutex);
     str.append("sections=",";");
     str << s_cfg->sectCount() << ",extra=" << s_extra.count();
+    s_cfg->statusParams(str);
     lock.acquire(s_varsMtx);
     str << ",variables=" << s_vars.count();
     lock.drop();
@@ -24,22 +24,51 @@
 using namespace TelEngine;
 namespace { // anonymous
 
-class Context : public String
+#define CONTEXT_HASH_SIZE 1024   // Buckets in the contexts list
+#define CALL_STRIPES 32          // Independently locked parts of the call index
+#define CALL_HASH_SIZE 256       // Buckets in each part of the call index
+
+// A counting context, the counter is changed without holding any lock
+class Context : public RefObject
 {
 public:
     inline Context(const String& name)
-	: String(name), m_count(0)
-	{ }
+	: m_name(name)
+	{ m_name.hash(); }
+    virtual const String& toString() const
+	{ return m_name; }
     inline int count() const
-	{ return m_count; }
-    inline bool has(const String& id) const
-	{ return 0 != m_calls.find(id); }
-    inline void add(const String& id)
-	{ m_calls.append(new String(id)); ++m_count; }
-    bool remove(const String& id);
+	{ return m_count.valueAtomic(); }
+    inline int inc()
+	{ return m_count.inc(); }
+    inline int dec()
+	{ return m_count.dec(); }
 private:
-    ObjList m_calls;
-    int m_count;
+    String m_name;
+    AtomicInt m_count;
+};
+
+// A counted call leg, holds a reference to its context
+class Call : public String
+{
+public:
+    inline Call(const String& id, Context* ctxt)
+	: String(id), m_context(ctxt)
+	{ }
+    inline ~Call()
+	{ TelEngine::destruct(m_context); }
+    Context* m_context;
+};
+
+// A part of the call index, calls are spread by the hash of their ID
+class CallStripe
+{
+public:
+    inline CallStripe()
+	: m_mutex(false,"CallCounters:calls"), m_calls(CALL_HASH_SIZE)
+	{ }
+    Mutex m_mutex;
+    HashList m_calls;
 };
 
 class CallCountersPlugin : public Plugin
@@ -56,8 +85,9 @@ static String s_paramName;
 static String s_paramPrefix;
 static String s_direction;
 
-static ObjList s_contexts;
-static Mutex s_mutex(false,"CallCounters");
+static HashList s_contexts(CONTEXT_HASH_SIZE);
+static RWLock s_contextsLock("CallCounters");
+static CallStripe s_calls[CALL_STRIPES];
 
 INIT_PLUGIN(CallCountersPlugin);
 
@@ -99,19 +129,51 @@ public:
 };
 
 
-bool Context::remove(const String& id)
+// Find a context and count a new call in it, create the context if missing
+// Returns a referenced pointer
+static Context* addCall(const String& name)
 {
-    String* s = static_cast<String*>(m_calls.remove(id,false));
-    if (!s)
-	return false;
-    delete s;
-    DDebug(&__plugin,DebugAll,"Removing call '%s' from context '%s'",
-	id.c_str(),c_str());
-    if (--m_count <= 0) {
-	DDebug(&__plugin,DebugInfo,"Removing empty context '%s'",c_str());
-	s_contexts.remove(this);
+    RLock rlck(s_contextsLock);
+    Context* c = static_cast<Context*>(s_contexts[name]);
+    if (c && c->ref()) {
+	c->inc();
+	return c;
     }
-    return true;
+    rlck.drop();
+    WLock wlck(s_contextsLock);
+    c = static_cast<Context*>(s_contexts[name]);
+    if (!c) {
+	DDebug(&__plugin,DebugInfo,"Creating context '%s'",name.c_str());
+	c = new Context(name);
+	s_contexts.append(c);
+    }
+    c->ref();
+    c->inc();
+    return c;
+}
+
+// Stop counting a call in a context, remove the context if it became empty
+// Releases the reference held on the context
+static void removeCall(Context* c)
+{
+    if (!c)
+	return;
+    if (c->dec() <= 0) {
+	// Contexts are counted up only while holding a read lock so the
+	//  counter cannot change while we hold the write lock
+	WLock lck(s_contextsLock);
+	if (c->count() <= 0 && s_contexts.find(c,c->toString().hash())) {
+	    DDebug(&__plugin,DebugInfo,"Removing empty context '%s'",c->toString().c_str());
+	    s_contexts.remove(c,c->toString().hash());
+	}
+    }
+    TelEngine::destruct(c);
+}
+
+// Retrieve the part of the call index holding a call
+static inline CallStripe& callStripe(const String& id)
+{
+    return s_calls[id.hash() % CALL_STRIPES];
 }
 
 
@@ -126,46 +188,45 @@ bool CdrHandler::received(Message& msg)
 	    return false;
     }
     const String* oper = msg.getParam("operation");
-    const String* ctxt = msg.getParam(s_paramName);
-    Lock mylock(s_mutex);
+    CallStripe& stripe = callStripe(*chan);
     if (oper && (*oper == "finalize")) {
-	// finalizing a CDR, remove call from any context
-	if (!TelEngine::null(ctxt)) {
-	    // first try to search in context, usually it will be there
-	    Context* c = static_cast<Context*>(s_contexts[*ctxt]);
-	    if (c && c->remove(*chan))
-		return false;
-	    DDebug(&__plugin,DebugNote,"Call '%s' not removed from '%s'",chan->c_str(),ctxt->c_str());
-	}
-	// now we have to look in all contexts
-	for (ObjList* l = s_contexts.skipNull(); l; l=l->skipNext()) {
-	    Context* c = static_cast<Context*>(l->get());
-	    if (c->remove(*chan))
-		return false;
+	// finalizing a CDR, remove call from its context
+	stripe.m_mutex.lock();
+	Call* call = static_cast<Call*>(stripe.m_calls.remove(*chan,false));
+	stripe.m_mutex.unlock();
+	if (!call) {
+	    DDebug(&__plugin,DebugAll,"Call '%s' not found in any context",chan->c_str());
+	    return false;
 	}
-	DDebug(&__plugin,DebugAll,"Call '%s' not found in any context",chan->c_str());
+	DDebug(&__plugin,DebugAll,"Removing call '%s' from context '%s'",
+	    chan->c_str(),call->m_context->toString().c_str());
+	Context* c = call->m_context;
+	call->m_context = 0;
+	TelEngine::destruct(call);
+	removeCall(c);
     } // finalize operation
     else {
+	const String* ctxt = msg.getParam(s_paramName);
 	if (TelEngine::null(ctxt))
 	    return false;
-	// first look up the call in the context it was supposed to be in
-	Context* c = static_cast<Context*>(s_contexts[*ctxt]);
-	if (c && c->has(*chan))
+	Context* old = 0;
+	Lock mylock(stripe.m_mutex);
+	Call* call = static_cast<Call*>(stripe.m_calls[*chan]);
+	// nothing to do if the call is already in the right context
+	if (call && (call->m_context->toString() == *ctxt))
 	    return false;
-	// call has new context, remove from any old context
-	for (ObjList* l = s_contexts.skipNull(); l; l=l->skipNext()) {
-	    Context* c2 = static_cast<Context*>(l->get());
-	    if ((c2 != c) && c2->remove(*chan))
-		break;
-	}
-	if (!c) {
-	    DDebug(&__plugin,DebugInfo,"Creating context '%s'",ctxt->c_str());
-	    c = new Context(*ctxt);
-	    s_contexts.append(c);
-	}
 	DDebug(&__plugin,DebugAll,"Adding call '%s' to context '%s'",
 	    chan->c_str(),ctxt->c_str());
-	c->add(*chan);
+	Context* c = addCall(*ctxt);
+	if (call) {
+	    // call has new context, remove from the old one
+	    old = call->m_context;
+	    call->m_context = c;
+	}
+	else
+	    stripe.m_calls.append(new Call(*chan,c));
+	mylock.drop();
+	removeCall(old);
     }
     return false;
 };
@@ -174,17 +235,21 @@ bool CdrHandler::received(Message& msg)
 bool RouteHandler::received(Message& msg)
 {
     if (msg.getBoolValue("allcounters",s_allCounters)) {
-	Lock mylock(s_mutex);
-	for (ObjList* l = s_contexts.skipNull(); l; l=l->skipNext()) {
-	    Context* c = static_cast<Context*>(l->get());
-	    msg.setParam(s_paramPrefix + "_" + *c,String(c->count()));
+	RLock mylock(s_contextsLock);
+	for (unsigned int i = 0; i < s_contexts.length(); i++) {
+	    for (ObjList* l = s_contexts.getList(i); l; l = l->next()) {
+		Context* c = static_cast<Context*>(l->get());
+		int n = c ? c->count() : 0;
+		if (n > 0)
+		    msg.setParam(s_paramPrefix + "_" + c->toString(),String(n));
+	    }
 	}
     }
     else {
 	const String* ctxt = msg.getParam(s_paramName);
 	if (TelEngine::null(ctxt))
 	    return false;
-	Lock mylock(s_mutex);
+	RLock mylock(s_contextsLock);
 	Context* c = static_cast<Context*>(s_contexts[*ctxt]);
 	if (c)
 	    msg.setParam(s_paramPrefix,String(c->count()));
@@ -193,27 +258,44 @@ bool RouteHandler::received(Message& msg)
 };
 
 
+// Append a snapshot of all counters to a string
+// Returns the number of contexts appended
+static unsigned int snapshot(String& buf, const char* sep, const String& prefix = String::empty())
+{
+    unsigned int n = 0;
+    RLock mylock(s_contextsLock);
+    for (unsigned int i = 0; i < s_contexts.length(); i++) {
+	for (ObjList* l = s_contexts.getList(i); l; l = l->next()) {
+	    Context* c = static_cast<Context*>(l->get());
+	    if (!c || (prefix && !c->toString().startsWith(prefix)))
+		continue;
+	    int cnt = c->count();
+	    if (cnt <= 0)
+		continue;
+	    if (n++)
+		buf << sep;
+	    buf << c->toString() << "=" << cnt;
+	}
+    }
+    return n;
+}
+
+
 bool StatusHandler::received(Message &msg)
 {
     const String* sel = msg.getParam("module");
     if (!TelEngine::null(sel) && (*sel != __plugin.name()))
 	return false;
     String st("name=callcounters,type=misc,format=Context|Count");
-    s_mutex.lock();
-    st << ";counters=" << s_contexts.count();
     if (msg.getBoolValue("details",true)) {
-	st << ";";
-	bool first = true;
-	for (ObjList* l = s_contexts.skipNull(); l; l=l->skipNext()) {
-	    Context* c = static_cast<Context*>(l->get());
-	    if (first)
-		first = false;
-	    else
-		st << ",";
-	    st << *c << "=" << c->count();
-	}
+	String details;
+	unsigned int n = snapshot(details,",");
+	st << ";counters=" << n << ";" << details;
+    }
+    else {
+	RLock mylock(s_contextsLock);
+	st << ";counters=" << s_contexts.count();
     }
-    s_mutex.unlock();
     msg.retValue() << st << "\r\n";
     return false;
 }
@@ -221,15 +303,30 @@ bool StatusHandler::received(Message &msg)
 
 bool CommandHandler::received(Message &msg)
 {
-    if (!msg.getParam("line")) {
+    String line = msg.getValue("line");
+    if (!line) {
 	String* tmp = msg.getParam("partline");
 	if (tmp && (*tmp == "status")) {
 	    tmp = msg.getParam("partword");
 	    if (!tmp || tmp->null() || __plugin.name().startsWith(*tmp))
 		msg.retValue().append(__plugin.name(),"\t");
 	}
+	else if (TelEngine::null(tmp)) {
+	    tmp = msg.getParam("partword");
+	    if (!tmp || tmp->null() || __plugin.name().startsWith(*tmp))
+		msg.retValue().append(__plugin.name(),"\t");
+	}
+	return false;
     }
-    return false;
+    if (!line.startSkip(__plugin.name()))
+	return false;
+    // callcounters [prefix]: one line for each active context
+    String buf;
+    snapshot(buf,"\r\n",line.trimBlanks());
+    if (buf)
+	buf << "\r\n";
+    msg.retValue() << buf;
+    return true;
 }
 
 
@@ -26,6 +26,7 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <string.h>
+#include <stdio.h>
 
 using namespace TelEngine;
 namespace { // anonymous
@@ -43,42 +44,220 @@ private:
 };
 
 
-#ifdef _WINDOWS
-const char eoln[] = { '\r', '\n' };
-#else
-const char eoln[] = { '\n' };
-#endif
-
 static String s_baseDir;
 static bool s_pubRead = false;
 
 INIT_PLUGIN(EventLogsPlugin);
 
+// Lines waiting to be written to the same log file
+class EventFile : public String
+{
+public:
+    inline EventFile(const String& name)
+	: String(name), m_count(0)
+	{ }
+    ObjList m_lines;
+    unsigned int m_count;
+};
 
 class EventLogsHandler : public MessageHandler, public Mutex
 {
+    friend class EventLogsWriter;
 public:
     EventLogsHandler(const char *name)
 	: MessageHandler(name,100,__plugin.name()),
 	  Mutex(false,"EventLogs"),
-	  m_mappings("")
+	  m_mappings(""),
+	  m_fileMutex(false,"EventLogsWrite"),
+	  m_wakeup(1,"EventLogsWakeup",0), m_writer(0), m_stopping(false), m_queueTail(&m_queue),
+	  m_rotated("")
 	{ }
     virtual bool received(Message &msg);
-    void init(const NamedList* mappings);
+    void init(const NamedList* mappings, const NamedList& params);
+    void stop();
+    void status(String& str);
 private:
-    bool writeLog(const char* name, const String& line);
+    void run();
+    void flush();
+    bool writeLog(EventFile& file);
+    bool needRotate(const String& name, File& f);
+    void rotate(const String& name);
     NamedList m_mappings;
+    // Serializes file operations
+    Mutex m_fileMutex;
+    // Asynchronous writer
+    Semaphore m_wakeup;
+    Thread* m_writer;
+    bool m_stopping;
+    ObjList m_queue;
+    ObjList* m_queueTail;
+    // Settings and statistics
+    BatchFileWriter m_batch;
+    // Time each file was last rotated or first written
+    NamedList m_rotated;
+};
+
+// Thread that writes the buffered events to disk
+class EventLogsWriter : public Thread
+{
+public:
+    inline EventLogsWriter(EventLogsHandler* handler)
+	: Thread("Event Logs"), m_handler(handler)
+	{ }
+    virtual ~EventLogsWriter()
+	{
+	    Lock lock(m_handler);
+	    if (m_handler->m_writer == this)
+		m_handler->m_writer = 0;
+	}
+    virtual void run()
+	{ m_handler->run(); }
+private:
+    EventLogsHandler* m_handler;
+};
+
+// Stop the writer and flush buffered events on engine halt
+class HaltHandler : public MessageHandler
+{
+public:
+    inline HaltHandler(EventLogsHandler* handler)
+	: MessageHandler("engine.halt",200,__plugin.name()),
+	  m_handler(handler)
+	{ }
+    virtual bool received(Message &msg)
+	{ m_handler->stop(); return false; }
+private:
+    EventLogsHandler* m_handler;
 };
 
+class StatusHandler : public MessageHandler
+{
+public:
+    inline StatusHandler(EventLogsHandler* handler)
+	: MessageHandler("engine.status",100,__plugin.name()),
+	  m_handler(handler)
+	{ }
+    virtual bool received(Message &msg);
+private:
+    EventLogsHandler* m_handler;
+};
+
+
+// Check if a log file must be rotated before writing to it
+bool EventLogsHandler::needRotate(const String& name, File& f)
+{
+    NamedString* t = m_rotated.getParam(name);
+    if (!t)
+	m_rotated.addParam(name,String(Time::secNow()));
+    return m_batch.needRotate(f.length(),t ? (u_int32_t)t->toInteger(0) : 0);
+}
 
-bool EventLogsHandler::writeLog(const char* name, const String& line)
+// Rename a log file appending a timestamp
+void EventLogsHandler::rotate(const String& name)
+{
+    int err = 0;
+    Lock lock(this);
+    if (!m_batch.rotate(name,&err))
+	Debug(__plugin.name(),DebugWarn,"Failed to rotate '%s': %s (%d)",
+	    name.c_str(),::strerror(err),err);
+    lock.drop();
+    m_rotated.setParam(name,String(Time::secNow()));
+}
+
+// Write all lines queued for a file, must be called with the file mutex locked
+bool EventLogsHandler::writeLog(EventFile& file)
 {
     File f;
-    if (!f.openPath(name,true,false,true,true,true,s_pubRead))
+    if (!f.openPath(file,true,false,true,true,true,s_pubRead))
 	return false;
-    f.writeData(line.c_str(),line.length());
-    f.writeData(eoln,sizeof(eoln));
-    return true;
+    if (needRotate(file,f)) {
+	if (m_batch.fsync() != BatchFileWriter::FsyncNone)
+	    BatchFileWriter::sync(f);
+	f.terminate();
+	rotate(file);
+	if (!f.openPath(file,true,false,true,true,true,s_pubRead))
+	    return false;
+    }
+    return m_batch.writeLines(f,file.m_lines);
+}
+
+// Take the buffered events and write them to their files
+void EventLogsHandler::flush()
+{
+    Lock flock(m_fileMutex);
+    Lock lock(this);
+    if (!m_batch.dequeued())
+	return;
+    ObjList events;
+    ObjList* tail = &events;
+    while (GenObject* o = m_queue.remove(false))
+	tail = tail->append(o);
+    m_queueTail = &m_queue;
+    lock.drop();
+    u_int64_t start = Time::now();
+    // Group the events by destination file keeping their order
+    ObjList files;
+    while (NamedString* ev = static_cast<NamedString*>(events.remove(false))) {
+	EventFile* file = static_cast<EventFile*>(files[ev->name()]);
+	if (!file) {
+	    file = new EventFile(ev->name());
+	    files.append(file);
+	}
+	file->m_lines.append(ev);
+	file->m_count++;
+    }
+    unsigned int written = 0;
+    unsigned int errors = 0;
+    for (ObjList* l = files.skipNull(); l; l = l->skipNext()) {
+	EventFile* file = static_cast<EventFile*>(l->get());
+	if (writeLog(*file))
+	    written += file->m_count;
+	else {
+	    errors++;
+	    Debug(__plugin.name(),DebugWarn,"Failed to log %u events to file '%s'",
+		file->m_count,file->c_str());
+	}
+    }
+    u_int64_t dt = Time::now() - start;
+    lock.acquire(this);
+    m_batch.flushed(written,errors,dt);
+}
+
+void EventLogsHandler::run()
+{
+    while (!(m_stopping || Thread::check(false))) {
+	m_wakeup.lock(1000 * (long)m_batch.flushInterval());
+	if (m_stopping || !m_batch.flushInterval())
+	    break;
+	flush();
+    }
+    lock();
+    m_writer = 0;
+    unlock();
+    flush();
+    Debug(__plugin.name(),DebugInfo,"Event logs writer thread stopped");
+}
+
+// Stop the writer thread, events are written synchronously from now on
+void EventLogsHandler::stop()
+{
+    lock();
+    m_stopping = true;
+    bool wait = (m_writer != 0);
+    unlock();
+    if (wait) {
+	m_wakeup.unlock();
+	while (m_writer)
+	    Thread::idle();
+    }
+    flush();
+}
+
+void EventLogsHandler::status(String& str)
+{
+    Lock lock(this);
+    m_batch.status(str);
+    str << ",async=" << String::boolText(m_writer != 0);
 }
 
 bool EventLogsHandler::received(Message &msg)
@@ -108,22 +287,56 @@ bool EventLogsHandler::received(Message &msg)
 		break;
 	}
     }
-    if (file) {
-	if (!file.startsWith(Engine::pathSeparator()))
-	    file = s_baseDir + file;
-        if (!writeLog(file,text))
-	    Debug(__plugin.name(),DebugWarn,"Failed to log to file '%s'",file.c_str());
+    if (file.null())
+	return false;
+    if (!file.startsWith(Engine::pathSeparator()))
+	file = s_baseDir + file;
+    m_batch.queued(text.length() + 1);
+    m_queueTail = m_queueTail->append(new NamedString(file,text));
+    if (!m_writer) {
+	lock.drop();
+	flush();
+	return false;
+    }
+    if (m_batch.flushNow())
+	m_wakeup.unlock();
+    // Disk can't keep up, throttle the callers
+    while (m_writer && m_batch.overflow()) {
+	lock.drop();
+	Thread::idle();
+	lock.acquire(this);
     }
     return false;
 };
 
-void EventLogsHandler::init(const NamedList* mappings)
+void EventLogsHandler::init(const NamedList* mappings, const NamedList& params)
 {
     m_mappings.clearParams();
     if (mappings)
 	m_mappings.copyParams(*mappings);
     if (m_mappings.count() == 0)
 	m_mappings.addParam("^[A-Za-z0-9_-]\\+","\\0.log");
+    m_batch.setup(params);
+    if (m_batch.flushInterval() && !(m_writer || m_stopping)) {
+	m_writer = new EventLogsWriter(this);
+	if (!m_writer->startup()) {
+	    Debug(__plugin.name(),DebugWarn,"Failed to start event logs writer thread, writing synchronously");
+	    m_writer = 0;
+	}
+    }
+    else if (!m_batch.flushInterval() && m_writer)
+	m_wakeup.unlock();
+}
+
+bool StatusHandler::received(Message &msg)
+{
+    const String* sel = msg.getParam(YSTRING("module"));
+    if (!(TelEngine::null(sel) || (*sel == YSTRING("eventlogs"))))
+	return false;
+    String st("name=eventlogs,type=misc;");
+    m_handler->status(st);
+    msg.retValue() << st << "\r\n";
+    return false;
 }
 
 
@@ -137,6 +350,8 @@ EventLogsPlugin::EventLogsPlugin()
 EventLogsPlugin::~EventLogsPlugin()
 {
     Output("Unloading module Event Logs");
+    if (m_handler)
+	m_handler->stop();
 }
 
 void EventLogsPlugin::initialize()
@@ -150,15 +365,18 @@ void EventLogsPlugin::initialize()
 	if (!base.endsWith(Engine::pathSeparator()))
 	    base += Engine::pathSeparator();
     }
+    const NamedList* general = cfg.getSection("general");
     Lock lock(m_handler);
     s_baseDir = base;
     s_pubRead = cfg.getBoolValue("general","public_read");
     if (m_handler)
-	m_handler->init(cfg.getSection("mappings"));
+	m_handler->init(cfg.getSection("mappings"),general ? *general : NamedList::empty());
     else if (base) {
 	m_handler = new EventLogsHandler("module.update");
-	m_handler->init(cfg.getSection("mappings"));
+	m_handler->init(cfg.getSection("mappings"),general ? *general : NamedList::empty());
 	Engine::install(m_handler);
+	Engine::install(new HaltHandler(m_handler));
+	Engine::install(new StatusHandler(m_handler));
     }
 }
 
@@ -257,13 +257,7 @@ bool YMGCPEngine::handleControl(const String& comp, Message& msg, bool& retVal)
 {
     retVal = false;
     Lock lock(this);
-    MGCPEndpoint* ep = 0;
-    for (ObjList* o = m_endpoints.skipNull(); o; o = o->skipNext()) {
-	ep = static_cast<MGCPEndpoint*>(o->get());
-	if (ep->toString() == comp)
-	    break;
-	ep = 0;
-    }
+    MGCPEndpoint* ep = findEp(comp);
     if (!ep)
 	return false;
     MGCPEpInfo* peer = ep->peer();
@@ -32,6 +32,7 @@ class MsgUpdateHandler;
 class CdrHandler;
 class HangupHandler;
 class CallMonitor;
+class CallMetrics;
 
 // structure to hold a counter, a threshold for the counter
 // and an alarm for when the threshold had been surpassed
@@ -888,6 +889,9 @@ public:
     bool verifyGateway(const String& address);
     // obtain SIP/MGCP transactions info
     String getTransactionsInfo(const String& query, const int who);
+protected:
+    virtual bool commandExecute(String& retVal, const String& line);
+    virtual bool commandComplete(Message& msg, const String& partLine, const String& partWord);
 private:
     // message handlers
     MsgUpdateHandler* m_msgUpdateHandler;
@@ -895,6 +899,7 @@ private:
     HangupHandler* m_hangupHandler;
     EngineStartHandler* m_startHandler;
     CallMonitor* m_callMonitor;
+    CallMetrics* m_callMetrics;
     AuthHandler* m_authHandler;
     RegisterHandler* m_registerHandler;
     bool m_init;
@@ -1185,6 +1190,21 @@ static TokenDict s_endReasons[] = {
     {0,0}
 };
 
+// labels of call end reasons in exported metrics
+static TokenDict s_endReasonLabels[] = {
+    {"hangup",          CallRouteQoS::HANGUP},
+    {"rejected",        CallRouteQoS::REJECT},
+    {"busy",            CallRouteQoS::BUSY},
+    {"cancelled",       CallRouteQoS::CANCELLED},
+    {"noanswer",        CallRouteQoS::NO_ANSWER},
+    {"noroute",         CallRouteQoS::NO_ROUTE},
+    {"noconn",          CallRouteQoS::NO_CONN},
+    {"noauth",          CallRouteQoS::NO_AUTH},
+    {"congestion",      CallRouteQoS::CONGESTION},
+    {"nomedia",         CallRouteQoS::NO_MEDIA},
+    {0,0}
+};
+
 static TokenDict s_callCounterQueries[] = {
     {"incomingCalls",		CallMonitor::INCOMING_CALLS},
     {"outgoingCalls",		CallMonitor::OUTGOING_CALLS},
@@ -1590,6 +1610,58 @@ private:
     unsigned int m_count;
 };
 
+// Number of fixed buckets of a histogram
+#define METRIC_BUCKETS 12
+
+/**
+ * Class MetricHistogram
+ * Histogram with fixed buckets, updated and read without locking
+ */
+class MetricHistogram
+{
+public:
+    inline MetricHistogram()
+	{ }
+    // count a sample given in milliseconds
+    void add(unsigned int msec);
+    // append the samples in text exposition format
+    void dump(String& buf, const char* name, const char* labels);
+private:
+    AtomicUInt64 m_buckets[METRIC_BUCKETS + 1];
+    AtomicUInt64 m_sum;
+};
+
+/**
+ * Class CallMetrics
+ * Handler for "call.cdr" messages. Keeps call counters, gauges and setup time histograms
+ */
+class CallMetrics : public MessageHandler
+{
+public:
+    enum Direction {
+	INCOMING = 0,
+	OUTGOING = 1,
+	DIRECTIONS = 2,
+    };
+    inline CallMetrics(unsigned int priority = 100)
+	: MessageHandler("call.cdr",priority,__plugin.name())
+	{ }
+    virtual ~CallMetrics()
+	{ }
+    virtual bool received(Message& msg);
+    // append the metrics in text exposition format
+    void dump(String& buf);
+private:
+    AtomicUInt64 m_calls[DIRECTIONS];
+    AtomicUInt64 m_answered[DIRECTIONS];
+    AtomicInt m_active[DIRECTIONS];
+    AtomicUInt64 m_hangups[DIRECTIONS][CallRouteQoS::NO_CAUSE - CallRouteQoS::HANGUP];
+    // time until the call was answered
+    MetricHistogram m_setup[DIRECTIONS];
+    // time until the call started ringing or was answered (post dial delay)
+    MetricHistogram m_pdd[DIRECTIONS];
+};
+
 
 // helper function to get rid of new line characters
 static void cutNewLine(String& line) {
@@ -3494,6 +3566,148 @@ void CallMonitor::get(const String& query, const int& index, String& result)
 /**
   * Monitor
   */
+/**
+  * MetricHistogram
+  */
+// upper bounds of histogram buckets, in milliseconds
+static const unsigned int s_metricBuckets[METRIC_BUCKETS] = {
+    100, 250, 500, 1000, 2000, 3000, 5000, 8000, 13000, 20000, 30000, 60000
+};
+
+static const char* s_metricDirections[CallMetrics::DIRECTIONS] = { "incoming", "outgoing" };
+
+void MetricHistogram::add(unsigned int msec)
+{
+    unsigned int i = 0;
+    while (i < METRIC_BUCKETS && msec > s_metricBuckets[i])
+	i++;
+    m_buckets[i].inc();
+    m_sum.add(msec);
+}
+
+void MetricHistogram::dump(String& buf, const char* name, const char* labels)
+{
+    // buckets are exported cumulative, the last one is the total count
+    u_int64_t count = 0;
+    String tmp;
+    for (unsigned int i = 0; i <= METRIC_BUCKETS; i++) {
+	count += m_buckets[i].valueAtomic();
+	buf << name << "_bucket{" << labels << ",le=\"";
+	if (i < METRIC_BUCKETS)
+	    buf << tmp.printf("%u.%03u",s_metricBuckets[i] / 1000,s_metricBuckets[i] % 1000);
+	else
+	    buf << "+Inf";
+	buf << "\"} " << count << "\n";
+    }
+    u_int64_t sum = m_sum.valueAtomic();
+    buf << name << "_sum{" << labels << "} " << (sum / 1000) << "."
+	<< tmp.printf("%03u",(unsigned int)(sum % 1000)) << "\n";
+    buf << name << "_count{" << labels << "} " << count << "\n";
+}
+
+
+/**
+  * CallMetrics
+  */
+// Update counters from call.cdr messages, only atomic operations are done here
+bool CallMetrics::received(Message& msg)
+{
+    if (!msg.getBoolValue(YSTRING("cdrwrite"),true))
+	return false;
+    const String& direction = msg[YSTRING("direction")];
+    int dir = INCOMING;
+    if (direction == YSTRING("outgoing"))
+	dir = OUTGOING;
+    else if (direction != YSTRING("incoming"))
+	return false;
+
+    const String& operation = msg[YSTRING("operation")];
+    if (operation == YSTRING("initialize")) {
+	m_active[dir].inc();
+	return false;
+    }
+    if (operation != YSTRING("finalize"))
+	return false;
+    m_active[dir].dec();
+    m_calls[dir].inc();
+
+    // times are provided in seconds
+    int64_t duration = (int64_t)(msg.getDoubleValue(YSTRING("duration")) * 1000 + 0.5);
+    int64_t billtime = (int64_t)(msg.getDoubleValue(YSTRING("billtime")) * 1000 + 0.5);
+    int64_t ringtime = (int64_t)(msg.getDoubleValue(YSTRING("ringtime")) * 1000 + 0.5);
+    bool answered = (msg[YSTRING("status")] == YSTRING("answered")) || (billtime > 0);
+    int64_t setup = duration - billtime;
+    if (setup < 0)
+	setup = 0;
+    if (answered) {
+	m_answered[dir].inc();
+	m_setup[dir].add((unsigned int)setup);
+    }
+    if (answered || ringtime > 0) {
+	int64_t pdd = setup - ringtime;
+	m_pdd[dir].add((unsigned int)(pdd > 0 ? pdd : 0));
+    }
+
+    // classify the end reason the same way as the call route monitor
+    const String& reason = msg[YSTRING("reason")];
+    int type = lookup(reason,s_endReasons,CallRouteQoS::HANGUP);
+    const String& status = msg[YSTRING("status")];
+    bool delivered = (status == YSTRING("ringing")) || (status == YSTRING("accepted"));
+    if (type == CallRouteQoS::HANGUP && delivered && dir == OUTGOING)
+	type = CallRouteQoS::CANCELLED;
+    else if (type <= CallRouteQoS::NO_ANSWER && dir != OUTGOING)
+	type = CallRouteQoS::HANGUP;
+    m_hangups[dir][type - CallRouteQoS::HANGUP].inc();
+    return false;
+}
+
+// Build the call metrics in Prometheus text exposition format
+void CallMetrics::dump(String& buf)
+{
+    String labels;
+    buf << "# HELP yate_calls_total Finished calls\n";
+    buf << "# TYPE yate_calls_total counter\n";
+    for (int d = 0; d < DIRECTIONS; d++)
+	buf << "yate_calls_total{direction=\"" << s_metricDirections[d] << "\"} "
+	    << m_calls[d].valueAtomic() << "\n";
+    buf << "# HELP yate_calls_answered_total Finished calls that were answered\n";
+    buf << "# TYPE yate_calls_answered_total counter\n";
+    for (int d = 0; d < DIRECTIONS; d++)
+	buf << "yate_calls_answered_total{direction=\"" << s_metricDirections[d] << "\"} "
+	    << m_answered[d].valueAtomic() << "\n";
+    buf << "# HELP yate_calls_active Calls in progress\n";
+    buf << "# TYPE yate_calls_active gauge\n";
+    for (int d = 0; d < DIRECTIONS; d++) {
+	// calls started before the module was loaded may push it below zero
+	int active = m_active[d].valueAtomic();
+	buf << "yate_calls_active{direction=\"" << s_metricDirections[d] << "\"} "
+	    << (active > 0 ? active : 0) << "\n";
+    }
+    buf << "# HELP yate_call_hangups_total Finished calls by end reason\n";
+    buf << "# TYPE yate_call_hangups_total counter\n";
+    for (int d = 0; d < DIRECTIONS; d++) {
+	for (int i = 0; i < CallRouteQoS::NO_CAUSE - CallRouteQoS::HANGUP; i++)
+	    buf << "yate_call_hangups_total{direction=\"" << s_metricDirections[d]
+		<< "\",reason=\"" << lookup(CallRouteQoS::HANGUP + i,s_endReasonLabels) << "\"} "
+		<< m_hangups[d][i].valueAtomic() << "\n";
+    }
+    buf << "# HELP yate_call_setup_seconds Time from call start until answer\n";
+    buf << "# TYPE yate_call_setup_seconds histogram\n";
+    for (int d = 0; d < DIRECTIONS; d++) {
+	labels.clear();
+	labels << "direction=\"" << s_metricDirections[d] << "\"";
+	m_setup[d].dump(buf,"yate_call_setup_seconds",labels);
+    }
+    buf << "# HELP yate_call_pdd_seconds Post dial delay, time from call start until ringing or answer\n";
+    buf << "# TYPE yate_call_pdd_seconds histogram\n";
+    for (int d = 0; d < DIRECTIONS; d++) {
+	labels.clear();
+	labels << "direction=\"" << s_metricDirections[d] << "\"";
+	m_pdd[d].dump(buf,"yate_call_pdd_seconds",labels);
+    }
+}
+
+
 Monitor::Monitor()
       : Module("monitoring","misc"),
 	m_msgUpdateHandler(0),
@@ -3501,6 +3715,7 @@ Monitor::Monitor()
 	m_hangupHandler(0),
 	m_startHandler(0),
 	m_callMonitor(0),
+	m_callMetrics(0),
 	m_authHandler(0),
 	m_registerHandler(0),
 	m_init(false),
@@ -3549,6 +3764,7 @@ Monitor::~Monitor()
     TelEngine::destruct(m_authHandler);
     TelEngine::destruct(m_registerHandler);
     TelEngine::destruct(m_hangupHandler);
+    TelEngine::destruct(m_callMetrics);
 }
 
 bool Monitor::unload()
@@ -3563,6 +3779,7 @@ bool Monitor::unload()
     Engine::uninstall(m_authHandler);
     Engine::uninstall(m_registerHandler);
     Engine::uninstall(m_hangupHandler);
+    Engine::uninstall(m_callMetrics);
 
     if (m_callMonitor) {
 	Engine::uninstall(m_callMonitor);
@@ -3625,6 +3842,10 @@ void Monitor::initialize()
     }
     else
 	m_callMonitor->setConfigure(asrCfg);
+    if (!m_callMetrics) {
+	m_callMetrics = new CallMetrics();
+	Engine::install(m_callMetrics);
+    }
 
     int cacheFor = cfg.getIntValue("general","cache",1);
     if (!m_activeCallsCache)
@@ -3780,6 +4001,34 @@ bool Monitor::received(Message& msg, int id)
     return Module::received(msg,id);
 }
 
+// handle 'monitoring metrics' commands, counters are read without blocking call processing
+bool Monitor::commandExecute(String& retVal, const String& line)
+{
+    String tmp = line;
+    if (!(tmp.startSkip(name()) && tmp.trimSpaces() == YSTRING("metrics")))
+	return Module::commandExecute(retVal,line);
+    if (m_callMetrics)
+	m_callMetrics->dump(retVal);
+    retVal << "# HELP yate_auth_requests_total Received user.auth requests\n";
+    retVal << "# TYPE yate_auth_requests_total counter\n";
+    retVal << "yate_auth_requests_total " << (m_authHandler ? m_authHandler->getCount() : 0) << "\n";
+    retVal << "# HELP yate_register_requests_total Received user.register requests\n";
+    retVal << "# TYPE yate_register_requests_total counter\n";
+    retVal << "yate_register_requests_total " << (m_registerHandler ? m_registerHandler->getCount() : 0) << "\n";
+    return true;
+}
+
+bool Monitor::commandComplete(Message& msg, const String& partLine, const String& partWord)
+{
+    if (partLine.null() || partLine == YSTRING("help"))
+	itemComplete(msg.retValue(),name(),partWord);
+    else if (partLine == name()) {
+	itemComplete(msg.retValue(),"metrics",partWord);
+	return true;
+    }
+    return Module::commandComplete(msg,partLine,partWord);
+}
+
 // handle module.update messages
 void Monitor::update(Message& msg)
 {
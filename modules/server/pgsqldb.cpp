@@ -22,6 +22,7 @@
 #include <yatephone.h>
 
 #include <stdio.h>
+#include <string.h>
 #include <libpq-fe.h>
 
 using namespace TelEngine;
@@ -29,11 +30,67 @@ namespace { // anonymous
 
 class PGConn;                            // A database connection
 class PgAccount;                         // Database account holding the connection(s)
+class PgQuery;                           // A query sent on a connection
 
 static ObjList s_accounts;
 Mutex s_conmutex(false,"PgSQL::acc");
 static unsigned int s_failedConns;
 
+// A query sent on a connection, results are read in the order of sending
+class PgQuery : public GenObject
+{
+public:
+    inline PgQuery(const char* query, Message* dest, const String* stmt = 0,
+	int nParams = 0, const char* const* values = 0, bool prepare = false)
+	: m_query(query), m_dest(dest), m_stmt(stmt),
+	  m_nParams(nParams), m_values(values), m_prepare(prepare), m_detached(false),
+	  m_timedOut(false), m_ended(false), m_error(false), m_done(false),
+	  m_rows(0), m_affected(0), m_result(-1),
+	  m_semaphore(1,"PgSQL::query",0)
+	{ }
+    inline bool done() const
+	{ return m_done; }
+    inline int result() const
+	{ return m_result; }
+    // Mark the query complete and wake up its waiter
+    inline void complete(int result) {
+	    m_result = result;
+	    m_done = true;
+	    m_semaphore.unlock();
+	}
+    inline void wait(long maxwait)
+	{ m_semaphore.lock(maxwait); }
+    inline void wake()
+	{ m_semaphore.unlock(); }
+
+    String m_query;                      // Query text, kept as the query may outlive its waiter
+    Message* m_dest;                     // Message to fill with results
+    const String* m_stmt;                // Server side name of a prepared statement
+    int m_nParams;                       // Number of statement parameters
+    const char* const* m_values;         // Values of statement parameters
+    bool m_prepare;                      // Prepares the statement on server
+    bool m_detached;                     // Nobody waits for it, deleted when finished
+    bool m_timedOut;                     // Waiter gave up, results are discarded
+    bool m_ended;                        // All results were read, waiting for sync point
+    bool m_error;                        // Server returned an error
+    volatile bool m_done;
+    int m_rows;
+    int m_affected;
+    int m_result;
+private:
+    Semaphore m_semaphore;
+};
+
+// A statement prepared on a connection
+class PgStmt : public String
+{
+public:
+    inline PgStmt(const String& sql, const String& name)
+	: String(sql), m_name(name)
+	{ }
+    String m_name;                       // Name of the statement on server
+};
+
 // A database connection
 class PgConn : public String
 {
@@ -41,10 +98,15 @@ class PgConn : public String
 public:
     PgConn(PgAccount* account = 0);
     ~PgConn();
+    // Retrieve the number of queries that can be in flight on this connection
+    unsigned int maxDepth() const;
+    inline unsigned int depth() const
+	{ return m_depth; }
     inline bool isBusy() const
-	{ return m_busy; }
-    inline void setBusy(bool busy)
-	{ m_busy = busy; }
+	{ return m_depth >= maxDepth(); }
+    // Test if the connection was established and not dropped since
+    inline bool isOnline() const
+	{ return m_online; }
     // Test if the connection is still OK
     inline bool testDb() const
 	{ return m_conn && (CONNECTION_OK == PQstatus(m_conn)); }
@@ -52,18 +114,40 @@ public:
     void dropDb();
     // Perform the query, fill the message with data
     // Return number of rows, -1 for non-retryable errors and -2 to retry
-    int queryDb(const char* query, Message* dest);
+    int queryDb(const char* query, Message* dest, bool prepare = false,
+	int nParams = 0, const char* const* values = 0);
     virtual void destruct();
 private:
     // Init DB connection
     bool initDbInternal(int retry);
     // Perform the query, fill the message with data
     // Return number of rows, -1 for non-retryable errors and -2 to retry
-    int queryDbInternal(const char* query, Message* dest);
+    int queryDbInternal(const char* query, Message* dest, bool prepare,
+	int nParams, const char* const* values);
+    // Send a query and queue it to wait for results, connection must be locked
+    // Return 0 on success, -1 for non-retryable errors and -2 to retry
+    int sendQuery(PgQuery* query);
+    // Wait for a query to complete while reading results of all queued queries
+    // The query is deleted unless it timed out and was left to the connection
+    int waitQuery(PgQuery* query, u_int64_t timeout);
+    // Read available results and dispatch them to queued queries
+    bool readResults();
+    void handleResult(PgQuery* query, PGresult* res);
+    void finishQuery(PgQuery* query);
+    // Fail all queued queries and drop the connection
+    void failQueries(const char* error);
 
     PgAccount* m_account;
-    bool m_busy;
+    unsigned int m_depth;                // Queries using the connection, changed under account stats lock
+    bool m_online;
+    bool m_pipelined;                    // Connection is in pipeline mode
+    bool m_reading;                      // A waiter is reading results
     PGconn* m_conn;
+    Mutex m_mutex;                       // Protects the connection and queue
+    ObjList m_queue;                     // Queries waiting for results, in sending order
+    HashList m_prepared;                 // Configured statements prepared on this connection
+    unsigned int m_stmtSeq;
+    u_int64_t m_lastUsed;                // Time the last query released the connection
 };
 
 // Database account holding the connection(s)
@@ -76,6 +160,8 @@ public:
     bool initDb();
     // Make a query
     int queryDb(const char* query, Message* dest);
+    // Execute a configured statement or the one in query with parameters from message
+    int queryStmt(const String& name, Message& msg);
     bool hasConn();
     virtual const String& toString() const
 	{ return m_name; }
@@ -89,6 +175,13 @@ public:
 	{ return m_errorQueries; }
     inline unsigned int queryTime()
         { return (unsigned int) m_queryTime; }
+    inline unsigned int queueTime()
+        { return (unsigned int) m_queueTime; }
+    inline unsigned int connections()
+	{ return m_connPoolSize; }
+    inline unsigned int maxDepth()
+	{ return m_maxDepth; }
+    unsigned int depth();
 
 protected:
     inline void incErrorQueriesSafe() {
@@ -98,20 +191,33 @@ protected:
 
 private:
     void dropDb();
+    // Run a query on a connection of the pool, update statistics
+    int runQuery(const char* query, Message* dest, bool prepare = false,
+	int nParams = 0, const char* const* values = 0);
+    // Reserve a query slot on a connection, grow the pool if all are busy
+    PgConn* reserveConn();
+    void releaseConn(PgConn* conn);
 
     String m_name;
     String m_connection;
     String m_encoding;
     int m_retry;
     u_int64_t m_timeout;
+    unsigned int m_pipeline;             // Maximum queries in flight on a connection
+    NamedList m_statements;              // Configured statements by name
     PgConn* m_connPool;
-    unsigned int m_connPoolSize;
+    unsigned int m_connPoolSize;         // Connections in use, grows up to pool maximum
+    unsigned int m_connPoolMin;
+    unsigned int m_connPoolMax;
+    u_int64_t m_connIdle;                // Unused time after which an added connection is closed
     // stat counters
     Mutex* m_statsMutex;
     unsigned int m_totalQueries;
     unsigned int m_failedQueries;
     unsigned int m_errorQueries;
     u_int64_t m_queryTime;
+    u_int64_t m_queueTime;
+    unsigned int m_maxDepth;
 };
 
 class PgModule : public Module
@@ -146,8 +252,9 @@ public:
 // PgConn
 //
 PgConn::PgConn(PgAccount* account)
-    : m_account(account), m_busy(false),
-    m_conn(0)
+    : m_account(account), m_depth(0),
+    m_online(false), m_pipelined(false), m_reading(false),
+    m_conn(0), m_mutex(true,"PgSQL::conn"), m_stmtSeq(0), m_lastUsed(0)
 {
 }
 
@@ -156,9 +263,16 @@ PgConn::~PgConn()
     dropDb();
 }
 
+// Retrieve the number of queries that can be in flight on this connection
+unsigned int PgConn::maxDepth() const
+{
+    return m_pipelined ? m_account->m_pipeline : 1;
+}
+
 // Initialize the database connection and handler data
 bool PgConn::initDb()
 {
+    Lock mylock(m_mutex);
     if (testDb())
 	return true;
     int retry = m_account->m_retry;
@@ -175,23 +289,29 @@ bool PgConn::initDb()
 // Drop the connection
 void PgConn::dropDb()
 {
+    Lock mylock(m_mutex);
     if (!m_conn)
 	return;
+    failQueries("connection closed");
     PGconn* tmp = m_conn;
     m_conn = 0;
+    m_online = false;
+    m_pipelined = false;
+    m_prepared.clear();
     XDebug(&module,DebugAll,"Connection '%s' dropped [%p]",c_str(),m_account);
     PQfinish(tmp);
 }
 
 // Perform the query, fill the message with data
 // Return number of rows, -1 for non-retryable errors and -2 to retry
-int PgConn::queryDb(const char* query, Message* dest)
+int PgConn::queryDb(const char* query, Message* dest, bool prepare,
+    int nParams, const char* const* values)
 {
     int retry = m_account->m_retry;
     for (int i = 0; i < retry; i++) {
 	XDebug(&module,DebugAll,"Connection '%s' performing query (retry=%d): %s [%p]",
 	    c_str(),i + 1,query,m_account);
-	int res = queryDbInternal(query,dest);
+	int res = queryDbInternal(query,dest,prepare,nParams,values);
 	if (res > -2)
 	    return res;
     }
@@ -273,6 +393,17 @@ bool PgConn::initDbInternal(int retry)
 		    Debug(&module,DebugWarn,
 			"Failed to set encoding '%s' on connection '%s' [%p]",
 			m_account->m_encoding.c_str(),c_str(),m_account);
+#ifdef LIBPQ_HAS_PIPELINING
+		if (m_account->m_pipeline > 1) {
+		    if (PQenterPipelineMode(m_conn))
+			m_pipelined = true;
+		    else
+			Debug(&module,DebugWarn,
+			    "Failed to enter pipeline mode on connection '%s': %s [%p]",
+			    c_str(),PQerrorMessage(m_conn),m_account);
+		}
+#endif
+		m_online = true;
 		return true;
 	    default:
 		break;
@@ -288,124 +419,334 @@ bool PgConn::initDbInternal(int retry)
 
 // Perform the query, fill the message with data
 // Return number of rows, -1 for non-retryable errors and -2 to retry
-int PgConn::queryDbInternal(const char* query, Message* dest)
+int PgConn::queryDbInternal(const char* query, Message* dest, bool prepare,
+    int nParams, const char* const* values)
 {
+    Lock mylock(m_mutex);
     if (!initDb())
 	// no retry - initDb already tried and failed...
 	return -1;
     u_int64_t timeout = Time::now() + m_account->m_timeout;
-    if (!PQsendQuery(m_conn,query)) {
+    const String* name = 0;
+    if (prepare) {
+	PgStmt* st = static_cast<PgStmt*>(m_prepared[query]);
+	if (!st) {
+	    String tmp("yate_");
+	    tmp << ++m_stmtSeq;
+	    st = new PgStmt(query,tmp);
+	    m_prepared.append(st);
+	    PgQuery* prep = new PgQuery(query,dest,&st->m_name,0,0,true);
+	    int res = 0;
+	    if (m_pipelined) {
+		// queued right before the execution, nobody needs to wait for it
+		prep->m_detached = true;
+		res = sendQuery(prep);
+		if (res == -1)
+		    delete prep;
+	    }
+	    else {
+		res = sendQuery(prep);
+		if (!res) {
+		    mylock.drop();
+		    res = waitQuery(prep,timeout);
+		    mylock.acquire(m_mutex);
+		}
+		else
+		    delete prep;
+	    }
+	    if (res < 0) {
+		m_prepared.remove(query);
+		if (res == -2)
+		    dropDb();
+		return res;
+	    }
+	    st = static_cast<PgStmt*>(m_prepared[query]);
+	    if (!st)
+		return -2;
+	}
+	name = &st->m_name;
+    }
+    PgQuery* q = new PgQuery(query,dest,name,nParams,values);
+    int res = sendQuery(q);
+    if (res) {
+	delete q;
+	if (res == -2)
+	    dropDb();
+	return res;
+    }
+    mylock.drop();
+    return waitQuery(q,timeout);
+}
+
+// Send a query and queue it to wait for results, connection must be locked
+// Return 0 on success, -1 for non-retryable errors and -2 to retry
+int PgConn::sendQuery(PgQuery* query)
+{
+    int ok = 0;
+    if (query->m_prepare)
+	ok = PQsendPrepare(m_conn,*query->m_stmt,query->m_query,0,0);
+    else if (query->m_stmt)
+	ok = PQsendQueryPrepared(m_conn,*query->m_stmt,query->m_nParams,query->m_values,0,0,0);
+    else if (m_pipelined || query->m_nParams)
+	// simple query protocol is not allowed in pipeline mode
+	ok = PQsendQueryParams(m_conn,query->m_query,query->m_nParams,0,query->m_values,0,0,0);
+    else
+	ok = PQsendQuery(m_conn,query->m_query);
+    if (!ok) {
 	// a connection failure cannot be detected at this point so any
 	//  error must be caused by the query itself - bad syntax or so
 	Debug(&module,DebugWarn,"Query '%s' for '%s' failed: %s [%p]",
-	    query,c_str(),PQerrorMessage(m_conn),m_account);
-	if (dest)
-	    dest->setParam("error",PQerrorMessage(m_conn));
+	    query->m_query.c_str(),c_str(),PQerrorMessage(m_conn),m_account);
+	if (query->m_dest)
+	    query->m_dest->setParam("error",PQerrorMessage(m_conn));
 	// non-retryable, query should be fixed
 	return -1;
     }
-
-    if (PQflush(m_conn)) {
+    m_queue.append(query)->setDelete(false);
+#ifdef LIBPQ_HAS_PIPELINING
+    // each query gets its own sync point so a failed one won't abort the next ones
+    if (m_pipelined && !PQpipelineSync(m_conn)) {
+	Debug(&module,DebugWarn,"Sync for '%s' failed: %s [%p]",
+	    c_str(),PQerrorMessage(m_conn),m_account);
+	failQueries(PQerrorMessage(m_conn));
+	return -2;
+    }
+#endif
+    int res = 0;
+    while ((res = PQflush(m_conn)) > 0) {
+	// server may wait for us to read results before accepting more data
+	if (!PQconsumeInput(m_conn)) {
+	    res = -1;
+	    break;
+	}
+	Thread::yield();
+    }
+    if (res) {
 	Debug(&module,DebugWarn,"Flush for '%s' failed: %s [%p]",
 	    c_str(),PQerrorMessage(m_conn),m_account);
-	dropDb();
-	if (dest)
-	    dest->setParam("error",PQerrorMessage(m_conn));
+	failQueries(PQerrorMessage(m_conn));
 	return -2;
     }
+    return 0;
+}
 
-    int totalRows = 0;
-    int affectedRows = 0;
-    while (Time::now() < timeout) {
-	PQconsumeInput(m_conn);
-	if (PQisBusy(m_conn)) {
+// Wait for a query to complete while reading results of all queued queries
+// Only one waiter reads at a time, the others sleep until their query completes
+//  or they are asked to take over reading
+// The query is deleted unless it timed out and was left to the connection
+// Return number of rows, -1 for non-retryable errors and -2 on timeout or connection loss
+int PgConn::waitQuery(PgQuery* query, u_int64_t timeout)
+{
+    bool reader = false;
+    int res = -1;
+    Lock mylock(m_mutex);
+    while (!query->done()) {
+	if (Time::now() >= timeout) {
+	    ObjList* o = m_queue.skipNull();
+	    PgQuery* first = o ? static_cast<PgQuery*>(o->get()) : 0;
+	    if (!m_pipelined || (first && first != query && first->m_timedOut)) {
+		// nothing else is in flight or an older query still got no answer
+		Debug(&module,DebugWarn,"Query timed out for '%s' [%p]",c_str(),m_account);
+		failQueries("query timeout");
+		dropDb();
+		break;
+	    }
+	    // fail only this query, its results are discarded when they arrive
+	    Debug(&module,DebugNote,"Query timed out for '%s', left in pipeline [%p]",
+		c_str(),m_account);
+	    query->m_dest = 0;
+	    query->m_detached = true;
+	    query->m_timedOut = true;
+	    query = 0;
+	    res = -2;
+	    break;
+	}
+	if (!reader) {
+	    if (m_reading) {
+		mylock.drop();
+		query->wait(Thread::idleUsec());
+		mylock.acquire(m_mutex);
+		continue;
+	    }
+	    m_reading = reader = true;
+	}
+	if (!readResults()) {
+	    String error = m_conn ? PQerrorMessage(m_conn) : "connection lost";
+	    Debug(&module,DebugWarn,"Reading results for '%s' failed: %s [%p]",
+		c_str(),error.safe(),m_account);
+	    failQueries(error);
+	    dropDb();
+	    break;
+	}
+	if (!query->done()) {
+	    mylock.drop();
 	    Thread::yield();
-	    continue;
+	    mylock.acquire(m_mutex);
 	}
+    }
+    if (reader) {
+	m_reading = false;
+	// hand reading over to the oldest waiter
+	for (ObjList* o = m_queue.skipNull(); o; o = o->skipNext()) {
+	    PgQuery* q = static_cast<PgQuery*>(o->get());
+	    if (!q->m_detached) {
+		q->wake();
+		break;
+	    }
+	}
+    }
+    if (query) {
+	res = query->result();
+	delete query;
+    }
+    return res;
+}
+
+// Read available results and dispatch them to queued queries, connection must be locked
+bool PgConn::readResults()
+{
+    if (!(m_conn && PQconsumeInput(m_conn)))
+	return false;
+    while (ObjList* o = m_queue.skipNull()) {
+	if (PQisBusy(m_conn))
+	    break;
+	PgQuery* q = static_cast<PgQuery*>(o->get());
 	PGresult* res = PQgetResult(m_conn);
 	if (!res) {
-	    // last result already received and processed - exit successfully
-	    Debug(&module,DebugAll,"Query for '%s' returned %d rows, %d affected [%p]",
-		c_str(),totalRows,affectedRows,m_account);
-	    if (dest) {
-		dest->setParam("rows",String(totalRows));
-		dest->setParam("affected",String(affectedRows));
+	    // last result of the query received and processed
+	    if (!m_pipelined) {
+		finishQuery(q);
+		continue;
 	    }
-	    return totalRows;
+	    // out of sync with the server, pipeline is unusable
+	    if (q->m_ended)
+		return false;
+	    q->m_ended = true;
+	    continue;
 	}
-	ExecStatusType stat = PQresultStatus(res);
-	switch (stat) {
-	    case PGRES_TUPLES_OK:
-		// we got some data - but maybe zero rows or binary...
-		if (dest) {
-		    affectedRows += String(PQcmdTuples(res)).toInteger();
-		    int columns = PQnfields(res);
-		    int rows = PQntuples(res);
-		    if (rows > 0) {
-			totalRows += rows;
-			dest->setParam("columns",String(columns));
-			if (dest->getBoolValue("results",true) && !PQbinaryTuples(res)) {
-			    Array *a = new Array(columns,rows+1);
-			    for (int k = 0; k < columns; k++) {
-				ObjList* column = a->getColumn(k);
-				if (column)
-				    column->set(new String(PQfname(res,k)));
-				else {
+#ifdef LIBPQ_HAS_PIPELINING
+	if (PGRES_PIPELINE_SYNC == PQresultStatus(res)) {
+	    PQclear(res);
+	    finishQuery(q);
+	    continue;
+	}
+#endif
+	handleResult(q,res);
+	PQclear(res);
+    }
+    return true;
+}
+
+// Fill the query message with the data of a result
+void PgConn::handleResult(PgQuery* query, PGresult* res)
+{
+    Message* dest = query->m_dest;
+    ExecStatusType stat = PQresultStatus(res);
+    switch (stat) {
+	case PGRES_TUPLES_OK:
+	    // we got some data - but maybe zero rows or binary...
+	    if (dest) {
+		query->m_affected += String(PQcmdTuples(res)).toInteger();
+		int columns = PQnfields(res);
+		int rows = PQntuples(res);
+		if (rows > 0) {
+		    query->m_rows += rows;
+		    dest->setParam("columns",String(columns));
+		    if (dest->getBoolValue("results",true) && !PQbinaryTuples(res)) {
+			Array *a = new Array(columns,rows+1);
+			for (int k = 0; k < columns; k++) {
+			    ObjList* column = a->getColumn(k);
+			    if (column)
+				column->set(new String(PQfname(res,k)));
+			    else {
+				Debug(&module,DebugCrit,
+				    "Query '%s' for '%s': No array column for %d [%p]",
+				    query->m_query.c_str(),c_str(),k,m_account);
+				continue;
+			    }
+			    for (int j = 0; j < rows; j++) {
+				column = column->next();
+				if (!column) {
+				    // Stop now: we won't get the next row
 				    Debug(&module,DebugCrit,
-					"Query '%s' for '%s': No array column for %d [%p]",
-					query,c_str(),k,m_account);
-				    continue;
-				}
-				for (int j = 0; j < rows; j++) {
-				    column = column->next();
-				    if (!column) {
-					// Stop now: we won't get the next row
-					Debug(&module,DebugCrit,
-					    "Query '%s' for '%s': No array row %d in column %d [%p]",
-					    query,c_str(),j + 1,k,m_account);
-					break;
-				    }
-				    // skip over NULL values
-				    if (PQgetisnull(res,j,k))
-					continue;
-				    GenObject* v = 0;
-				    if (PQfformat(res,k))
-					v = new DataBlock(PQgetvalue(res,j,k),PQgetlength(res,j,k));
-				    else
-					v = new String(PQgetvalue(res,j,k));
-				    column->set(v);
+					"Query '%s' for '%s': No array row %d in column %d [%p]",
+					query->m_query.c_str(),c_str(),j + 1,k,m_account);
+				    break;
 				}
+				// skip over NULL values
+				if (PQgetisnull(res,j,k))
+				    continue;
+				GenObject* v = 0;
+				if (PQfformat(res,k))
+				    v = new DataBlock(PQgetvalue(res,j,k),PQgetlength(res,j,k));
+				else
+				    v = new String(PQgetvalue(res,j,k));
+				column->set(v);
 			    }
-			    dest->userData(a);
-			    a->deref();
 			}
+			dest->userData(a);
+			a->deref();
 		    }
 		}
-		break;
-	    case PGRES_COMMAND_OK:
-		if (dest)
-		    affectedRows += String(PQcmdTuples(res)).toInteger();
-		// no data returned
-		break;
-	    case PGRES_COPY_IN:
-	    case PGRES_COPY_OUT:
-		// data transfers - ignore them
-		break;
-	    default:
-		Debug(&module,DebugWarn,"Query '%s' for '%s' error: %s [%p]",
-		    query,c_str(),PQresultErrorMessage(res),m_account);
-		if (dest)
-		    dest->setParam("error",PQresultErrorMessage(res));
-		m_account->incErrorQueriesSafe();
-		module.changed();
+	    }
+	    break;
+	case PGRES_COMMAND_OK:
+	    if (dest && !query->m_prepare)
+		query->m_affected += String(PQcmdTuples(res)).toInteger();
+	    // no data returned
+	    break;
+	case PGRES_COPY_IN:
+	case PGRES_COPY_OUT:
+	    // data transfers - ignore them
+	    break;
+	default:
+	    Debug(&module,DebugWarn,"Query '%s' for '%s' error: %s [%p]",
+		query->m_query.c_str(),c_str(),PQresultErrorMessage(res),m_account);
+	    query->m_error = true;
+	    if (dest)
+		dest->setParam("error",PQresultErrorMessage(res));
+	    m_account->incErrorQueriesSafe();
+	    module.changed();
+    }
+}
+
+// Remove a query from queue when all its results were read
+void PgConn::finishQuery(PgQuery* query)
+{
+    m_queue.remove(query,false);
+    int res = query->m_rows;
+    if (query->m_prepare) {
+	if (query->m_error) {
+	    // executions queued after a failed prepare will fail too
+	    m_prepared.remove(query->m_query);
+	    res = -1;
 	}
-	PQclear(res);
     }
-    Debug(&module,DebugWarn,"Query timed out for '%s' [%p]",c_str(),m_account);
-    if (dest)
-	dest->setParam("error","query timeout");
-    dropDb();
-    return -2;
+    else {
+	Debug(&module,DebugAll,"Query for '%s' returned %d rows, %d affected [%p]",
+	    c_str(),query->m_rows,query->m_affected,m_account);
+	if (query->m_dest) {
+	    query->m_dest->setParam("rows",String(query->m_rows));
+	    query->m_dest->setParam("affected",String(query->m_affected));
+	}
+    }
+    if (query->m_detached)
+	delete query;
+    else
+	query->complete(res);
+}
+
+// Fail all queued queries, they will be retried by their waiters
+void PgConn::failQueries(const char* error)
+{
+    while (PgQuery* q = static_cast<PgQuery*>(m_queue.remove(false))) {
+	if (q->m_dest && error)
+	    q->m_dest->setParam("error",error);
+	if (q->m_detached)
+	    delete q;
+	else
+	    q->complete(-2);
+    }
 }
 
 
@@ -415,10 +756,12 @@ int PgConn::queryDbInternal(const char* query, Message* dest)
 PgAccount::PgAccount(const NamedList& sect)
     : Mutex(true,"PgAccount"),
       m_name(sect),
-      m_connPool(0), m_connPoolSize(0),
+      m_pipeline(1), m_statements(""),
+      m_connPool(0), m_connPoolSize(0), m_connPoolMin(0), m_connPoolMax(0), m_connIdle(0),
       m_statsMutex(&s_conmutex),
       m_totalQueries(0), m_failedQueries(0),
-      m_errorQueries(0), m_queryTime(0)
+      m_errorQueries(0), m_queryTime(0),
+      m_queueTime(0), m_maxDepth(0)
 {
     m_connection = sect.getValue("connection");
     if (m_connection.null()) {
@@ -441,14 +784,26 @@ PgAccount::PgAccount(const NamedList& sect)
 	m_timeout = 500000;
     m_retry = sect.getIntValue("retry",5);
     m_encoding = sect.getValue("encoding");
+    m_pipeline = sect.getIntValue("pipeline",1,1,1000);
+#ifndef LIBPQ_HAS_PIPELINING
+    if (m_pipeline > 1) {
+	Debug(&module,DebugWarn,"Database account '%s': pipeline mode not supported by libpq [%p]",
+	    m_name.c_str(),this);
+	m_pipeline = 1;
+    }
+#endif
+    m_statements.copySubParams(sect,"statement.");
     m_connPoolSize = sect.getIntValue("poolsize",1,1);
-    m_connPool = new PgConn[m_connPoolSize];
-    for (unsigned int i = 0; i < m_connPoolSize; i++) {
+    m_connPoolMin = m_connPoolSize;
+    m_connPoolMax = sect.getIntValue("maxpool",m_connPoolSize,m_connPoolSize);
+    m_connIdle = (u_int64_t)1000 * sect.getIntValue("pool_idle",60000,1000);
+    m_connPool = new PgConn[m_connPoolMax];
+    for (unsigned int i = 0; i < m_connPoolMax; i++) {
 	m_connPool[i].m_account = this;
 	m_connPool[i].assign(m_name + "." + String(i + 1));
     }
-    Debug(&module,DebugInfo,"Database account '%s' created poolsize=%u [%p]",
-	m_name.c_str(),m_connPoolSize,this);
+    Debug(&module,DebugInfo,"Database account '%s' created poolsize=%u maxpool=%u pipeline=%u [%p]",
+	m_name.c_str(),m_connPoolSize,m_connPoolMax,m_pipeline,this);
 }
 
 // Init the connections the connection
@@ -469,13 +824,14 @@ void PgAccount::destroyed()
     if (m_connPool)
 	delete[] m_connPool;
     m_connPoolSize = 0;
+    m_connPoolMax = 0;
     Debug(&module,DebugInfo,"Database account '%s' destroyed [%p]",m_name.c_str(),this);
 }
 
 // drop the connection
 void PgAccount::dropDb()
 {
-    for (unsigned int i = 0; i < m_connPoolSize; i++)
+    for (unsigned int i = 0; i < m_connPoolMax; i++)
 	m_connPool[i].dropDb();
 }
 
@@ -486,66 +842,84 @@ static bool failure(Message* m)
     return false;
 }
 
+// Replace ${name} placeholders of a statement with $N and collect the names
+static String stmtPrepare(const String& text, ObjList& names)
+{
+    String sql;
+    const char* s = text.c_str();
+    while (s && *s) {
+	const char* p = ::strstr(s,"${");
+	const char* e = p ? ::strchr(p + 2,'}') : 0;
+	if (!e) {
+	    sql << s;
+	    break;
+	}
+	String name(p + 2,e - p - 2);
+	int idx = names.index(name);
+	if (idx < 0) {
+	    idx = names.count();
+	    names.append(new String(name));
+	}
+	sql.append(s,p - s) << "$" << (idx + 1);
+	s = e + 1;
+    }
+    return sql;
+}
+
 int PgAccount::queryDb(const char* query, Message* dest)
 {
     if (TelEngine::null(query))
 	return -1;
     Debug(&module,DebugAll,"Performing query \"%s\" for '%s'",
 	query,m_name.c_str());
-    // Use a while() to break to the end to update statistics
+    return runQuery(query,dest);
+}
+
+// Execute a configured statement or the one in query with parameters from message
+int PgAccount::queryStmt(const String& name, Message& msg)
+{
+    // only configured statements are prepared on server, a query given in
+    //  the message is executed with its parameters but not kept
+    String text = msg.getValue("query");
+    bool prepare = text.null();
+    if (prepare)
+	text = m_statements.getValue(name);
+    if (text.null()) {
+	Debug(&module,DebugWarn,"Account '%s' has no statement '%s'",
+	    m_name.c_str(),name.c_str());
+	msg.setParam("error","nostatement");
+	return -1;
+    }
+    ObjList names;
+    String sql = stmtPrepare(text,names);
+    int n = names.count();
+    const char** values = n ? new const char*[n] : 0;
+    int i = 0;
+    // missing parameters are passed as NULL
+    for (ObjList* o = names.skipNull(); o; o = o->skipNext())
+	values[i++] = msg.getValue(o->get()->toString(),0);
+    Debug(&module,DebugAll,"Executing statement '%s' for '%s'",
+	name.c_str(),m_name.c_str());
+    int res = runQuery(sql,&msg,prepare,n,values);
+    delete[] values;
+    return res;
+}
+
+// Run a query on a connection of the pool, update statistics
+int PgAccount::runQuery(const char* query, Message* dest, bool prepare,
+    int nParams, const char* const* values)
+{
     int res = -1;
     u_int64_t start = Time::now();
-    while (true) {
-	Lock mylock(this,(long)m_timeout);
-	if (!mylock.locked()) {
-	    Debug(&module,DebugWarn,"Failed to lock '%s' for " FMT64U " usec",
-		m_name.c_str(),m_timeout);
-	    break;
-	}
-	// Find a non busy connection
-	PgConn* conn = 0;
-	PgConn* notConnected = 0;
-	for (unsigned int i = 0; i < m_connPoolSize; i++) {
-	    if (m_connPool[i].isBusy())
-		continue;
-	    if (m_connPool[i].testDb()) {
-		conn = &(m_connPool[i]);
-		break;
-	    }
-	    if (!notConnected)
-		notConnected = &(m_connPool[i]);
-        }
-	if (!conn)
-	    conn = notConnected;
-	if (!conn) {
-	    // Wait for a connection to become non-busy
-	    // Round up the number of intervals to wait
-	    unsigned int n = (unsigned int)((m_timeout + 999999) / Thread::idleUsec());
-	    for (unsigned int i = 0; i < n; i++) {
-		for (unsigned int j = 0; j < m_connPoolSize; j++) {
-		    if (!m_connPool[j].isBusy() && m_connPool[j].testDb()) {
-			conn = &(m_connPool[j]);
-			break;
-		    }
-		}
-		if (conn || Thread::check(false))
-		    break;
-		Thread::idle();
-	    }
-	}
-	if (conn)
-	    conn->setBusy(true);
-	else
-	    Debug(&module,DebugWarn,"Account '%s' failed to pick a connection [%p]",m_name.c_str(),this);
-	mylock.drop();
-	if (conn) {
-	    res = conn->queryDb(query,dest);
-	    conn->setBusy(false);
-	}
-	break;
+    PgConn* conn = reserveConn();
+    u_int64_t queued = Time::now() - start;
+    if (conn) {
+	res = conn->queryDb(query,dest,prepare,nParams,values);
+	releaseConn(conn);
     }
     Lock stats(m_statsMutex);
     m_totalQueries++;
+    m_queueTime += queued;
     if (res > -2) {
 	if (res < 0)
 	    m_failedQueries++;
@@ -559,10 +933,103 @@ int PgAccount::queryDb(const char* query, Message* dest)
     return res;
 }
 
+// Reserve a query slot on a connection, grow the pool if all are busy
+PgConn* PgAccount::reserveConn()
+{
+    Lock mylock(this,(long)m_timeout);
+    if (!mylock.locked()) {
+	Debug(&module,DebugWarn,"Failed to lock '%s' for " FMT64U " usec",
+	    m_name.c_str(),m_timeout);
+	return 0;
+    }
+    // Find the least loaded connection having free query slots
+    PgConn* conn = 0;
+    PgConn* notConnected = 0;
+    for (unsigned int i = 0; i < m_connPoolSize; i++) {
+	PgConn& c = m_connPool[i];
+	if (c.isBusy())
+	    continue;
+	if (c.isOnline()) {
+	    if (!conn || (c.depth() < conn->depth()))
+		conn = &c;
+	    if (!c.depth())
+		break;
+	}
+	else if (!notConnected)
+	    notConnected = &c;
+    }
+    if (!conn)
+	conn = notConnected;
+    if (!conn && (m_connPoolSize < m_connPoolMax)) {
+	// All connections are saturated, add one to the pool
+	conn = &(m_connPool[m_connPoolSize++]);
+	Debug(&module,DebugInfo,"Account '%s' growing pool to %u connections [%p]",
+	    m_name.c_str(),m_connPoolSize,this);
+    }
+    if (!conn) {
+	// Wait for a connection to become non-busy
+	// Round up the number of intervals to wait
+	unsigned int n = (unsigned int)((m_timeout + 999999) / Thread::idleUsec());
+	for (unsigned int i = 0; i < n; i++) {
+	    for (unsigned int j = 0; j < m_connPoolSize; j++) {
+		if (!m_connPool[j].isBusy() && m_connPool[j].isOnline()) {
+		    conn = &(m_connPool[j]);
+		    break;
+		}
+	    }
+	    if (conn || Thread::check(false))
+		break;
+	    Thread::idle();
+	}
+    }
+    if (!conn) {
+	Debug(&module,DebugWarn,"Account '%s' failed to pick a connection [%p]",m_name.c_str(),this);
+	return 0;
+    }
+    Lock stats(m_statsMutex);
+    conn->m_depth++;
+    if (m_maxDepth < conn->m_depth)
+	m_maxDepth = conn->m_depth;
+    // Connections are picked from the start of the pool so the ones added
+    //  last become idle first when load drops, close one of them if unused
+    PgConn* idle = 0;
+    if (m_connPoolSize > m_connPoolMin) {
+	PgConn& last = m_connPool[m_connPoolSize - 1];
+	if (&last != conn && !last.depth() && (last.m_lastUsed + m_connIdle < Time::now())) {
+	    idle = &last;
+	    m_connPoolSize--;
+	}
+    }
+    stats.drop();
+    if (idle) {
+	Debug(&module,DebugInfo,"Account '%s' shrinking pool to %u connections [%p]",
+	    m_name.c_str(),m_connPoolSize,this);
+	idle->dropDb();
+    }
+    return conn;
+}
+
+void PgAccount::releaseConn(PgConn* conn)
+{
+    Lock stats(m_statsMutex);
+    conn->m_depth--;
+    conn->m_lastUsed = Time::now();
+}
+
+// Retrieve the number of queries currently using the connections
+// Called with the stats mutex locked by status reports
+unsigned int PgAccount::depth()
+{
+    unsigned int n = 0;
+    for (unsigned int i = 0; i < m_connPoolSize; i++)
+	n += m_connPool[i].depth();
+    return n;
+}
+
 bool PgAccount::hasConn()
 {
     for (unsigned int i = 0; i < m_connPoolSize; i++)
-	if (m_connPool[i].testDb())
+	if (m_connPool[i].isOnline())
 	    return true;
     return false;
 }
@@ -584,9 +1051,14 @@ bool PgHandler::received(Message& msg)
     s_conmutex.unlock();
     if (!db)
 	return false;
-    str = msg.getParam("query");
+    str = msg.getParam("statement");
     if (!TelEngine::null(str))
-	db->queryDb(*str,&msg);
+	db->queryStmt(*str,msg);
+    else {
+	str = msg.getParam("query");
+	if (!TelEngine::null(str))
+	    db->queryDb(*str,&msg);
+    }
     db = 0;
     msg.setParam("dbtype","pgsqldb");
     return true;
@@ -607,7 +1079,7 @@ PgModule::~PgModule()
 void PgModule::statusModule(String& str)
 {
     Module::statusModule(str);
-    str.append("format=Total|Failed|Errors|AvgExecTime",",");
+    str.append("format=Total|Failed|Errors|AvgExecTime|AvgQueueTime|Conns|Depth|MaxDepth",",");
 }
 
 void PgModule::statusParams(String& str)
@@ -629,6 +1101,12 @@ void PgModule::statusDetail(String& str)
 	    str << (acc->queryTime() / (acc->total() - acc->failed()) / 1000); //miliseconds
         else
 	    str << "0";
+	str << "|";
+	if (acc->total())
+	    str << (acc->queueTime() / acc->total() / 1000);
+	else
+	    str << "0";
+	str << "|" << acc->connections() << "|" << acc->depth() << "|" << acc->maxDepth();
     }
     s_conmutex.unlock();
 }
@@ -671,6 +1149,9 @@ void PgModule::genUpdate(Message& msg)
 	msg.setParam(String("errorred.") << index,String(acc->errorred()));
 	msg.setParam(String("hasconn.") << index,String::boolText(acc->hasConn()));
 	msg.setParam(String("querytime.") << index,String(acc->queryTime()));
+	msg.setParam(String("queuetime.") << index,String(acc->queueTime()));
+	msg.setParam(String("connections.") << index,String(acc->connections()));
+	msg.setParam(String("depth.") << index,String(acc->depth()));
 	index++;
     }
     s_conmutex.unlock();
@@ -22,22 +22,102 @@
 #include <yatephone.h>
 
 #include <stdio.h>
+#include <string.h>
+#include <ctype.h>
 #include <sqlite3.h>
 
 using namespace TelEngine;
 namespace { // anonymous
 
 class SqlConn;
+class SqlBatcher;
 
 static ObjList s_accounts;
 Mutex s_conmutex(false,"SQLite::acc");
 static unsigned int s_failedConns;
 static bool s_sharedCache = false;
 
+// Journal and synchronous settings applied by the named profiles
+static const TokenDict s_profileJournal[] = {
+    { "wal",      1 },
+    { "durable",  1 },
+    { "volatile", 2 },
+    { 0, 0 }
+};
+
+static const TokenDict s_profileSync[] = {
+    { "wal",      1 },
+    { "durable",  2 },
+    { "volatile", 0 },
+    { 0, 0 }
+};
+
+static const TokenDict s_journalModes[] = {
+    { "delete",   0 },
+    { "wal",      1 },
+    { "memory",   2 },
+    { "truncate", 3 },
+    { "persist",  4 },
+    { "off",      5 },
+    { 0, 0 }
+};
+
+static const TokenDict s_syncModes[] = {
+    { "off",    0 },
+    { "normal", 1 },
+    { "full",   2 },
+    { "extra",  3 },
+    { 0, 0 }
+};
+
+// A statement kept prepared in the cache of a connection
+class SqlStmt : public String
+{
+public:
+    inline SqlStmt(const char* query, sqlite3_stmt* stmt)
+	: String(query),
+	  m_stmt(stmt), m_used(0)
+	{ }
+    ~SqlStmt()
+	{ sqlite3_finalize(m_stmt); }
+    sqlite3_stmt* m_stmt;
+    u_int64_t m_used;                    // Last use sequence, for LRU eviction
+};
+
+// A write query waiting to be executed in a batch transaction
+// Referenced by the batch and by the waiting message thread, if any
+class SqlBatchQuery : public RefObject
+{
+public:
+    inline SqlBatchQuery(const char* query, bool wait)
+	: m_query(query), m_results("database"), m_wait(wait), m_result(-1), m_done(false),
+	  m_semaphore(1,"SQLite::batch",0)
+	{ }
+    inline bool done() const
+	{ return m_done; }
+    inline void complete(int result) {
+	    m_result = result;
+	    m_done = true;
+	    m_semaphore.unlock();
+	}
+    inline void wait()
+	{ m_semaphore.lock(Thread::idleUsec()); }
+    void copyResults(Message& dest);
+
+    String m_query;
+    Message m_results;                   // Results, copied by the waiter when done
+    bool m_wait;                         // A message thread waits for results
+    int m_result;
+private:
+    volatile bool m_done;
+    Semaphore m_semaphore;
+};
+
 // Database account holding the connection(s)
 class SqlAccount : public RefObject, public Mutex
 {
     friend class SqlConn;
+    friend class SqlBatcher;
 public:
     SqlAccount(const NamedList& sect);
     // Try to initialize DB connections. Return true if at least one of them is active
@@ -57,6 +137,14 @@ public:
 	{ return m_errorQueries; }
     inline unsigned int queryTime()
         { return (unsigned int) m_queryTime; }
+    inline unsigned int batches()
+	{ return m_batches; }
+    unsigned int cacheHits() const;
+    unsigned int cacheMisses() const;
+    // Execute the queued writes in a single transaction
+    void flushBatch();
+    // Run batches until the account is destroyed
+    void runBatches();
 
 protected:
     inline void incErrorQueriesSafe() {
@@ -66,20 +154,37 @@ protected:
 
 private:
     void dropDb();
+    // Pick a non busy connection from a pool and mark it busy
+    SqlConn* pickConn(SqlConn* pool, unsigned int size, Mutex* lock);
+    // Queue a write to be executed in the next batch
+    int batchQuery(const char* query, Message* dest);
 
     String m_name;
     String m_database;
     String m_initialize;
     int m_retry;
     u_int64_t m_timeout;
+    String m_journal;                    // Journal mode set on the database
+    String m_synchronous;                // Synchronous mode of connections
+    unsigned int m_cacheSize;            // Prepared statements cached per connection
     SqlConn* m_connPool;
     unsigned int m_connPoolSize;
+    SqlConn* m_readPool;                 // Read-only connections for SELECT queries
+    unsigned int m_readPoolSize;
+    Mutex m_readMutex;
+    // write batching
+    unsigned int m_batchInterval;
+    Mutex m_batchMutex;
+    ObjList m_batch;
+    SqlBatcher* m_batcher;
+    bool m_stopping;
     // stat counters
     Mutex* m_statsMutex;
     unsigned int m_totalQueries;
     unsigned int m_failedQueries;
     unsigned int m_errorQueries;
     u_int64_t m_queryTime;
+    unsigned int m_batches;
 };
 
 // A database connection
@@ -105,9 +210,37 @@ public:
     int queryDb(const char* query, Message* dest);
     virtual void destruct();
 private:
+    // Apply a PRAGMA setting, log failures
+    void pragma(const char* name, const String& value);
+    // Retrieve a cached statement or prepare a new one
+    int prepare(const char* query, sqlite3_stmt*& stmt, const char*& tail, SqlStmt*& cached);
+    // Reset a statement and keep it in cache or destroy it
+    void release(const char* query, const char* tail, sqlite3_stmt* stmt,
+	SqlStmt* cached, bool ok);
+
     SqlAccount* m_account;
     bool m_busy;
+    bool m_readOnly;
     sqlite3* m_conn;
+    HashList m_cache;                    // Prepared statements by query text
+    u_int64_t m_cacheUse;
+    unsigned int m_cacheHits;
+    unsigned int m_cacheMisses;
+};
+
+// Thread executing the batched writes of an account
+class SqlBatcher : public Thread
+{
+public:
+    inline SqlBatcher(SqlAccount* account)
+	: Thread("SQLite Batch"),
+	  m_account(account)
+	{ }
+    virtual ~SqlBatcher();
+    virtual void run()
+	{ m_account->runBatches(); }
+private:
+    SqlAccount* m_account;
 };
 
 class SqlModule : public Module
@@ -142,8 +275,9 @@ public:
 // SqlConn
 //
 SqlConn::SqlConn(SqlAccount* account)
-    : m_account(account), m_busy(false),
-    m_conn(0)
+    : m_account(account), m_busy(false), m_readOnly(false),
+    m_conn(0), m_cache(64), m_cacheUse(0),
+    m_cacheHits(0), m_cacheMisses(0)
 {
 }
 
@@ -158,22 +292,45 @@ bool SqlConn::initDb()
     if (testDb())
 	return true;
     dropDb();
-    Debug(&module,DebugAll,"'%s' opening database \"%s\" [%p]",
-	c_str(),m_account->m_database.safe(),m_account);
-    if (sqlite3_open(m_account->m_database.safe(),&m_conn) != SQLITE_OK) {
+    Debug(&module,DebugAll,"'%s' opening database \"%s\"%s [%p]",
+	c_str(),m_account->m_database.safe(),m_readOnly ? " read-only" : "",m_account);
+    int flags = m_readOnly ? SQLITE_OPEN_READONLY : (SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+    if (sqlite3_open_v2(m_account->m_database.safe(),&m_conn,flags,0) != SQLITE_OK) {
 	Debug(&module,DebugWarn,"Failed to open database '%s': %s",
 	    c_str(),sqlite3_errmsg(m_conn));
 	dropDb();
 	return false;
     }
+    // journal mode is persistent in database, only the writer changes it
+    if (!m_readOnly)
+	pragma("journal_mode",m_account->m_journal);
+    pragma("synchronous",m_account->m_synchronous);
     return true;
 }
 
+// Apply a PRAGMA setting, log failures
+void SqlConn::pragma(const char* name, const String& value)
+{
+    if (value.null())
+	return;
+    String query;
+    query << "PRAGMA " << name << "=" << value;
+    char* err = 0;
+    if (sqlite3_exec(m_conn,query,0,0,&err) != SQLITE_OK)
+	Debug(&module,DebugWarn,"Failed to set %s=%s on '%s': %s",
+	    name,value.c_str(),c_str(),err ? err : sqlite3_errmsg(m_conn));
+    else
+	DDebug(&module,DebugAll,"Set %s=%s on '%s'",name,value.c_str(),c_str());
+    sqlite3_free(err);
+}
+
 // Drop the connection
 void SqlConn::dropDb()
 {
     if (!m_conn)
 	return;
+    // all statements must be finalized before closing
+    m_cache.clear();
     sqlite3* tmp = m_conn;
     m_conn = 0;
     XDebug(&module,DebugAll,"Database '%s' dropped [%p]",c_str(),m_account);
@@ -202,14 +359,13 @@ int SqlConn::queryDb(const char* query, Message* dest)
 	int retry = retries();
 	sqlite3_stmt* stmt;
 	const char* tail;
+	SqlStmt* cached;
 	int i;
 	// Prepare statement, leave whatever unparsed in tail
 	for (i = 0; i >= 0; i++) {
 	    if (i)
 		Thread::idle();
-	    stmt = 0;
-	    tail = 0;
-	    switch (sqlite3_prepare_v2(m_conn,query,-1,&stmt,&tail)) {
+	    switch (prepare(query,stmt,tail,cached)) {
 		case SQLITE_OK:
 		    i = -2;
 		    break;
@@ -285,8 +441,7 @@ int SqlConn::queryDb(const char* query, Message* dest)
 		case SQLITE_BUSY:
 		case SQLITE_LOCKED:
 		    if (i++ >= retry) {
-			sqlite3_reset(stmt);
-			sqlite3_finalize(stmt);
+			release(query,tail,stmt,cached,false);
 			TelEngine::destruct(a);
 			if (results)
 			    dest->userData(0);
@@ -301,8 +456,7 @@ int SqlConn::queryDb(const char* query, Message* dest)
 			if (dest)
 			    dest->setParam("error",errStr);
 		    }
-		    sqlite3_reset(stmt);
-		    sqlite3_finalize(stmt);
+		    release(query,tail,stmt,cached,false);
 		    TelEngine::destruct(a);
 		    if (results)
 			dest->userData(0);
@@ -311,8 +465,7 @@ int SqlConn::queryDb(const char* query, Message* dest)
 	    }
 	}
 	// Clean up statement and advance to next one
-	sqlite3_reset(stmt);
-	sqlite3_finalize(stmt);
+	release(query,tail,stmt,cached,true);
 	TelEngine::destruct(a);
 	query = tail;
     }
@@ -332,6 +485,68 @@ void SqlConn::destruct()
     String::destruct();
 }
 
+// Check if only separators follow a statement
+static inline bool lastStatement(const char* tail)
+{
+    while (tail && (';' == *tail || ' ' == *tail || '\t' == *tail || '\r' == *tail || '\n' == *tail))
+	tail++;
+    return !(tail && *tail);
+}
+
+// Retrieve a cached statement or prepare a new one
+// Only queries holding a single statement are cached, keyed by their text
+int SqlConn::prepare(const char* query, sqlite3_stmt*& stmt, const char*& tail, SqlStmt*& cached)
+{
+    cached = 0;
+    tail = 0;
+    stmt = 0;
+    if (m_account->m_cacheSize) {
+	cached = static_cast<SqlStmt*>(m_cache[query]);
+	if (cached) {
+	    m_cacheHits++;
+	    cached->m_used = ++m_cacheUse;
+	    stmt = cached->m_stmt;
+	    tail = query + cached->length();
+	    return SQLITE_OK;
+	}
+	m_cacheMisses++;
+    }
+    return sqlite3_prepare_v2(m_conn,query,-1,&stmt,&tail);
+}
+
+// Reset a statement and keep it in cache or destroy it
+void SqlConn::release(const char* query, const char* tail, sqlite3_stmt* stmt,
+    SqlStmt* cached, bool ok)
+{
+    sqlite3_reset(stmt);
+    if (cached) {
+	// don't keep a statement that failed, it will be prepared again
+	if (!ok)
+	    m_cache.remove(cached,true,true);
+	return;
+    }
+    if (!(ok && m_account->m_cacheSize && lastStatement(tail))) {
+	sqlite3_finalize(stmt);
+	return;
+    }
+    if (m_cache.count() >= m_account->m_cacheSize) {
+	// evict the least recently used statement
+	SqlStmt* old = 0;
+	for (unsigned int i = 0; i < m_cache.length(); i++) {
+	    for (ObjList* o = m_cache.getList(i); o; o = o->next()) {
+		SqlStmt* st = static_cast<SqlStmt*>(o->get());
+		if (st && (!old || (st->m_used < old->m_used)))
+		    old = st;
+	    }
+	}
+	if (old)
+	    m_cache.remove(old,true,true);
+    }
+    SqlStmt* st = new SqlStmt(query,stmt);
+    st->m_used = ++m_cacheUse;
+    m_cache.append(st);
+}
+
 
 //
 // SqlAccount
@@ -339,10 +554,17 @@ void SqlConn::destruct()
 SqlAccount::SqlAccount(const NamedList& sect)
     : Mutex(true,"SqlAccount"),
       m_name(sect),
+      m_cacheSize(0),
       m_connPool(0), m_connPoolSize(0),
+      m_readPool(0), m_readPoolSize(0),
+      m_readMutex(true,"SqlAccount::read"),
+      m_batchInterval(0),
+      m_batchMutex(false,"SqlAccount::batch"),
+      m_batcher(0), m_stopping(false),
       m_statsMutex(&s_conmutex),
       m_totalQueries(0), m_failedQueries(0),
-      m_errorQueries(0), m_queryTime(0)
+      m_errorQueries(0), m_queryTime(0),
+      m_batches(0)
 {
     m_database = sect.getValue("database",":memory:");
     Engine::runParams().replaceParams(m_database);
@@ -391,8 +613,45 @@ SqlAccount::SqlAccount(const NamedList& sect)
 	m_connPool[i].m_account = this;
 	m_connPool[i].assign(m_name + "." + String(i + 1));
     }
-    Debug(&module,DebugInfo,"Database account '%s' created poolsize=%u [%p]",
-	m_name.c_str(),m_connPoolSize,this);
+    // Journal and synchronous modes, a profile provides defaults for both
+    const String& profile = sect["profile"];
+    if (profile && (lookup(profile,s_profileJournal,-1) < 0))
+	Debug(&module,DebugConf,"Unknown profile '%s' for account '%s'",
+	    profile.c_str(),m_name.c_str());
+    m_journal = lookup(sect.getIntValue("journal_mode",s_journalModes,
+	lookup(profile,s_profileJournal,-1)),s_journalModes);
+    m_synchronous = lookup(sect.getIntValue("synchronous",s_syncModes,
+	lookup(profile,s_profileSync,-1)),s_syncModes);
+    m_cacheSize = sect.getIntValue("stmt_cache",32,0,1000);
+    // Read-only connections must see the same database as the writer
+    unsigned int readers = sect.getIntValue("readers",0,0,64);
+    if (readers && (shared || m_database.null() || (m_database.find(":memory:") >= 0)
+	    || (m_database.find("mode=memory") >= 0))) {
+	Debug(&module,DebugConf,"Disabling readers for memory, temporary or shared cache account '%s'",
+	    m_name.c_str());
+	readers = 0;
+    }
+    if (readers) {
+	m_readPoolSize = readers;
+	m_readPool = new SqlConn[m_readPoolSize];
+	for (unsigned int i = 0; i < m_readPoolSize; i++) {
+	    m_readPool[i].m_account = this;
+	    m_readPool[i].m_readOnly = true;
+	    m_readPool[i].assign(m_name + ".r" + String(i + 1));
+	}
+    }
+    m_batchInterval = sect.getIntValue("batch_interval",0,0,10000);
+    if (m_batchInterval) {
+	m_batcher = new SqlBatcher(this);
+	if (!m_batcher->startup()) {
+	    Debug(&module,DebugWarn,"Failed to start batch thread for account '%s'",m_name.c_str());
+	    delete m_batcher;
+	    m_batcher = 0;
+	    m_batchInterval = 0;
+	}
+    }
+    Debug(&module,DebugInfo,"Database account '%s' created poolsize=%u readers=%u batch=%u [%p]",
+	m_name.c_str(),m_connPoolSize,m_readPoolSize,m_batchInterval,this);
 }
 
 // Init the connections for the account, run init query
@@ -404,6 +663,9 @@ bool SqlAccount::initDb()
 	if (ok && m_initialize && (i == 0) && (m_connPool[i].queryDb(m_initialize,0) < 0))
 	    Debug(&module,DebugWarn,"Failed to run initializer for account '%s'",m_name.c_str());
     }
+    // open readers after the writer had the chance to create the database
+    for (unsigned int i = 0; ok && (i < m_readPoolSize); i++)
+	m_readPool[i].initDb();
     return ok;
 }
 
@@ -412,10 +674,18 @@ void SqlAccount::destroyed()
     s_conmutex.lock();
     s_accounts.remove(this,false);
     s_conmutex.unlock();
+    // batch thread executes pending writes before exiting
+    m_stopping = true;
+    while (m_batcher)
+	Thread::idle();
+    m_batch.clear();
     dropDb();
     if (m_connPool)
 	delete[] m_connPool;
     m_connPoolSize = 0;
+    if (m_readPool)
+	delete[] m_readPool;
+    m_readPoolSize = 0;
     Debug(&module,DebugInfo,"Database account '%s' destroyed [%p]",m_name.c_str(),this);
 }
 
@@ -424,6 +694,8 @@ void SqlAccount::dropDb()
 {
     for (unsigned int i = 0; i < m_connPoolSize; i++)
 	m_connPool[i].dropDb();
+    for (unsigned int i = 0; i < m_readPoolSize; i++)
+	m_readPool[i].dropDb();
 }
 
 static bool failure(Message* m)
@@ -433,63 +705,51 @@ static bool failure(Message* m)
     return false;
 }
 
+// Check if a query starts with one of the keywords
+static bool startsWithWord(const char* query, const char** words)
+{
+    while (' ' == *query || '\t' == *query || '\r' == *query || '\n' == *query)
+	query++;
+    for (; *words; words++) {
+	unsigned int len = ::strlen(*words);
+	if (!::strncasecmp(query,*words,len) && !(isalnum(query[len]) || ('_' == query[len])))
+	    return true;
+    }
+    return false;
+}
+
+static const char* s_readWords[] = { "SELECT", 0 };
+static const char* s_writeWords[] = { "INSERT", "UPDATE", "DELETE", "REPLACE", 0 };
+
+// Check if a query holds a single SELECT statement that a reader can execute
+static bool readOnlyQuery(const char* query)
+{
+    if (!startsWithWord(query,s_readWords))
+	return false;
+    const char* sep = ::strchr(query,';');
+    return !sep || lastStatement(sep);
+}
+
 int SqlAccount::queryDb(const char* query, Message* dest)
 {
     if (TelEngine::null(query))
 	return -1;
     Debug(&module,DebugAll,"Performing query \"%s\" for '%s'",
 	query,m_name.c_str());
-    // Use a while() to break to the end to update statistics
     int res = -1;
     u_int64_t start = Time::now();
-    while (true) {
-	Lock mylock(this,(long)m_timeout);
-	if (!mylock.locked()) {
-	    Debug(&module,DebugWarn,"Failed to lock '%s' for " FMT64U " usec",
-		m_name.c_str(),m_timeout);
-	    break;
-	}
-	// Find a non busy connection
+    if (m_batchInterval && startsWithWord(query,s_writeWords))
+	res = batchQuery(query,dest);
+    else {
 	SqlConn* conn = 0;
-	SqlConn* notConnected = 0;
-	for (unsigned int i = 0; i < m_connPoolSize; i++) {
-	    if (m_connPool[i].isBusy())
-		continue;
-	    if (m_connPool[i].testDb()) {
-		conn = &(m_connPool[i]);
-		break;
-	    }
-	    if (!notConnected)
-		notConnected = &(m_connPool[i]);
-        }
-	if (!conn)
-	    conn = notConnected;
-	if (!conn) {
-	    // Wait for a connection to become non-busy
-	    // Round up the number of intervals to wait
-	    unsigned int n = (unsigned int)((m_timeout + 999999) / Thread::idleUsec());
-	    for (unsigned int i = 0; i < n; i++) {
-		for (unsigned int j = 0; j < m_connPoolSize; j++) {
-		    if (!m_connPool[j].isBusy() && m_connPool[j].testDb()) {
-			conn = &(m_connPool[j]);
-			break;
-		    }
-		}
-		if (conn || Thread::check(false))
-		    break;
-		Thread::idle();
-	    }
-	}
-	if (conn)
-	    conn->setBusy(true);
+	if (m_readPoolSize && readOnlyQuery(query))
+	    conn = pickConn(m_readPool,m_readPoolSize,&m_readMutex);
 	else
-	    Debug(&module,DebugWarn,"Account '%s' failed to pick a connection [%p]",m_name.c_str(),this);
-	mylock.drop();
+	    conn = pickConn(m_connPool,m_connPoolSize,this);
 	if (conn) {
 	    res = conn->queryDb(query,dest);
 	    conn->setBusy(false);
 	}
-	break;
     }
     Lock stats(m_statsMutex);
     m_totalQueries++;
@@ -506,6 +766,179 @@ int SqlAccount::queryDb(const char* query, Message* dest)
     return res;
 }
 
+// Pick a non busy connection from a pool and mark it busy
+SqlConn* SqlAccount::pickConn(SqlConn* pool, unsigned int size, Mutex* lock)
+{
+    Lock mylock(lock,(long)m_timeout);
+    if (!mylock.locked()) {
+	Debug(&module,DebugWarn,"Failed to lock '%s' for " FMT64U " usec",
+	    m_name.c_str(),m_timeout);
+	return 0;
+    }
+    // Find a non busy connection
+    SqlConn* conn = 0;
+    SqlConn* notConnected = 0;
+    for (unsigned int i = 0; i < size; i++) {
+	if (pool[i].isBusy())
+	    continue;
+	if (pool[i].testDb()) {
+	    conn = &(pool[i]);
+	    break;
+	}
+	if (!notConnected)
+	    notConnected = &(pool[i]);
+    }
+    if (!conn)
+	conn = notConnected;
+    if (!conn) {
+	// Wait for a connection to become non-busy
+	// Round up the number of intervals to wait
+	unsigned int n = (unsigned int)((m_timeout + 999999) / Thread::idleUsec());
+	for (unsigned int i = 0; i < n; i++) {
+	    for (unsigned int j = 0; j < size; j++) {
+		if (!pool[j].isBusy() && pool[j].testDb()) {
+		    conn = &(pool[j]);
+		    break;
+		}
+	    }
+	    if (conn || Thread::check(false))
+		break;
+	    Thread::idle();
+	}
+    }
+    if (conn)
+	conn->setBusy(true);
+    else
+	Debug(&module,DebugWarn,"Account '%s' failed to pick a connection [%p]",m_name.c_str(),this);
+    return conn;
+}
+
+// Queue a write to be executed in the next batch
+// Queries that don't need results are not waited for
+int SqlAccount::batchQuery(const char* query, Message* dest)
+{
+    bool wait = dest && dest->getBoolValue("results",true);
+    SqlBatchQuery* q = new SqlBatchQuery(query,wait);
+    Lock mylock(m_batchMutex);
+    m_batch.append(q);
+    if (!wait)
+	return 0;
+    q->ref();
+    mylock.drop();
+    u_int64_t tout = Time::now() + m_timeout;
+    while (!q->done() && (Time::now() < tout))
+	q->wait();
+    int res = -2;
+    if (q->done()) {
+	res = q->m_result;
+	q->copyResults(*dest);
+    }
+    else {
+	// don't execute it later if the batch did not pick it up yet
+	mylock.acquire(m_batchMutex);
+	bool queued = (0 != m_batch.remove(q,false));
+	mylock.drop();
+	if (queued)
+	    TelEngine::destruct(q);
+	Debug(&module,DebugWarn,"Account '%s' timed out waiting for a batched query%s [%p]",
+	    m_name.c_str(),queued ? "" : " in progress",this);
+    }
+    TelEngine::destruct(q);
+    return res;
+}
+
+// Execute the queued writes in a single transaction
+void SqlAccount::flushBatch()
+{
+    Lock mylock(m_batchMutex);
+    if (!m_batch.skipNull())
+	return;
+    ObjList batch;
+    while (ObjList* o = m_batch.skipNull())
+	batch.append(o->remove(false));
+    mylock.drop();
+    SqlConn* conn = pickConn(m_connPool,m_connPoolSize,this);
+    bool ok = conn && (conn->queryDb("BEGIN IMMEDIATE",0) >= 0);
+    if (!ok)
+	Debug(&module,DebugWarn,"Account '%s' failed to start batch transaction [%p]",
+	    m_name.c_str(),this);
+    unsigned int n = 0;
+    for (ObjList* o = batch.skipNull(); o; o = o->skipNext()) {
+	SqlBatchQuery* q = static_cast<SqlBatchQuery*>(o->get());
+	if (ok)
+	    q->m_result = conn->queryDb(q->m_query,q->m_wait ? &q->m_results : 0);
+	n++;
+    }
+    if (ok && (conn->queryDb("COMMIT",0) < 0)) {
+	Debug(&module,DebugWarn,"Account '%s' failed to commit batch of %u queries [%p]",
+	    m_name.c_str(),n,this);
+	conn->queryDb("ROLLBACK",0);
+	ok = false;
+	for (ObjList* o = batch.skipNull(); o; o = o->skipNext())
+	    static_cast<SqlBatchQuery*>(o->get())->m_result = -2;
+    }
+    if (conn)
+	conn->setBusy(false);
+    XDebug(&module,DebugAll,"Account '%s' executed batch of %u queries [%p]",
+	m_name.c_str(),n,this);
+    for (ObjList* o = batch.skipNull(); o; o = o->skipNext()) {
+	SqlBatchQuery* q = static_cast<SqlBatchQuery*>(o->get());
+	if (q->m_wait)
+	    q->complete(q->m_result);
+    }
+    batch.clear();
+    Lock stats(m_statsMutex);
+    m_batches++;
+}
+
+// Run batches until the account is destroyed
+void SqlAccount::runBatches()
+{
+    while (!m_stopping) {
+	u_int64_t next = Time::now() + 1000 * (u_int64_t)m_batchInterval;
+	while (!m_stopping && (Time::now() < next))
+	    Thread::idle();
+	flushBatch();
+    }
+}
+
+unsigned int SqlAccount::cacheHits() const
+{
+    unsigned int n = 0;
+    for (unsigned int i = 0; i < m_connPoolSize; i++)
+	n += m_connPool[i].m_cacheHits;
+    for (unsigned int i = 0; i < m_readPoolSize; i++)
+	n += m_readPool[i].m_cacheHits;
+    return n;
+}
+
+unsigned int SqlAccount::cacheMisses() const
+{
+    unsigned int n = 0;
+    for (unsigned int i = 0; i < m_connPoolSize; i++)
+	n += m_connPool[i].m_cacheMisses;
+    for (unsigned int i = 0; i < m_readPoolSize; i++)
+	n += m_readPool[i].m_cacheMisses;
+    return n;
+}
+
+// Copy the results of an executed query to the message waiting for them
+void SqlBatchQuery::copyResults(Message& dest)
+{
+    static const char* params[] = { "error", "rows", "columns", "affected", 0 };
+    for (const char** p = params; *p; p++) {
+	const String* v = m_results.getParam(*p);
+	if (v)
+	    dest.setParam(*p,*v);
+    }
+    dest.userData(m_results.userData());
+}
+
+SqlBatcher::~SqlBatcher()
+{
+    m_account->m_batcher = 0;
+}
+
 bool SqlAccount::hasConn()
 {
     for (unsigned int i = 0; i < m_connPoolSize; i++)
@@ -562,7 +995,7 @@ SqlModule::~SqlModule()
 void SqlModule::statusModule(String& str)
 {
     Module::statusModule(str);
-    str.append("format=Total|Failed|Errors|AvgExecTime",",");
+    str.append("format=Total|Failed|Errors|AvgExecTime|CacheHits|CacheMisses|Batches",",");
 }
 
 void SqlModule::statusParams(String& str)
@@ -584,6 +1017,7 @@ void SqlModule::statusDetail(String& str)
 	    str << (acc->queryTime() / (acc->total() - acc->failed()) / 1000); //miliseconds
         else
 	    str << "0";
+	str << "|" << acc->cacheHits() << "|" << acc->cacheMisses() << "|" << acc->batches();
     }
     s_conmutex.unlock();
 }
@@ -31,9 +31,16 @@
 using namespace TelEngine;
 namespace { // anonymous
 
+#define USERS_HASH_SIZE         1024    // Default buckets in the users list
+#define USERS_HASH_MAX          262144  // Maximum buckets in the users list
+#define CONTACTS_INDEX_MIN      16      // Index user contacts starting with this count
+#define CONTACTS_PER_BUCKET     4       // Average contacts in a bucket before re-indexing
+#define CONTACTS_INDEX_MAX      1024    // Maximum buckets in the contacts index (HashList limit)
+
 class SubscriptionState;                 // This class holds subscription states
 class Instance;                          // A known instance of an user/contact
 class InstanceList;                      // A list of instances
+class NotifyBatch;                       // A batch of resource.notify messages
 class Contact;                           // An user's contact
 class User;                              // An user along with its contacts
 class PresenceUser;                      // An presence user along with its contacts
@@ -171,6 +178,32 @@ public:
 	const InstanceList& dest) const;
 };
 
+/*
+ * A batch of resource.notify messages sharing the notifier side parameters.
+ * Messages are built from a common prototype and enqueued together when
+ *  the batch is flushed, usually after releasing the user locks
+ */
+class NotifyBatch
+{
+public:
+    NotifyBatch(bool online, const String& from, const String& fromInst,
+	const char* data = 0);
+    ~NotifyBatch();
+    // Add a notification to a subscriber, optionally without data
+    void add(const String& to, const String& toInst = String::empty(),
+	bool withData = true);
+    // Add a notification to all instances of a subscriber
+    void add(const String& to, const InstanceList& instances);
+    // Enqueue all notifications. Return the number of enqueued messages
+    unsigned int flush();
+private:
+    Message m_proto;                     // Parameters common to all notifications
+    String m_data;                       // Notification data
+    ObjList m_msgs;                      // Pending messages
+    ObjList* m_last;                     // Last item in pending list
+    unsigned int m_count;                // Pending messages count
+};
+
 /*
  * An user's contact
  */
@@ -255,6 +288,9 @@ class PresenceUser : public User
 public:
     PresenceUser(const char* name);
     virtual ~PresenceUser();
+    // Retrieve the number of contacts
+    inline unsigned int contacts() const
+	{ return m_contacts; }
     inline InstanceList& instances()
 	{ return m_instances; }
     // Notify all user's instances
@@ -268,6 +304,8 @@ public:
 	}
     // Find a contact
     inline Contact* findContact(const String& name) {
+	    if (m_index)
+		return static_cast<Contact*>((*m_index)[name]);
 	    ObjList* o = m_list.find(name);
 	    return o ? static_cast<Contact*>(o->get()) : 0;
 	}
@@ -292,8 +330,14 @@ public:
     // Each list's parameter name is the target
     // Parameter value may contain a target's instance
     ObjList m_directNotify;
+protected:
+    virtual void destroyed();
 private:
+    // (Re)build the contacts index
+    void buildIndex();
     InstanceList m_instances;            // The list of instances
+    HashList* m_index;                   // Contacts index, built for large rosters
+    unsigned int m_contacts;             // Number of contacts in list
 };
 
 /*
@@ -335,8 +379,16 @@ class UserList : public GenObject, public Mutex
 {
 public:
     UserList();
-    inline ObjList& users()
-	{ return m_users; }
+    ~UserList();
+    // Change the number of buckets, existing users are moved to the new ones
+    void setSize(unsigned int size);
+    // Number of buckets, the list must be locked while they are walked
+    inline unsigned int length() const
+	{ return m_size; }
+    inline ObjList* getList(unsigned int index) const
+	{ return (index < m_size) ? m_lists[index] : 0; }
+    // Add an user to the list, the list must be locked
+    void append(PresenceUser* user);
     // Find an user. Load it from database if not found and load is true
     // Returns referrenced pointer if found
     PresenceUser* getUser(const String& user, bool load = true, bool force = false);
@@ -346,7 +398,10 @@ protected:
     // Load an user from database. Build an PresenceUser object and returns it if found
     PresenceUser* askDatabase(const String& name);
 private:
-    ObjList m_users;                     // Users list
+    ObjList* find(const String& user) const;
+    // Users indexed by name hash, HashList is limited to 1024 buckets
+    ObjList** m_lists;
+    unsigned int m_size;
 };
 
 /*
@@ -871,6 +926,62 @@ void InstanceList::notifyUpdate(bool online, const String& from, const String& t
 }
 
 
+/*
+ * NotifyBatch
+ */
+NotifyBatch::NotifyBatch(bool online, const String& from, const String& fromInst,
+    const char* data)
+    : m_proto("resource.notify"), m_data(data), m_last(&m_msgs), m_count(0)
+{
+    m_proto.addParam("module",__plugin.name());
+    m_proto.addParam("operation",online ? "online" : "offline");
+    m_proto.addParam("from",from);
+    if (fromInst)
+	m_proto.addParam("from_instance",fromInst);
+}
+
+NotifyBatch::~NotifyBatch()
+{
+    flush();
+}
+
+// Add a notification to a subscriber, optionally without data
+void NotifyBatch::add(const String& to, const String& toInst, bool withData)
+{
+    Message* m = new Message(m_proto);
+    m->addParam("to",to);
+    if (toInst)
+	m->addParam("to_instance",toInst);
+    if (withData && m_data)
+	m->addParam("data",m_data);
+    m_last = m_last->append(m);
+    m_count++;
+}
+
+// Add a notification to all instances of a subscriber
+void NotifyBatch::add(const String& to, const InstanceList& instances)
+{
+    for (ObjList* o = instances.skipNull(); o; o = o->skipNext())
+	add(to,*static_cast<Instance*>(o->get()));
+}
+
+// Enqueue all notifications
+unsigned int NotifyBatch::flush()
+{
+    if (!m_count)
+	return 0;
+    DDebug(&__plugin,DebugAll,"Enqueueing %u notifications operation=%s from=%s (%s)",
+	m_count,m_proto.getValue("operation"),m_proto.getValue("from"),
+	m_proto.getValue("from_instance"));
+    unsigned int n = m_count;
+    while (GenObject* m = m_msgs.remove(false))
+	Engine::enqueue(static_cast<Message*>(m));
+    m_last = &m_msgs;
+    m_count = 0;
+    return n;
+}
+
+
 /*
  * Contact
  */
@@ -1030,7 +1141,8 @@ void User::destroyed()
  * PresenceUser
  */
 PresenceUser::PresenceUser(const char* name)
-    : User(name)
+    : User(name),
+    m_index(0), m_contacts(0)
 {
     DDebug(&__plugin,DebugAll,"PresenceUser::PresenceUser(%s) [%p]",name,this);
 }
@@ -1038,11 +1150,15 @@ PresenceUser::PresenceUser(const char* name)
 PresenceUser::~PresenceUser()
 {
     DDebug(&__plugin,DebugAll,"PresenceUser::~PresenceUser(%s) [%p]",user().c_str(),this);
+    TelEngine::destruct(m_index);
     m_list.clear();
 }
 
 void PresenceUser::notify(const Message& msg)
 {
+    String* oper = msg.getParam("operation");
+    bool online = !oper || *oper != "finalize";
+    NotifyBatch batch(online,user(),msg["callid"]);
     Lock lock(this);
     ObjList* o = m_list.skipNull();
     for (; o; o = o->skipNext()) {
@@ -1056,11 +1172,10 @@ void PresenceUser::notify(const Message& msg)
 	}
 	DDebug(&__plugin,DebugAll,"PresenceUser(%s) notifying contact %s [%p]",
 	    user().c_str(),c->c_str(),this);
-	String* oper = msg.getParam("operation");
-	bool online = !oper || *oper != "finalize";
-	c->m_instances.notifyInstance(online,false,user(),*c,msg.getValue("callid"),0);
+	batch.add(*c,c->m_instances);
     }
-
+    lock.drop();
+    batch.flush();
 }
 
 // Add a contact
@@ -1070,6 +1185,13 @@ void PresenceUser::appendContact(Contact* c)
 	return;
     Lock lock(this);
     m_list.append(c);
+    m_contacts++;
+    // Don't re-index once the index reached the maximum size, it would not grow
+    if (m_index && ((m_contacts <= m_index->length() * CONTACTS_PER_BUCKET) ||
+	(m_index->length() >= CONTACTS_INDEX_MAX)))
+	m_index->append(c)->setDelete(false);
+    else if (m_contacts >= CONTACTS_INDEX_MIN)
+	buildIndex();
 #ifdef DEBUG
     String sub;
     c->m_subscription.toString(sub);
@@ -1081,20 +1203,41 @@ void PresenceUser::appendContact(Contact* c)
 // Remove a contact. Return it if found and not deleted
 Contact* PresenceUser::removeContact(const String& name, bool delObj)
 {
-    ObjList* o = m_list.find(name);
-    if (!o)
+    Contact* c = findContact(name);
+    if (!c)
 	return 0;
-    Contact* c = static_cast<Contact*>(o->get());
 #ifdef DEBUG
     String sub;
     c->m_subscription.toString(sub);
     DDebug(&__plugin,DebugAll,"PresenceUser(%s) removed contact (%p,%s) subscription=%s [%p]",
 	user().c_str(),c,c->c_str(),sub.c_str(),this);
 #endif
-    o->remove(delObj);
+    if (m_index)
+	m_index->remove(c,c->hash(),false);
+    m_list.remove(c,delObj);
+    if (m_contacts)
+	m_contacts--;
     return delObj ? 0 : c;
 }
 
+// (Re)build the contacts index with about one contact in each bucket
+void PresenceUser::buildIndex()
+{
+    TelEngine::destruct(m_index);
+    m_index = new HashList((m_contacts < CONTACTS_INDEX_MAX) ? m_contacts : CONTACTS_INDEX_MAX);
+    for (ObjList* o = m_list.skipNull(); o; o = o->skipNext())
+	m_index->append(o->get())->setDelete(false);
+    DDebug(&__plugin,DebugAll,"PresenceUser(%s) indexed %u contacts in %u buckets [%p]",
+	user().c_str(),m_contacts,m_index->length(),this);
+}
+
+void PresenceUser::destroyed()
+{
+    TelEngine::destruct(m_index);
+    m_contacts = 0;
+    User::destroyed();
+}
+
 // Add or remove directed presence. Remove all instances if instance is empty.
 // Update it for all targets if contact is empty
 void PresenceUser::updateDirectNotify(bool online, const String& instance,
@@ -1319,8 +1462,62 @@ void ExpireThread::run()
  * UserList
  */
 UserList::UserList()
-    : Mutex(true,__plugin.name() + ":UserList")
+    : Mutex(true,__plugin.name() + ":UserList"),
+    m_lists(0), m_size(0)
+{
+    setSize(USERS_HASH_SIZE);
+}
+
+UserList::~UserList()
 {
+    for (unsigned int i = 0; i < m_size; i++)
+	TelEngine::destruct(m_lists[i]);
+    delete[] m_lists;
+}
+
+// Change the number of buckets, existing users are moved to the new ones
+void UserList::setSize(unsigned int size)
+{
+    if (size < 1)
+	size = 1;
+    Lock lock(this);
+    if (size == m_size)
+	return;
+    ObjList** lists = new ObjList*[size];
+    for (unsigned int i = 0; i < size; i++)
+	lists[i] = 0;
+    unsigned int n = 0;
+    for (unsigned int i = 0; i < m_size; i++) {
+	if (!m_lists[i])
+	    continue;
+	while (GenObject* u = m_lists[i]->remove(false)) {
+	    unsigned int idx = u->toString().hash() % size;
+	    if (!lists[idx])
+		lists[idx] = new ObjList;
+	    lists[idx]->append(u);
+	    n++;
+	}
+	TelEngine::destruct(m_lists[i]);
+    }
+    delete[] m_lists;
+    m_lists = lists;
+    m_size = size;
+    Debug(&__plugin,DebugInfo,"Users list has %u buckets for %u users",size,n);
+}
+
+// Add an user to the list, the list must be locked
+void UserList::append(PresenceUser* user)
+{
+    unsigned int idx = user->toString().hash() % m_size;
+    if (!m_lists[idx])
+	m_lists[idx] = new ObjList;
+    m_lists[idx]->append(user);
+}
+
+ObjList* UserList::find(const String& user) const
+{
+    ObjList* l = m_lists[user.hash() % m_size];
+    return l ? l->find(user) : 0;
 }
 
 // Find an user. Load it from database if not found
@@ -1329,7 +1526,7 @@ PresenceUser* UserList::getUser(const String& user, bool load, bool force)
 {
     XDebug(&__plugin,DebugAll,"UserList::getUser(%s)",user.c_str());
     Lock lock(this);
-    ObjList* o = m_users.find(user);
+    ObjList* o = find(user);
     if (o) {
 	PresenceUser* u = static_cast<PresenceUser*>(o->get());
 	return u->ref() ? u : 0;
@@ -1342,9 +1539,9 @@ PresenceUser* UserList::getUser(const String& user, bool load, bool force)
 	return 0;
     // Check if the user was already added while unlocked
     Lock lock2(this);
-    ObjList* tmp = m_users.find(user);
+    ObjList* tmp = find(user);
     if (!tmp)
-	m_users.append(u);
+	append(u);
     else {
 	TelEngine::destruct(u);
 	u = static_cast<PresenceUser*>(tmp->get());
@@ -1356,7 +1553,7 @@ PresenceUser* UserList::getUser(const String& user, bool load, bool force)
 void UserList::removeUser(const String& user)
 {
     Lock lock(this);
-    ObjList* o = m_users.find(user);
+    ObjList* o = find(user);
     if (!o)
 	return;
 #ifdef DEBUG
@@ -1669,7 +1866,7 @@ bool SubMessageHandler::received(Message& msg)
 			if (!u) {
 			    n++;
 			    u = new PresenceUser(*s);
-			    __plugin.m_users.users().append(u);
+			    __plugin.m_users.append(u);
 			    u->ref();
 			}
 			if (cntCol >= 0) {
@@ -1763,6 +1960,7 @@ void SubscriptionModule::initialize()
 	    m_handlers.append(h);
 	}
     }
+    m_users.setSize(cfg.getIntValue("general","users_hash",USERS_HASH_SIZE,1,USERS_HASH_MAX));
     Lock lck(this);
     m_routeCallto = cfg.getValue("general","route_callto","jabber/${called}");
     if (!m_routeCallto)
@@ -2008,13 +2206,15 @@ void SubscriptionModule::handleCallCdr(const Message& msg, const String& notif)
     }
     PresenceUser* pu = 0;
     m_users.lock();
-    for (ObjList* o = m_users.users().skipNull(); o; o = o->skipNext()) {
-	pu = static_cast<PresenceUser*>(o->get());
-	if (pu->user().substr(0,pu->user().find("@")) == notif) {
-	    pu->ref();
-	    break;
+    for (unsigned int i = 0; !pu && i < m_users.length(); i++) {
+	for (ObjList* o = m_users.getList(i); o; o = o->next()) {
+	    pu = static_cast<PresenceUser*>(o->get());
+	    if (pu && pu->user().substr(0,pu->user().find("@")) == notif) {
+		pu->ref();
+		break;
+	    }
+	    pu = 0;
 	}
-	pu = 0;
     }
     m_users.unlock();
     if (!pu)
@@ -2284,6 +2484,7 @@ bool SubscriptionModule::handleResNotify(bool online, Message& msg)
     }
     if (notify) {
 	const char* data = msg.getValue("data");
+	NotifyBatch batch(online,u->toString(),inst ? *inst : String::empty(),data);
 	// Notify contacts (from user) and new online user (from contacts)
 	// Send pending in subscription requests to user's new instance
 	// Re-send pending out subscription requests each time a new instance is notified
@@ -2303,12 +2504,8 @@ bool SubscriptionModule::handleResNotify(bool online, Message& msg)
 	    if (!dest) {
 		// User not found, it may belong to other domain
 		// Send presence and probe it if our user is online
-		if (c->m_subscription.from()) {
-		    if (online)
-			__plugin.notify(true,u->toString(),*c,*inst,String::empty(),data);
-		    else
-			__plugin.notify(false,u->toString(),*c,inst ? *inst : String::empty());
-		}
+		if (c->m_subscription.from())
+		    batch.add(*c,String::empty(),online);
 		if (online) {
 		    probe(u->toString(),*c);
 		    if (pendingOut)
@@ -2319,8 +2516,7 @@ bool SubscriptionModule::handleResNotify(bool online, Message& msg)
 	    dest->lock();
 	    // Notify user's instance to all contact's instances
 	    if (c->m_subscription.from())
-		dest->instances().notifyInstance(online,false,u->toString(),
-		    dest->toString(),inst ? *inst : String::empty(),data);
+		batch.add(dest->toString(),dest->instances());
 	    // Notify all contact's instances to the new user's instance
 	    if (fromContact)
 		dest->instances().notifyUpdate(online,dest->toString(),
@@ -2340,8 +2536,11 @@ bool SubscriptionModule::handleResNotify(bool online, Message& msg)
 	    if (newInstance && online)
 		u->instances().notifySkip(online,true,u->toString(),*inst,data);
 	}
+	u->unlock();
+	batch.flush();
     }
-    u->unlock();
+    else
+	u->unlock();
     TelEngine::destruct(u);
     return false;
 }
@@ -2529,11 +2728,15 @@ bool SubscriptionModule::handleResNotifyProbe(const String& from, const String&
 void SubscriptionModule::updateCaps(const String& capsid, NamedList& list)
 {
     m_users.lock();
-    for (ObjList* o = m_users.users().skipNull(); o; o = o->skipNext()) {
-	PresenceUser* u = static_cast<PresenceUser*>(o->get());
-	u->instances().updateCaps(capsid,list);
-	for (ObjList* c = u->m_list.skipNull(); c; c = c->skipNext())
-	    (static_cast<Contact*>(c->get()))->m_instances.updateCaps(capsid,list);
+    for (unsigned int i = 0; i < m_users.length(); i++) {
+	for (ObjList* o = m_users.getList(i); o; o = o->next()) {
+	    PresenceUser* u = static_cast<PresenceUser*>(o->get());
+	    if (!u)
+		continue;
+	    u->instances().updateCaps(capsid,list);
+	    for (ObjList* c = u->m_list.skipNull(); c; c = c->skipNext())
+		(static_cast<Contact*>(c->get()))->m_instances.updateCaps(capsid,list);
+	}
     }
     m_users.unlock();
     // TODO: handle generic users
@@ -811,9 +811,10 @@ public:
 };
 
 // Implementation for a SCCP Global Title Translator
-class GTTranslator : public GTT
+// Uses the native prefix rules first and sccp.route messages if none matched
+class GTTranslator : public PrefixGTT
 {
-    YCLASS(GTTranslator,GTT)
+    YCLASS(GTTranslator,PrefixGTT)
 public:
     GTTranslator(const NamedList& params);
     virtual ~GTTranslator();
@@ -821,6 +822,8 @@ public:
 	    const String& nextPrefix);
     virtual bool initialize(const NamedList* config);
     virtual void updateTables(const NamedList& params);
+private:
+    bool m_messages;
 };
 
 class SCCPUserDummy : public SCCPUser
@@ -4996,7 +4999,8 @@ bool SCCPUserDummy::managementNotify(SCCP::Type type, NamedList &params)
 
 GTTranslator::GTTranslator(const NamedList& params)
     : SignallingComponent(params.safe("GTT"),&params,"ss7-gtt"),
-      GTT(params)
+      PrefixGTT(params),
+      m_messages(true)
 {
     DDebug(this,DebugAll,"Crated Global Title Translator [%p]",this);
 }
@@ -5008,10 +5012,9 @@ GTTranslator::~GTTranslator()
 
 NamedList* GTTranslator::routeGT(const NamedList& gt, const String& prefix, const String& nextPrefix)
 {
-    // TODO keep a cache!!
-    // Verify if the requested gt exists in cache
-    // if exists return the cached translation of th GT
-    // if not exists send it for translation
+    NamedList* route = PrefixGTT::routeGT(gt,prefix,nextPrefix);
+    if (route || !m_messages)
+	return route;
     Message* msg = new Message("sccp.route");
     const char* name = sccp() ? sccp()->toString().c_str() : (const char*)0;
     msg->addParam("component",name,false);
@@ -5022,7 +5025,7 @@ NamedList* GTTranslator::routeGT(const NamedList& gt, const String& prefix, cons
     msg->copyParam(gt,YSTRING("generated"));
     msg->copySubParams(gt,nextPrefix + ".",false);
     msg->copySubParams(gt,prefix + ".");
-    if (Engine::dispatch(msg)) // Append the translated GT to cache
+    if (Engine::dispatch(msg))
 	return msg;
     TelEngine::destruct(msg);
     return 0;
@@ -5037,7 +5040,9 @@ void GTTranslator::updateTables(const NamedList& params)
 
 bool GTTranslator::initialize(const NamedList* config)
 {
-    return GTT::initialize(config);
+    if (config)
+	m_messages = config->getBoolValue(YSTRING("route_messages"),true);
+    return PrefixGTT::initialize(config);
 }
 
 /**
@@ -22,6 +22,7 @@
 #include <yatephone.h>
 #include <yatesnmp.h>
 
+#include <stdlib.h>
 #include <string.h>
 
 // values for the different versions of the protocol
@@ -427,6 +428,8 @@ public:
 
     // obtain the value for a query
     AsnValue makeQuery(const String& query, unsigned int& index, AsnMib* mib = 0);
+    // keep the answer to a monitor query for a short time
+    void cacheQuery(const String& key, const String& value, u_int64_t now);
 
     // send in form of a SNMP trap a notification
     bool sendNotification(const String& notif, const String* value = 0,
@@ -484,6 +487,12 @@ private:
     // AES and DES ciphers
     Cipher* m_cipherAES;
     Cipher* m_cipherDES;
+
+    // recent answers to monitor queries
+    Mutex m_cacheMutex;
+    HashList m_queryCache;
+    u_int64_t m_cacheTtl;
+    u_int64_t m_cachePurge;
 };
 
 /**
@@ -500,6 +509,19 @@ public:
     virtual void cleanup();
 };
 
+/**
+  * QueryCacheItem - answer to a monitor query kept for a short time
+  */
+class QueryCacheItem : public String
+{
+public:
+    inline QueryCacheItem(const String& key)
+	: String(key), m_expires(0)
+	{ }
+    String m_value;
+    u_int64_t m_expires;
+};
+
 /**
   * CipherHolder - class for obtaining an appropriate encryption/decryption object from OpenSSL module
   */
@@ -519,6 +541,30 @@ private:
     Cipher* m_cipher;
 };
 
+/**
+ * Entry of the OID index, keeps the numeric form of the OID and its position in the sorted index
+ */
+class AsnMibNode : public GenObject {
+public:
+    AsnMibNode(AsnMib* mib);
+    virtual const String& toString() const
+	{ return m_mib->toString(); }
+    inline const u_int32_t* ids() const
+	{ return (const u_int32_t*)m_ids.data(); }
+    inline unsigned int count() const
+	{ return m_ids.length() / sizeof(u_int32_t); }
+    // Build the numeric form of an OID
+    static void parse(DataBlock& dest, const String& oid);
+    // Compare two numeric OIDs
+    static int compare(const u_int32_t* ids1, unsigned int len1,
+	const u_int32_t* ids2, unsigned int len2);
+
+    AsnMib* m_mib;
+    DataBlock m_ids;
+    unsigned int m_pos;
+    unsigned int m_next;
+};
+
 /**
  * Tree of OIDs.
  */
@@ -526,6 +572,7 @@ class AsnMibTree : public GenObject {
     YCLASS(AsnMibTree, GenObject)
 public:
     inline AsnMibTree()
+	: m_nodes(0), m_count(0), m_byOid(256), m_byName(256)
 	{}
     // Constructor with file name from which the tree is to be built
     AsnMibTree(const String& fileName);
@@ -544,8 +591,20 @@ public:
     String findRevision(const String& name);
 
 private:
+    // Find the index entry of an OID
+    inline AsnMibNode* findNode(const String& oid) const
+	{ return static_cast<AsnMibNode*>(m_byOid[oid]); }
+    // Find the first accessible object following an OID
+    AsnMib* findAfter(const String& oid);
+    // Build the OID and name indexes
+    void buildIndex();
+
     String m_treeConf;
     ObjList m_mibs;
+    AsnMibNode** m_nodes;                // index sorted by numeric OID
+    unsigned int m_count;
+    HashList m_byOid;                    // index entries by OID, owns the entries
+    HashList m_byName;                   // index entries by MIB name
 };
 
 const TokenDict TransportType::s_typeText[] = {
@@ -663,10 +722,50 @@ UNLOAD_PLUGIN(unloadNow)
     return true;
 }
 
+/**
+  * AsnMibNode
+  */
+AsnMibNode::AsnMibNode(AsnMib* mib)
+    : m_mib(mib), m_next(0)
+{
+    parse(m_ids,mib->toString());
+}
+
+void AsnMibNode::parse(DataBlock& dest, const String& oid)
+{
+    dest.clear();
+    ObjList* list = oid.split('.',false);
+    for (ObjList* o = list->skipNull(); o; o = o->skipNext()) {
+	u_int32_t val = static_cast<String*>(o->get())->toInteger();
+	dest.append(&val,sizeof(val));
+    }
+    TelEngine::destruct(list);
+}
+
+int AsnMibNode::compare(const u_int32_t* ids1, unsigned int len1,
+    const u_int32_t* ids2, unsigned int len2)
+{
+    for (unsigned int i = 0; i < len1 && i < len2; i++) {
+	if (ids1[i] != ids2[i])
+	    return (ids1[i] < ids2[i]) ? -1 : 1;
+    }
+    if (len1 == len2)
+	return 0;
+    return (len1 < len2) ? -1 : 1;
+}
+
+static int nodeCompare(const void* a, const void* b)
+{
+    const AsnMibNode* n1 = *static_cast<AsnMibNode* const*>(a);
+    const AsnMibNode* n2 = *static_cast<AsnMibNode* const*>(b);
+    return AsnMibNode::compare(n1->ids(),n1->count(),n2->ids(),n2->count());
+}
+
 /**
   * AsnMibTree
   */
 AsnMibTree::AsnMibTree(const String& fileName)
+    : m_nodes(0), m_count(0), m_byOid(256), m_byName(256)
 {
     DDebug(&__plugin,DebugAll,"AsnMibTree object created from %s", fileName.c_str());
     m_treeConf = fileName;
@@ -675,6 +774,9 @@ AsnMibTree::AsnMibTree(const String& fileName)
 
 AsnMibTree::~AsnMibTree()
 {
+    m_byName.clear();
+    m_byOid.clear();
+    delete[] m_nodes;
     m_mibs.clear();
 }
 
@@ -693,6 +795,33 @@ void AsnMibTree::buildTree()
 	    }
     	}
     }
+    buildIndex();
+}
+
+// Sort the objects by OID and remember for each of them the next accessible one
+void AsnMibTree::buildIndex()
+{
+    m_byName.clear();
+    m_byOid.clear();
+    delete[] m_nodes;
+    m_count = m_mibs.count();
+    m_nodes = m_count ? new AsnMibNode*[m_count] : 0;
+    unsigned int i = 0;
+    for (ObjList* o = m_mibs.skipNull(); o; o = o->skipNext())
+	m_nodes[i++] = new AsnMibNode(static_cast<AsnMib*>(o->get()));
+    if (m_count)
+	::qsort(m_nodes,m_count,sizeof(AsnMibNode*),nodeCompare);
+    unsigned int next = m_count;
+    for (i = m_count; i--; ) {
+	m_nodes[i]->m_next = next;
+	if (m_nodes[i]->m_mib->getAccessValue() > AsnMib::accessibleForNotify)
+	    next = i;
+    }
+    for (i = 0; i < m_count; i++) {
+	m_byOid.append(m_nodes[i]);
+	m_byName.append(m_nodes[i],m_nodes[i]->m_mib->getName().hash())->setDelete(false);
+    }
+    DDebug(&__plugin,DebugAll,"AsnMibTree indexed %u objects",m_count);
 }
 
 String AsnMibTree::findRevision(const String& name)
@@ -715,16 +844,13 @@ String AsnMibTree::findRevision(const String& name)
 AsnMib* AsnMibTree::find(const String& name)
 {
     DDebug(&__plugin,DebugAll,"AsnMibTree::find('%s')",name.c_str());
-    const ObjList *n = m_mibs.skipNull();
-    AsnMib* mib = 0;
-    while (n) {
-	mib = static_cast<AsnMib*>(n->get());
+    ObjList* n = m_byName.getHashList(name.hash());
+    for (n = n ? n->skipNull() : 0; n; n = n->skipNext()) {
+	AsnMib* mib = static_cast<AsnMibNode*>(n->get())->m_mib;
 	if (name == mib->getName())
-	    break;
-	n = n->skipNext();
-	mib = 0;
+	    return mib;
     }
-    return mib;
+    return 0;
 }
 
 AsnMib* AsnMibTree::find(const ASNObjId& id)
@@ -737,8 +863,8 @@ AsnMib* AsnMibTree::find(const ASNObjId& id)
     AsnMib* searched = 0;
     unsigned int cycles = 0;
     while (cycles < 2) {
- 	ObjList* n = m_mibs.find(value);
-	searched = n ? static_cast<AsnMib*>(n->get()) : 0;
+	AsnMibNode* n = findNode(value);
+	searched = n ? n->m_mib : 0;
 	if (searched) {
 	    searched->setIndex(index);
 	    return searched;
@@ -753,52 +879,67 @@ AsnMib* AsnMibTree::find(const ASNObjId& id)
     return searched;
 }
 
+// Binary search the first object with an OID greater than the given one
+AsnMib* AsnMibTree::findAfter(const String& oid)
+{
+    DataBlock buf;
+    AsnMibNode::parse(buf,oid);
+    const u_int32_t* ids = (const u_int32_t*)buf.data();
+    unsigned int len = buf.length() / sizeof(u_int32_t);
+    unsigned int lo = 0;
+    unsigned int hi = m_count;
+    while (lo < hi) {
+	unsigned int mid = (lo + hi) / 2;
+	if (AsnMibNode::compare(m_nodes[mid]->ids(),m_nodes[mid]->count(),ids,len) <= 0)
+	    lo = mid + 1;
+	else
+	    hi = mid;
+    }
+    if (lo >= m_count)
+	return 0;
+    if (m_nodes[lo]->m_mib->getAccessValue() <= AsnMib::accessibleForNotify)
+	lo = m_nodes[lo]->m_next;
+    return (lo < m_count) ? m_nodes[lo]->m_mib : 0;
+}
+
 AsnMib* AsnMibTree::findNext(const ASNObjId& id)
 {
     DDebug(&__plugin,DebugAll,"AsnMibTree::findNext('%s')",id.toString().c_str());
     String searchID = id.toString();
     // check it the oid is in our known tree
-    AsnMib* root = static_cast<AsnMib*>(m_mibs.get());
+    AsnMibNode* root = m_count ? m_nodes[0] : 0;
     if (root && !(id.toString().startsWith(root->toString()))) {
-    	NamedList p(id.toString());
-    	AsnMib oid(p);
-    	int comp = oid.compareTo(root);
+	DataBlock ids;
+	AsnMibNode::parse(ids,id.toString());
+	int comp = AsnMibNode::compare((const u_int32_t*)ids.data(),ids.length() / sizeof(u_int32_t),
+	    root->ids(),root->count());
     	if (comp < 0)
     	    searchID = root->toString();
     	else if (comp > 0)
     	    return 0;
     }
-    AsnMib* searched = static_cast<AsnMib*>(m_mibs[searchID.toString()]);
-    if (searched) {
-    	if (searched->getAccessValue() > AsnMib::accessibleForNotify) {
+    AsnMibNode* node = findNode(searchID);
+    if (node) {
+    	if (node->m_mib->getAccessValue() > AsnMib::accessibleForNotify) {
 	    DDebug(&__plugin,DebugInfo,"AsnMibTree::findNext('%s') - found an exact match to be '%s'",
-			id.toString().c_str(), searched->toString().c_str());
-	    return searched;
+			id.toString().c_str(), node->m_mib->toString().c_str());
+	    return node->m_mib;
 	}
     }
     String value = searchID.toString();
     int pos = 0;
     int index = 0;
     while (true) {
- 	ObjList* n = m_mibs.find(value);
-	searched = n ? static_cast<AsnMib*>(n->get()) : 0;
-	if (searched) {
-	    if (id.toString() == searched->getOID() || id.toString() == searched->toString()) {
-	    	ObjList* aux = n->skipNext();
-	    	if (!aux)
-	    	    return 0;
-	    	while (aux) {
-		    AsnMib* mib = static_cast<AsnMib*>(aux->get());
-		    if (mib && mib->getAccessValue() > AsnMib::accessibleForNotify)
-			return mib;
-		    aux = aux->skipNext();
-	    	}
-		return 0;
-	    }
-	    else {
-	    	searched->setIndex(index + 1);
-	    	return searched;
-	    }
+	node = findNode(value);
+	if (node) {
+	    AsnMib* searched = node->m_mib;
+	    if (id.toString() == searched->getOID() || id.toString() == searched->toString())
+		return (node->m_next < m_count) ? m_nodes[node->m_next]->m_mib : 0;
+	    // only accessible objects have instances, the next object is further in the tree
+	    if (searched->getAccessValue() <= AsnMib::accessibleForNotify)
+		return findAfter(id.toString());
+	    searched->setIndex(index + 1);
+	    return searched;
 	}
 	pos = value.rfind('.');
 	if (pos < 0)
@@ -1322,9 +1463,9 @@ int SnmpV3MsgContainer::generateTooBigMsg(Snmp::SNMPv3Message& msg)
     Debug(&__plugin,DebugInfo,"SnmpV3MsgContainer::generateTooBigMsg() [%p]",this);
     if (!m_scopedPdu)
 	return SnmpAgent::MESSAGE_DROP;
-    DataBlock data = m_scopedPdu->m_data;
+    AsnCursor pduData(m_scopedPdu->m_data);
     Snmp::PDUs pdus;
-    pdus.decode(data);
+    pdus.decode(pduData);
     Snmp::PDU* pdu = __plugin.getPDU(pdus);
     if (!pdu)
 	return SnmpAgent::MESSAGE_DROP;
@@ -1333,7 +1474,7 @@ int SnmpV3MsgContainer::generateTooBigMsg(Snmp::SNMPv3Message& msg)
     if (!pdu->m_variable_bindings)
 	pdu->m_variable_bindings = new Snmp::VarBindList();
     pdu->m_variable_bindings->m_list.clear();
-    data.clear();
+    DataBlock data;
     pdus.encode(data);
     m_scopedPdu->m_data.clear();
     m_scopedPdu->m_data.append(data);
@@ -1379,7 +1520,8 @@ int SnmpV3MsgContainer::processSecurityModel(Snmp::SNMPv3Message& msg)
 {
     DDebug(&__plugin,DebugAll,"SnmpV3MsgContainer::processSecurityModel() [%p]",this);
 
-    int r = m_security.decode(msg.m_msgSecurityParameters);
+    AsnCursor secParams(msg.m_msgSecurityParameters);
+    int r = m_security.decode(secParams);
     if (r < 0)
 	return SnmpAgent::MESSAGE_DROP;
 
@@ -1449,7 +1591,8 @@ int SnmpV3MsgContainer::processScopedPdu()
 	return SnmpAgent::MESSAGE_DROP;
 
     Snmp::PDUs pdus;
-    pdus.decode(m_scopedPdu->m_data);
+    AsnCursor pduData(m_scopedPdu->m_data);
+    pdus.decode(pduData);
     int type = pdus.m_choiceType;
 
     Snmp::PDU* decodedPdu = 0;
@@ -1613,7 +1756,8 @@ int SnmpV3MsgContainer::decrypt(Snmp::SNMPv3Message& msg)
     cipher->decrypt(encryptedBlock);
     // decode the pdu from the data
     m_scopedPdu = new Snmp::ScopedPDU();
-    if(m_scopedPdu->decode(encryptedBlock) < 0)
+    AsnCursor decrypted(encryptedBlock);
+    if(m_scopedPdu->decode(decrypted) < 0)
 	return SnmpAgent::WRONG_ENCRYPT;
 
     return SnmpAgent::SUCCESS;
@@ -1691,7 +1835,11 @@ SnmpAgent::SnmpAgent()
 	m_traps(0),
 	m_trapUser(0),
 	m_cipherAES(0),
-	m_cipherDES(0)
+	m_cipherDES(0),
+	m_cacheMutex(false,"SnmpAgent::cache"),
+	m_queryCache(64),
+	m_cacheTtl(0),
+	m_cachePurge(0)
 {
     Output("Loaded module SNMP Agent");
 }
@@ -1795,6 +1943,13 @@ void SnmpAgent::initialize()
     Engine::runParams().replaceParams(ver);
     s_yateVersion = ver;
 
+    // lifetime of the answers to monitor queries
+    m_cacheMutex.lock();
+    m_cacheTtl = 1000 * (u_int64_t)s_cfg.getIntValue("general","query_cache",1000,0,60000);
+    m_queryCache.clear();
+    m_cachePurge = 0;
+    m_cacheMutex.unlock();
+
     // load saved data
     s_saveCfg = Engine::configFile("snmp_data");
     s_saveCfg.load();
@@ -1886,12 +2041,13 @@ int SnmpAgent::processMsg(SnmpMessage* msg)
     DDebug(&__plugin,DebugAll,"::processMsg([%p])",msg);
     if(!msg)
 	return MESSAGE_DROP;
-    DataBlock data = msg->data();
+    DataBlock data;
     const String& host = msg->peer().host();
 
     // determine the version of the SNMP message
     Snmp::Message msgSnmp;
-    int l = msgSnmp.decode(data);
+    AsnCursor received(msg->data());
+    int l = msgSnmp.decode(received);
     if (l > 0) {
 	// SNMPv2 message
 	DDebug(&__plugin,DebugAll,"::processMsg() - received %s message msg=%p",lookup(msgSnmp.m_version,s_proto,""),&msgSnmp);
@@ -1908,9 +2064,9 @@ int SnmpAgent::processMsg(SnmpMessage* msg)
 	msgSnmp.encode(data);
     }
     else {
-	data = msg->data();
+	received = AsnCursor(msg->data());
 	Snmp::SNMPv3Message m;
-	l = m.decode(data);
+	l = m.decode(received);
 	if (l >= 0) {
 	    // SNMPv3 message
 	    DDebug(&__plugin,DebugAll,"::processMsg() - received SNMPv3 message msg=%p",&m);
@@ -1967,7 +2123,7 @@ int SnmpAgent::processSnmpV2Msg(Snmp::Message& msg, const String& host)
 	return WRONG_COMMUNITY;
     }
     // obtain pdus and do decoding
-    DataBlock pdu = msg.m_data;
+    AsnCursor pdu(msg.m_data);
     if (pdu.length() > 0) {
 	Snmp::PDUs chosen;
 	int l = chosen.decode(pdu);
@@ -2124,6 +2280,11 @@ int SnmpAgent::processGetNextReq(Snmp::VarBind* varBind, AsnValue* value,  int&
 
     // obtain the value for the next oid
     next = m_mibTree->find(oid);
+    // objects that are not accessible have no instances, search further in the tree
+    if (next && next->getAccessValue() <= AsnMib::accessibleForNotify) {
+	next->setIndex(0);
+	next = 0;
+    }
     if (next && !next->getName().null()) {
 	String name = next->getName();
 	unsigned int idx = next->index();
@@ -2298,6 +2459,8 @@ Snmp::PDU* SnmpAgent::decodeBulkPDU(int& reqType, Snmp::BulkPDU* pdu, const int&
     int i = 0;
     int error = 0;
     AsnValue val;
+    // keep the end of the response list, it grows with each repetition
+    ObjList* tail = &retPdu->m_variable_bindings->m_list;
 
     // handle non-repeaters
     ObjList* o = list->m_list.skipNull();
@@ -2322,7 +2485,7 @@ Snmp::PDU* SnmpAgent::decodeBulkPDU(int& reqType, Snmp::BulkPDU* pdu, const int&
 	    }
 	    if (newVar->m_choiceType == Snmp::VarBind::VALUE)
 		assignValue(newVar,&val);
-	    retPdu->m_variable_bindings->m_list.append(newVar);
+	    tail = tail->append(newVar);
 	    i++;
 	}
 	if (retPdu->m_error_status)
@@ -2353,7 +2516,7 @@ Snmp::PDU* SnmpAgent::decodeBulkPDU(int& reqType, Snmp::BulkPDU* pdu, const int&
 		}
 		if (newVar->m_choiceType == Snmp::VarBind::VALUE)
 		    assignValue(newVar,&val);
-		retPdu->m_variable_bindings->m_list.append(newVar);
+		tail = tail->append(newVar);
 		var->m_name->m_ObjectName = newVar->m_name->m_ObjectName;
 		l->set(var,false);
 		if (newVar->m_choiceType == Snmp::VarBind::ENDOFMIBVIEW)
@@ -2525,7 +2688,8 @@ int SnmpAgent::generateReport(Snmp::SNMPv3Message& msg, const int& secRes, SnmpV
     TelEngine::destruct(p.m_report->m_Report_PDU);
     if (choice == Snmp::ScopedPduData::PLAINTEXT && data->m_plaintext) {
 	pdu = data->m_plaintext;
-	p.decode(pdu->m_data);
+	AsnCursor pduData(pdu->m_data);
+	p.decode(pduData);
 	p.m_report->m_Report_PDU = getPDU(p);
     }
     if (!pdu) {
@@ -3058,12 +3222,30 @@ AsnValue SnmpAgent::makeQuery(const String& query, unsigned int& index, AsnMib*
     if (!queryIsSupported(query,mib))
 	return val;
 
+    // use a recent answer, managers walking the tree at once ask for the same values
+    String key;
+    key << query << "." << index;
+    u_int64_t now = m_cacheTtl ? Time::now() : 0;
+    if (now) {
+	Lock lck(m_cacheMutex);
+	QueryCacheItem* item = static_cast<QueryCacheItem*>(m_queryCache[key]);
+	if (item && item->m_expires > now) {
+	    XDebug(&__plugin,DebugAll,"::makeQuery(query='%s', index='%d') cached",query.c_str(),index);
+	    if (item->m_value) {
+		val.setValue(item->m_value);
+		val.setType(STRING);
+	    }
+	    return val;
+	}
+    }
+
     // ask the monitor module
     Message msg("monitor.query");
     msg.addParam("name",query);
     msg.addParam("index",String(index));
+    const String* value = 0;
     if (Engine::dispatch(msg)) {
-	const String* value = msg.getParam(YSTRING("value"));
+	value = msg.getParam(YSTRING("value"));
 	if (!value)
 	    value = &msg.retValue();
 	if (*value) {
@@ -3071,10 +3253,39 @@ AsnValue SnmpAgent::makeQuery(const String& query, unsigned int& index, AsnMib*
 	    val.setType(STRING);
 	}
     }
+    if (now)
+	cacheQuery(key,TelEngine::c_safe(value),now);
 
     return val;
 }
 
+void SnmpAgent::cacheQuery(const String& key, const String& value, u_int64_t now)
+{
+    Lock lck(m_cacheMutex);
+    if (now >= m_cachePurge) {
+	// drop the expired answers once in a lifetime
+	for (unsigned int i = 0; i < m_queryCache.length(); i++) {
+	    ObjList* o = m_queryCache.getList(i);
+	    for (o = o ? o->skipNull() : 0; o; ) {
+		if (static_cast<QueryCacheItem*>(o->get())->m_expires <= now) {
+		    o->remove();
+		    o = o->skipNull();
+		}
+		else
+		    o = o->skipNext();
+	    }
+	}
+	m_cachePurge = now + m_cacheTtl;
+    }
+    QueryCacheItem* item = static_cast<QueryCacheItem*>(m_queryCache[key]);
+    if (!item) {
+	item = new QueryCacheItem(key);
+	m_queryCache.append(item);
+    }
+    item->m_value = value;
+    item->m_expires = now + m_cacheTtl;
+}
+
 bool SnmpAgent::queryIsSupported(const String& query, AsnMib* mib)
 {
     if (!m_mibTree || s_yateRoot.null())
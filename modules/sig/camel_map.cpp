@@ -225,7 +225,7 @@ public:
     bool decodeDialogPDU(XmlElement* el, const AppCtxt* ctxt, DataBlock& data);
     XmlElement* addToXml(XmlElement* root, const XMLMap* map, NamedString* val);
     void addComponentsToXml(XmlElement* root, NamedList& params, const AppCtxt* ctxt);
-    const XMLMap* findMap(String& elem);
+    const XMLMap* findMap(const String& elem);
     void addParametersToXml(XmlElement* elem, String& payloadHex, Operation* op, bool searchArgs = true);
     void decodeTcapToXml(TelEngine::XmlElement*, TelEngine::DataBlock&, Operation* op, unsigned int index = 0, bool seachArgs = true);
     bool decodeOperation(Operation* op, XmlElement* elem, DataBlock& data, bool searchArgs = true);
@@ -7387,9 +7387,11 @@ void TcapToXml::reset()
     m_type = Unknown;
 }
 
-const XMLMap* TcapToXml::findMap(String& what)
+const XMLMap* TcapToXml::findMap(const String& elem)
 {
-    XDebug(&__plugin,DebugAll,"TcapToXml::findMap(%s) [%p]",what.c_str(),this);
+    XDebug(&__plugin,DebugAll,"TcapToXml::findMap(%s) [%p]",elem.c_str(),this);
+    // Parameter names are shared, match on a private copy
+    String what(elem);
     const XMLMap* map = s_xmlMap;
     while (map->type != End) {
 	if (what.matches(map->name))
@@ -7435,7 +7437,7 @@ bool TcapToXml::buildXMLMessage(NamedList& params, XmlFragment* msg, MsgType typ
 	    continue;
 	if (ns->name().startsWith(s_tcapCompPrefixSep))
 	    continue;
-	const XMLMap* map = findMap((String&)ns->name());
+	const XMLMap* map = findMap(ns->name());
 	if (!map)
 	    continue;
 	addToXml(el,map,ns);
@@ -7462,7 +7464,7 @@ void TcapToXml::handleMAPDialog(XmlElement* root, NamedList& params)
     param = params.getParam(s_tcapEncodingContent);
     if (TelEngine::null(param))
 	return;
-    const XMLMap* map = findMap((String&)s_tcapEncodingContent);
+    const XMLMap* map = findMap(s_tcapEncodingContent);
     if (!map)
 	return;
     XmlElement* parent = addToXml(root,map,&s_encodingPath);
@@ -7621,7 +7623,7 @@ void TcapToXml::addComponentsToXml(XmlElement* el, NamedList& params, const AppC
 	    if (TelEngine::null(ns))
 		continue;
 
-	    const XMLMap* map = findMap((String&)ns->name());
+	    const XMLMap* map = findMap(ns->name());
 	    if (!map)
 		continue;
 	    XmlElement* child;
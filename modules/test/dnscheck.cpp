@@ -0,0 +1,397 @@
+/**
+ * dnscheck.cpp
+ * This file is part of the YATE Project http://YATE.null.ro
+ *
+ * DNS query cache check against a loopback stub name server
+ *
+ * Yet Another Telephony Engine - a fully featured software PBX and IVR
+ * Copyright (C) 2026 Null Team
+ *
+ * This software is distributed under multiple licenses;
+ * see the COPYING file in the main directory for licensing
+ * information for this specific distribution.
+ *
+ * This use of this software may be subject to additional restrictions.
+ * See the LEGAL file in the main directory for details.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include <yatephone.h>
+
+#include <string.h>
+
+using namespace TelEngine;
+namespace { // anonymous
+
+#define STUB_DELAY      200             // Answer delay of the stub server in msec
+#define STUB_SLOW_DELAY 1500            // Answer delay for names starting with "slow"
+
+class DnsCheck : public Module
+{
+public:
+    DnsCheck();
+    virtual ~DnsCheck();
+    virtual void initialize();
+protected:
+    virtual bool commandExecute(String& retVal, const String& line);
+private:
+    bool runCheck(String& retVal, int port);
+    unsigned int m_runs;
+};
+
+// Loopback name server answering TXT queries, counts the queries per name
+class StubServer : public Mutex
+{
+    friend class StubListener;
+    friend class StubReply;
+public:
+    inline StubServer()
+	: Mutex(false,"DnsStub"),
+	  m_stop(false), m_threads(0), m_counts("")
+	{ }
+    bool start(int port);
+    void stop();
+    unsigned int count(const String& name);
+private:
+    void listen();
+    void answer(const unsigned char* buf, int len, const SocketAddr& addr);
+    void finished();
+    Socket m_socket;
+    volatile bool m_stop;
+    unsigned int m_threads;
+    NamedList m_counts;
+};
+
+// Thread receiving the queries of the stub server
+class StubListener : public Thread
+{
+public:
+    inline StubListener(StubServer* server)
+	: Thread("DNS Stub"), m_server(server)
+	{ }
+    virtual void run()
+	{ m_server->listen(); }
+    virtual void cleanup()
+	{ m_server->finished(); }
+private:
+    StubServer* m_server;
+};
+
+// Delayed answer of the stub server
+class StubReply : public Thread
+{
+public:
+    inline StubReply(StubServer* server, const DataBlock& data, const SocketAddr& addr, unsigned int delay)
+	: Thread("DNS Stub Reply"), m_server(server), m_data(data), m_addr(addr), m_delay(delay)
+	{ }
+    virtual void run()
+	{
+	    Thread::msleep(m_delay);
+	    m_server->m_socket.sendTo(m_data.data(),m_data.length(),m_addr);
+	}
+    virtual void cleanup()
+	{ m_server->finished(); }
+private:
+    StubServer* m_server;
+    DataBlock m_data;
+    SocketAddr m_addr;
+    unsigned int m_delay;
+};
+
+// Result of one cached query
+class QueryResult : public GenObject
+{
+public:
+    inline QueryResult()
+	: m_code(-1), m_usec(0)
+	{ }
+    int m_code;
+    String m_text;
+    u_int64_t m_usec;
+};
+
+// Thread making one cached query
+class Querier : public Thread
+{
+public:
+    inline Querier(const String& name, QueryResult* result, Semaphore& done)
+	: Thread("DNS Check"), m_name(name), m_result(result), m_done(done)
+	{ }
+    virtual void run()
+	{
+	    u_int64_t start = Time::now();
+	    ObjList res;
+	    m_result->m_code = Resolver::cachedQuery(Resolver::Txt,m_name,res);
+	    m_result->m_usec = Time::now() - start;
+	    TxtRecord* rec = static_cast<TxtRecord*>(res.get());
+	    if (rec)
+		m_result->m_text = rec->text();
+	    m_done.unlock();
+	}
+private:
+    String m_name;
+    QueryResult* m_result;
+    Semaphore& m_done;
+};
+
+INIT_PLUGIN(DnsCheck);
+
+
+bool StubServer::start(int port)
+{
+    SocketAddr addr(SocketAddr::IPv4);
+    if (!(m_socket.create(PF_INET,SOCK_DGRAM) && addr.host("127.0.0.1") && addr.port(port) &&
+	m_socket.bind(addr)))
+	return false;
+    m_threads = 1;
+    StubListener* l = new StubListener(this);
+    if (l->startup())
+	return true;
+    delete l;
+    m_threads = 0;
+    m_socket.terminate();
+    return false;
+}
+
+// Stop listening, wait for the pending answers to be sent
+void StubServer::stop()
+{
+    m_stop = true;
+    for (;;) {
+	lock();
+	unsigned int n = m_threads;
+	unlock();
+	if (!n)
+	    break;
+	Thread::idle();
+    }
+    m_socket.terminate();
+}
+
+unsigned int StubServer::count(const String& name)
+{
+    Lock lck(this);
+    return m_counts.getIntValue(name);
+}
+
+void StubServer::finished()
+{
+    Lock lck(this);
+    m_threads--;
+}
+
+void StubServer::listen()
+{
+    unsigned char buf[512];
+    while (!m_stop) {
+	bool readok = false;
+	if (!(m_socket.select(&readok,0,0,(int64_t)Thread::idleUsec()) && readok))
+	    continue;
+	SocketAddr addr;
+	int len = m_socket.recvFrom(buf,sizeof(buf),addr);
+	if (len > 0)
+	    answer(buf,len,addr);
+    }
+}
+
+// Answer a TXT query with a single "ok" record, NXDOMAIN if the name starts with "missing"
+void StubServer::answer(const unsigned char* buf, int len, const SocketAddr& addr)
+{
+    if (len < 17)
+	return;
+    String name;
+    int pos = 12;
+    while (pos < len && buf[pos]) {
+	int l = buf[pos++];
+	if (pos + l > len)
+	    return;
+	if (name)
+	    name << ".";
+	name.append((const char*)buf + pos,l);
+	pos += l;
+    }
+    pos += 5;
+    if (pos > len)
+	return;
+    name.toLower();
+    lock();
+    m_counts.setParam(name,String(m_counts.getIntValue(name) + 1));
+    unlock();
+    bool missing = name.startsWith("missing");
+    DataBlock data(0,pos);
+    unsigned char* d = (unsigned char*)data.data();
+    ::memcpy(d,buf,pos);
+    d[2] = 0x81;
+    d[3] = missing ? 0x83 : 0x80;
+    d[6] = 0;
+    d[7] = missing ? 0 : 1;
+    d[8] = d[9] = d[10] = d[11] = 0;
+    if (!missing) {
+	static const unsigned char rr[] = {
+	    0xc0, 0x0c,                  // name: pointer to the question
+	    0x00, 0x10, 0x00, 0x01,      // TXT, IN
+	    0x00, 0x00, 0x00, 0x3c,      // TTL 60
+	    0x00, 0x03, 0x02, 'o', 'k'   // one string "ok"
+	};
+	data.append((void*)rr,sizeof(rr));
+    }
+    lock();
+    m_threads++;
+    unlock();
+    StubReply* r = new StubReply(this,data,addr,
+	name.startsWith("slow") ? STUB_SLOW_DELAY : STUB_DELAY);
+    if (!r->startup()) {
+	delete r;
+	finished();
+    }
+}
+
+
+// Run identical queries in parallel, wait for all to finish
+static void runQueries(ObjList& results, const String& name, unsigned int count)
+{
+    Semaphore done(count,"DnsCheckDone",0);
+    unsigned int started = 0;
+    for (unsigned int i = 0; i < count; i++) {
+	QueryResult* r = new QueryResult;
+	results.append(r);
+	Querier* q = new Querier(name,r,done);
+	if (q->startup())
+	    started++;
+	else
+	    delete q;
+    }
+    for (; started; started--)
+	done.lock();
+}
+
+static void report(String& retVal, bool& ok, const char* step, bool pass, const String& info)
+{
+    retVal << (pass ? "PASS " : "FAIL ") << step << ": " << info << "\r\n";
+    ok = ok && pass;
+}
+
+
+DnsCheck::DnsCheck()
+    : Module("dnscheck","misc"),
+      m_runs(0)
+{
+    Output("Loaded module DnsCheck");
+}
+
+DnsCheck::~DnsCheck()
+{
+    Output("Unloading module DnsCheck");
+}
+
+void DnsCheck::initialize()
+{
+    Output("Initializing module DnsCheck");
+    setup();
+}
+
+// Point the resolver to a stub server on the loopback and check caching,
+//  coalescing of identical queries and the coalesced wait timeout
+bool DnsCheck::runCheck(String& retVal, int port)
+{
+    StubServer* stub = new StubServer;
+    if (!stub->start(port)) {
+	retVal << "Could not start the stub name server on 127.0.0.1:" << port << "\r\n";
+	delete stub;
+	return false;
+    }
+    NamedList params("");
+    params.addParam("cache","yes");
+    params.addParam("nameservers",String("127.0.0.1:") + String(port));
+    params.addParam("wait_timeout","500");
+    Resolver::setup(params);
+    unsigned int run = ++m_runs;
+    bool ok = true;
+    String info;
+
+    // identical queries in parallel make a single upstream query
+    String name;
+    name << "coalesce" << run << ".dnscheck.test";
+    ObjList list;
+    runQueries(list,name,8);
+    unsigned int good = 0;
+    for (ObjList* o = list.skipNull(); o; o = o->skipNext()) {
+	QueryResult* q = static_cast<QueryResult*>(o->get());
+	if (!q->m_code && (q->m_text == YSTRING("ok")))
+	    good++;
+    }
+    info.clear();
+    info << "answers=" << good << "/" << list.count() << " upstream=" << stub->count(name);
+    report(retVal,ok,"coalesce",(good == 8) && (stub->count(name) == 1),info);
+    list.clear();
+
+    // the answer is now served from the cache
+    runQueries(list,name,1);
+    QueryResult* q = static_cast<QueryResult*>(list.get());
+    info.clear();
+    info << "code=" << (q ? q->m_code : -1) << " usec=" << (unsigned int)(q ? q->m_usec : 0)
+	<< " upstream=" << stub->count(name);
+    report(retVal,ok,"cache",q && !q->m_code && (q->m_usec < 1000 * STUB_DELAY / 2) &&
+	(stub->count(name) == 1),info);
+    list.clear();
+
+    // negative answers are cached too
+    name.clear();
+    name << "missing" << run << ".dnscheck.test";
+    runQueries(list,name,1);
+    list.clear();
+    runQueries(list,name,1);
+    q = static_cast<QueryResult*>(list.get());
+    info.clear();
+    info << "code=" << (q ? q->m_code : 0) << " upstream=" << stub->count(name);
+    report(retVal,ok,"negative",q && q->m_code && (stub->count(name) == 1),info);
+    list.clear();
+
+    // waiters for a slow query give up after wait_timeout, the first one gets the answer
+    name.clear();
+    name << "slow" << run << ".dnscheck.test";
+    runQueries(list,name,4);
+    unsigned int answered = 0;
+    unsigned int timedOut = 0;
+    for (ObjList* o = list.skipNull(); o; o = o->skipNext()) {
+	q = static_cast<QueryResult*>(o->get());
+	if (!q->m_code)
+	    answered++;
+	else if (q->m_usec < 1000 * STUB_SLOW_DELAY)
+	    timedOut++;
+    }
+    info.clear();
+    info << "answered=" << answered << " timedout=" << timedOut << " upstream=" << stub->count(name);
+    report(retVal,ok,"wait timeout",(answered == 1) && (timedOut == 3) && (stub->count(name) == 1),info);
+    list.clear();
+
+    stub->stop();
+    delete stub;
+    // restore the configured resolver settings
+    Configuration cfg(Engine::configFile("yate"));
+    const NamedList* dns = cfg.getSection("dns");
+    Resolver::setup(dns ? *dns : NamedList::empty());
+    Resolver::cacheFlush();
+    retVal << "DNS check " << (ok ? "passed" : "failed") << "\r\n";
+    return ok;
+}
+
+bool DnsCheck::commandExecute(String& retVal, const String& line)
+{
+    String cmd = line;
+    if (!cmd.startSkip(name()))
+	return false;
+    if (!Resolver::available(Resolver::Txt)) {
+	retVal << "Resolver not available\r\n";
+	return true;
+    }
+    runCheck(retVal,cmd.toInteger(15353,0,1024,65535));
+    return true;
+}
+
+}; // anonymous namespace
+
+/* vi: set ts=8 sw=4 sts=4 noet: */
@@ -0,0 +1,205 @@
+/**
+ * routebench.cpp
+ * This file is part of the YATE Project http://YATE.null.ro
+ *
+ * Call routing throughput benchmark
+ *
+ * Yet Another Telephony Engine - a fully featured software PBX and IVR
+ * Copyright (C) 2026 Null Team
+ *
+ * This software is distributed under multiple licenses;
+ * see the COPYING file in the main directory for licensing
+ * information for this specific distribution.
+ *
+ * This use of this software may be subject to additional restrictions.
+ * See the LEGAL file in the main directory for details.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include <yatephone.h>
+
+using namespace TelEngine;
+namespace { // anonymous
+
+class RouteBench : public Module
+{
+public:
+    RouteBench();
+    virtual ~RouteBench();
+    virtual void initialize();
+protected:
+    virtual bool commandExecute(String& retVal, const String& line);
+    virtual bool commandComplete(Message& msg, const String& partLine, const String& partWord);
+private:
+    bool writeScript(String& retVal, const String& file, unsigned int lines);
+    void runCalls(String& retVal, unsigned int calls);
+    unsigned int m_runs;
+};
+
+INIT_PLUGIN(RouteBench);
+
+static const char* s_cmds[] = {
+    "run",
+    "script",
+    0
+};
+
+// Build and dispatch one of the messages of a benchmark call
+static bool callMessage(const char* name, const String& id, const String& called)
+{
+    Message* m = new Message(name);
+    m->addParam("id",id);
+    m->addParam("module","routebench");
+    m->addParam("status","incoming");
+    m->addParam("direction","incoming");
+    m->addParam("caller","routebench");
+    m->addParam("called",called);
+    m->addParam("billid",id);
+    bool ok = Engine::dispatch(m);
+    TelEngine::destruct(m);
+    return ok;
+}
+
+
+RouteBench::RouteBench()
+    : Module("routebench","misc"),
+      m_runs(0)
+{
+    Output("Loaded module RouteBench");
+}
+
+RouteBench::~RouteBench()
+{
+    Output("Unloading module RouteBench");
+}
+
+void RouteBench::initialize()
+{
+    Output("Initializing module RouteBench");
+    setup();
+}
+
+// Write a routing script having a number of lines, mostly in global functions
+bool RouteBench::writeScript(String& retVal, const String& file, unsigned int lines)
+{
+    File f;
+    if (!f.openPath(file,true,false,true,false,false,true)) {
+	retVal << "Could not create '" << file << "'\r\n";
+	return false;
+    }
+    String buf;
+    buf << "// Routing benchmark script generated by routebench\n\n";
+    unsigned int funcs = 0;
+    unsigned int n = 2;
+    // Each rule function takes 12 lines plus one in the dispatcher,
+    //  leave room for the dispatcher and routing body
+    while (n + 13 + 20 <= lines) {
+	buf << "function rule" << funcs << "(called)\n{\n";
+	buf << "    var prefix = \"" << (1000 + funcs) << "\";\n";
+	buf << "    if (called.substr(0,4) != prefix)\n";
+	buf << "\treturn null;\n";
+	buf << "    var tail = called.substr(4);\n";
+	buf << "    if (tail.length < 2)\n";
+	buf << "\treturn \"sip/sip:\" + called + \"@10.0.0." << (funcs % 250 + 1) << "\";\n";
+	buf << "    return \"sip/sip:\" + tail + \"@10.0.1." << (funcs % 250 + 1) << "\";\n";
+	buf << "}\n\n";
+	funcs++;
+	n += 13;
+    }
+    buf << "function route(called)\n{\n";
+    buf << "    switch (parseInt(called.substr(0,4)) - 1000) {\n";
+    for (unsigned int i = 0; i < funcs; i++)
+	buf << "\tcase " << i << ": return rule" << i << "(called);\n";
+    buf << "    }\n";
+    buf << "    return null;\n";
+    buf << "}\n\n";
+    buf << "var target = route(\"\" + message.called);\n";
+    buf << "if (target)\n";
+    buf << "    Channel.callTo(target);\n";
+    buf << "else\n";
+    buf << "    Channel.callTo(\"tone/busy\");\n";
+    n += 13;
+    bool ok = f.writeData(buf.c_str(),buf.length()) == (int)buf.length();
+    f.terminate();
+    if (ok)
+	retVal << "Wrote " << n << " lines with " << funcs << " functions to '" << file << "'\r\n";
+    else
+	retVal << "Failed to write '" << file << "'\r\n";
+    return ok;
+}
+
+// Push calls through startup, routing and hangup
+void RouteBench::runCalls(String& retVal, unsigned int calls)
+{
+    unsigned int run = ++m_runs;
+    unsigned int routed = 0;
+    u_int64_t start = Time::now();
+    for (unsigned int i = 0; i < calls; i++) {
+	String id;
+	id << "routebench/" << run << "-" << i;
+	String called;
+	called << (1000 + (i % 100)) << (i % 1000);
+	callMessage("chan.startup",id,called);
+	callMessage("call.preroute",id,called);
+	if (callMessage("call.route",id,called))
+	    routed++;
+	callMessage("chan.hangup",id,called);
+    }
+    u_int64_t usec = Time::now() - start;
+    if (!usec)
+	usec = 1;
+    retVal << "Ran " << calls << " calls (" << routed << " routed) in " << (unsigned int)(usec / 1000) << " ms";
+    retVal << ", " << (unsigned int)((u_int64_t)calls * 1000000 / usec) << " calls/s";
+    if (calls)
+	retVal << ", " << (unsigned int)(usec / calls) << " usec/call";
+    retVal << "\r\n";
+}
+
+bool RouteBench::commandExecute(String& retVal, const String& line)
+{
+    String cmd = line;
+    if (!cmd.startSkip(name()))
+	return false;
+    if (cmd.startSkip("run")) {
+	int calls = cmd.toInteger(1000);
+	if (calls <= 0)
+	    calls = 1000;
+	runCalls(retVal,calls);
+	return true;
+    }
+    if (cmd.startSkip("script")) {
+	String file;
+	int pos = cmd.find(' ');
+	unsigned int lines = 2000;
+	if (pos > 0) {
+	    file = cmd.substr(0,pos);
+	    lines = cmd.substr(pos + 1).toInteger(2000,0,100);
+	}
+	else
+	    file = cmd;
+	if (file.null())
+	    return false;
+	writeScript(retVal,file,lines);
+	return true;
+    }
+    return false;
+}
+
+bool RouteBench::commandComplete(Message& msg, const String& partLine, const String& partWord)
+{
+    if (partLine == name()) {
+	for (const char** list = s_cmds; *list; list++)
+	    itemComplete(msg.retValue(),*list,partWord);
+	return true;
+    }
+    if (partLine.null() || (partLine == YSTRING("help")))
+	itemComplete(msg.retValue(),name(),partWord);
+    return Module::commandComplete(msg,partLine,partWord);
+}
+
+}; // anonymous namespace
+
+/* vi: set ts=8 sw=4 sts=4 noet: */
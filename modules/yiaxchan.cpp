@@ -435,6 +435,7 @@ protected:
     virtual void statusParams(String& str);
     void msgStatusAccounts(Message& msg);
     void msgStatusListeners(Message& msg);
+    void msgStatusTrunks(Message& msg);
     virtual void genUpdate(Message& msg);
     // Update default engine
     void updateDefaultEngine();
@@ -2169,6 +2170,7 @@ bool YIAXDriver::commandComplete(Message& msg, const String& partLine, const Str
 	partLine == ("status overview " + name())) {
 	itemComplete(msg.retValue(),"accounts",partWord);
 	itemComplete(msg.retValue(),"listeners",partWord);
+	itemComplete(msg.retValue(),"trunks",partWord);
     }
     return Driver::commandComplete(msg,partLine,partWord);
 }
@@ -2188,6 +2190,10 @@ void YIAXDriver::msgStatus(Message& msg)
 	    msgStatusListeners(msg);
 	    return;
 	}
+	if (str.startSkip("trunks")) {
+	    msgStatusTrunks(msg);
+	    return;
+	}
     }
     Driver::msgStatus(msg);
 }
@@ -2267,6 +2273,41 @@ void YIAXDriver::msgStatusListeners(Message& msg)
     msg.retValue() << "\r\n";
 }
 
+void YIAXDriver::msgStatusTrunks(Message& msg)
+{
+    msg.retValue().clear();
+    msg.retValue() << "module=" << name();
+    msg.retValue() << ",protocol=IAX";
+    msg.retValue() << ",format=OutFrames|OutMini|OutBytes|InFrames|InMini|InBytes;";
+    unsigned int n = 0;
+    String det;
+    bool details = msg.getBoolValue("details",true);
+    ObjList engines;
+    m_enginesMutex.lock();
+    for (ObjList* o = m_engines.skipNull(); o; o = o->skipNext()) {
+	YIAXEngine* e = static_cast<YIAXEngine*>(o->get());
+	if (e->ref())
+	    engines.append(e);
+    }
+    m_enginesMutex.unlock();
+    for (ObjList* o = engines.skipNull(); o; o = o->skipNext()) {
+	YIAXEngine* e = static_cast<YIAXEngine*>(o->get());
+	ObjList stats;
+	e->trunkStats(stats);
+	for (ObjList* l = stats.skipNull(); l; l = l->skipNext()) {
+	    n++;
+	    if (!details)
+		continue;
+	    IAXTrunkStats* st = static_cast<IAXTrunkStats*>(l->get());
+	    det.append(e->toString(),",") << "/" << st->toString() << "=";
+	    st->dump(det);
+	}
+    }
+    msg.retValue() << "trunks=" << n;
+    msg.retValue().append(det,";");
+    msg.retValue() << "\r\n";
+}
+
 // Add specific module update parameters
 void YIAXDriver::genUpdate(Message& msg)
 {
@@ -0,0 +1,340 @@
+/* libyateshm.c
+ * This file is part of the YATE Project http://YATE.null.ro
+ *
+ * C interface library for Yate external scripts with shared memory transport
+ *
+ * Yet Another Telephony Engine - a fully featured software PBX and IVR
+ * Copyright (C) 2004-2023 Null Team
+ *
+ * This software is distributed under multiple licenses;
+ * see the COPYING file in the main directory for licensing
+ * information for this specific distribution.
+ *
+ * This use of this software may be subject to additional restrictions.
+ * See the LEGAL file in the main directory for details.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/*
+    Build together with the script, for example:
+    cc -O2 -o myscript myscript.c libyateshm.c
+*/
+
+#include "libyateshm.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static int grow(char** buf, size_t* size, size_t need)
+{
+    if (need <= *size)
+	return 0;
+    size_t n = *size ? *size : 1024;
+    while (n < need)
+	n <<= 1;
+    char* b = (char*)realloc(*buf,n);
+    if (!b)
+	return -1;
+    *buf = b;
+    *size = n;
+    return 0;
+}
+
+static void copy_in(yate_conn* c, uint32_t pos, const void* src, size_t len)
+{
+    uint32_t size = c->hdr->size;
+    uint32_t offs = pos & (size - 1);
+    uint32_t first = size - offs;
+    if (first >= len)
+	memcpy(c->data[1] + offs,src,len);
+    else {
+	memcpy(c->data[1] + offs,src,first);
+	memcpy(c->data[1],(const char*)src + first,len - first);
+    }
+}
+
+static void copy_out(yate_conn* c, uint32_t pos, void* dest, size_t len)
+{
+    uint32_t size = c->hdr->size;
+    uint32_t offs = pos & (size - 1);
+    uint32_t first = size - offs;
+    if (first >= len)
+	memcpy(dest,c->data[0] + offs,len);
+    else {
+	memcpy(dest,c->data[0] + offs,first);
+	memcpy((char*)dest + first,c->data[0],len - first);
+    }
+}
+
+static int write_all(int fd, const char* data, size_t len)
+{
+    while (len) {
+	ssize_t w = write(fd,data,len);
+	if (w < 0) {
+	    if (errno == EINTR)
+		continue;
+	    return -1;
+	}
+	data += w;
+	len -= w;
+    }
+    return 0;
+}
+
+static int64_t now_ms()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+int yate_init(yate_conn* conn)
+{
+    struct stat st;
+    memset(conn,0,sizeof(*conn));
+    /* the engine passes no descriptor if the transport is disabled */
+    if (fstat(YSHM_FD_MEMORY,&st))
+	return (errno == EBADF) ? 0 : -1;
+    if (st.st_size < (off_t)sizeof(struct yshm_header))
+	return -1;
+    void* p = mmap(0,st.st_size,PROT_READ | PROT_WRITE,MAP_SHARED,YSHM_FD_MEMORY,0);
+    if (p == MAP_FAILED)
+	return -1;
+    struct yshm_header* hdr = (struct yshm_header*)p;
+    uint32_t size = hdr->size;
+    if ((__atomic_load_n(&hdr->magic,__ATOMIC_ACQUIRE) != YSHM_MAGIC) ||
+	!size || (size & (size - 1)) ||
+	(st.st_size < (off_t)(sizeof(*hdr) + 2 * (size_t)size))) {
+	munmap(p,st.st_size);
+	return -1;
+    }
+    conn->hdr = hdr;
+    conn->mapped = st.st_size;
+    conn->data[0] = (unsigned char*)(hdr + 1);
+    conn->data[1] = conn->data[0] + hdr->size;
+    return 0;
+}
+
+/* Return the first line queued while switching transport */
+static const char* queue_pop(yate_conn* c)
+{
+    char* eol = (char*)memchr(c->queue,'\n',c->queuelen);
+    size_t len = eol - c->queue;
+    if (grow(&c->buf,&c->bufsize,len + 1))
+	return 0;
+    memcpy(c->buf,c->queue,len);
+    c->buf[len] = 0;
+    c->queuelen -= len + 1;
+    memmove(c->queue,eol + 1,c->queuelen);
+    return c->buf;
+}
+
+/* Read a newline terminated line from stdin */
+static const char* pipe_recv(yate_conn* c, int timeout_ms)
+{
+    for (;;) {
+	char* eol = c->pipelen ? (char*)memchr(c->pipebuf,'\n',c->pipelen) : 0;
+	if (eol) {
+	    size_t len = eol - c->pipebuf;
+	    if (grow(&c->buf,&c->bufsize,len + 1))
+		return 0;
+	    memcpy(c->buf,c->pipebuf,len);
+	    c->buf[len] = 0;
+	    c->pipelen -= len + 1;
+	    memmove(c->pipebuf,eol + 1,c->pipelen);
+	    return c->buf;
+	}
+	if (grow(&c->pipebuf,&c->pipesize,c->pipelen + 4096))
+	    return 0;
+	if (timeout_ms >= 0) {
+	    struct pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
+	    if (poll(&pfd,1,timeout_ms) <= 0)
+		return 0;
+	}
+	ssize_t r = read(STDIN_FILENO,c->pipebuf + c->pipelen,c->pipesize - c->pipelen);
+	if (r < 0 && errno == EINTR)
+	    continue;
+	if (r <= 0)
+	    return 0;
+	c->pipelen += r;
+    }
+}
+
+int yate_use_shm(yate_conn* conn)
+{
+    if (conn->shm)
+	return 1;
+    if (!conn->hdr)
+	return 0;
+    if (yate_send(conn,"%%>setlocal:transport:shm"))
+	return -1;
+    for (;;) {
+	const char* line = pipe_recv(conn,-1);
+	if (!line)
+	    return -1;
+	if (!strncmp(line,"%%<setlocal:transport:",22)) {
+	    conn->shm = !strcmp(line + 22,"shm:true");
+	    return conn->shm;
+	}
+	/* keep anything else for yate_recv() */
+	size_t len = strlen(line);
+	if (grow(&conn->queue,&conn->queuesize,conn->queuelen + len + 1))
+	    return -1;
+	memcpy(conn->queue + conn->queuelen,line,len);
+	conn->queue[conn->queuelen + len] = '\n';
+	conn->queuelen += len + 1;
+    }
+}
+
+/* Wait until the engine signals us or the timeout expires.
+   Returns 0 if signaled or timed out, -1 if the engine went away */
+static int wait_engine(yate_conn* conn, int timeout_ms, int* signaled)
+{
+    struct pollfd pfd[2] = {
+	{ YSHM_FD_NOTIFY_APP, POLLIN, 0 },
+	{ STDIN_FILENO, POLLIN, 0 }
+    };
+    int res = poll(pfd,2,timeout_ms);
+    if (signaled)
+	*signaled = res;
+    if (res < 0)
+	return (errno == EINTR) ? 0 : -1;
+    if (pfd[0].revents & POLLIN) {
+	uint64_t cnt;
+	if (read(YSHM_FD_NOTIFY_APP,&cnt,sizeof(cnt)) < 0 && errno != EAGAIN)
+	    return -1;
+    }
+    /* the engine closes our stdin when it wants us to exit */
+    if (pfd[1].revents & (POLLIN | POLLHUP | POLLERR)) {
+	char tmp[256];
+	if (read(STDIN_FILENO,tmp,sizeof(tmp)) <= 0)
+	    return -1;
+    }
+    return 0;
+}
+
+int yate_send(yate_conn* conn, const char* line)
+{
+    if (conn->broken)
+	return -1;
+    size_t len = strlen(line);
+    if (!conn->shm) {
+	char* buf = 0;
+	size_t size = 0;
+	if (grow(&buf,&size,len + 1))
+	    return -1;
+	memcpy(buf,line,len);
+	buf[len] = '\n';
+	int res = write_all(STDOUT_FILENO,buf,len + 1);
+	free(buf);
+	return res;
+    }
+    struct yshm_ring* ring = &conn->hdr->rings[1];
+    uint32_t size = conn->hdr->size;
+    uint32_t need = len + sizeof(uint32_t);
+    if (need > size)
+	return -1;
+    uint32_t head = ring->head;
+    int64_t deadline = 0;
+    while (size - (head - __atomic_load_n(&ring->tail,__ATOMIC_ACQUIRE)) < need) {
+	/* the engine is behind, sleep until it frees some space */
+	int64_t now = now_ms();
+	if (!deadline)
+	    deadline = now + YSHM_SEND_TIMEOUT;
+	else if (now >= deadline)
+	    return -1;
+	__atomic_store_n(&ring->full,1,__ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (size - (head - __atomic_load_n(&ring->tail,__ATOMIC_ACQUIRE)) >= need) {
+	    __atomic_store_n(&ring->full,0,__ATOMIC_RELAXED);
+	    break;
+	}
+	int res = wait_engine(conn,(int)(deadline - now),0);
+	__atomic_store_n(&ring->full,0,__ATOMIC_RELAXED);
+	if (res) {
+	    conn->broken = 1;
+	    return -1;
+	}
+    }
+    uint32_t l = len;
+    copy_in(conn,head,&l,sizeof(l));
+    copy_in(conn,head + sizeof(l),line,len);
+    __atomic_store_n(&ring->head,head + need,__ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring->waiting,__ATOMIC_RELAXED)) {
+	uint64_t one = 1;
+	if (write(YSHM_FD_NOTIFY_ENGINE,&one,sizeof(one)) < 0)
+	    return -1;
+    }
+    return 0;
+}
+
+const char* yate_recv(yate_conn* conn, int timeout_ms)
+{
+    if (conn->broken)
+	return 0;
+    if (conn->queuelen)
+	return queue_pop(conn);
+    if (!conn->shm)
+	return pipe_recv(conn,timeout_ms);
+    struct yshm_ring* ring = &conn->hdr->rings[0];
+    uint32_t size = conn->hdr->size;
+    for (;;) {
+	uint32_t tail = ring->tail;
+	uint32_t head = __atomic_load_n(&ring->head,__ATOMIC_ACQUIRE);
+	if (head != tail) {
+	    /* never trust a length that goes past the written data */
+	    uint32_t avail = head - tail;
+	    uint32_t len = 0;
+	    if (avail <= size && avail >= sizeof(len))
+		copy_out(conn,tail,&len,sizeof(len));
+	    if (avail > size || avail < sizeof(len) || len > avail - sizeof(len)) {
+		conn->broken = 1;
+		return 0;
+	    }
+	    if (grow(&conn->buf,&conn->bufsize,len + 1))
+		return 0;
+	    copy_out(conn,tail + sizeof(len),conn->buf,len);
+	    conn->buf[len] = 0;
+	    __atomic_store_n(&ring->tail,tail + len + (uint32_t)sizeof(len),__ATOMIC_RELEASE);
+	    return conn->buf;
+	}
+	/* announce we sleep, check again to avoid missing a wakeup */
+	__atomic_store_n(&ring->waiting,1,__ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&ring->head,__ATOMIC_ACQUIRE) != tail) {
+	    __atomic_store_n(&ring->waiting,0,__ATOMIC_RELAXED);
+	    continue;
+	}
+	int signaled = 0;
+	int res = wait_engine(conn,timeout_ms,&signaled);
+	__atomic_store_n(&ring->waiting,0,__ATOMIC_RELAXED);
+	if (res) {
+	    conn->broken = 1;
+	    return 0;
+	}
+	if (!signaled)
+	    return 0;
+    }
+}
+
+void yate_close(yate_conn* conn)
+{
+    if (conn->hdr)
+	munmap(conn->hdr,conn->mapped);
+    free(conn->buf);
+    free(conn->pipebuf);
+    free(conn->queue);
+    memset(conn,0,sizeof(*conn));
+}
+
+/* vi: set ts=8 sw=4 sts=4 noet: */
@@ -0,0 +1,117 @@
+/* libyateshm.h
+ * This file is part of the YATE Project http://YATE.null.ro
+ *
+ * C interface library for Yate external scripts with shared memory transport
+ *
+ * Yet Another Telephony Engine - a fully featured software PBX and IVR
+ * Copyright (C) 2004-2023 Null Team
+ *
+ * This software is distributed under multiple licenses;
+ * see the COPYING file in the main directory for licensing
+ * information for this specific distribution.
+ *
+ * This use of this software may be subject to additional restrictions.
+ * See the LEGAL file in the main directory for details.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/*
+    Scripts started by the extmodule on Linux inherit a shared memory region
+    and two event descriptors. After a successful "%%>setlocal:transport:shm"
+    request the commands are exchanged through two single producer single
+    consumer rings instead of the stdin and stdout pipes.
+
+    The layout below must match the one in modules/extmodule.cpp
+*/
+
+#ifndef __LIBYATESHM_H
+#define __LIBYATESHM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define YSHM_MAGIC 0x59534d31
+#define YSHM_FD_MEMORY 5
+#define YSHM_FD_NOTIFY_APP 6
+#define YSHM_FD_NOTIFY_ENGINE 7
+
+struct yshm_ring {
+    uint32_t head;
+    uint32_t pad1[15];
+    uint32_t tail;
+    uint32_t pad2[15];
+    uint32_t waiting;
+    uint32_t pad3[15];
+    uint32_t full;
+    uint32_t pad4[15];
+};
+
+struct yshm_header {
+    uint32_t magic;
+    uint32_t size;
+    uint32_t pad[14];
+    /* ring 0 carries data from engine to application, ring 1 the other way */
+    struct yshm_ring rings[2];
+};
+
+typedef struct {
+    /* non zero once the shared memory transport is in use */
+    int shm;
+    struct yshm_header* hdr;
+    unsigned char* data[2];
+    size_t mapped;
+    /* received line or record, NUL terminated */
+    char* buf;
+    size_t bufsize;
+    /* data read from the pipe but not yet returned */
+    char* pipebuf;
+    size_t pipesize;
+    size_t pipelen;
+    /* lines received while switching transport, returned first */
+    char* queue;
+    size_t queuesize;
+    size_t queuelen;
+    /* non zero after a protocol error or if the engine went away */
+    int broken;
+} yate_conn;
+
+/* Maximum time in milliseconds to wait for free space in the ring */
+#define YSHM_SEND_TIMEOUT 10000
+
+/* Prepare a connection over stdin/stdout, map the shared memory if inherited.
+   Returns 0 on success or if no shared memory was inherited, -1 if the
+   inherited shared memory could not be set up. The pipe can be used anyway */
+int yate_init(yate_conn* conn);
+
+/* Ask the engine to switch to the shared memory transport.
+   Must be called before installing handlers or sending messages.
+   Returns 1 if shared memory is in use, 0 if not available, -1 on error */
+int yate_use_shm(yate_conn* conn);
+
+/* Send one already escaped command without line terminator.
+   If the ring is full waits at most YSHM_SEND_TIMEOUT for the engine.
+   Returns 0 on success, -1 on error */
+int yate_send(yate_conn* conn, const char* line);
+
+/* Receive one command. Returns a pointer to an internal buffer valid until the
+   next call, NULL on timeout, end of input or error. A negative timeout waits
+   forever. An invalid record in the ring breaks the connection */
+const char* yate_recv(yate_conn* conn, int timeout_ms);
+
+/* Release all resources */
+void yate_close(yate_conn* conn);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LIBYATESHM_H */
+
+/* vi: set ts=8 sw=4 sts=4 noet: */
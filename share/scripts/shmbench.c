@@ -0,0 +1,140 @@
+/* shmbench.c
+ * This file is part of the YATE Project http://YATE.null.ro
+ *
+ * Benchmark of the external module pipe and shared memory transports
+ *
+ * Yet Another Telephony Engine - a fully featured software PBX and IVR
+ * Copyright (C) 2004-2023 Null Team
+ *
+ * This software is distributed under multiple licenses;
+ * see the COPYING file in the main directory for licensing
+ * information for this specific distribution.
+ *
+ * This use of this software may be subject to additional restrictions.
+ * See the LEGAL file in the main directory for details.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/*
+    Built with the engine, or by hand:
+    cc -O2 -o shmbench shmbench.c libyateshm.c
+
+    Run from the rmanager console, once for each transport:
+    external start /path/to/shmbench 100000,pipe
+    external start /path/to/shmbench 100000,shm
+
+    Each run dispatches the given number of messages one at a time to measure
+    the round trip latency, then again keeping 64 messages in flight to
+    measure the throughput. Results are sent to the engine output.
+*/
+
+#include "libyateshm.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define WINDOW 64
+
+static uint64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int cmp_u64(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static int send_msg(yate_conn* c, unsigned int n)
+{
+    char line[128];
+    snprintf(line,sizeof(line),"%%%%>message:bench.%u:0:shmbench.ping::n=%u",n,n);
+    return yate_send(c,line);
+}
+
+/* wait for the answer to any of our messages */
+static int wait_answer(yate_conn* c)
+{
+    for (;;) {
+	const char* line = yate_recv(c,5000);
+	if (!line)
+	    return -1;
+	if (!strncmp(line,"%%<message:bench.",17))
+	    return 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int count = 10000;
+    const char* mode = "pipe";
+    char arg[64];
+    if (argc > 1) {
+	/* the engine passes a single parameter, accept count,mode */
+	strncpy(arg,argv[1],sizeof(arg) - 1);
+	arg[sizeof(arg) - 1] = 0;
+	char* sep = strchr(arg,',');
+	if (sep) {
+	    *sep++ = 0;
+	    mode = sep;
+	}
+	count = atoi(arg);
+	if (!count)
+	    count = 10000;
+    }
+    yate_conn c;
+    int ok = yate_init(&c);
+    if (!strcmp(mode,"shm") && (ok || (yate_use_shm(&c) != 1))) {
+	yate_send(&c,"%%>output:shmbench: shared memory transport not available");
+	return 1;
+    }
+    uint64_t* lat = (uint64_t*)malloc(count * sizeof(uint64_t));
+    if (!lat)
+	return 1;
+    uint64_t start = now_ns();
+    unsigned int i;
+    for (i = 0; i < count; i++) {
+	uint64_t t = now_ns();
+	if (send_msg(&c,i) || wait_answer(&c))
+	    break;
+	lat[i] = now_ns() - t;
+    }
+    uint64_t total = now_ns() - start;
+    unsigned int done = i;
+    qsort(lat,done,sizeof(uint64_t),cmp_u64);
+    /* pipelined run */
+    unsigned int sent = 0, recv = 0;
+    start = now_ns();
+    while (recv < count) {
+	while ((sent < count) && (sent - recv < WINDOW)) {
+	    if (send_msg(&c,sent))
+		break;
+	    sent++;
+	}
+	if (wait_answer(&c))
+	    break;
+	recv++;
+    }
+    uint64_t piped = now_ns() - start;
+    char line[256];
+    snprintf(line,sizeof(line),"%%%%>output:shmbench %s: %u round trips avg %.1f us p50 %.1f us p99 %.1f us,"
+	" %u pipelined in %.1f ms %.0f msg/s",
+	mode,done,done ? total / 1000.0 / done : 0.0,
+	done ? lat[done / 2] / 1000.0 : 0.0,done ? lat[(done * 99) / 100] / 1000.0 : 0.0,
+	recv,piped / 1000000.0,piped ? recv * 1000000000.0 / piped : 0.0);
+    yate_send(&c,line);
+    free(lat);
+    yate_close(&c);
+    return 0;
+}
+
+/* vi: set ts=8 sw=4 sts=4 noet: */
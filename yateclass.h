@@ -235,9 +235,11 @@ namespace TelEngine {
 #ifdef HAVE_BLOCK_RETURN
 #define YSTRING(s) (*({static const String str("" s);&str;}))
 #define YATOM(s) (*({static const String* str(0);str ? str : String::atom(str,"" s);}))
+#define YNAME(s) (*({static const String* str(0);str ? str : NamedString::atom(str,"" s);}))
 #else
 #define YSTRING(s) ("" s)
 #define YATOM(s) ("" s)
+#define YNAME(s) ("" s)
 #endif
 
 #define YSTRING_INIT_HASH ((unsigned) -1)
@@ -826,6 +828,27 @@ public:
      */
     static void setIntOut(void (*outFunc)(const char*,int) = 0);
 
+    /**
+     * Enable, resize or disable the asynchronous output mode.
+     * When enabled output lines are buffered per group of threads and written
+     *  by a background thread, lines that do not fit in buffers are dropped
+     * @param maxBytes Total size of the output buffers, zero to write synchronously
+     * @return True if asynchronous output is enabled after the call
+     */
+    static bool asyncOutput(unsigned int maxBytes);
+
+    /**
+     * Write immediately all output buffered in asynchronous mode
+     * @param emergency Write without taking any locks, for use from crash handlers
+     */
+    static void flushOutput(bool emergency = false);
+
+    /**
+     * Retrieve the number of output lines dropped in asynchronous mode
+     * @return Count of lines dropped because the buffers were full
+     */
+    static u_int64_t outputDropped();
+
     /**
      * Set the alarm hook callback
      * @param alarmFunc Pointer to the alarm callback function, NULL to disable
@@ -5450,12 +5473,54 @@ public:
     explicit NamedString(const char* name, const char* value = 0, int len = -1,
 	const char* namePrefix = 0, int nameLen = -1);
 
+    /**
+     * Creates a new named string. If the name is already interned, as when it
+     *  is the name of another NamedString, it is shared without any allocation
+     * @param name Name of this string
+     * @param value Initial value of the string
+     * @param len Length of the value, -1 for full string
+     * @param namePrefix Prefix to put in front of the name of this string
+     */
+    explicit NamedString(const String& name, const char* value = 0, int len = -1,
+	const char* namePrefix = 0);
+
+    /**
+     * Destructor. Releases the interned name
+     */
+    virtual ~NamedString();
+
     /**
      * Retrieve the name of this string.
+     * Names are interned engine-wide so identical names usually share the
+     *  same immutable String and compare equal by pointer
      * @return A hashed string with the name of the string
      */
     inline const String& name() const
-	{ return m_name; }
+	{ return *m_name; }
+
+    /**
+     * Change the name of this string. The name returned by name() must never
+     *  be modified directly as it is shared with other objects
+     * @param name New name of this string
+     */
+    void rename(const String& name);
+
+    /**
+     * Check if a string is an interned parameter name. NamedList lookups by
+     *  an interned name compare only pointers
+     * @param name String to check
+     * @return True if the string is an interned name
+     */
+    static bool isName(const String& name);
+
+    /**
+     * Interned parameter name support helper, used by the YNAME macro.
+     * The returned name stays referenced for the lifetime of the program
+     * @param str Reference to variable to hold the interned name
+     * @param name Text of the name
+     * @return Pointer to interned name
+     */
+    static const String* atom(const String*& str, const char* name);
 
     /**
      * Get a string representation of this object
@@ -5478,7 +5543,7 @@ public:
 
 private:
     NamedString(); // no default constructor please
-    String m_name;
+    const String* m_name;
 };
 
 /**
@@ -8844,6 +8909,33 @@ public:
      * @return Locking safety measures flag value
      */
     static bool safety();
+
+    /**
+     * Enable or disable the lock contention profiler.
+     * Acquisitions, contended acquisitions and wait time are accounted per lock
+     *  name, hold time is sampled
+     * @param sample Number of acquisitions of a lock between merging its statistics
+     *  and sampling its hold time, zero to disable profiling
+     */
+    static void enableProfiling(unsigned int sample);
+
+    /**
+     * Retrieve the lock contention profiler sampling interval
+     * @return Number of acquisitions between samples, zero if profiling is disabled
+     */
+    static unsigned int profiling();
+
+    /**
+     * Clear all lock contention statistics collected so far
+     */
+    static void resetProfiling();
+
+    /**
+     * Append lock contention statistics to a string in status format
+     * @param str String to append statistics to
+     * @param details True to append statistics of each lock name
+     */
+    static void dumpProfiling(String& str, bool details = true);
 };
 
 /**
@@ -11053,6 +11145,153 @@ protected:
     HANDLE m_handle;
 };
 
+/**
+ * Settings and statistics shared by writers that buffer lines of text and
+ *  append them in batches to log files, with optional fsync and rotation.
+ * This class is not thread safe, the caller must serialize access to it
+ * @short Helper for batched writing of text lines to log files
+ */
+class YATE_API BatchFileWriter
+{
+public:
+    /**
+     * When to flush the file data to the storage device
+     */
+    enum FsyncPolicy {
+	FsyncNone = 0,
+	FsyncFlush,
+	FsyncRotate,
+    };
+
+    /**
+     * Constructor, writes synchronously, never syncs or rotates
+     */
+    BatchFileWriter();
+
+    /**
+     * Read the settings from a list of parameters: flush_interval, flush_size,
+     *  max_backlog, fsync, rotate_size and rotate_interval
+     * @param params Parameters list, usually the general section of a module config
+     */
+    void setup(const NamedList& params);
+
+    /**
+     * Retrieve the interval at which the buffered lines must be written
+     * @return Flush interval in milliseconds, 0 to write synchronously
+     */
+    inline unsigned int flushInterval() const
+	{ return m_flushInterval; }
+
+    /**
+     * Check if the buffered data is large enough to be written before the interval expires
+     * @return True if the amount of buffered data reached the flush size
+     */
+    inline bool flushNow() const
+	{ return m_bytes >= m_flushSize; }
+
+    /**
+     * Check if the buffered data exceeds the backlog so producers must wait
+     * @return True if the amount of buffered data reached the maximum backlog
+     */
+    inline bool overflow() const
+	{ return m_bytes >= m_maxBacklog; }
+
+    /**
+     * Retrieve the fsync policy
+     * @return Value from the FsyncPolicy enumeration
+     */
+    inline int fsync() const
+	{ return m_fsync; }
+
+    /**
+     * Check if a file must be rotated before writing to it
+     * @param size Current size of the file
+     * @param since Time the file was created or last rotated in seconds, 0 if unknown
+     * @return True if the file reached the rotation size or interval
+     */
+    bool needRotate(int64_t size, u_int32_t since) const;
+
+    /**
+     * Rename a closed file appending the current time, never overwrite an existing file
+     * @param name Path and name of the file to rotate
+     * @param error Optional pointer to error code to be filled on failure
+     * @return True if the file was renamed
+     */
+    bool rotate(const String& name, int* error = 0);
+
+    /**
+     * Account a line added to the buffer
+     * @param bytes Length of the buffered line
+     */
+    void queued(unsigned int bytes);
+
+    /**
+     * Account all buffered lines taken to be written
+     * @return Number of lines that were buffered
+     */
+    unsigned int dequeued();
+
+    /**
+     * Account the result of writing buffered lines
+     * @param written Number of lines written successfully
+     * @param errors Number of failed write operations
+     * @param usec Time spent writing in microseconds
+     */
+    void flushed(unsigned int written, unsigned int errors, u_int64_t usec);
+
+    /**
+     * Append the backlog, write and rotation statistics to a status string
+     * @param str String to append comma separated name=value pairs to
+     */
+    void status(String& str) const;
+
+    /**
+     * Write lines of text to a file using as few system calls as possible.
+     * Partial writes are continued, a sync is done according to the fsync policy
+     * @param file File opened for writing
+     * @param lines List of String lines
+     * @param eoln Add a line terminator after each line
+     * @param bytes Optional pointer to count the number of bytes written
+     * @return True if all lines were written
+     */
+    bool writeLines(File& file, const ObjList& lines, bool eoln = true, int64_t* bytes = 0);
+
+    /**
+     * Flush the data of an open file to the storage device
+     * @param file File to flush
+     * @return True on success
+     */
+    static bool sync(File& file);
+
+    /**
+     * Line terminator used by the writer on this platform
+     * @return Line terminator as a C string
+     */
+    static const char* eoln();
+
+    /**
+     * Fsync policy names
+     */
+    static const TokenDict s_fsyncPolicy[];
+
+private:
+    unsigned int m_flushInterval;
+    unsigned int m_flushSize;
+    unsigned int m_maxBacklog;
+    int m_fsync;
+    int64_t m_rotateSize;
+    unsigned int m_rotateInterval;
+    unsigned int m_queued;
+    unsigned int m_bytes;
+    unsigned int m_maxQueued;
+    u_int64_t m_written;
+    u_int64_t m_flushes;
+    u_int64_t m_flushTime;
+    u_int64_t m_flushMax;
+    unsigned int m_errors;
+    unsigned int m_rotations;
+};
+
 /**
  * This class encapsulates a system dependent socket in a system independent abstraction
  * @short A generic socket class
@@ -12063,6 +12302,13 @@ public:
     inline const String& nextName() const
 	{ return m_next; }
 
+    /**
+     * Copy a NaptrRecord list into another one
+     * @param dest Destination list
+     * @param src Source list
+     */
+    static void copy(ObjList& dest, const ObjList& src);
+
 protected:
     String m_flags;
     String m_service;
@@ -12164,6 +12410,46 @@ public:
      */
     static int txtQuery(const char* dname, ObjList& result, String* error = 0);
 
+    /**
+     * Configure the query cache
+     * @param params Parameters list: cache, cache_size, min_ttl, max_ttl,
+     *  negative_ttl, wait_timeout, nameservers
+     */
+    static void setup(const NamedList& params);
+
+    /**
+     * Make a query using the cache. If the same query is already in progress
+     *  in another thread wait for its result instead of sending another one,
+     *  the wait fails with an error if it exceeds the configured wait_timeout.
+     * The resolver is initialized in the current thread if needed.
+     * This method blocks so it is suitable for ScriptAsync operations
+     * @param type Query type as enumeration
+     * @param dname Domain to query
+     * @param result List of resulting record items
+     * @param error Optional string to be filled with error string
+     * @return 0 on success, error code otherwise (h_errno value on Linux)
+     */
+    static int cachedQuery(Type type, const char* dname, ObjList& result, String* error = 0);
+
+    /**
+     * Copy a list of records of a given type into another one
+     * @param type Records type
+     * @param dest Destination list
+     * @param src Source list
+     */
+    static void copyRecords(Type type, ObjList& dest, const ObjList& src);
+
+    /**
+     * Append cache statistics to a status string
+     * @param buf Destination string
+     */
+    static void cacheStatus(String& buf);
+
+    /**
+     * Remove all completed entries from the query cache
+     */
+    static void cacheFlush();
+
     /**
      * Resolver type names
      */